@@ -19,6 +19,7 @@
 
 #include <poll.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <vector>
@@ -199,13 +200,40 @@ void Context::Load(const std::vector<std::string>& args,
   LoadBinary();
 
   // Create Arm-Thumb Symbol List
+  LoadMappingSymbols();
+}
+
+void Context::LoadMappingSymbols() {
+  // Collect mapping symbols. Symbols of the binary are already sorted by
+  // address, but a stable sort keeps the table valid regardless, while
+  // preserving the order of symbols at the same address.
+  std::vector<MappingSymbol> symbols;
   for (int i = 0; i < loader->binary->getNumSymbols(); i++) {
-    if (!(loader->binary->getSymbol(i)->getName().compare(0, 2, "$a")) ||
-        !(loader->binary->getSymbol(i)->getName().compare(0, 2, "$t"))) {
-      ELFReader::Symbol* symbolPtr = loader->binary->getSymbol(i);
-      thumb_symbol_list.push_back(symbolPtr);
-    }
+    ELFReader::Symbol* symbol = loader->binary->getSymbol(i);
+    if (!symbol->getName().compare(0, 2, "$a"))
+      symbols.push_back({symbol->getValue(), ContextModeArm});
+    else if (!symbol->getName().compare(0, 2, "$t"))
+      symbols.push_back({symbol->getValue(), ContextModeThumb});
   }
+  std::stable_sort(symbols.begin(), symbols.end(),
+                   [](const MappingSymbol& a, const MappingSymbol& b) {
+                     return a.address < b.address;
+                   });
+
+  // Build the table. The last symbol at an address determines the mode,
+  // and a symbol not changing the mode of the previous one is redundant.
+  mapping_symbols.clear();
+  for (const MappingSymbol& symbol : symbols) {
+    if (!mapping_symbols.empty() &&
+        mapping_symbols.back().address == symbol.address)
+      mapping_symbols.back().mode = symbol.mode;
+    else if (mapping_symbols.empty() ||
+             mapping_symbols.back().mode != symbol.mode)
+      mapping_symbols.push_back(symbol);
+  }
+
+  // Instructions decoded for a previous binary are no longer valid
+  decode_cache.clear();
 }
 
 void Context::HostThreadSuspend() {
@@ -387,8 +415,14 @@ void Context::Execute() {
     }
   }
 
+  // Look up the instruction decoded at this program counter
+  unsigned long long key =
+      ((unsigned long long)regs.getPC() << 1) | (regs.getCPSR().thumb != 0);
+  auto it = decode_cache.find(key);
+  DecodeCacheEntry* entry = it == decode_cache.end() ? nullptr : &it->second;
+
   // Get ARM operating mode
-  ContextMode arm_mode = OperateMode(regs.getPC() - 2);
+  ContextMode arm_mode = entry ? entry->mode : OperateMode(regs.getPC() - 2);
 
   // Change PC according to the thumb field in CPSR
   if (arm_mode == ContextModeArm) {
@@ -407,43 +441,66 @@ void Context::Execute() {
     }
   }
 
-  // Get buffer according to the Program Counter
-  char* buffer_ptr;
-  if (regs.getCPSR().thumb != 0)
-    buffer_ptr =
-        memory->getBuffer((regs.getPC() - 2), 2, mem::Memory::AccessExec);
-  else
-    buffer_ptr =
-        memory->getBuffer((regs.getPC() - 4), 4, mem::Memory::AccessExec);
-
-  // Return to default safe mode
-  memory->setSafeDefault();
+  // Reuse the decoded instruction if the code did not change
+  if (entry) {
+    if (entry->inst_type == ContextInstTypeThumb32) regs.incPC(2);
+    if (ReadInstBytes(entry->inst_type) == entry->bytes) {
+      memory->setSafeDefault();
+      inst = entry->inst;
+      setInstType(entry->inst_type);
+    } else {
+      if (entry->inst_type == ContextInstTypeThumb32) regs.decPC(2);
+      entry = nullptr;
+    }
+  }
 
-  // Disassemble
-  if (regs.getCPSR().thumb != 0) {
-    if (IsThumb32(buffer_ptr)) {
-      regs.incPC(2);
+  // Decode instruction
+  if (!entry) {
+    // Get buffer according to the Program Counter
+    char* buffer_ptr;
+    if (regs.getCPSR().thumb != 0)
+      buffer_ptr =
+          memory->getBuffer((regs.getPC() - 2), 2, mem::Memory::AccessExec);
+    else
       buffer_ptr =
           memory->getBuffer((regs.getPC() - 4), 4, mem::Memory::AccessExec);
-      inst.Thumb32Decode(buffer_ptr, (regs.getPC() - 4));
-      setInstType(ContextInstTypeThumb32);
-      if (inst.getThumb32Opcode() == Instruction::Thumb32OpcodeInvalid)
+
+    // Return to default safe mode
+    memory->setSafeDefault();
+
+    // Disassemble
+    if (regs.getCPSR().thumb != 0) {
+      if (IsThumb32(buffer_ptr)) {
+        regs.incPC(2);
+        buffer_ptr =
+            memory->getBuffer((regs.getPC() - 4), 4, mem::Memory::AccessExec);
+        inst.Thumb32Decode(buffer_ptr, (regs.getPC() - 4));
+        setInstType(ContextInstTypeThumb32);
+        if (inst.getThumb32Opcode() == Instruction::Thumb32OpcodeInvalid)
+          throw misc::Panic(misc::fmt(
+              "0x%x: not supported arm instruction (%02x %02x %02x %02x...)",
+              (regs.getPC() - 4), buffer_ptr[0], buffer_ptr[1], buffer_ptr[2],
+              buffer_ptr[3]));
+      } else {
+        inst.Thumb16Decode(buffer_ptr, (regs.getPC() - 2));
+        setInstType(ContextInstTypeThumb16);
+      }
+    } else {
+      inst.Decode((regs.getPC() - 4), buffer_ptr);
+      setInstType(ContextInstTypeArm32);
+      if (inst.getOpcode() == Instruction::OpcodeInvalid)
         throw misc::Panic(misc::fmt(
             "0x%x: not supported arm instruction (%02x %02x %02x %02x...)",
             (regs.getPC() - 4), buffer_ptr[0], buffer_ptr[1], buffer_ptr[2],
             buffer_ptr[3]));
-    } else {
-      inst.Thumb16Decode(buffer_ptr, (regs.getPC() - 2));
-      setInstType(ContextInstTypeThumb16);
     }
-  } else {
-    inst.Decode((regs.getPC() - 4), buffer_ptr);
-    setInstType(ContextInstTypeArm32);
-    if (inst.getOpcode() == Instruction::OpcodeInvalid)
-      throw misc::Panic(misc::fmt(
-          "0x%x: not supported arm instruction (%02x %02x %02x %02x...)",
-          (regs.getPC() - 4), buffer_ptr[0], buffer_ptr[1], buffer_ptr[2],
-          buffer_ptr[3]));
+
+    // Save the decoded instruction
+    DecodeCacheEntry& new_entry = decode_cache[key];
+    new_entry.mode = arm_mode;
+    new_entry.inst_type = getInstType();
+    new_entry.inst = inst;
+    new_entry.bytes = ReadInstBytes(getInstType());
   }
 
   // Execute instruction
@@ -570,35 +627,25 @@ void Context::Finish(int exit_code) {
 }
 
 ContextMode Context::OperateMode(unsigned int addr) {
-  ELFReader::Symbol* symbol;
-  ContextMode mode;
-
-  // Locate the symbol tag in the sorted symbol list by input address
-  unsigned int tag_index;
-  for (unsigned int i = 0; i < thumb_symbol_list.size(); ++i) {
-    symbol = thumb_symbol_list[i];
-    if (symbol->getValue() > addr) {
-      tag_index = i - 1;
-      break;
-    }
-  }
+  // Locate the last mapping symbol at or before the address. Code before
+  // the first mapping symbol runs in ARM mode.
+  auto it = std::upper_bound(
+      mapping_symbols.begin(), mapping_symbols.end(), addr,
+      [](unsigned addr, const MappingSymbol& symbol) {
+        return addr < symbol.address;
+      });
+  if (it == mapping_symbols.begin()) return ContextModeArm;
+  return (it - 1)->mode;
+}
 
-  // Get the ARM operating mode based on the symbol
-  if (tag_index < 0 || tag_index >= thumb_symbol_list.size()) {
-    symbol = nullptr;
-  } else {
-    symbol = thumb_symbol_list[tag_index];
-  }
-  if (symbol) {
-    if (!(symbol->getName().compare(0, 2, "$a"))) {
-      mode = ContextModeArm;
-    } else if (!(symbol->getName().compare(0, 2, "$t"))) {
-      mode = ContextModeThumb;
-    }
-  } else {
-    mode = ContextModeArm;
-  }
-  return mode;
+unsigned Context::ReadInstBytes(ContextInstType inst_type) {
+  // Thumb-16 instructions end at PC - 2, other instructions at PC - 4
+  unsigned size = inst_type == ContextInstTypeThumb16 ? 2 : 4;
+  char* buffer_ptr =
+      memory->getBuffer(regs.getPC() - size, size, mem::Memory::AccessExec);
+  unsigned bytes = 0;
+  memcpy(&bytes, buffer_ptr, size);
+  return bytes;
 }
 
 unsigned int Context::CheckKuserHelper() {
@@ -21,7 +21,9 @@
 #define ARCH_ARM_EMU_CONTEXT_H
 
 #include <iostream>
+#include <map>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <arch/arm/disassembler/Disassembler.h>
@@ -171,8 +173,43 @@ class Context {
   // Get instruction type
   ContextInstType getInstType() { return inst_type; }
 
-  // symbol list used for getting the ARM operating mode
-  std::vector<ELFReader::Symbol*> thumb_symbol_list;
+  // Entry of the mapping symbol table, giving the operating mode of the
+  // code that starts at an address
+  struct MappingSymbol {
+    unsigned address;
+    ContextMode mode;
+  };
+
+  // Table of '$a' and '$t' mapping symbols used for getting the ARM
+  // operating mode, sorted by address. Consecutive symbols with the same
+  // mode are merged into one entry.
+  std::vector<MappingSymbol> mapping_symbols;
+
+  // Build 'mapping_symbols' from the mapping symbols of the binary
+  void LoadMappingSymbols();
+
+  // Instruction decoded at a program counter
+  struct DecodeCacheEntry {
+    // Operating mode at the program counter
+    ContextMode mode;
+
+    // Instruction type and decoded instruction
+    ContextInstType inst_type;
+    Instruction inst;
+
+    // Instruction bytes that were decoded, checked before every use of
+    // the entry in case the code was modified or remapped
+    unsigned bytes;
+  };
+
+  // Decoded instructions, indexed by the value of the program counter and
+  // the thumb flag of the CPSR when the instruction is fetched
+  std::unordered_map<unsigned long long, DecodeCacheEntry> decode_cache;
+
+  // Read the bytes of the instruction of the given type at the program
+  // counter, with the program counter already adjusted to the operating
+  // mode
+  unsigned ReadInstBytes(ContextInstType inst_type);
 
   // Fault Management
   unsigned int fault_addr;
@@ -238,6 +275,12 @@ class Context {
   void Suspend(CanWakeupFn can_wakeup_fn, WakeupFn wakeup_fn,
                ContextState wakeup_state);
 
+  // All pairs of wakeup callbacks, used to save them in checkpoints by
+  // their position in the table. The first entry is a pair of null
+  // callbacks.
+  static const std::pair<CanWakeupFn, WakeupFn> wakeup_callbacks[];
+  static const unsigned num_wakeup_callbacks;
+
   ///////////////////////////////////////////////////////////////////////
   //
   // Functions implemented in ContextLoader.cc. These are the functions
@@ -620,6 +663,16 @@ class Context {
             const std::string& stdin_file_name,
             const std::string& stdout_file_name);
 
+  /// Save the architectural state of the context into a checkpoint. The
+  /// context must not be in speculative mode.
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) const;
+
+  /// Restore the state saved with SaveCheckpoint() into a context just
+  /// created with Emulator::newContext(). Host file descriptors reopened
+  /// by previous contexts are recorded in \a host_indexes.
+  void LoadCheckpoint(misc::Checkpoint& checkpoint,
+                      std::map<int, int>& host_indexes);
+
   /// Given a file name, return its full path based on the current working
   /// directory for the context.
   std::string getFullPath(const std::string& path) {
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <lib/cpp/Checkpoint.h>
+
 #include "Emulator.h"
 #include "Context.h"
 
@@ -171,6 +173,39 @@ void Emulator::LoadProgram(const std::vector<std::string>& args,
   context->Load(args, env, cwd, stdin_file_name, stdout_file_name);
 }
 
+void Emulator::SaveCheckpoint(misc::Checkpoint& checkpoint) {
+  // Emulator state
+  checkpoint.WriteTag("ARM");
+  checkpoint.WriteValue(pid);
+  checkpoint.WriteValue(futex_sleep_count);
+
+  // Contexts, in the order of the main list
+  checkpoint.WriteValue((int)contexts.size());
+  for (auto& context : contexts) context->SaveCheckpoint(checkpoint);
+}
+
+void Emulator::LoadCheckpoint(misc::Checkpoint& checkpoint) {
+  // Contexts must be created from the checkpoint only
+  if (contexts.size())
+    throw Error("Cannot load a checkpoint after loading a program");
+
+  // Emulator state. The process ID counter is restored last, since
+  // creating contexts consumes new IDs.
+  checkpoint.ReadTag("ARM");
+  int saved_pid = checkpoint.ReadValue<int>();
+  checkpoint.ReadValue(futex_sleep_count);
+
+  // Contexts
+  std::map<int, int> host_indexes;
+  int num_contexts = checkpoint.ReadValue<int>();
+  for (int i = 0; i < num_contexts; i++)
+    newContext()->LoadCheckpoint(checkpoint, host_indexes);
+  pid = saved_pid;
+
+  // Let suspended contexts check whether they can wake up
+  ProcessEventsSchedule();
+}
+
 void Emulator::freeContext(Context* context) {
   // Remove context from all context lists
   for (int i = 0; i < ContextListCount; i++)
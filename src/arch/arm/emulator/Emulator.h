@@ -142,6 +142,13 @@ class Emulator : public comm::Emulator {
                    const std::string& stdin_file_name = "",
                    const std::string& stdout_file_name = "");
 
+  /// Save all contexts into a checkpoint. See comm::Emulator for details.
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) override;
+
+  /// Create the contexts saved in a checkpoint. See comm::Emulator for
+  /// details.
+  void LoadCheckpoint(misc::Checkpoint& checkpoint) override;
+
   /// Add a context to a context list if it is not present already
   void AddContextToList(ContextListType type, Context* context);
 
@@ -34,6 +34,15 @@ Context::Context(Emulator* emulator) : emulator(emulator) {
   name = misc::fmt("%s context %d", emulator->getName().c_str(), id);
 }
 
+void Context::setId(int id) {
+  // Assign ID and recompute name
+  this->id = id;
+  name = misc::fmt("%s context %d", emulator->getName().c_str(), id);
+
+  // Keep future IDs unique
+  if (id_counter <= id) id_counter = id + 1;
+}
+
 void Context::Suspend() { throw misc::Panic("Not implemented"); }
 
 void Context::Wakeup() { throw misc::Panic("Not implemented"); }
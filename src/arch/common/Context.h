@@ -43,6 +43,11 @@ class Context {
   // Associated emulator, initialized in constructor
   Emulator* emulator;
 
+ protected:
+  /// Replace the context identifier with one recorded in a checkpoint.
+  /// Contexts created afterwards receive higher identifiers.
+  void setId(int id);
+
  public:
   /// Constructor
   Context(Emulator* emulator);
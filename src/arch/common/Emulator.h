@@ -20,6 +20,7 @@
 #ifndef ARCH_COMMON_EMULATOR_H
 #define ARCH_COMMON_EMULATOR_H
 
+#include <atomic>
 #include <cstdlib>
 #include <string>
 
@@ -28,6 +29,10 @@
 #include <lib/esim/Engine.h>
 #include <memory/Mmu.h>
 
+namespace misc {
+class Checkpoint;
+}
+
 namespace comm {
 
 class Emulator {
@@ -51,8 +56,9 @@ class Emulator {
   /// Event-driven simulation engine
   esim::Engine* esim;
 
-  /// Number of emulated instructions
-  long long num_instructions = 0;
+  /// Number of emulated instructions. Host threads of a timing simulator
+  /// may emulate instructions concurrently.
+  std::atomic<long long> num_instructions{0};
 
  public:
   /// Constructor
@@ -67,7 +73,7 @@ class Emulator {
   mem::Mmu* getMmu() { return &mmu; }
 
   /// Increment the number of emulated instructions
-  void incNumInstructions() { ++num_instructions; }
+  void incNumInstructions(long long count = 1) { num_instructions += count; }
 
   /// Return the number of emulated instructions
   long long getNumInstructions() const { return num_instructions; }
@@ -122,6 +128,19 @@ class Emulator {
     throw misc::Panic("Unimplemented");
   }
 
+  /// Save the state of all guest contexts into a checkpoint. This function
+  /// should be overridden by the CPU architectures supporting checkpoints.
+  virtual void SaveCheckpoint(misc::Checkpoint& checkpoint) {
+    throw misc::Panic("Unimplemented");
+  }
+
+  /// Create the guest contexts saved in a checkpoint with a previous call
+  /// to SaveCheckpoint(), leaving them ready to continue execution. This
+  /// function replaces LoadProgram() when a simulation is restored.
+  virtual void LoadCheckpoint(misc::Checkpoint& checkpoint) {
+    throw misc::Panic("Unimplemented");
+  }
+
   /// Run one iteration of the emulation loop for the architecture. If
   /// there was an active emulation, the function returns \c true. This is
   /// a virtual abstract function. Every emulator derived from this class
@@ -17,7 +17,11 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <fcntl.h>
 #include <unistd.h>
+#include <cstring>
+
+#include <lib/cpp/Checkpoint.h>
 
 #include "FileTable.h"
 
@@ -138,4 +142,115 @@ void FileTable::freeFileDescriptor(int index) {
   descriptors[index] = nullptr;
 }
 
+void FileTable::SaveCheckpoint(misc::Checkpoint& checkpoint) const {
+  checkpoint.WriteTag("FileTable");
+  checkpoint.WriteValue((unsigned)descriptors.size());
+  for (auto& desc : descriptors) {
+    // Empty entry
+    checkpoint.WriteValue(desc != nullptr);
+    if (!desc) continue;
+
+    // Only files whose host state can be reconstructed are supported
+    FileDescriptor::Type type = desc->getType();
+    if (type != FileDescriptor::TypeStandard &&
+        type != FileDescriptor::TypeRegular &&
+        type != FileDescriptor::TypeVirtual)
+      throw misc::Checkpoint::Error(
+          checkpoint.getPath(),
+          misc::fmt("Guest file descriptor %d of type '%s' cannot be saved",
+                    desc->getGuestIndex(),
+                    FileDescriptor::TypeTypeMap[type]));
+
+    // Common fields
+    checkpoint.WriteValue(type);
+    checkpoint.WriteValue(desc->getHostIndex());
+    checkpoint.WriteValue(desc->getFlags());
+    checkpoint.WriteString(desc->getPath());
+
+    // Current host file offset. Non-seekable standard streams report -1.
+    off_t offset = lseek(desc->getHostIndex(), 0, SEEK_CUR);
+    checkpoint.WriteValue((long long)offset);
+
+    // Content of virtual files, which live in temporary host files that
+    // will not exist anymore when the checkpoint is loaded.
+    if (type == FileDescriptor::TypeVirtual) {
+      std::string content;
+      char buffer[4096];
+      ssize_t count;
+      off_t position = 0;
+      while ((count = pread(desc->getHostIndex(), buffer, sizeof buffer,
+                            position)) > 0) {
+        content.append(buffer, count);
+        position += count;
+      }
+      checkpoint.WriteString(content);
+    }
+  }
+}
+
+void FileTable::LoadCheckpoint(misc::Checkpoint& checkpoint,
+                               std::map<int, int>& host_indexes) {
+  checkpoint.ReadTag("FileTable");
+  descriptors.clear();
+  unsigned size = checkpoint.ReadValue<unsigned>();
+  for (unsigned guest_index = 0; guest_index < size; guest_index++) {
+    // Empty entry
+    descriptors.emplace_back(nullptr);
+    if (!checkpoint.ReadValue<bool>()) continue;
+
+    // Common fields
+    auto type = checkpoint.ReadValue<FileDescriptor::Type>();
+    int saved_host_index = checkpoint.ReadValue<int>();
+    int flags = checkpoint.ReadValue<int>();
+    std::string path = checkpoint.ReadString();
+    off_t offset = checkpoint.ReadValue<long long>();
+    std::string content;
+    if (type == FileDescriptor::TypeVirtual) content = checkpoint.ReadString();
+
+    // Reuse the host file if it was already reopened. The standard input
+    // and output of the simulator are used as they are.
+    int host_index;
+    bool reopened = false;
+    auto it = host_indexes.find(saved_host_index);
+    if (it != host_indexes.end()) {
+      host_index = it->second;
+    } else if (type == FileDescriptor::TypeStandard && path.empty()) {
+      host_index = saved_host_index;
+    } else if (type == FileDescriptor::TypeVirtual) {
+      // Recreate temporary file with the saved content
+      char temp_path[256];
+      strcpy(temp_path, "/tmp/m2s.XXXXXX");
+      host_index = mkstemp(temp_path);
+      if (host_index < 0 ||
+          write(host_index, content.data(), content.size()) !=
+              (ssize_t)content.size())
+        throw misc::Checkpoint::Error(checkpoint.getPath(),
+                                      "Cannot create temporary file");
+      path = temp_path;
+      reopened = true;
+    } else {
+      // Regular file or redirected standard stream. Files are reopened
+      // without truncating them, since their content is part of the
+      // state that the guest program has already produced.
+      int open_flags = flags & ~(O_CREAT | O_TRUNC | O_EXCL);
+      if (type == FileDescriptor::TypeStandard && (flags & O_ACCMODE))
+        open_flags |= O_APPEND;
+      host_index = open(path.c_str(), open_flags);
+      if (host_index < 0)
+        throw misc::Checkpoint::Error(
+            checkpoint.getPath(),
+            misc::fmt("%s: Cannot reopen guest file", path.c_str()));
+      reopened = true;
+    }
+
+    // Restore offset of newly opened files
+    if (reopened && offset >= 0) lseek(host_index, offset, SEEK_SET);
+    host_indexes[saved_host_index] = host_index;
+
+    // Create descriptor
+    descriptors[guest_index].reset(
+        new FileDescriptor(type, guest_index, host_index, flags, path));
+  }
+}
+
 }  // namespace comm
@@ -21,12 +21,17 @@
 #define ARCH_X86_EMU_FILE_TABLE_H
 
 #include <iostream>
+#include <map>
 #include <memory>
 #include <vector>
 
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/String.h>
 
+namespace misc {
+class Checkpoint;
+}
+
 namespace comm {
 
 class Driver;
@@ -171,6 +176,23 @@ class FileTable {
   /// Return the guest file descriptor associated with a host file
   /// descriptor given in \a host_index, or -1 if invalid.
   int getGuestIndex(int host_index) const;
+
+  /// Save the file descriptor table into a checkpoint. Regular files are
+  /// saved by path and file offset, and virtual files by content.
+  ///
+  /// \throw
+  ///	A misc::Checkpoint::Error is thrown if the table contains a pipe,
+  ///	a socket, or a device, whose state cannot be saved.
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) const;
+
+  /// Replace the content of the table with the file descriptors saved in
+  /// a checkpoint, reopening the corresponding host files. Argument \a
+  /// host_indexes maps host file descriptors recorded in the checkpoint
+  /// to the ones reopened in the current process. It is shared across all
+  /// tables loaded from the same checkpoint, so that a host file shared
+  /// by several guest descriptors or tables is only opened once.
+  void LoadCheckpoint(misc::Checkpoint& checkpoint,
+                      std::map<int, int>& host_indexes);
 };
 
 }  // namespace comm
@@ -31,4 +31,8 @@ unsigned int BrigEntry::getOffset() const {
   return base - section->getBuffer();
 }
 
+void BrigEntry::setOffset(unsigned int offset) {
+  base = section->getBuffer() + offset;
+}
+
 }  // namespace HSA
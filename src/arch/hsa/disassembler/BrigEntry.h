@@ -49,6 +49,11 @@ class BrigEntry {
   /// Get the offset of this entry in the section
   unsigned int getOffset() const;
 
+  /// Point the entry to another offset in the same section. This lets
+  /// an entry object be reused as a cursor instead of allocating a new
+  /// entry for every step.
+  void setOffset(unsigned int offset);
+
   /// Set the BRIG section is belongs to
   void setSection(const BrigSection* section);
 
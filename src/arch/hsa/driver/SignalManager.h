@@ -34,8 +34,9 @@ class SignalManager {
   // A hash map that maps from the signal handler to the signals
   std::unordered_map<uint64_t, std::unique_ptr<Signal>> signals;
 
-  // The handler to allocate next
-  uint64_t handler_to_allocate = 0;
+  // The handler to allocate next. Handler 0 is never allocated, so
+  // that it can stand for no signal in AQL packets.
+  uint64_t handler_to_allocate = 1;
 
  public:
   /// Constructor
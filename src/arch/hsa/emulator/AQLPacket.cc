@@ -26,7 +26,7 @@ AQLPacket::AQLPacket() {}
 
 AQLPacket::~AQLPacket() {}
 
-void AQLPacket::Assign() { setFormat(AQLFormatDispatch); }
+void AQLPacket::Assign() { setFormat(AQLFormatKernelDispatch); }
 
 void AQLPacket::setFormat(unsigned char format) {
   setByOffset<unsigned char>(0, format);
@@ -55,4 +55,15 @@ void AQLDispatchPacket::Dump(std::ostream& os = std::cout) const {
   os << "\t***** ****** *****\n";
 }
 
+void AQLBarrierPacket::Dump(std::ostream& os = std::cout) const {
+  os << "\t***** Barrier packet *****\n";
+  os << misc::fmt("\tformat: 0x%x, \n", getFormat());
+  for (unsigned i = 0; i < num_dependent_signals; i++)
+    os << misc::fmt("\tdependent signal %u: 0x%" PRIx64 ", \n", i,
+                    getDependentSignal(i));
+  os << misc::fmt("\tcompletion signal: 0x%" PRIx64 "\n",
+                  getCompletionSignal());
+  os << "\t***** ****** *****\n";
+}
+
 }  // namespace HSA
@@ -25,12 +25,15 @@
 
 namespace HSA {
 
+/// Packet types, as encoded by the guest in the low byte of the packet
+/// header. Values match \c hsa_packet_type_t in the HSA runtime.
 enum AQLFormat {
-  AQLFormatAlwaysReserved = 0,
-  AQLFormatInvalid,
-  AQLFormatDispatch,
-  AQLFormatBarrier,
-  AQLFormatAgentDispatch
+  AQLFormatVendorSpecific = 0,
+  AQLFormatInvalid = 1,
+  AQLFormatKernelDispatch = 2,
+  AQLFormatBarrierAnd = 3,
+  AQLFormatAgentDispatch = 4,
+  AQLFormatBarrierOr = 5
 };
 
 /// Represent an AQL packet for HSA agent to dispatch task
@@ -73,7 +76,7 @@ class AQLPacket {
   ~AQLPacket();
 
   /// Assign the packet to the HSA Packet Processor, by changing the AQL
-  /// packet format field from INVALID or ALWAYS_RESERVED
+  /// packet format field from INVALID to KERNEL_DISPATCH
   void Assign();
 
   /// Returns the pointer to the beginning of the packet buffer
@@ -90,8 +93,13 @@ class AQLPacket {
 
   /// Set the header in whole
   void setHeader(unsigned short header) {
-    setByOffset<unsigned int>(2, header);
+    setByOffset<unsigned short>(0, header);
   }
+
+  /// Return true if the barrier bit is set in the header. A packet with
+  /// the barrier bit set is not launched until all preceding packets
+  /// in its queue have completed.
+  bool getBarrierBit() const { return (getHeader() >> 8) & 1; }
 };
 
 // An AQLDispatchPacket encapsulates information required to launch a kernel
@@ -231,6 +239,40 @@ class AQLDispatchPacket : public AQLPacket {
   }
 };
 
+/// An AQLBarrierPacket holds back the packets behind it in its queue
+/// until a set of dependent signals is satisfied. The format field tells
+/// whether all signals (barrier-AND) or any of them (barrier-OR) must
+/// reach zero.
+class AQLBarrierPacket : public AQLPacket {
+ public:
+  /// Maximum number of dependent signals in a barrier packet
+  static const unsigned num_dependent_signals = 5;
+
+  /// Return the dependent signal with the given index. A handler of 0
+  /// means that the slot is not used.
+  uint64_t getDependentSignal(unsigned index) const {
+    return getByOffset<uint64_t>(8 + index * 8);
+  }
+
+  /// Set the dependent signal with the given index
+  void setDependentSignal(unsigned index, uint64_t signal) {
+    setByOffset<uint64_t>(8 + index * 8, signal);
+  }
+
+  /// Return the completion signal
+  uint64_t getCompletionSignal() const { return getByOffset<uint64_t>(56); }
+
+  /// Dump the AQL barrier packet
+  void Dump(std::ostream& os) const;
+
+  /// Operator \c << invoking the function Dump) on an output stream
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const AQLBarrierPacket& packet) {
+    packet.Dump(os);
+    return os;
+  }
+};
+
 }  // namespace HSA
 
 #endif
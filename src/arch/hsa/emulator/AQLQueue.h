@@ -85,6 +85,12 @@ class AQLQueue {
   /// size of AQLPacket
   void allocatesPacketSlot() { fields->write_index += sizeof(AQLPacket); }
 
+  /// Return the packet at the read index without consuming it, or
+  /// nullptr if the queue is empty
+  AQLPacket* getHeadPacket() {
+    return isEmpty() ? nullptr : getPacket(getReadIndex());
+  }
+
   /// Read next packet, increase read_index, mark the packet format as
   /// Invalid
   AQLDispatchPacket* ReadPacket();
@@ -32,12 +32,11 @@ BrInstructionWorker::~BrInstructionWorker() {}
 
 void BrInstructionWorker::Execute(BrigCodeEntry* instruction) {
   // Retrieve 1st operand
-  auto operand0 = instruction->getOperand(0);
-  if (operand0->getKind() == BRIG_KIND_OPERAND_CODE_REF) {
-    auto label = operand0->getRef();
-
+  const Function::Operand& operand0 =
+      stack_frame->getFunction()->getOperand(instruction, 0);
+  if (operand0.kind == BRIG_KIND_OPERAND_CODE_REF) {
     // Redirect pc to a certain label
-    stack_frame->setPc(std::move(label));
+    stack_frame->setPc(operand0.label);
     return;
   } else {
     throw misc::Panic("Unsupported operand type for CBR.");
@@ -46,12 +46,11 @@ void CbrInstructionWorker::Execute(BrigCodeEntry* instruction) {
   // Jump if condition is true
   if (condition) {
     // Retrieve 1st operand
-    auto operand1 = instruction->getOperand(1);
-    if (operand1->getKind() == BRIG_KIND_OPERAND_CODE_REF) {
-      auto label = operand1->getRef();
-
+    const Function::Operand& operand1 =
+        stack_frame->getFunction()->getOperand(instruction, 1);
+    if (operand1.kind == BRIG_KIND_OPERAND_CODE_REF) {
       // Redirect pc to a certain label
-      stack_frame->setPc(std::move(label));
+      stack_frame->setPc(operand1.label);
       return;
     } else {
       throw misc::Panic("Unsupported operand type for CBR.");
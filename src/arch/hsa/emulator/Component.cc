@@ -17,8 +17,13 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include "Component.h"
+#include <cinttypes>
+
+#include <arch/hsa/driver/Driver.h>
+#include <arch/hsa/driver/SignalManager.h>
+
 #include "AQLQueue.h"
+#include "Component.h"
 
 namespace HSA {
 
@@ -62,36 +67,120 @@ void Component::addQueue(std::unique_ptr<AQLQueue> queue) {
   queues.emplace_back(std::move(queue));
 }
 
+unsigned Component::getNumActiveGrids(AQLQueue* queue) const {
+  unsigned count = 0;
+  for (auto it = grids.begin(); it != grids.end(); it++)
+    if (it->queue == queue) count++;
+  return count;
+}
+
+bool Component::isBarrierSatisfied(AQLBarrierPacket* packet) const {
+  SignalManager* signal_manager = Driver::getInstance()->getSignalManager();
+
+  // A barrier-AND packet waits for all its signals, a barrier-OR packet
+  // for any of them. Unused slots hold the null handler.
+  bool is_or = packet->getFormat() == AQLFormatBarrierOr;
+  bool has_signal = false;
+  for (unsigned i = 0; i < AQLBarrierPacket::num_dependent_signals; i++) {
+    uint64_t signal = packet->getDependentSignal(i);
+    if (!signal) continue;
+    has_signal = true;
+
+    if (!signal_manager->isValidSignalHandler(signal))
+      throw Error(misc::fmt("Barrier packet waits on invalid signal 0x%" PRIx64,
+                            signal));
+
+    bool satisfied = signal_manager->GetValue(signal) == 0;
+    if (is_or && satisfied) return true;
+    if (!is_or && !satisfied) return false;
+  }
+
+  // A barrier-OR packet without signals completes right away
+  return !is_or || !has_signal;
+}
+
+bool Component::ProcessQueueHead(AQLQueue* queue) {
+  AQLPacket* packet = queue->getHeadPacket();
+  if (!packet) return false;
+
+  // A packet with the barrier bit waits for the earlier packets of its
+  // queue to complete
+  if (packet->getBarrierBit() && getNumActiveGrids(queue)) return false;
+
+  switch (packet->getFormat()) {
+    case AQLFormatKernelDispatch:
+
+      if (grids.size() >= Emulator::max_active_grids) return false;
+      LaunchGrid(queue->ReadPacket(), queue);
+      return true;
+
+    case AQLFormatBarrierAnd:
+    case AQLFormatBarrierOr:
+
+    {
+      AQLBarrierPacket* barrier = (AQLBarrierPacket*)packet;
+      if (!isBarrierSatisfied(barrier)) return false;
+
+      // Consume the packet and signal its completion
+      Emulator::aql_debug << "Barrier packet completed: \n" << *barrier;
+      uint64_t completion_signal = barrier->getCompletionSignal();
+      queue->ReadPacket();
+      if (completion_signal) {
+        SignalManager* signal_manager =
+            Driver::getInstance()->getSignalManager();
+        signal_manager->ChangeValue(
+            completion_signal, signal_manager->GetValue(completion_signal) - 1);
+      }
+      return true;
+    }
+
+    default:
+
+      // The packet has not been assigned to the packet processor yet
+      // (invalid header), or its type is not supported. It stays at the
+      // head of the queue.
+      return false;
+  }
+}
+
 bool Component::Execute() {
   // std::cout << misc::fmt("Component %lld executing\n", this->getHandler());
-  // 1. Check if the tasks is being processed. If true, process it.
-  bool has_active_grid = false;
+  // 1. Execute the grids being processed, and retire those finished.
   auto it = grids.begin();
   while (it != grids.end()) {
-    if ((*it)->Execute()) {
-      has_active_grid = true;
+    if (it->grid->Execute()) {
       it++;
     } else {
       it = grids.erase(it);
     }
   }
-  if (has_active_grid) return true;
 
-  // 2. Otherwise, read from queue list and grab a task to start.
-  for (auto it = queues.begin(); it != queues.end(); it++) {
-    if (!(*it)->isEmpty()) {
-      AQLDispatchPacket* packet = (*it)->ReadPacket();
-      LaunchGrid(packet);
-      return true;
+  // 2. Serve the queues in round-robin order, starting after the last
+  // queue that had a packet consumed. Each round consumes at most one
+  // packet per queue, so that no queue can starve the others.
+  bool progress = true;
+  while (progress && !queues.empty()) {
+    progress = false;
+    unsigned num_queues = queues.size();
+    unsigned first_queue = next_queue % num_queues;
+    for (unsigned i = 0; i < num_queues; i++) {
+      unsigned index = (first_queue + i) % num_queues;
+      if (ProcessQueueHead(queues[index].get())) {
+        next_queue = index + 1;
+        progress = true;
+      }
     }
   }
 
   // 3. If this component is not running and there is no pending task,
   // 	return false indicating this component is idle.
+  if (!grids.empty()) return true;
+  for (auto& queue : queues)
+    if (!queue->isEmpty()) return true;
   return false;
 }
 
-void Component::LaunchGrid(AQLDispatchPacket* packet) {
+void Component::LaunchGrid(AQLDispatchPacket* packet, AQLQueue* queue) {
   // Dump debug information
   Emulator::aql_debug << "Packet dispatched: \n" << *packet;
 
@@ -101,7 +190,10 @@ void Component::LaunchGrid(AQLDispatchPacket* packet) {
   if (Emulator::aql_debug) grid->Dump(Emulator::aql_debug);
 
   // Insert grid into list
-  this->grids.push_back(std::move(grid));
+  ActiveGrid active_grid;
+  active_grid.queue = queue;
+  active_grid.grid = std::move(grid);
+  this->grids.push_back(std::move(active_grid));
 }
 
 void Component::Dump(std::ostream& os = std::cout) const {
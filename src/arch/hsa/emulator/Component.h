@@ -22,6 +22,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "../../../../runtime/include/hsa.h"
 #include "Emulator.h"
@@ -56,11 +57,32 @@ class Component {
   // Information of current device
   AgentInfo agent_info;
 
-  // List of work groups
-  std::list<std::unique_ptr<Grid>> grids;
+  // A grid being executed, with the queue its packet was read from
+  struct ActiveGrid {
+    AQLQueue* queue;
+    std::unique_ptr<Grid> grid;
+  };
+
+  // List of grids being executed
+  std::list<ActiveGrid> grids;
 
   // List of queues associated with this component
-  std::list<std::unique_ptr<AQLQueue>> queues;
+  std::vector<std::unique_ptr<AQLQueue>> queues;
+
+  // Index of the queue served first in the next arbitration round
+  unsigned next_queue = 0;
+
+  // Return the number of grids being executed that were launched from
+  // the given queue
+  unsigned getNumActiveGrids(AQLQueue* queue) const;
+
+  // Return true if the dependent signals of a barrier packet allow it
+  // to complete
+  bool isBarrierSatisfied(AQLBarrierPacket* packet) const;
+
+  // Process the packet at the head of a queue. Return true if the
+  // packet was consumed.
+  bool ProcessQueueHead(AQLQueue* queue);
 
  public:
   /// Constructor
@@ -85,8 +107,8 @@ class Component {
   ///	their tasks, the emulation finishes.
   bool Execute();
 
-  /// Create a grid from a dispatch packet
-  void LaunchGrid(AQLDispatchPacket* packet);
+  /// Create a grid from a dispatch packet read from a queue
+  void LaunchGrid(AQLDispatchPacket* packet, AQLQueue* queue);
 
   /// Dump the information about the agent
   void Dump(std::ostream& os) const;
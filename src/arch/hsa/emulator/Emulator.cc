@@ -50,6 +50,12 @@ misc::Debug Emulator::aql_debug;
 // Singleton instance
 std::unique_ptr<Emulator> Emulator::instance;
 
+// Work group residency
+unsigned Emulator::max_resident_work_groups = 64;
+
+// Concurrent grids
+unsigned Emulator::max_active_grids = 4;
+
 //
 // Functions
 //
@@ -82,9 +88,28 @@ void Emulator::RegisterOptions() {
       "(default = functional)",
       (int&)sim_kind, comm::Arch::SimKindMap,
       "Level of accuracy of HSA simulation");
+
+  // Option --hsa-max-work-groups <num>
+  command_line->RegisterUInt32(
+      "--hsa-max-work-groups <num> (default = 64)", max_resident_work_groups,
+      "Maximum number of work groups of a grid resident at a time. Work "
+      "groups are created as earlier ones finish, so that host memory "
+      "does not grow with the grid size.");
+
+  // Option --hsa-max-grids <num>
+  command_line->RegisterUInt32(
+      "--hsa-max-grids <num> (default = 4)", max_active_grids,
+      "Maximum number of grids executing at a time on a component. Queues "
+      "are served in round-robin order, so kernels dispatched to different "
+      "queues run concurrently up to this limit.");
+
 }
 
 void Emulator::ProcessOptions() {
+  if (!max_resident_work_groups)
+    throw Error("Option --hsa-max-work-groups must be at least 1");
+  if (!max_active_grids)
+    throw Error("Option --hsa-max-grids must be at least 1");
   loader_debug.setPath(hsa_debug_loader_file);
   isa_debug.setPath(hsa_debug_isa_file);
   aql_debug.setPath(hsa_debug_aql_file);
@@ -22,6 +22,7 @@
 
 #include <list>
 #include <memory>
+#include <unordered_map>
 
 #include <arch/common/Arch.h>
 #include <arch/common/Emulator.h>
@@ -33,6 +34,7 @@
 
 #include "AQLQueue.h"
 #include "Component.h"
+#include "HsaInstructionWorker.h"
 
 namespace HSA {
 
@@ -86,6 +88,12 @@ class Emulator : public comm::Emulator {
   // Global memory manager
   std::unique_ptr<mem::Manager> manager;
 
+  // Instruction workers indexed by opcode, shared by all work items. They
+  // are created the first time an opcode is executed and rebound to the
+  // executing work item and stack frame afterwards.
+  std::unordered_map<unsigned, std::unique_ptr<HsaInstructionWorker>>
+      instruction_workers;
+
  public:
   /// Destructor
   ~Emulator() {
@@ -124,11 +132,34 @@ class Emulator : public comm::Emulator {
   /// Dump component list for debug purpose
   void DumpComponentList(std::ostream& os) const;
 
+  /// Return the instruction worker for the given opcode, or `nullptr` if
+  /// no work item executed the opcode yet
+  HsaInstructionWorker* getInstructionWorker(unsigned opcode) const {
+    auto it = instruction_workers.find(opcode);
+    return it == instruction_workers.end() ? nullptr : it->second.get();
+  }
+
+  /// Keep the instruction worker for the given opcode, and return it
+  HsaInstructionWorker* addInstructionWorker(
+      unsigned opcode, std::unique_ptr<HsaInstructionWorker> worker) {
+    HsaInstructionWorker* result = worker.get();
+    instruction_workers[opcode] = std::move(worker);
+    return result;
+  }
+
   /// Run one iteration of the emulation loop
   /// \return This function \c true if the iteration had a useful emulation
   /// and \c false if all work items finished execution
   bool Run();
 
+  /// Maximum number of work groups of a grid resident at a time, set
+  /// with option --hsa-max-work-groups
+  static unsigned max_resident_work_groups;
+
+  /// Maximum number of grids executing at a time on a component, set
+  /// with option --hsa-max-grids
+  static unsigned max_active_grids;
+
   /// Debugger for HSA
   static misc::Debug loader_debug;
   static misc::Debug isa_debug;
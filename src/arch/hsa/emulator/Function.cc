@@ -22,6 +22,7 @@
 #include <arch/hsa/disassembler/AsmService.h>
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
 #include <arch/hsa/disassembler/BrigFile.h>
+#include <arch/hsa/disassembler/BrigImmed.h>
 #include <arch/hsa/disassembler/BrigOperandEntry.h>
 #include <lib/cpp/String.h>
 
@@ -96,6 +97,74 @@ unsigned int Function::getRegisterOffset(const std::string& name) const {
   return it->second;
 }
 
+Function::RegisterOperand Function::ResolveRegister(
+    const std::string& name) const {
+  RegisterOperand reg;
+  reg.size = AsmService::getSizeInByteByRegisterName(name);
+  if (name[1] == 'c') {
+    reg.control = true;
+    reg.offset = name[2] - '0';
+  } else {
+    reg.offset = getRegisterOffset(name);
+  }
+  return reg;
+}
+
+Function::RegisterOperand Function::DecodeRegisterOperand(
+    const BrigOperandEntry* operand) const {
+  return ResolveRegister(operand->getRegisterName());
+}
+
+Function::Operand Function::DecodeOperand(const BrigCodeEntry* instruction,
+                                          unsigned index) const {
+  Operand decoded;
+  auto operand = instruction->getOperand(index);
+  decoded.kind = operand->getKind();
+  switch (decoded.kind) {
+    case BRIG_KIND_OPERAND_CONSTANT_BYTES: {
+      BrigImmed immed(operand->getBytes(), instruction->getOperandType(index));
+      decoded.bytes = operand->getBytes();
+      decoded.size = immed.getSize();
+      break;
+    }
+
+    case BRIG_KIND_OPERAND_REGISTER:
+      decoded.reg = DecodeRegisterOperand(operand.get());
+      break;
+
+    case BRIG_KIND_OPERAND_ADDRESS: {
+      auto symbol = operand->getSymbol();
+      if (symbol.get()) decoded.address.symbol = symbol->getName();
+      auto reg = operand->getReg();
+      if (reg.get()) {
+        decoded.address.has_register = true;
+        decoded.address.reg = DecodeRegisterOperand(reg.get());
+      }
+      decoded.address.offset = operand->getOffset();
+      break;
+    }
+
+    case BRIG_KIND_OPERAND_CODE_REF:
+      decoded.label = operand->getRef()->getOffset();
+      break;
+
+    case BRIG_KIND_OPERAND_OPERAND_LIST: {
+      unsigned vector_size = instruction->getVectorModifier();
+      for (unsigned i = 0; i < vector_size; i++) {
+        auto element = operand->getOperandElement(i);
+        if (element->getKind() != BRIG_KIND_OPERAND_REGISTER)
+          throw misc::Panic("Unsupported operand type in operand list");
+        decoded.elements.push_back(DecodeRegisterOperand(element.get()));
+      }
+      break;
+    }
+
+    default:
+      break;
+  }
+  return decoded;
+}
+
 void Function::AllocateRegister(unsigned int* max_register) {
   for (unsigned int i = 0; i < 4; i++) {
     for (unsigned int j = 0; j < max_register[i]; j++) {
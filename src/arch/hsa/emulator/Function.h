@@ -23,6 +23,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
 
@@ -32,6 +34,7 @@ namespace HSA {
 
 class StackFrame;
 class HsaExecutable;
+class BrigOperandEntry;
 
 /// A function encapsulates information about a HSAIL function
 class Function {
@@ -84,6 +87,72 @@ class Function {
   // Add register information into table
   void addRegister(BrigRegisterKind kind, unsigned short number);
 
+ public:
+  /// Location of a register in the stack frame, resolved once from its
+  /// name so that instructions can access it without string lookups
+  struct RegisterOperand {
+    // True for 1-bit control registers, which are stored apart from
+    // the register storage
+    bool control = false;
+
+    // Offset in the register storage, or index of a control register
+    unsigned offset = 0;
+
+    // Size of the register in bytes
+    unsigned size = 0;
+  };
+
+  /// Components of an address operand decoded from the BRIG file
+  struct AddressOperand {
+    // Name of the symbol the address is based on, empty if none
+    std::string symbol;
+
+    // Whether the address adds the value of a register
+    bool has_register = false;
+
+    // Base register, valid if has_register is set
+    RegisterOperand reg;
+
+    // Constant offset
+    unsigned long long offset = 0;
+  };
+
+  /// Operand of an instruction decoded from the BRIG file, so that its
+  /// value can be accessed without creating operand entries
+  struct Operand {
+    // Kind of operand entry
+    BrigKind kind = BRIG_KIND_NONE;
+
+    // Value of a constant operand in the BRIG file, and its size given
+    // by the operand type of the instruction
+    const unsigned char* bytes = nullptr;
+    unsigned size = 0;
+
+    // Register operand
+    RegisterOperand reg;
+
+    // Address operand
+    AddressOperand address;
+
+    // Offset in the code section of the label of a code reference
+    unsigned label = 0;
+
+    // Registers of an operand list, one per element of the vector
+    std::vector<RegisterOperand> elements;
+  };
+
+ private:
+  // Operands decoded so far, indexed by the offset of the instruction in
+  // the code section and the index of the operand in the instruction
+  std::unordered_map<unsigned long long, Operand> operands;
+
+  // Return the location of the register referenced by an operand entry
+  RegisterOperand DecodeRegisterOperand(const BrigOperandEntry* operand) const;
+
+  // Decode an operand of an instruction
+  Operand DecodeOperand(const BrigCodeEntry* instruction,
+                        unsigned index) const;
+
  public:
   /// Constructor
   Function(const std::string& name);
@@ -110,6 +179,9 @@ class Function {
   /// Return pointer to the last entry
   std::unique_ptr<BrigCodeEntry> getLastEntry() const;
 
+  /// Return the offset of the last entry in the code section
+  unsigned getLastEntryOffset() const { return last_entry->getOffset(); }
+
   /// Set the directive
   void setFunctionDirective(std::unique_ptr<BrigCodeEntry> directive) {
     this->function_directive = std::move(directive);
@@ -136,6 +208,22 @@ class Function {
   /// return -1.
   unsigned int getRegisterOffset(const std::string& name) const;
 
+  /// Return the location of a register given its name
+  RegisterOperand ResolveRegister(const std::string& name) const;
+
+  /// Return an operand of an instruction of the function. The operand is
+  /// decoded the first time it is accessed and served from a table
+  /// afterwards.
+  const Operand& getOperand(const BrigCodeEntry* instruction,
+                            unsigned index) {
+    unsigned long long key =
+        (unsigned long long)instruction->getOffset() << 8 | index;
+    auto it = operands.find(key);
+    if (it != operands.end()) return it->second;
+    return operands.emplace(key, DecodeOperand(instruction, index))
+        .first->second;
+  }
+
   /// Return the size of register required
   unsigned int getRegisterSize() const { return register_size; }
 
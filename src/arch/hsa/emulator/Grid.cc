@@ -17,6 +17,7 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
 
@@ -34,7 +35,7 @@ namespace HSA {
 
 Grid::Grid(Component* component, AQLDispatchPacket* packet) {
   // Set packet
-  this->packet = packet;
+  this->packet = *packet;
 
   // Set component
   this->component = component;
@@ -52,6 +53,12 @@ Grid::Grid(Component* component, AQLDispatchPacket* packet) {
   group_size_z = packet->getWorkGroupSizeZ();
   group_size = group_size_x * group_size_y * group_size_z;
 
+  // Set number of work groups. Work groups are created during execution.
+  num_groups_x = (grid_size_x + group_size_x - 1) / group_size_x;
+  num_groups_y = (grid_size_y + group_size_y - 1) / group_size_y;
+  num_groups_z = (grid_size_z + group_size_z - 1) / group_size_z;
+  num_groups = num_groups_x * num_groups_y * num_groups_z;
+
   // Get kernel object
   HsaExecutableSymbol* kernel_object =
       (HsaExecutableSymbol*)packet->getKernalObjectAddress();
@@ -82,11 +89,9 @@ Grid::Grid(Component* component, AQLDispatchPacket* packet) {
     kernel_arguments.emplace(name, std::move(argument));
 
     // Copy argument
-    auto host_buffer = misc::new_unique_array<char>(argument_size * dim);
-    memory->Read(kernel_args + input_argument_offset, argument_size * dim,
-                 host_buffer.get());
     unsigned flat_address = kernarg_segment->getFlatAddress(address);
-    memory->Write(flat_address, argument_size * dim, host_buffer.get());
+    memory->Copy(flat_address, memory, kernel_args + input_argument_offset,
+                 argument_size * dim);
 
     // Move arg_entry forward
     argument_entry = argument_entry->Next();
@@ -95,23 +100,23 @@ Grid::Grid(Component* component, AQLDispatchPacket* packet) {
     input_argument_offset += argument_size * dim;
   }
 
-  // Create work items
-  for (unsigned int i = 0; i < grid_size; i++) {
-    unsigned int z = i / grid_size_x / grid_size_y;
-    unsigned int y = i % (grid_size_x * grid_size_y) / grid_size_x;
-    unsigned int x = i % (grid_size_x * grid_size_y) % grid_size_x;
-    deployWorkItem(x, y, z, packet->getPrivateSegmentSizeBytes(),
-                   packet->getGroupSegmentSizeBytes());
-  }
-
   // Retrieve signal manager
   signal_manager = Driver::getInstance()->getSignalManager();
 }
 
-Grid::~Grid() {}
+Grid::~Grid() {
+  // Release work groups while the segment pools still exist
+  workgroups.clear();
+}
 
 bool Grid::Execute() {
-  bool active = false;
+  // Create work groups up to the maximum number resident at a time
+  while (next_group < num_groups &&
+         workgroups.size() < Emulator::max_resident_work_groups)
+    createWorkGroup(next_group++);
+
+  // Work groups not created yet
+  bool active = next_group < num_groups;
   auto it = workgroups.begin();
   while (it != workgroups.end()) {
     if (it->second->Execute()) {
@@ -123,8 +128,8 @@ bool Grid::Execute() {
   }
 
   // Send completion signal when finished execution
-  if (!active) {
-    uint64_t completion_signal = packet->getCompletionSignal();
+  uint64_t completion_signal = packet.getCompletionSignal();
+  if (!active && completion_signal) {
     int64_t signal_value = signal_manager->GetValue(completion_signal);
     Emulator::isa_debug << misc::fmt(
         "Kernel execution finished, "
@@ -154,39 +159,63 @@ void Grid::Dump(std::ostream& os = std::cout) const {
   os << "***** **** *****\n";
 }
 
-void Grid::deployWorkItem(unsigned int abs_id_x, unsigned int abs_id_y,
-                          unsigned int abs_id_z, unsigned private_segment_size,
-                          unsigned group_segment_size) {
+void Grid::createWorkGroup(unsigned int flattened_id) {
   // Get work group id
-  unsigned int group_id_x = abs_id_x / group_size_x;
-  unsigned int group_id_y = abs_id_y / group_size_y;
-  unsigned int group_id_z = abs_id_z / group_size_z;
-  unsigned int group_flattened_id = group_id_x + group_id_y * group_size_x +
-                                    group_id_z * group_size_x * group_size_y;
-
-  // Check if the work group exist. If not, create it.
-  auto it = workgroups.find(group_flattened_id);
-  if (it == workgroups.end()) {
-    createWorkGroup(group_id_x, group_id_y, group_id_z, group_segment_size);
-    it = workgroups.find(group_flattened_id);
+  unsigned int id_x = flattened_id % num_groups_x;
+  unsigned int id_y = flattened_id / num_groups_x % num_groups_y;
+  unsigned int id_z = flattened_id / num_groups_x / num_groups_y;
+  auto work_group = misc::new_unique<WorkGroup>(
+      this, packet.getGroupSegmentSizeBytes(), id_x, id_y, id_z);
+
+  // Create work items, leaving out the ones beyond the grid in a partial
+  // work group
+  unsigned int end_x = std::min(grid_size_x, (id_x + 1) * group_size_x);
+  unsigned int end_y = std::min(grid_size_y, (id_y + 1) * group_size_y);
+  unsigned int end_z = std::min(grid_size_z, (id_z + 1) * group_size_z);
+  for (unsigned int z = id_z * group_size_z; z < end_z; z++) {
+    for (unsigned int y = id_y * group_size_y; y < end_y; y++) {
+      for (unsigned int x = id_x * group_size_x; x < end_x; x++) {
+        auto work_item = misc::new_unique<WorkItem>();
+        work_item->Initialize(work_group.get(),
+                              packet.getPrivateSegmentSizeBytes(), x, y, z,
+                              root_function);
+        work_group->addWorkItem(std::move(work_item));
+      }
+    }
   }
-  WorkGroup* work_group = it->second.get();
 
-  // Create work item
-  auto work_item = misc::new_unique<WorkItem>();
-  work_item->Initialize(work_group, private_segment_size, abs_id_x, abs_id_y,
-                        abs_id_z, root_function);
+  // Add it to the resident work groups
+  workgroups.insert(std::make_pair(flattened_id, std::move(work_group)));
+}
 
-  // Add created work item into work group
-  work_group->addWorkItem(std::move(work_item));
+std::unique_ptr<SegmentManager> Grid::AcquireGroupSegment(unsigned size) {
+  if (free_group_segments.empty())
+    return misc::new_unique<SegmentManager>(
+        Emulator::getInstance()->getMemory(), size);
+  std::unique_ptr<SegmentManager> segment =
+      std::move(free_group_segments.back());
+  free_group_segments.pop_back();
+  return segment;
 }
 
-void Grid::createWorkGroup(unsigned int id_x, unsigned int id_y,
-                           unsigned int id_z, unsigned group_segment_size) {
-  auto work_group =
-      misc::new_unique<WorkGroup>(this, group_segment_size, id_x, id_y, id_z);
-  unsigned int flattened_id = work_group->getGroupFlattenedId();
-  workgroups.insert(std::make_pair(flattened_id, std::move(work_group)));
+std::unique_ptr<SegmentManager> Grid::AcquirePrivateSegment(unsigned size) {
+  if (free_private_segments.empty())
+    return misc::new_unique<SegmentManager>(
+        Emulator::getInstance()->getMemory(), size);
+  std::unique_ptr<SegmentManager> segment =
+      std::move(free_private_segments.back());
+  free_private_segments.pop_back();
+  return segment;
+}
+
+void Grid::ReleaseGroupSegment(std::unique_ptr<SegmentManager> segment) {
+  segment->Clear();
+  free_group_segments.push_back(std::move(segment));
+}
+
+void Grid::ReleasePrivateSegment(std::unique_ptr<SegmentManager> segment) {
+  segment->Clear();
+  free_private_segments.push_back(std::move(segment));
 }
 
 }  // namespace HSA
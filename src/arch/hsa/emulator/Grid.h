@@ -21,6 +21,8 @@
 #define ARCH_HSA_EMULATOR_GRID_H
 
 #include <map>
+#include <memory>
+#include <vector>
 
 // #include "WorkGroup.h"
 #include "AQLPacket.h"
@@ -40,8 +42,9 @@ class Grid {
   // Component it belongs to
   Component* component;
 
-  // The packet that launches this kernel
-  AQLDispatchPacket* packet;
+  // Copy of the packet that launches this kernel. The queue slot may be
+  // reused by the producer while the grid is still running.
+  AQLDispatchPacket packet;
 
   // The signal manager
   SignalManager* signal_manager;
@@ -65,6 +68,19 @@ class Grid {
   // Work group size, number of work items in a work group
   unsigned int group_size;
 
+  // Number of work groups along each dimension, including partial ones
+  unsigned int num_groups_x;
+  unsigned int num_groups_y;
+  unsigned int num_groups_z;
+
+  // Number of work groups in the grid
+  unsigned int num_groups;
+
+  // Flattened id of the next work group to create. Work groups are
+  // created on demand, when fewer than Emulator::max_resident_work_groups
+  // are running.
+  unsigned int next_group = 0;
+
   // Root function to execute
   Function* root_function;
 
@@ -77,17 +93,17 @@ class Grid {
   // Kernal arguments
   std::map<std::string, std::unique_ptr<Variable>> kernel_arguments;
 
-  // List of work groups, maps work group flattened absolute id
-  std::map<unsigned int, std::unique_ptr<WorkGroup>> workgroups;
+  // Segments released by finished work groups and work items, reused by
+  // the ones created later
+  std::vector<std::unique_ptr<SegmentManager>> free_group_segments;
+  std::vector<std::unique_ptr<SegmentManager>> free_private_segments;
 
-  // Deploy tasks on work item
-  void deployWorkItem(unsigned int abs_id_x, unsigned int abs_id_y,
-                      unsigned int abs_id_z, unsigned private_segment_size,
-                      unsigned group_segment_size);
+  // List of resident work groups, maps work group flattened absolute id
+  std::map<unsigned int, std::unique_ptr<WorkGroup>> workgroups;
 
-  // Create work group
-  void createWorkGroup(unsigned int id_x, unsigned int id_y, unsigned int id_z,
-                       unsigned group_segment_size);
+  // Create the work group with the given flattened id, together with its
+  // work items
+  void createWorkGroup(unsigned int flattened_id);
 
  public:
   /// Constructor
@@ -142,6 +158,20 @@ class Grid {
   /// Return the kernel segment manager
   SegmentManager* getKernargSegment() const { return kernarg_segment.get(); }
 
+  /// Return a group segment for a new work group, reusing one released by
+  /// a finished work group if available
+  std::unique_ptr<SegmentManager> AcquireGroupSegment(unsigned size);
+
+  /// Return a private segment for a new work item, reusing one released
+  /// by a finished work item if available
+  std::unique_ptr<SegmentManager> AcquirePrivateSegment(unsigned size);
+
+  /// Release the group segment of a finished work group
+  void ReleaseGroupSegment(std::unique_ptr<SegmentManager> segment);
+
+  /// Release the private segment of a finished work item
+  void ReleasePrivateSegment(std::unique_ptr<SegmentManager> segment);
+
   /// Return the kernel argument variable by the name. If the name is
   /// not found, return nullptr;
   Variable* getKernelArgument(const std::string& name) {
@@ -54,6 +54,15 @@ class HsaInstructionWorker {
   /// Destructor
   virtual ~HsaInstructionWorker(){};
 
+  /// Attach the worker to another work item and stack frame, so that a
+  /// single worker per opcode can be reused across instructions
+  void Bind(WorkItem* work_item, StackFrame* stack_frame) {
+    this->work_item = work_item;
+    this->stack_frame = stack_frame;
+    operand_value_retriever->Bind(work_item, stack_frame);
+    operand_value_writer->Bind(work_item, stack_frame);
+  }
+
   /// Execute the instruction
   virtual void Execute(BrigCodeEntry* instruction) = 0;
 
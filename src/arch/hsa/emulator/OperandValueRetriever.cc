@@ -17,9 +17,9 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cstring>
+
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
-#include <arch/hsa/disassembler/BrigImmed.h>
-#include <arch/hsa/disassembler/BrigOperandEntry.h>
 
 #include "OperandValueRetriever.h"
 #include "StackFrame.h"
@@ -35,18 +35,16 @@ OperandValueRetriever::~OperandValueRetriever() {}
 
 void OperandValueRetriever::Retrieve(BrigCodeEntry* instruction,
                                      unsigned int index, void* buffer) {
-  // Get the operand entry
-  auto operand = instruction->getOperand(index);
+  // Get the operand, decoded the first time it is accessed
+  const Function::Operand& operand =
+      stack_frame->getFunction()->getOperand(instruction, index);
 
   // Do corresponding action according to the type of operand
-  switch (operand->getKind()) {
+  switch (operand.kind) {
     case BRIG_KIND_OPERAND_CONSTANT_BYTES:
 
-    {
-      BrigImmed immed(operand->getBytes(), instruction->getOperandType(index));
-      immed.getImmedValue(buffer);
+      memcpy(buffer, operand.bytes, operand.size);
       return;
-    }
 
     case BRIG_KIND_OPERAND_WAVESIZE:
 
@@ -55,44 +53,22 @@ void OperandValueRetriever::Retrieve(BrigCodeEntry* instruction,
 
     case BRIG_KIND_OPERAND_REGISTER:
 
-    {
-      std::string register_name = operand->getRegisterName();
-      stack_frame->getRegisterValue(register_name, buffer);
+      stack_frame->getRegisterValue(operand.reg, buffer);
       return;
-    }
 
     case BRIG_KIND_OPERAND_ADDRESS:
 
     {
+      const Function::AddressOperand& operand_address = operand.address;
       unsigned long long address = 0;
-      unsigned long long offset = operand->getOffset();
-      if (operand->getSymbol().get()) {
-        auto symbol = operand->getSymbol();
-        std::string name = symbol->getName();
-
-        // Get the variable
-        Variable* variable = stack_frame->getSymbol(name);
-
-        // If the variable is not found in stack frame
-        // try kernel argument
-        if (!variable) variable = work_item->getGrid()->getKernelArgument(name);
-
-        // If the variable is still not found
-        if (!variable)
-          throw misc::Error(
-              misc::fmt("Symbol %s is not"
-                        " defined",
-                        name.c_str()));
-
-        address += variable->getAddress();
-      }
-      if (operand->getReg().get()) {
-        std::string register_name = operand->getReg()->getRegisterName();
+      if (!operand_address.symbol.empty())
+        address += stack_frame->ResolveSymbol(operand_address)->getAddress();
+      if (operand_address.has_register) {
         unsigned long long reg_address = 0;
-        stack_frame->getRegisterValue(register_name, &reg_address);
+        stack_frame->getRegisterValue(operand_address.reg, &reg_address);
         address += reg_address;
       }
-      address += offset;
+      address += operand_address.offset;
       *(uint32_t*)buffer = address;
       return;
     }
@@ -100,27 +76,11 @@ void OperandValueRetriever::Retrieve(BrigCodeEntry* instruction,
     case BRIG_KIND_OPERAND_OPERAND_LIST:
 
     {
-      // Get the vector modifier
-      unsigned vector_size = instruction->getVectorModifier();
-      for (unsigned int i = 0; i < vector_size; i++) {
-        auto op_item = operand->getOperandElement(i);
-        switch (op_item->getKind()) {
-          case BRIG_KIND_OPERAND_REGISTER:
-
-          {
-            std::string register_name = op_item->getRegisterName();
-            unsigned size =
-                AsmService::getSizeInByteByRegisterName(register_name);
-            stack_frame->getRegisterValue(register_name,
-                                          (unsigned char*)buffer + i * size);
-            break;
-          }
-
-          default:
-            throw misc::Panic(
-                misc::fmt("Unsupported operand "
-                          "type in operand list"));
-        }
+      // One register per element of the vector
+      unsigned char* element_buffer = (unsigned char*)buffer;
+      for (const Function::RegisterOperand& reg : operand.elements) {
+        stack_frame->getRegisterValue(reg, element_buffer);
+        element_buffer += reg.size;
       }
       break;
     }
@@ -32,6 +32,10 @@ class OperandValueRetriever {
  public:
   OperandValueRetriever(WorkItem* work_item, StackFrame* stack_frame);
   virtual ~OperandValueRetriever();
+  void Bind(WorkItem* work_item, StackFrame* stack_frame) {
+    this->work_item = work_item;
+    this->stack_frame = stack_frame;
+  }
   virtual void Retrieve(BrigCodeEntry* instruction, unsigned int index,
                         void* buffer);
 };
@@ -18,7 +18,6 @@
  */
 
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
-#include <arch/hsa/disassembler/BrigOperandEntry.h>
 
 #include "OperandValueWriter.h"
 #include "StackFrame.h"
@@ -34,43 +33,25 @@ OperandValueWriter::~OperandValueWriter() {}
 
 void OperandValueWriter::Write(BrigCodeEntry* instruction, unsigned int index,
                                void* buffer) {
-  // Get the operand entry
-  auto operand = instruction->getOperand(index);
+  // Get the operand, decoded the first time it is accessed
+  const Function::Operand& operand =
+      stack_frame->getFunction()->getOperand(instruction, index);
 
   // Do corresponding action according to the type of operand
-  switch (operand->getKind()) {
+  switch (operand.kind) {
     case BRIG_KIND_OPERAND_REGISTER:
 
-    {
-      std::string register_name = operand->getRegisterName();
-      stack_frame->setRegisterValue(register_name, buffer);
+      stack_frame->setRegisterValue(operand.reg, buffer);
       break;
-    }
 
     case BRIG_KIND_OPERAND_OPERAND_LIST:
 
     {
-      // Get the vector modifier
-      unsigned vector_size = instruction->getVectorModifier();
-      for (unsigned int i = 0; i < vector_size; i++) {
-        auto op_item = operand->getOperandElement(i);
-        switch (op_item->getKind()) {
-          case BRIG_KIND_OPERAND_REGISTER:
-
-          {
-            std::string register_name = op_item->getRegisterName();
-            unsigned size =
-                AsmService::getSizeInByteByRegisterName(register_name);
-            stack_frame->setRegisterValue(register_name,
-                                          (unsigned char*)buffer + i * size);
-            break;
-          }
-
-          default:
-            throw misc::Panic(
-                misc::fmt("Unsupported operand "
-                          "type in operand list"));
-        }
+      // One register per element of the vector
+      unsigned char* element_buffer = (unsigned char*)buffer;
+      for (const Function::RegisterOperand& reg : operand.elements) {
+        stack_frame->setRegisterValue(reg, element_buffer);
+        element_buffer += reg.size;
       }
       break;
     }
@@ -32,6 +32,10 @@ class OperandValueWriter {
  public:
   OperandValueWriter(WorkItem* work_item, StackFrame* stack_frame);
   virtual ~OperandValueWriter();
+  void Bind(WorkItem* work_item, StackFrame* stack_frame) {
+    this->work_item = work_item;
+    this->stack_frame = stack_frame;
+  }
   virtual void Write(BrigCodeEntry* instruction, unsigned int index,
                      void* buffer);
 };
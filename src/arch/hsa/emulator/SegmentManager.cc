@@ -31,6 +31,7 @@ SegmentManager::SegmentManager(mem::Memory* memory, unsigned size)
 unsigned SegmentManager::Allocate(unsigned size, unsigned alignment) {
   unsigned flat_address = Manager::Allocate(size, alignment);
   assert(flat_address >= base_address);
+  allocations.push_back(flat_address);
   return flat_address - base_address;
 }
 
@@ -40,4 +41,13 @@ unsigned SegmentManager::getFlatAddress(unsigned address) {
   return address + base_address;
 }
 
+void SegmentManager::Clear() {
+  // Free in reverse order, so that the page of the null pointer
+  // reservation is never left empty
+  while (allocations.size() > 1) {
+    Free(allocations.back());
+    allocations.pop_back();
+  }
+}
+
 }  // namespace HSA
@@ -20,6 +20,8 @@
 #ifndef ARCH_HSA_EMULATOR_SEGMENTMANAGER_H
 #define ARCH_HSA_EMULATOR_SEGMENTMANAGER_H
 
+#include <vector>
+
 #include <memory/Manager.h>
 
 namespace HSA {
@@ -34,6 +36,10 @@ class SegmentManager : public mem::Manager {
   // The size of the segment requires
   unsigned size;
 
+  // Flat addresses of the allocations in the segment, starting with the
+  // null pointer reservation
+  std::vector<unsigned> allocations;
+
  public:
   /// Constructor
   SegmentManager(mem::Memory* memory, unsigned size);
@@ -46,6 +52,11 @@ class SegmentManager : public mem::Manager {
 
   /// Convert inner-segment address to flat address
   unsigned getFlatAddress(unsigned address);
+
+  /// Free all the allocations in the segment except the null pointer
+  /// reservation, so that the segment can be reused by another work item
+  /// or work group. Pages mapped for the segment are kept.
+  void Clear();
 };
 
 }  // namespace HSA
@@ -61,10 +61,6 @@ StackFrame::~StackFrame() {
   }
 }
 
-void StackFrame::setPc(std::unique_ptr<BrigCodeEntry> pc) {
-  this->pc = std::move(pc);
-}
-
 void StackFrame::StartArgumentScope(unsigned size) {
   // Check if the previous argument scope has not been closed
   if (!argument_scope.empty())
@@ -78,6 +74,7 @@ void StackFrame::StartArgumentScope(unsigned size) {
 void StackFrame::CloseArgumentScope() {
   argument_scope.clear();
   argument_segment.reset(nullptr);
+  resolved_symbols.clear();
 };
 
 void StackFrame::Dump(std::ostream& os = std::cout) const {
@@ -207,4 +204,21 @@ Variable* StackFrame::getSymbol(const std::string& name) {
   return nullptr;
 }
 
+Variable* StackFrame::ResolveSymbol(const Function::AddressOperand& operand) {
+  // Return the variable found earlier for this operand
+  auto it = resolved_symbols.find(&operand);
+  if (it != resolved_symbols.end()) return it->second;
+
+  // If the variable is not found in stack frame, try kernel argument
+  const std::string& name = operand.symbol;
+  Variable* variable = getSymbol(name);
+  if (!variable) variable = work_item->getGrid()->getKernelArgument(name);
+  if (!variable)
+    throw misc::Error(misc::fmt("Symbol %s is not defined", name.c_str()));
+
+  // Keep it for later accesses
+  resolved_symbols.emplace(&operand, variable);
+  return variable;
+}
+
 }  // namespace HSA
@@ -21,6 +21,7 @@
 #define ARCH_HSA_EMULATOR_STACKFRAME_H
 
 #include <cstring>
+#include <unordered_map>
 
 #include <arch/hsa/disassembler/AsmService.h>
 #include <arch/hsa/driver/Driver.h>
@@ -59,6 +60,13 @@ class StackFrame {
   // All variables declared in private, group and global segment
   std::map<std::string, std::unique_ptr<Variable>> variables;
 
+  // Variables that address operands of the function are based on,
+  // indexed by the decoded operand. A symbol is looked up by name the
+  // first time an operand is accessed in this frame, and the table is
+  // cleared whenever the set of symbols in scope changes.
+  std::unordered_map<const Function::AddressOperand*, Variable*>
+      resolved_symbols;
+
   // Register storage
   std::unique_ptr<char[]> register_storage;
 
@@ -93,8 +101,9 @@ class StackFrame {
   /// Return the program counter
   BrigCodeEntry* getPc() const { return pc.get(); }
 
-  /// Set the program counter
-  void setPc(std::unique_ptr<BrigCodeEntry> pc);
+  /// Move the program counter to an offset in the code section. The
+  /// entry returned by getPc() is updated in place.
+  void setPc(unsigned offset) { pc->setOffset(offset); }
 
   /// Dump stack frame information
   void Dump(std::ostream& os) const;
@@ -108,48 +117,39 @@ class StackFrame {
   /// Dump the information of a register by name
   void DumpRegister(const std::string& name, std::ostream& os) const;
 
-  /// Return register value
-  void getRegisterValue(const std::string& name, void* buffer) const {
+  /// Return the value of a register resolved by the function
+  void getRegisterValue(const Function::RegisterOperand& reg,
+                        void* buffer) const {
     // Do special action for c registers
-    if (name[1] == 'c') {
-      unsigned int index = name[2] - '0';
-      *(unsigned char*)buffer = c_registers[index];
+    if (reg.control) {
+      *(unsigned char*)buffer = c_registers[reg.offset];
       return;
     }
 
-    // Get the offset of the register
-    unsigned int offset = function->getRegisterOffset(name);
-
-    // Get the size of the register
-    unsigned size = AsmService::getSizeInByteByRegisterName(name);
-
     // Copy the value of the register
-    memcpy(buffer, register_storage.get() + offset, size);
-
-    // Return the value of the register
-    return;
+    memcpy(buffer, register_storage.get() + reg.offset, reg.size);
   }
 
-  /// Set a registers value
-  void setRegisterValue(const std::string& name, void* value) {
+  /// Set the value of a register resolved by the function
+  void setRegisterValue(const Function::RegisterOperand& reg, void* value) {
     // Do special action for c registers
-    if (name[1] == 'c') {
-      unsigned int index = name[2] - '0';
-      c_registers[index] = *(unsigned char*)value;
+    if (reg.control) {
+      c_registers[reg.offset] = *(unsigned char*)value;
       return;
     }
 
-    // Get the offset of the register
-    unsigned int offset = function->getRegisterOffset(name);
-
-    // Get the size of the register
-    unsigned size = AsmService::getSizeInByteByRegisterName(name);
-
     // Copy the value to the register
-    memcpy(register_storage.get() + offset, value, size);
+    memcpy(register_storage.get() + reg.offset, value, reg.size);
+  }
 
-    // Set the value of the register
-    return;
+  /// Return register value
+  void getRegisterValue(const std::string& name, void* buffer) const {
+    getRegisterValue(function->ResolveRegister(name), buffer);
+  }
+
+  /// Set a registers value
+  void setRegisterValue(const std::string& name, void* value) {
+    setRegisterValue(function->ResolveRegister(name), value);
   }
 
   /// Start an argument scope, when a '{' appears. Requires the size to
@@ -192,6 +192,7 @@ class StackFrame {
   /// Add an variable to the the variable list
   void addVariable(std::unique_ptr<Variable> variable) {
     variables.emplace(variable->getName(), std::move(variable));
+    resolved_symbols.clear();
   }
 
   /// Return an variable by the name of the variable. If the name is
@@ -223,6 +224,12 @@ class StackFrame {
   /// finally function arguments. If the name is net defined in
   //. this stack frame, nullptr will be returned.
   Variable* getSymbol(const std::string& name);
+
+  /// Return the variable that an address operand of the function is
+  /// based on. The symbol is searched in the stack frame and then in
+  /// the kernel arguments of the grid only the first time the operand is
+  /// accessed in this frame. An error is thrown if it is not defined.
+  Variable* ResolveSymbol(const Function::AddressOperand& operand);
 };
 
 }  // namespace HSA
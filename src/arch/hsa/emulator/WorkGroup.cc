@@ -18,6 +18,7 @@
  */
 
 #include "WorkGroup.h"
+#include "Grid.h"
 #include "SegmentManager.h"
 
 namespace HSA {
@@ -34,11 +35,14 @@ WorkGroup::WorkGroup(Grid* grid, unsigned group_segment_size,
   this->group_id_z = group_id_z;
 
   // Set the group segment memory manager
-  mem::Memory* memory = Emulator::getInstance()->getMemory();
-  group_segment.reset(new SegmentManager(memory, group_segment_size));
+  group_segment = grid->AcquireGroupSegment(group_segment_size);
 }
 
-WorkGroup::~WorkGroup() {}
+WorkGroup::~WorkGroup() {
+  // Release work items before the group segment
+  wavefronts.clear();
+  grid->ReleaseGroupSegment(std::move(group_segment));
+}
 
 bool WorkGroup::Execute() {
   bool active = false;
@@ -77,8 +77,8 @@ void WorkItem::Initialize(WorkGroup* work_group, unsigned private_segment_size,
   status = WorkItemStatusActive;
 
   // Set the private segment memory manager
-  mem::Memory* memory = Emulator::getInstance()->getMemory();
-  private_segment.reset(new SegmentManager(memory, private_segment_size));
+  private_segment =
+      work_group->getGrid()->AcquirePrivateSegment(private_segment_size);
 
   // Dump initial state of the stack frame when a work item created.
   if (getAbsoluteFlattenedId() == 0) {
@@ -89,26 +89,29 @@ void WorkItem::Initialize(WorkGroup* work_group, unsigned private_segment_size,
   }
 }
 
-WorkItem::~WorkItem() {}
+WorkItem::~WorkItem() {
+  // Return the private segment to the grid for reuse
+  if (private_segment)
+    work_group->getGrid()->ReleasePrivateSegment(std::move(private_segment));
+}
 
 bool WorkItem::MovePcForwardByOne() {
   // Retrieve the stack top
   StackFrame* stack_top = stack.back().get();
 
   // Set the stackframe's pc to the next instuction
-  auto next_pc = stack_top->getPc()->Next();
+  BrigCodeEntry* pc = stack_top->getPc();
+  unsigned next_offset = pc->getOffset() + pc->getSize();
 
   // If next pc is beyond last inst, the last instruction of the function
   // is executed. Return the function.
-  if (!next_pc ||
-      next_pc->getOffset() >
-          stack_top->getFunction()->getLastEntry()->getOffset()) {
+  if (next_offset > stack_top->getFunction()->getLastEntryOffset()) {
     ReturnFunction();
     return false;
   }
 
   // Set program counter to next instruction
-  stack_top->setPc(std::move(next_pc));
+  stack_top->setPc(next_offset);
 
   // Returns true to tell the caller that the function is not returned
   return true;
@@ -458,7 +461,7 @@ void WorkItem::DeclareVariable() {
                                    dim);
 }
 
-std::unique_ptr<HsaInstructionWorker> WorkItem::getInstructionWorker(
+std::unique_ptr<HsaInstructionWorker> WorkItem::createInstructionWorker(
     BrigCodeEntry* instruction) {
   BrigOpcode opcode = instruction->getOpcode();
   StackFrame* stack_top = getStackTop();
@@ -474,7 +477,7 @@ std::unique_ptr<HsaInstructionWorker> WorkItem::getInstructionWorker(
     case BRIG_OPCODE_ATOMICNORET:
 
       return misc::new_unique<AtomicNoRetInstructionWorker>(
-          this, stack_top, Emulator::getInstance()->getMemory());
+          this, stack_top, emulator->getMemory());
 
     case BRIG_OPCODE_BR:
 
@@ -572,6 +575,18 @@ std::unique_ptr<HsaInstructionWorker> WorkItem::getInstructionWorker(
   }
 }
 
+HsaInstructionWorker* WorkItem::getInstructionWorker(
+    BrigCodeEntry* instruction) {
+  // Workers are kept by the emulator, so that none outlives it
+  unsigned opcode = instruction->getOpcode();
+  HsaInstructionWorker* worker = emulator->getInstructionWorker(opcode);
+  if (!worker)
+    return emulator->addInstructionWorker(
+        opcode, createInstructionWorker(instruction));
+  worker->Bind(this, getStackTop());
+  return worker;
+}
+
 bool WorkItem::Execute() {
   // Only execute the active work item
   if (status != WorkItemStatusActive) return true;
@@ -604,8 +619,8 @@ bool WorkItem::Execute() {
     }
 
     // Get the function according to the opcode and perform the inst
-    auto instruction_worker = getInstructionWorker(inst);
-    if (instruction_worker.get()) {
+    HsaInstructionWorker* instruction_worker = getInstructionWorker(inst);
+    if (instruction_worker) {
       instruction_worker->Execute(inst);
     }
 
@@ -90,10 +90,14 @@ class WorkItem {
   // Process directives befor an instruction
   void ExecuteDirective();
 
-  // Get HSA instruction worker according to the instruction
-  std::unique_ptr<HsaInstructionWorker> getInstructionWorker(
+  // Create a HSA instruction worker according to the instruction
+  std::unique_ptr<HsaInstructionWorker> createInstructionWorker(
       BrigCodeEntry* instruction);
 
+  // Get the HSA instruction worker for the instruction, bound to this
+  // work item and its current stack frame
+  HsaInstructionWorker* getInstructionWorker(BrigCodeEntry* instruction);
+
   //
   // Memory related fields and function
   //
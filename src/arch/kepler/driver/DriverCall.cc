@@ -155,9 +155,7 @@ int Driver::CallMemRead(comm::Context* context, mem::Memory* memory,
     throw Error("Accessing device memory not allocated");
 
   // Read memory from device to host
-  std::unique_ptr<char> buffer(new char[size]);
-  global_mem->Read(device_ptr, size, buffer.get());
-  memory->Write(host_ptr, size, buffer.get());
+  memory->Copy(host_ptr, global_mem, device_ptr, size);
 
   // Return
   return 0;
@@ -200,10 +198,8 @@ int Driver::CallMemWrite(comm::Context* context, mem::Memory* memory,
   // if (device_ptr + size > kpl_emu->getGlobalMemTop())
   //	throw Error("Accessing device memory not allocated");
 
-  // Read memory from host to device
-  std::unique_ptr<char> buffer(new char[size]);
-  memory->Read(host_ptr, size, buffer.get());
-  global_mem->Write(device_ptr, size, buffer.get());
+  // Write memory from host to device
+  global_mem->Copy(device_ptr, memory, host_ptr, size);
 
   // Return
   return 0;
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <list>
 #include <memory>
@@ -59,6 +61,9 @@ Emulator* Emulator::getInstance() {
   return instance.get();
 }
 
+// Number of host threads
+int Emulator::num_host_threads = 1;
+
 Emulator::Emulator() : comm::Emulator("Kepler") {
   // Initialize disassembler
   disassembler = Disassembler::getInstance();
@@ -82,6 +87,8 @@ Emulator::Emulator() : comm::Emulator("Kepler") {
   max_functions = 0x0;
 }
 
+Emulator::~Emulator() { StopHostThreads(); }
+
 void Emulator::Dump(std::ostream& os) const {
   std::cout << "\n[ Kepler ]\nInstructions = " << num_alu_instructions
             << std::endl;
@@ -98,44 +105,25 @@ bool Emulator::Run() {
 
   // Remove grid and its thread blocks from pending list, and add them to
   // running list
-  Grid* grid;
-  std::unique_ptr<ThreadBlock> thread_block;
-  int thread_block_id;
-  unsigned thread_block_3d_id[3];
   while (pending_grids.size()) {
-    grid = pending_grids.front();
+    Grid* grid = pending_grids.front();
     pending_grids.pop_front();
-    thread_block_id = 0;
+
+    // Execute thread blocks on multiple host threads. Tracing ISA
+    // execution forces the sequential emulation.
+    if (num_host_threads > 1 && !isa_debug) {
+      RunParallel(grid);
+      finished_grids.push_back(grid);
+      continue;
+    }
+
+    // Execute thread blocks one by one
+    int thread_block_id = 0;
     while (grid->getPendThreadBlocksize()) {
-      // Threadblock.X
-      thread_block_3d_id[0] = thread_block_id / (grid->getThreadBlockCount3(1) *
-                                                 grid->getThreadBlockCount3(2));
-
-      // Threadblock.Y
-      thread_block_3d_id[1] =
-          (thread_block_id %
-           (grid->getThreadBlockCount3(1) * grid->getThreadBlockCount3(2))) /
-          grid->getThreadBlockCount3(2);
-
-      // ThreadBlock.Z
-      thread_block_3d_id[2] =
-          ((thread_block_id %
-            (grid->getThreadBlockCount3(1) * grid->getThreadBlockCount3(2))) %
-           grid->getThreadBlockCount3(2));
-      grid->WaitingToRunning(thread_block_id, thread_block_3d_id);
-      thread_block_id++;
-      thread_block.reset(grid->getRunningThreadBlocksBegin()->release());
-      while (thread_block.get()->getNumWarpsCompletedEmu() !=
-             thread_block.get()->getWarpCount()) {
-        for (auto wp_p = thread_block.get()->WarpsBegin();
-             wp_p < thread_block.get()->WarpsEnd(); ++wp_p) {
-          if ((*wp_p)->getFinishedEmu() || (*wp_p)->getAtBarrier()) continue;
-          (*wp_p)->Execute();
-        }
-      }
-      thread_block.get()->setFinishedEmu(true);
-      grid->PopRunningThreadBlock();
-      thread_block.reset();  // free the memory of thread block
+      std::unique_ptr<ThreadBlock> thread_block =
+          ScheduleThreadBlock(grid, thread_block_id++);
+      RunThreadBlock(thread_block.get());
+      AddThreadBlockStatistics(thread_block.get());
     }
     finished_grids.push_back(grid);
   }
@@ -148,6 +136,71 @@ bool Emulator::Run() {
   return true;
 }
 
+std::unique_ptr<ThreadBlock> Emulator::ScheduleThreadBlock(
+    Grid* grid, int thread_block_id) {
+  unsigned thread_block_3d_id[3];
+
+  // Threadblock.X
+  thread_block_3d_id[0] = thread_block_id / (grid->getThreadBlockCount3(1) *
+                                             grid->getThreadBlockCount3(2));
+
+  // Threadblock.Y
+  thread_block_3d_id[1] =
+      (thread_block_id %
+       (grid->getThreadBlockCount3(1) * grid->getThreadBlockCount3(2))) /
+      grid->getThreadBlockCount3(2);
+
+  // ThreadBlock.Z
+  thread_block_3d_id[2] =
+      ((thread_block_id %
+        (grid->getThreadBlockCount3(1) * grid->getThreadBlockCount3(2))) %
+       grid->getThreadBlockCount3(2));
+
+  // Take the thread block out of the running list of the grid
+  grid->WaitingToRunning(thread_block_id, thread_block_3d_id);
+  std::unique_ptr<ThreadBlock> thread_block(
+      grid->getRunningThreadBlocksBegin()->release());
+  grid->PopRunningThreadBlock();
+  return thread_block;
+}
+
+void Emulator::RunThreadBlock(ThreadBlock* thread_block) {
+  while (thread_block->getNumWarpsCompletedEmu() !=
+         thread_block->getWarpCount()) {
+    for (auto wp_p = thread_block->WarpsBegin();
+         wp_p < thread_block->WarpsEnd(); ++wp_p) {
+      if ((*wp_p)->getFinishedEmu() || (*wp_p)->getAtBarrier()) continue;
+      (*wp_p)->Execute();
+    }
+  }
+  thread_block->setFinishedEmu(true);
+}
+
+void Emulator::AddThreadBlockStatistics(ThreadBlock* thread_block) {
+  for (auto wp_p = thread_block->WarpsBegin(); wp_p < thread_block->WarpsEnd();
+       ++wp_p)
+    incNumAluInstructions((*wp_p)->getEmuInstCount());
+}
+
+void Emulator::ReadConstantMemory(unsigned address, unsigned size,
+                                  char* buffer) {
+  // Pages are copied directly instead of calling mem::Memory::Read(),
+  // which records the last accessed address in the memory object. The
+  // driver only writes constant memory while no thread block runs.
+  while (size) {
+    unsigned offset = address & (mem::Memory::PageSize - 1);
+    unsigned chunk_size = std::min(size, mem::Memory::PageSize - offset);
+    mem::Memory::Page* page = constant_memory->getPage(address);
+    if (page && page->getData())
+      memcpy(buffer, page->getData() + offset, chunk_size);
+    else
+      memset(buffer, 0, chunk_size);
+    address += chunk_size;
+    buffer += chunk_size;
+    size -= chunk_size;
+  }
+}
+
 void Emulator::PushPendingGrid(Grid* grid) { pending_grids.push_back(grid); }
 
 Grid* Emulator::addGrid(Function* function) {
@@ -174,6 +227,15 @@ void Emulator::RegisterOptions() {
   command_line->RegisterString(
       "--kpl-debug-isa <file>", isa_debug_file,
       "Dump debug information about Kepler isa implementation");
+
+  // Option --kpl-emu-threads <num>
+  command_line->RegisterInt32(
+      "--kpl-emu-threads <num>", num_host_threads,
+      "Number of host threads executing thread blocks concurrently. "
+      "Global memory accesses are serialized, so that each of them is "
+      "atomic with respect to the other thread blocks, and statistics "
+      "are added up in thread block order. Tracing ISA execution with "
+      "--kpl-debug-isa forces a single host thread. The default is 1.");
 }
 
 void Emulator::ProcessOptions() {
@@ -186,6 +248,12 @@ void Emulator::ProcessOptions() {
   // Set the path for the debug files
   isa_debug.setPath(isa_debug_file);
   isa_debug.setPrefix("[Kepler emulator]");
+
+  // Host threads
+  if (num_host_threads < 1)
+    throw Error(misc::fmt("Invalid number of host threads for option "
+                          "--kpl-emu-threads (%d)",
+                          num_host_threads));
 }
 
 }  // namespace
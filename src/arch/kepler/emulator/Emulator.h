@@ -23,6 +23,7 @@
 #include <iostream>
 #include <list>
 #include <memory>
+#include <pthread.h>
 #include <vector>
 
 #include <arch/common/Arch.h>
@@ -30,6 +31,7 @@
 #include <arch/kepler/disassembler/Disassembler.h>
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
+#include <lib/cpp/HostThreadPool.h>
 #include <lib/cpp/Misc.h>
 #include <memory/Memory.h>
 
@@ -52,6 +54,9 @@ class Emulator : public comm::Emulator {
   // Emu singleton instance
   static std::unique_ptr<Emulator> instance;
 
+  // Number of host threads executing thread blocks in parallel
+  static int num_host_threads;
+
   // Disassembler
   Disassembler* disassembler;
 
@@ -91,9 +96,50 @@ class Emulator : public comm::Emulator {
   // Number of global memory instructions executed
   long long num_global_memory_instructions = 0;
 
+  //
+  // Parallel emulation
+  //
+
+  // Host threads executing thread blocks, created the first time thread
+  // blocks are executed in parallel
+  std::unique_ptr<misc::HostThreadPool> host_thread_pool;
+
+  // Batch of thread blocks executed by the host threads, in the order in
+  // which they were created
+  std::vector<std::unique_ptr<ThreadBlock>> batch_thread_blocks;
+
+  // Mutex serializing global memory accesses while host threads are
+  // active
+  pthread_mutex_t global_memory_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+  // Flag set while thread blocks are executed by multiple host threads
+  bool parallel = false;
+
   /// Constructor
   Emulator();
 
+  // Create the thread blocks of the given grid in batches and execute
+  // them on multiple host threads
+  void RunParallel(Grid* grid);
+
+  // Move the thread block with the given 1D identifier from the pending
+  // to the running list of a grid and return it
+  std::unique_ptr<ThreadBlock> ScheduleThreadBlock(Grid* grid,
+                                                   int thread_block_id);
+
+  // Execute the warps of a thread block until all of them finish
+  static void RunThreadBlock(ThreadBlock* thread_block);
+
+  // Add the instruction counts of the warps of a finished thread block to
+  // the emulator statistics
+  void AddThreadBlockStatistics(ThreadBlock* thread_block);
+
+  // Create the host threads
+  void StartHostThreads();
+
+  // Make host threads finish and wait for them
+  void StopHostThreads();
+
  public:
   /// Runtime error for Kepler
   class Error : public misc::Error {
@@ -131,6 +177,31 @@ class Emulator : public comm::Emulator {
   /// end of the execution.
   static Emulator* getInstance();
 
+  /// Destructor
+  ~Emulator();
+
+  /// Return the number of host threads executing thread blocks in
+  /// parallel, as configured by the user
+  static int getNumHostThreads() { return num_host_threads; }
+
+  /// Lock of the mutex serializing global memory accesses, held during
+  /// the lifetime of the object. Locking has no effect when thread blocks
+  /// are executed by a single host thread.
+  class GlobalMemoryLock {
+    Emulator* emulator;
+
+   public:
+    GlobalMemoryLock(Emulator* emulator) : emulator(emulator) {
+      if (emulator->parallel)
+        pthread_mutex_lock(&emulator->global_memory_mutex);
+    }
+
+    ~GlobalMemoryLock() {
+      if (emulator->parallel)
+        pthread_mutex_unlock(&emulator->global_memory_mutex);
+    }
+  };
+
   /// Get grid list size
   unsigned getGridSize() { return grids.size(); }
 
@@ -178,8 +249,10 @@ class Emulator : public comm::Emulator {
     this->global_memory_free_size = global_memory_free_size;
   }
 
-  /// Increment ALU instruction counter
-  void incNumAluInstructions() { num_alu_instructions++; }
+  /// Add to the ALU instruction counter
+  void incNumAluInstructions(long long count = 1) {
+    num_alu_instructions += count;
+  }
 
   /// Increse global memory top
   void incGloablMemoryTop(unsigned inc) { global_memory_top += inc; }
@@ -214,22 +287,23 @@ class Emulator : public comm::Emulator {
   /// \param size of data
   /// \param data buffer
   void WriteGlobalMemory(unsigned address, unsigned size, const char* buffer) {
+    GlobalMemoryLock lock(this);
     global_memory->Write(address, size, buffer);
   }
 
-  /// Read Global Memory
+  /// Read Constant Memory. This function can be called from several host
+  /// threads at a time, since it does not modify the memory object.
   /// \param starting address to be read in
   /// \param size of data
   /// \param data buffer
-  void ReadConstantMemory(unsigned address, unsigned size, char* buffer) {
-    constant_memory->Read(address, size, buffer);
-  }
+  void ReadConstantMemory(unsigned address, unsigned size, char* buffer);
 
   /// Read Global Memory
   /// \param starting address to be read in
   /// \param size of data
   /// \param data buffer
   void ReadGlobalMemory(unsigned address, unsigned size, char* buffer) {
+    GlobalMemoryLock lock(this);
     global_memory->Read(address, size, buffer);
   }
 
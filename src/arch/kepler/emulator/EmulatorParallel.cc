@@ -0,0 +1,84 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Yuqing Shi (shi.yuq@husky.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cassert>
+
+#include "Emulator.h"
+#include "Grid.h"
+#include "Thread.h"
+#include "ThreadBlock.h"
+#include "Warp.h"
+
+namespace Kepler {
+
+void Emulator::RunParallel(Grid* grid) {
+  // Create host threads the first time
+  if (!host_thread_pool) StartHostThreads();
+
+  int thread_block_id = 0;
+  while (grid->getPendThreadBlocksize()) {
+    // Create a batch of thread blocks. Thread blocks are created by the
+    // main simulation thread, since they are taken from the lists of the
+    // grid. The batch size bounds the memory taken by the registers and
+    // local memories of the batch.
+    assert(batch_thread_blocks.empty());
+    while (grid->getPendThreadBlocksize() &&
+           (int)batch_thread_blocks.size() < host_thread_pool->getBatchSize())
+      batch_thread_blocks.push_back(
+          ScheduleThreadBlock(grid, thread_block_id++));
+
+    // Execute the batch
+    try {
+      host_thread_pool->Run(batch_thread_blocks.size(), [this](int index) {
+        RunThreadBlock(batch_thread_blocks[index].get());
+      });
+    } catch (...) {
+      batch_thread_blocks.clear();
+      throw;
+    }
+
+    // Add up statistics in the order in which thread blocks were created,
+    // so that results do not depend on how thread blocks were distributed
+    // among host threads.
+    for (auto& thread_block : batch_thread_blocks)
+      AddThreadBlockStatistics(thread_block.get());
+    batch_thread_blocks.clear();
+  }
+}
+
+void Emulator::StartHostThreads() {
+  // Create host threads
+  assert(!host_thread_pool);
+  host_thread_pool = misc::new_unique<misc::HostThreadPool>(num_host_threads);
+
+  // Global memory accesses are locked from now on
+  parallel = true;
+}
+
+void Emulator::StopHostThreads() {
+  // Host threads not created
+  if (!host_thread_pool) return;
+
+  // Make host threads finish
+  parallel = false;
+  host_thread_pool = nullptr;
+}
+
+}  // namespace Kepler
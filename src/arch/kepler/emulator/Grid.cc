@@ -47,6 +47,17 @@ Grid::Grid(Function* function) {
       instruction_buffer[i / 8] |= inst_byte << (i * 8 - 32);
     }
   }
+
+  // Decode the kernel once for all warps. The first of every 8
+  // instructions is a scheduling control word and is not decoded.
+  instructions.resize(instruction_buffer_size / 8);
+  for (unsigned i = 0; i < instructions.size(); i++) {
+    if (!(i % 8)) continue;
+    Instruction::Bytes inst_bytes;
+    inst_bytes.as_uint[0] = instruction_buffer[i] >> 32;
+    inst_bytes.as_uint[1] = instruction_buffer[i];
+    instructions[i].Decode((const char*)&inst_bytes, i * 8);
+  }
   state = GridStateInvalid;
 
   // for(int i = 0; i < inst_buffer_size / 8; i++)
@@ -26,6 +26,7 @@
 #include <memory>
 #include <vector>
 
+#include <arch/kepler/disassembler/Instruction.h>
 #include <arch/kepler/driver/Function.h>
 
 #include "Emulator.h"
@@ -87,6 +88,10 @@ class Grid {
   // Instruction buffer contains the all the instructions in the kernel binary
   std::vector<unsigned long long> instruction_buffer;
 
+  // Instructions of the kernel, decoded once when the grid is created
+  // and indexed by pc / 8
+  std::vector<Instruction> instructions;
+
   // Shared memory top pointer
   unsigned shared_memory_top;
 
@@ -137,6 +142,9 @@ class Grid {
     return instruction_buffer.begin();
   }
 
+  /// Return the decoded instruction at \a pc
+  Instruction* getInstruction(unsigned pc) { return &instructions[pc / 8]; }
+
   /// Get instruction buffer size
   unsigned getInstructionBufferSize() const { return instruction_buffer_size; }
 
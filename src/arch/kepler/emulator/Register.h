@@ -40,33 +40,15 @@ struct CC {
 
 enum RegValueType { RegValueTypeU32 = 0, RegValueTypeS32 = 1, RegValueTypeF };
 
-// This class includes all kinds of registers used in Thread
+// This class includes the special and condition code registers used in
+// Thread. General purpose and predicate registers are stored per warp,
+// see class Warp.
 class Register {
  private:
-  RegValue gpr[256]; /* General purpose registers */
-  RegValue sr[82];   /* Special registers */
-  unsigned pr[8];    /* Predicate registers */
+  RegValue sr[82]; /* Special registers */
   CC cc;
 
  public:
-  /// Get value of a GPR
-  /// \param vreg GPR identifier
-  unsigned ReadGPR(int gpr_id) const { return gpr[gpr_id].u32; }
-
-  /// Get float type value of a GPR
-  /// \param vreg GPR identifier
-  float ReadFloatGPR(int gpr_id) const { return gpr[gpr_id].f; }
-
-  /// Set value of a GPR
-  /// \param gpr GPR idenfifier
-  /// \param value Value given as an \a unsigned typed value
-  void WriteGPR(int gpr_id, unsigned value) { gpr[gpr_id].u32 = value; }
-
-  /// Set float value of a GPR
-  /// \param gpr GPR idenfifier
-  /// \param value Value given as an \a float typed value
-  void WriteFloatGPR(int gpr_id, float value) { gpr[gpr_id].f = value; }
-
   /// Get value of a SR
   /// \param vreg SR identifier
   unsigned ReadSpecialRegister(int special_register_id) {
@@ -80,16 +62,6 @@ class Register {
     sr[special_register_id].u32 = value;
   }
 
-  /// Get value of a predicate register
-  /// \param pr Predicate register identifier
-  int ReadPredicate(int predicate_id) { return pr[predicate_id]; };
-
-  /// Write value of a predicate register
-  /// \param pr predicate register identifier
-  void WritePredicate(int predicate_id, unsigned value) {
-    pr[predicate_id] = value;
-  };
-
   /// Read value of Condition Code register
   unsigned ReadCC_ZF() { return cc.zf; };
 
@@ -113,16 +85,6 @@ class Register {
 
   /// Write value of Condition register
   void WriteCC_OF(unsigned value) { cc.of = value; };
-
-  /// Read value of register
-  void Read_register(unsigned* dst, int gpr_id) {
-    memcpy(dst, &gpr[gpr_id], 4);
-  }
-
-  /// Write to register
-  void Write_register(unsigned* src, int gpr_id) {
-    memcpy(&gpr[gpr_id], src, 4);
-  }
 };
 
 }  // namespace
@@ -21,8 +21,6 @@
 
 namespace Kepler {
 
-unsigned ReturnAddressStack::common_counter = 1;
-
 void ReturnAddressStack::push(unsigned address, unsigned am,
                               std::unique_ptr<SyncStack>& ss) {
   /*
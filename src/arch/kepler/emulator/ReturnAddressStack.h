@@ -69,8 +69,9 @@ class ReturnAddressStack {
     unsigned getCounter() { return counter; }
   };
 
-  // A counter recording every sync stack "id"
-  static unsigned common_counter;
+  // A counter recording every sync stack "id". It is kept per warp, since
+  // warps of different thread blocks may run on different host threads.
+  unsigned common_counter = 1;
 
   // Modeled the stack as a list, recording the return address of CAL
   // and the sync stack of all previous contexts.
@@ -45,10 +45,6 @@ Thread::Thread(Warp* warp, int id) {
                                      emulator->getGlobalMemoryTotalSize() +
                                      emulator->getSharedMemoryTotalSize();
 
-  // local mem top generic address record in const mem c[0x0][0x24]
-  emulator->WriteConstantMemory(0x24, sizeof(unsigned),
-                                (const char*)&local_memory_top_generic_address);
-
 // Initialization instruction table
 #define DEFINST(_name, _fmt_str, ...) \
   inst_func[Instruction::INST_##_name] = &Thread::ExecuteInst_##_name;
@@ -141,4 +137,18 @@ void Thread::ISAUnsupportedFeature(Instruction* inst) {
                 inst->getName()));
 }
 
+void Thread::ReadConstantMemory(unsigned address, unsigned size,
+                                char* buffer) {
+  emulator->ReadConstantMemory(address, size, buffer);
+  if (!isPerThreadConstant(address, size)) return;
+
+  // Overwrite the bytes falling into c[0x0][0x20] and c[0x0][0x24]
+  unsigned values[2] = {thread_block->getSharedMemoryTopGenericAddress(),
+                        local_memory_top_generic_address};
+  for (unsigned i = 0; i < size; i++) {
+    unsigned offset = address + i - 0x20;
+    if (offset < sizeof values) buffer[i] = ((char*)values)[offset];
+  }
+}
+
 }  // namespace
@@ -81,7 +81,8 @@ class Thread {
   ThreadBlock* thread_block;
   Grid* grid;
 
-  // Registers
+  // Special and condition code registers. General purpose and predicate
+  // registers are stored in the warp.
   Register registers;
 
   // Last global memory access
@@ -122,6 +123,12 @@ class Thread {
   // Error massage of unsupported feature
   static void ISAUnsupportedFeature(Instruction* inst);
 
+  // Read constant memory. The shared and local memory top generic
+  // addresses in c[0x0][0x20] and c[0x0][0x24] are served by the thread
+  // itself, since they differ across thread blocks and threads that may
+  // be alive at the same time.
+  void ReadConstantMemory(unsigned address, unsigned size, char* buffer);
+
   // Fields below are used for architectural simulation only.
  public:
   /// Constructor
@@ -129,6 +136,12 @@ class Thread {
   /// \id Global 1D identifier of the thread
   Thread(Warp* warp, int id);
 
+  /// Return whether a constant memory location is served per thread by
+  /// ReadConstantMemory() instead of being read from the emulator
+  static bool isPerThreadConstant(unsigned address, unsigned size) {
+    return address < 0x28 && address + size > 0x20;
+  }
+
   /// Get global id
   unsigned getId() const { return id; }
 
@@ -140,24 +153,26 @@ class Thread {
 
   /// Get value of a GPR
   /// \param vreg GPR identifier
-  unsigned ReadGPR(int gpr_id) { return registers.ReadGPR(gpr_id); }
+  unsigned ReadGPR(int gpr_id) { return warp->ReadGPR(gpr_id, id_in_warp); }
 
   /// Get float type value of a GPR
   /// \param vreg GPR identifier
-  float ReadFloatGPR(int gpr_id) { return registers.ReadFloatGPR(gpr_id); }
+  float ReadFloatGPR(int gpr_id) {
+    return warp->ReadFloatGPR(gpr_id, id_in_warp);
+  }
 
   /// Set value of a GPR
   /// \param gpr GPR idenfifier
   /// \param value Value given as an \a unsigned typed value
   void WriteGPR(int gpr_id, unsigned value) {
-    registers.WriteGPR(gpr_id, value);
+    warp->WriteGPR(gpr_id, id_in_warp, value);
   }
 
   /// Set float value of a GPR
   /// \param gpr GPR idenfifier
   /// \param value Value given as an \a float typed value
   void WriteFloatGPR(int gpr_id, float value) {
-    registers.WriteFloatGPR(gpr_id, value);
+    warp->WriteFloatGPR(gpr_id, id_in_warp, value);
   }
 
   /// Get value of a SR
@@ -176,13 +191,13 @@ class Thread {
   /// Read value of a predicate register
   /// \param pr Predicate register identifier
   int ReadPredicate(int predicate_id) {
-    return registers.ReadPredicate(predicate_id);
+    return warp->ReadPredicate(predicate_id, id_in_warp);
   }
 
   /// Write value of a predicate register
   /// \param pr predicate register identifier
   void WritePredicate(int pr_id, unsigned value) {
-    registers.WritePredicate(pr_id, value);
+    warp->WritePredicate(pr_id, id_in_warp, value);
   }
 
   /// Read value of Condition Code register
@@ -227,12 +242,12 @@ class Thread {
 
   /// Read Register
   void Read_register(unsigned* dst, int gpr_id) {
-    registers.Read_register(dst, gpr_id);
+    *dst = warp->ReadGPR(gpr_id, id_in_warp);
   }
 
   /// Write Register
   void Write_register(unsigned* src, int gpr_id) {
-    registers.Write_register(src, gpr_id);
+    warp->WriteGPR(gpr_id, id_in_warp, *src);
   }
 };
 
@@ -70,11 +70,6 @@ ThreadBlock::ThreadBlock(Grid* grid, int id, unsigned* id_3d) {
                                       id * shared_memory_size +
                                       emulator->getGlobalMemoryTotalSize();
 
-  // Shared memory top generic address is recorded in constant memory
-  // c[0x0][0x20]
-  emulator->WriteConstantMemory(0x20, sizeof(unsigned),
-                                (char*)&shared_memory_top_generic_address);
-
   /* Flags */
   finished_emu = false;
   num_warps_completed_emu = 0;
@@ -128,6 +128,11 @@ class ThreadBlock {
   /// Get shared memory size
   unsigned getSharedMemorySize() const { return shared_memory_size; }
 
+  /// Get shared memory top generic address
+  unsigned getSharedMemoryTopGenericAddress() const {
+    return shared_memory_top_generic_address;
+  }
+
   /// Get counter of completed warps
   unsigned getNumWarpsCompletedEmu() const { return num_warps_completed_emu; }
 
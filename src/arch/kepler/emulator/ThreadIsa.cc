@@ -188,7 +188,6 @@ void Thread::ExecuteInst_IMUL_B(Instruction* inst) {
   Instruction::BytesIMUL format = inst_bytes.imul;
 
   // Predicates and active masks
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned pred;
@@ -229,7 +228,7 @@ void Thread::ExecuteInst_IMUL_B(Instruction* inst) {
     if ((format.op0 == 2) && (format.op2 == 1))
       src2 = ReadGPR(src2_id);  // Register Mode
     else if (format.op2 == 0)   // Const mode
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     // else
     //	src2 = format.src2 >> 18 ? format.src2 | 0xfff80000 : format.src2;
 
@@ -376,7 +375,6 @@ void Thread::ExecuteInst_ISCADD_B(Instruction* inst) {
   Instruction::BytesISCADD format = inst_bytes.iscadd;
 
   // Get Warp
-  Emulator* emu = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned active;
@@ -423,7 +421,7 @@ void Thread::ExecuteInst_ISCADD_B(Instruction* inst) {
 
     // Read src2 value Check it
     if (format.op2 == 1)  // constant mode
-      emu->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     else if (format.op2 == 3) {
       unsigned src2_id;
       src2_id = format.src2;
@@ -584,7 +582,6 @@ void Thread::ExecuteInst_ISAD_A(Instruction* inst) {
 
 void Thread::ExecuteInst_ISAD_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned active;
@@ -636,7 +633,7 @@ void Thread::ExecuteInst_ISAD_B(Instruction* inst) {
     if (format.op2 == 1)  // src2 is const src3 is register
     {
       unsigned src3_id;
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
       src3_id = format.src3;
       src3 = ReadGPR(src3_id);
     } else if ((format.op2 == 2))  // src2 is register src3 is const
@@ -644,7 +641,7 @@ void Thread::ExecuteInst_ISAD_B(Instruction* inst) {
       unsigned src2_id;
       src2_id = format.src3;
       src2 = ReadGPR(src2_id);
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src3);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src3);
     } else if (format.op2 == 3)  // both src2 src3 register
     {
       unsigned src2_id, src3_id;
@@ -960,7 +957,6 @@ void Thread::ExecuteInst_IMAD(Instruction* inst) {
   Instruction::BytesGeneral0 format = inst_bytes.general0;
 
   // Predicates and active masks
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned pred;
@@ -998,7 +994,7 @@ void Thread::ExecuteInst_IMAD(Instruction* inst) {
     src3 = ReadGPR(src_id);
     if (format.srcB_mod == 0) {
       src_id = format.srcB;
-      emulator->ReadConstantMemory(src_id << 2, 4, (char*)&srcB);
+      ReadConstantMemory(src_id << 2, 4, (char*)&srcB);
     } else if (format.srcB_mod == 1) {
       src_id = format.srcB & 0x1ff;
       srcB = ReadGPR(src_id);
@@ -1166,7 +1162,6 @@ void Thread::ExecuteInst_IADD_A(Instruction* inst) {
 
 void Thread::ExecuteInst_IADD_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   // Determine whether the warp reaches reconvergence pc.
@@ -1219,7 +1214,7 @@ void Thread::ExecuteInst_IADD_B(Instruction* inst) {
       src2_id = format.src2;
       src2 = ReadGPR(src2_id);
     } else if (format.op2 == 1)  // constant mode
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
 
     // Determine least significant bit value for the add
     unsigned lsb = 0;
@@ -1465,7 +1460,7 @@ void Thread::ExecuteInst_ISET_B(Instruction* inst) {
 
     // Read Src2
     if (format.op2 == 1)  // src is const
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     else if (format.op2 == 3)  // src is register mode
     {
       // src2 ID
@@ -1542,7 +1537,6 @@ void Thread::ExecuteInst_ISETP_A(Instruction* inst) {
   Instruction::BytesGeneral0 format = inst_bytes.general0;
 
   // Predicates and active masks
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned pred;
@@ -1586,7 +1580,7 @@ void Thread::ExecuteInst_ISETP_A(Instruction* inst) {
     srcA = ReadGPR(srcA_id) - (x ? ReadCC_CF() : 0);
     srcB_id = format.srcB;
     if (format.srcB_mod == 0) {
-      emulator->ReadConstantMemory(srcB_id << 2, 4, (char*)&srcB);
+      ReadConstantMemory(srcB_id << 2, 4, (char*)&srcB);
     } else if (format.srcB_mod == 1)
       srcB = ReadGPR(srcB_id);
 
@@ -1843,7 +1837,6 @@ void Thread::ExecuteInst_LOP_A(Instruction* inst) {
 
 void Thread::ExecuteInst_LOP_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned active;
@@ -1890,7 +1883,7 @@ void Thread::ExecuteInst_LOP_B(Instruction* inst) {
 
     // Read Src2
     if ((format.op0 == 2) && (format.op2 == 1))  // src is const
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     else if ((format.op0 == 2 && format.op2 == 3))  // src is register mode
     {
       // src2 ID
@@ -1929,7 +1922,6 @@ void Thread::ExecuteInst_ICMP_A(Instruction* inst) {
 
 void Thread::ExecuteInst_ICMP_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   // Determine whether the warp reaches reconvergence pc.
@@ -1976,7 +1968,7 @@ void Thread::ExecuteInst_ICMP_B(Instruction* inst) {
     if (format.op2 == 1)  // src2 is const src3 is register
     {
       unsigned src3_id;
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
       src3_id = format.src3;
       src3 = ReadGPR(src3_id);
     } else if ((format.op2 == 2))  // src2 is register src3 is const
@@ -1984,7 +1976,7 @@ void Thread::ExecuteInst_ICMP_B(Instruction* inst) {
       unsigned src2_id;
       src2_id = format.src3;
       src2 = ReadGPR(src2_id);
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src3);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src3);
     } else if (format.op2 == 3)  // both src2 src3 register
     {
       unsigned src2_id, src3_id;
@@ -2243,7 +2235,6 @@ void Thread::ExecuteInst_MOV_B(Instruction* inst) {
   Instruction::BytesGeneral0 format = inst_bytes.general0;
 
   // Predicates and active masks
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned pred;
@@ -2277,7 +2268,7 @@ void Thread::ExecuteInst_MOV_B(Instruction* inst) {
     /* Read */
     src_id = format.srcB;
     if (format.srcB_mod == 0) {
-      emulator->ReadConstantMemory(src_id << 2, 4, (char*)&src);
+      ReadConstantMemory(src_id << 2, 4, (char*)&src);
     } else if (format.srcB_mod == 1)
       // src = ReadGPR(src_id);
       Read_register(&src, src_id);
@@ -2434,7 +2425,6 @@ void Thread::ExecuteInst_SEL_A(Instruction* inst) {
 
 void Thread::ExecuteInst_SEL_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned active;
@@ -2481,7 +2471,7 @@ void Thread::ExecuteInst_SEL_B(Instruction* inst) {
 
     // Read Src2
     if ((format.op0 == 2) && (format.op2 == 1))  // src is const
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     else if ((format.op0 == 2 && format.op2 == 3))  // src is register mode
     {
       // src2 ID
@@ -2578,7 +2568,6 @@ void Thread::ExecuteInst_I2F_A(Instruction* inst) {
 
 void Thread::ExecuteInst_I2F_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned active;
@@ -2621,7 +2610,7 @@ void Thread::ExecuteInst_I2F_B(Instruction* inst) {
   // Execute
   if (active == 1 && pred == 1) {
     if ((format.op0 == 2) && (format.op2 == 1))  // src is const
-      emulator->ReadConstantMemory(format.src << 2, 4, (char*)&src);
+      ReadConstantMemory(format.src << 2, 4, (char*)&src);
     else if ((format.op0 == 2 && format.op2 == 3))  // src is register mode
     {
       // src2 ID
@@ -2720,7 +2709,6 @@ void Thread::ExecuteInst_I2I_A(Instruction* inst) {
 
 void Thread::ExecuteInst_I2I_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned active;
@@ -2762,7 +2750,7 @@ void Thread::ExecuteInst_I2I_B(Instruction* inst) {
   // Execute
   if (active == 1 && pred == 1) {
     if ((format.op0 == 2) && (format.op2 == 1))  // src is const
-      emulator->ReadConstantMemory(format.src << 2, 4, (char*)&src);
+      ReadConstantMemory(format.src << 2, 4, (char*)&src);
     else if ((format.op0 == 2 && format.op2 == 3))  // src is register mode
     {
       // src2 ID
@@ -2876,7 +2864,6 @@ void Thread::ExecuteInst_F2I_A(Instruction* inst) {
 
 void Thread::ExecuteInst_F2I_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned active;
@@ -2919,7 +2906,7 @@ void Thread::ExecuteInst_F2I_B(Instruction* inst) {
   // Execute
   if (active == 1 && pred == 1) {
     if ((format.op0 == 2) && (format.op2 == 1))  // src is const
-      emulator->ReadConstantMemory(format.src << 2, 4, (char*)&src);
+      ReadConstantMemory(format.src << 2, 4, (char*)&src);
     else if ((format.op0 == 2 && format.op2 == 3))  // src is register mode
     {
       // src ID
@@ -2963,7 +2950,6 @@ void Thread::ExecuteInst_F2F_A(Instruction* inst) { ISAUnimplemented(inst); }
 
 void Thread::ExecuteInst_F2F_B(Instruction* inst) {
   // Get Warp
-  Emulator* emulator = Emulator::getInstance();
   SyncStack* stack = warp->getSyncStack()->get();
 
   unsigned active;
@@ -3006,7 +2992,7 @@ void Thread::ExecuteInst_F2F_B(Instruction* inst) {
   // Execute
   if (active == 1 && pred == 1) {
     if (format.op2 == 1)  // src is const
-      emulator->ReadConstantMemory(format.src << 2, 4, (char*)&src);
+      ReadConstantMemory(format.src << 2, 4, (char*)&src);
     else if (format.op2 == 3)  // src is register mode
     {
       // src ID
@@ -3285,7 +3271,6 @@ void Thread::ExecuteInst_LDC(Instruction* inst) {
   RegValue srcA, srcB, dst;
 
   // Predicates and active masks
-  Emulator* emulator = Emulator::getInstance();
 
   SyncStack* stack = warp->getSyncStack()->get();
 
@@ -3328,7 +3313,7 @@ void Thread::ExecuteInst_LDC(Instruction* inst) {
 
       // Caculate mem_addr and read const mem
       mem_addr = srcB_id2 + srcA.s32 + (srcB_id1 << 16);
-      emulator->ReadConstantMemory(mem_addr, 4, (char*)&srcB.u32);
+      ReadConstantMemory(mem_addr, 4, (char*)&srcB.u32);
 
       // Execute
       dst.u32 = srcB.u32;
@@ -3352,7 +3337,7 @@ void Thread::ExecuteInst_LDC(Instruction* inst) {
       mem_addr = srcB_id2 + srcA.s32 + (srcB_id1 << 16);
 
       // Read the lower 32 bits
-      emulator->ReadConstantMemory(mem_addr, 4, (char*)&srcB.u32);
+      ReadConstantMemory(mem_addr, 4, (char*)&srcB.u32);
 
       // Execute
       dst.u32 = srcB.u32;
@@ -3362,7 +3347,7 @@ void Thread::ExecuteInst_LDC(Instruction* inst) {
       WriteGPR(dst_id, dst.u32);
 
       // Read the upper 32 bits
-      emulator->ReadConstantMemory(mem_addr + 4, 4, (char*)&srcB.u32);
+      ReadConstantMemory(mem_addr + 4, 4, (char*)&srcB.u32);
 
       // Execute the upper 32 bits
       dst.u32 = srcB.u32;
@@ -3608,7 +3593,6 @@ void Thread::ExecuteInst_DADD(Instruction* inst) { ISAUnimplemented(inst); }
 
 void Thread::ExecuteInst_FMUL(Instruction* inst) {
   // Get emulator
-  Emulator* emulator = Emulator::getInstance();
 
   // Get Warp
   SyncStack* stack = warp->getSyncStack()->get();
@@ -3665,7 +3649,7 @@ void Thread::ExecuteInst_FMUL(Instruction* inst) {
     src_id = format.srcB;
 
     if (format.srcB_mod == 0) {
-      emulator->ReadConstantMemory(src_id << 2, 4, (char*)&src2);
+      ReadConstantMemory(src_id << 2, 4, (char*)&src2);
     } else if (format.srcB_mod == 1 || format.srcB_mod == 2)
       src2 = ReadFloatGPR(src_id);
     else  // check it
@@ -3758,7 +3742,7 @@ mask
 
                 if (format.srcB_mod == 0)
                 {
-                        emulator->ReadConstantMemory(src_id << 2, 4,
+                        ReadConstantMemory(src_id << 2, 4,
 (char*)&src2);
                 }
                 else if (format.srcB_mod == 1 || format.srcB_mod == 2)
@@ -3792,7 +3776,6 @@ void Thread::ExecuteInst_FADD_A(Instruction* inst) {
 
 void Thread::ExecuteInst_FADD_B(Instruction* inst) {
   // Get emulator
-  Emulator* emulator = Emulator::getInstance();
 
   // Get Warp
   SyncStack* stack = warp->getSyncStack()->get();
@@ -3837,7 +3820,7 @@ void Thread::ExecuteInst_FADD_B(Instruction* inst) {
 
     // Read Src2
     if (format.op2 == 1)
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     else if (format.op2 == 3) {
       unsigned src2_id;
       src2_id = format.src2;
@@ -4011,8 +3994,7 @@ void Thread::ExecuteInst_FFMA_B(Instruction* inst) {
     // Read src2 and src3
     if (format.op2 == 1)  // src2 is const src3 is register
     {
-      Emulator* emulator = Emulator::getInstance();
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
       unsigned src3_id;
       src3_id = format.src3;
       src3 = ReadFloatGPR(src3_id);
@@ -4021,8 +4003,7 @@ void Thread::ExecuteInst_FFMA_B(Instruction* inst) {
       unsigned src2_id;
       src2_id = format.src3;  // format.src3 is for register mode
       src2 = ReadFloatGPR(src2_id);
-      Emulator* emulator = Emulator::getInstance();
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src3);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src3);
     } else if (format.op2 == 3)  // both src2 and src3 are register mode
     {
       unsigned src2_id, src3_id;
@@ -4121,7 +4102,7 @@ void Thread::ExecuteInst_FSET_B(Instruction* inst) {
 
     // Read Src2
     if (format.op2 == 1)  // src is const
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     else if (format.op2 == 3)  // src is register mode
     {
       // src2 ID
@@ -4566,7 +4547,6 @@ void Thread::ExecuteInst_PLONGJMP(Instruction* inst) { ISAUnimplemented(inst); }
 
 void Thread::ExecuteInst_SSY(Instruction* inst) {
   // Get emulator
-  Emulator* emulator = Emulator::getInstance();
 
   // Get synchronization stack
   SyncStack* stack = warp->getSyncStack()->get();
@@ -4605,7 +4585,7 @@ void Thread::ExecuteInst_SSY(Instruction* inst) {
     } else {
       // check this
       if (isconstmem == 1)
-        emulator->ReadConstantMemory(offset << 2, 4, (char*)&address);
+        ReadConstantMemory(offset << 2, 4, (char*)&address);
     }
 
     stack->push(address, stack->getActiveMask(), SyncStackEntrySSY);
@@ -5079,7 +5059,7 @@ void Thread::ExecuteInst_SHL_A(Instruction* inst) {
     dst_id = format.dst;
 
     // Calculate result
-    dst = srcA << srcB;
+    dst = srcB < 32 ? srcA << srcB : 0;
 
     // Write the value to destination register
     WriteGPR(dst_id, dst);
@@ -5139,10 +5119,9 @@ void Thread::ExecuteInst_SHL_B(Instruction* inst) {
     if (format.op2 == 1)  // src2 is constant mode
     {
       // Get emulator instance
-      Emulator* emulator = Emulator::getInstance();
 
       // Read src2
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     } else if (format.op2 == 3)  // src2 is register mode
     {
       unsigned src2_id;
@@ -5163,7 +5142,7 @@ void Thread::ExecuteInst_SHL_B(Instruction* inst) {
     dst_id = format.dst;
 
     // Calculate result
-    dst = src1 << src2;
+    dst = src2 < 32 ? src1 << src2 : 0;
 
     // Write the value to destination register
     WriteGPR(dst_id, dst);
@@ -5235,7 +5214,7 @@ void Thread::ExecuteInst_SHR_A(Instruction* inst) {
     if (format.shift_mode == 1)  // arithmatic shift
       dst = (int)src1 >> src2;
     else if (format.shift_mode == 0)  // logic shift
-      dst = src1 >> src2;
+      dst = src2 < 32 ? src1 >> src2 : 0;
 
     if (format.cc == 1) ISAUnsupportedFeature(inst);
 
@@ -5301,10 +5280,9 @@ void Thread::ExecuteInst_SHR_B(Instruction* inst) {
     if (format.op2 == 1)  // src2 is const mode
     {
       // Get emulator instance
-      Emulator* emulator = Emulator::getInstance();
 
       // Read src2
-      emulator->ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
+      ReadConstantMemory(format.src2 << 2, 4, (char*)&src2);
     } else if (format.op2 == 3)  // src2 is register mode
     {
       // Get src2 ID
@@ -5326,7 +5304,7 @@ void Thread::ExecuteInst_SHR_B(Instruction* inst) {
     if (format.shift_mode == 1)  // arithmatic shift
       dst = (int)src1 >> src2;
     else if (format.shift_mode == 0)  // logic shift
-      dst = src1 >> src2;
+      dst = src2 < 32 ? src1 >> src2 : 0;
 
     if (format.cc == 1) ISAUnsupportedFeature(inst);
 
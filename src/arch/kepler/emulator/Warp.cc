@@ -31,7 +31,7 @@
 
 namespace Kepler {
 
-Warp::Warp(ThreadBlock* thread_block, unsigned id) : inst(Instruction()) {
+Warp::Warp(ThreadBlock* thread_block, unsigned id) {
   unsigned am = 0;
 
   // Initialization
@@ -81,7 +81,6 @@ Warp::Warp(ThreadBlock* thread_block, unsigned id) : inst(Instruction()) {
   pc = 0;
   target_pc = 0;
   inst_size = 8;
-  instruction_buffer = grid->getInstructionBuffer();
   instruction_buffer_size = grid->getInstructionBufferSize();
 
   // Reset flags
@@ -104,25 +103,15 @@ Warp::Warp(ThreadBlock* thread_block, unsigned id) : inst(Instruction()) {
 void Warp::Dump(std::ostream& os) const {}
 
 void Warp::Execute() {
-  // Get emu instance
-  Emulator* emulator = Emulator::getInstance();
-
-  // Instruction binary
-  Instruction::Bytes inst_bytes;
-
   // Instruction opcode
   Instruction::Opcode inst_op;
 
-  // Read instruction binary
-  inst_bytes.as_uint[0] = instruction_buffer[pc / inst_size] >> 32;
-  inst_bytes.as_uint[1] = instruction_buffer[pc / inst_size];
-
-  // Decode instruction
+  // Get the instruction decoded when the grid was created
   if (pc % 64) {
-    inst.Decode((const char*)&inst_bytes, pc);
+    Instruction* inst = grid->getInstruction(pc);
 
     // Execute instruction
-    inst_op = (Instruction::Opcode)inst.getOpcode();
+    inst_op = (Instruction::Opcode)inst->getOpcode();
 
     if (!inst_op) {
       std::cerr << __FILE__ << ":" << __LINE__ << ": unrecognized instruction "
@@ -130,17 +119,10 @@ void Warp::Execute() {
       misc::Panic("Simulation exits with exception.\n");
     }
 
-    for (auto thread_id = threads_begin; thread_id < threads_end; ++thread_id) {
-      /*
-      if (thread_id->get()->getId() == 0)
-      std::cerr << inst.getName() << " id " << thread_id->get()->getId()
-                      << " warp_id " << id << " thread count " <<
-      this->thread_count
-                      << " block id " << thread_block->getId()
-                      << " warp count " << thread_block->getWarpCount()
-                      << " pc " << pc << std::endl;
-                      */
-      thread_id->get()->Execute(inst_op, &inst);
+    if (!ExecuteVector(inst_op, inst)) {
+      for (auto thread_id = threads_begin; thread_id < threads_end;
+           ++thread_id)
+        thread_id->get()->Execute(inst_op, inst);
     }
   } else {
     for (auto thread_id = threads_begin; thread_id < threads_end; ++thread_id) {
@@ -162,7 +144,6 @@ void Warp::Execute() {
 
   inst_count++;
   emu_inst_count++;
-  emulator->incNumAluInstructions();
   pc = this->target_pc;
 
   if (pc >= instruction_buffer_size - 8) {
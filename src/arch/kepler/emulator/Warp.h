@@ -30,6 +30,7 @@
 
 #include "../disassembler/Instruction.h"
 #include "Grid.h"
+#include "Register.h"
 #include "ReturnAddressStack.h"
 #include "ThreadBlock.h"
 #include "Warp.h"
@@ -81,15 +82,16 @@ class Warp {
   // Target PC for next instruction
   int target_pc;
 
-  // Current instruction
-  Instruction inst;
-
-  // Pointer points to the starting position of instruction buffer
-  std::vector<unsigned long long>::iterator instruction_buffer;
-
   // The whole instruction buffer size in bytes
   unsigned instruction_buffer_size;
 
+  // General purpose registers of the threads in the warp, stored as
+  // [register][lane] so that a register of all lanes is contiguous
+  RegValue gpr[256][warp_size];
+
+  // Predicate registers of the threads in the warp, stored the same way
+  unsigned pr[8][warp_size];
+
   // Return address stack
   std::unique_ptr<ReturnAddressStack> return_stack;
 
@@ -134,6 +136,46 @@ class Warp {
   // past-the-end iterator to the thread-block's thread list.
   std::vector<std::unique_ptr<Thread>>::iterator threads_end;
 
+  // Return the mask of lanes that execute an instruction guarded by
+  // predicate \a pred_id. The synchronization stack is popped first if
+  // the warp reached a reconvergence point, as thread 0 does when
+  // instructions run thread by thread.
+  unsigned getExecutionMask(unsigned pred_id);
+
+// Warp-wide emulation of common arithmetic instructions, operating on
+// all lanes of the register arrays at once. Each function returns false
+// without side effects if the instruction uses a feature it does not
+// handle, and the instruction then runs thread by thread.
+#define DEFINST(_name) bool ExecuteVectorInst_##_name(Instruction* inst);
+  DEFINST(MOV_B)
+  DEFINST(MOV32I)
+  DEFINST(FADD_B)
+  DEFINST(FFMA_B)
+  DEFINST(FMUL)
+  DEFINST(IADD_A)
+  DEFINST(IADD_B)
+  DEFINST(IMAD)
+  DEFINST(ISCADD_A)
+  DEFINST(ISCADD_B)
+  DEFINST(ISETP_A)
+  DEFINST(ISETP_B)
+  DEFINST(LOP_A)
+  DEFINST(LOP_B)
+  DEFINST(SHL_A)
+  DEFINST(SHL_B)
+  DEFINST(SHR_A)
+  DEFINST(SHR_B)
+#undef DEFINST
+
+  // Compare two sources of an ISETP instruction in one lane, combine the
+  // result with its third predicate, and write its destination predicates
+  void WriteISETP(const Instruction::BytesGeneral0& format, unsigned cmp_op,
+                  unsigned bool_op, int srcA, int srcB, unsigned lane);
+
+  // Run the warp-wide emulation of an instruction. Return false if
+  // there is none, or if it does not handle the instruction.
+  bool ExecuteVector(Instruction::Opcode opcode, Instruction* inst);
+
  public:
   /// Constructor
   ///
@@ -156,6 +198,9 @@ class Warp {
   /// Return PC
   unsigned getPC() const { return pc; }
 
+  /// Return the number of instructions emulated by the warp
+  long long getEmuInstCount() const { return emu_inst_count; }
+
   /// Return pointer to a thread inside this warp
   Thread* getThread(int id_in_warp) {
     assert(misc::inRange(id_in_warp, 0, (int)thread_count - 1));
@@ -187,6 +232,36 @@ class Warp {
   /// Get inst_size
   int getInstructionSize() const { return inst_size; }
 
+  /// Get value of a GPR of a lane
+  unsigned ReadGPR(int gpr_id, unsigned lane) const {
+    return gpr[gpr_id][lane].u32;
+  }
+
+  /// Get float type value of a GPR of a lane
+  float ReadFloatGPR(int gpr_id, unsigned lane) const {
+    return gpr[gpr_id][lane].f;
+  }
+
+  /// Set value of a GPR of a lane
+  void WriteGPR(int gpr_id, unsigned lane, unsigned value) {
+    gpr[gpr_id][lane].u32 = value;
+  }
+
+  /// Set float value of a GPR of a lane
+  void WriteFloatGPR(int gpr_id, unsigned lane, float value) {
+    gpr[gpr_id][lane].f = value;
+  }
+
+  /// Get value of a predicate register of a lane
+  unsigned ReadPredicate(int predicate_id, unsigned lane) const {
+    return pr[predicate_id][lane];
+  }
+
+  /// Set value of a predicate register of a lane
+  void WritePredicate(int predicate_id, unsigned lane, unsigned value) {
+    pr[predicate_id][lane] = value;
+  }
+
   //////////////////////////////////////////////////////////////
 
   // Setters
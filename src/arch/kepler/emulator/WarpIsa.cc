@@ -0,0 +1,779 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2012  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cmath>
+#include <cstdlib>
+
+#include "../disassembler/Instruction.h"
+
+#include "Emulator.h"
+#include "SyncStack.h"
+#include "Thread.h"
+#include "Warp.h"
+
+namespace Kepler {
+
+// Return true if the thread-by-thread versions dump the instructions they
+// execute, in which case the vector versions are skipped
+static bool isIsaDebug() {
+  static const bool kpl_isa_debug = getenv("M2S_KPL_ISA_DEBUG");
+  return kpl_isa_debug || Emulator::isa_debug;
+}
+
+// Read a 32-bit source operand from the constant memory into \a value.
+// Return false if the constant takes a different value in each thread.
+static bool ReadSharedConstant(unsigned address, void* value) {
+  if (Thread::isPerThreadConstant(address, 4)) return false;
+  Emulator::getInstance()->ReadConstantMemory(address, 4, (char*)value);
+  return true;
+}
+
+// Apply the .PO modifier of an integer addition to its sources, and return
+// the carry-in it adds
+static unsigned ApplyPlusOne(unsigned po, unsigned& src1, unsigned& src2) {
+  if (po == 3) return 1;
+  if (po == 1) {
+    src2 = ~src2;
+    return 1;
+  }
+  if (po == 2) {
+    src1 = ~src1;
+    return 1;
+  }
+  return 0;
+}
+
+// Return src1 + src2 + carry_in, writing the condition code flags of the
+// thread if \a write_cc is set. With \a extended, the zero flag also
+// depends on the previous one, as in IADD.X.
+static unsigned AddWithFlags(Thread* thread, unsigned src1, unsigned src2,
+                             unsigned carry_in, bool extended, bool write_cc) {
+  unsigned dst = src1 + src2 + carry_in;
+  if (!write_cc) return dst;
+
+  thread->WriteCC_ZF(dst == 0 && (!extended || thread->ReadCC_ZF()));
+  thread->WriteCC_SF((dst >> 31) & 0x1);
+  long long signed_sum = (long long)(int)src1 + (int)src2 + carry_in;
+  thread->WriteCC_OF(((signed_sum >> 32) & 0x1) ^ ((dst >> 31) & 0x1));
+  unsigned long long unsigned_sum =
+      (unsigned long long)src1 + src2 + carry_in;
+  thread->WriteCC_CF((unsigned_sum >> 32) & 0x1);
+  return dst;
+}
+
+// Return true if the comparison and the boolean operation of an ISETP
+// instruction are implemented
+static bool isSupportedISETP(unsigned cmp_op, unsigned bool_op) {
+  if (cmp_op < 1 || cmp_op > 6) return false;
+  return bool_op <= 1 || cmp_op == 2;
+}
+
+// Apply the logic operation of a LOP instruction to its sources
+static unsigned EvaluateLOP(const Instruction::BytesLOP& format,
+                            unsigned src1, unsigned src2) {
+  if (format.src1_negate) src1 = ~src1;
+  if (format.src2_negate) src2 = ~src2;
+  switch (format.lop) {
+    case 0:
+      return src1 & src2;
+    case 1:
+      return src1 | src2;
+    case 2:
+      return src1 ^ src2;
+    default:
+      return src2;
+  }
+}
+
+// Return the shift amount of SHL and SHR, clamped to 32 by default, or
+// taken modulo 32 in wrap mode
+static unsigned getShiftAmount(unsigned shift, unsigned wrap) {
+  if (wrap) return shift & 0x1f;
+  return shift > 32 ? 32 : shift;
+}
+
+// Shift a source of SHR right, arithmetically in wrap mode and logically
+// otherwise
+static unsigned EvaluateSHR(const Instruction::BytesSHR& format,
+                            unsigned src1, unsigned shift) {
+  if (format.bit_reverse) src1 ^= 0xffffffff;
+  if (format.shift_mode) return (int)src1 >> shift;
+  return shift < 32 ? src1 >> shift : 0;
+}
+
+bool Warp::ExecuteVector(Instruction::Opcode opcode, Instruction* inst) {
+  switch (opcode) {
+    case Instruction::INST_MOV_B:
+      return ExecuteVectorInst_MOV_B(inst);
+    case Instruction::INST_MOV32I:
+      return ExecuteVectorInst_MOV32I(inst);
+    case Instruction::INST_FADD_B:
+      return ExecuteVectorInst_FADD_B(inst);
+    case Instruction::INST_FFMA_B:
+      return ExecuteVectorInst_FFMA_B(inst);
+    case Instruction::INST_FMUL:
+      return ExecuteVectorInst_FMUL(inst);
+    case Instruction::INST_IADD_A:
+      return ExecuteVectorInst_IADD_A(inst);
+    case Instruction::INST_IADD_B:
+      return ExecuteVectorInst_IADD_B(inst);
+    case Instruction::INST_IMAD:
+      return ExecuteVectorInst_IMAD(inst);
+    case Instruction::INST_ISCADD_A:
+      return ExecuteVectorInst_ISCADD_A(inst);
+    case Instruction::INST_ISCADD_B:
+      return ExecuteVectorInst_ISCADD_B(inst);
+    case Instruction::INST_ISETP_A:
+      return ExecuteVectorInst_ISETP_A(inst);
+    case Instruction::INST_ISETP_B:
+      return ExecuteVectorInst_ISETP_B(inst);
+    case Instruction::INST_LOP_A:
+      return ExecuteVectorInst_LOP_A(inst);
+    case Instruction::INST_LOP_B:
+      return ExecuteVectorInst_LOP_B(inst);
+    case Instruction::INST_SHL_A:
+      return ExecuteVectorInst_SHL_A(inst);
+    case Instruction::INST_SHL_B:
+      return ExecuteVectorInst_SHL_B(inst);
+    case Instruction::INST_SHR_A:
+      return ExecuteVectorInst_SHR_A(inst);
+    case Instruction::INST_SHR_B:
+      return ExecuteVectorInst_SHR_B(inst);
+    default:
+      return false;
+  }
+}
+
+unsigned Warp::getExecutionMask(unsigned pred_id) {
+  // Determine whether the warp reaches reconvergence pc.
+  // If it is, pop the synchronization stack top and restore the active mask
+  SyncStack* stack = getSyncStack()->get();
+  if (pc) {
+    unsigned temp_am;
+    if (stack->pop(pc, temp_am)) stack->setActiveMask(temp_am);
+  }
+
+  // Predicate of each lane, negated for predicate identifiers above 7
+  unsigned mask = 0;
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    unsigned pred = pred_id <= 7 ? pr[pred_id][lane] == 1
+                                 : pr[pred_id - 8][lane] == 0;
+    mask |= pred << lane;
+  }
+
+  // Combine with the active mask
+  return mask & stack->getActiveMask();
+}
+
+bool Warp::ExecuteVectorInst_MOV_B(Instruction* inst) {
+  // The thread-by-thread version dumps each thread in debug mode
+  if (isIsaDebug()) return false;
+
+  // Inst bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesGeneral0 format = inst_bytes.general0;
+
+  // Constants served per thread take the thread-by-thread version
+  if (format.srcB_mod == 0 &&
+      Thread::isPerThreadConstant(format.srcB << 2, 4))
+    return false;
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  if (format.srcB_mod == 0) {
+    unsigned src;
+    Emulator::getInstance()->ReadConstantMemory(format.srcB << 2, 4,
+                                                (char*)&src);
+    for (unsigned lane = 0; lane < thread_count; lane++)
+      if ((mask >> lane) & 1) dst[lane].u32 = src;
+  } else {
+    RegValue* src = gpr[format.srcB];
+    for (unsigned lane = 0; lane < thread_count; lane++)
+      if ((mask >> lane) & 1) dst[lane].u32 = src[lane].u32;
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_MOV32I(Instruction* inst) {
+  // Inst bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesImm format = inst_bytes.immediate;
+  if (format.s) return false;
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  unsigned src = format.imm32;
+  for (unsigned lane = 0; lane < thread_count; lane++)
+    if ((mask >> lane) & 1) dst[lane].u32 = src;
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_FADD_B(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesFADD format = inst_bytes.fadd;
+  if (format.ftz || format.sat || format.cc) return false;
+  if (format.op2 != 1 && format.op2 != 3) return false;
+
+  // Source 2 is either one constant or a register per lane
+  float src2_const = 0.0f;
+  if (format.op2 == 1) {
+    if (Thread::isPerThreadConstant(format.src2 << 2, 4)) return false;
+    Emulator::getInstance()->ReadConstantMemory(format.src2 << 2, 4,
+                                                (char*)&src2_const);
+  }
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  RegValue* src2 = format.op2 == 3 ? gpr[format.src2] : nullptr;
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    float a = src1[lane].f;
+    float b = src2 ? src2[lane].f : src2_const;
+    if (format.src1_abs) a = fabsf(a);
+    if (format.src1_negate) a = -a;
+    if (format.src2_abs) b = fabsf(b);
+    if (format.src2_negate) b = -b;
+    dst[lane].f = a + b;
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_FFMA_B(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesFFMA format = inst_bytes.ffma;
+  if (format.fmz || format.sat) return false;
+  if (format.op2 != 1 && format.op2 != 2 && format.op2 != 3) return false;
+
+  // The constant operand is src2 with op2 = 1 and src3 with op2 = 2.
+  // Field src3 holds the register of the other operand in both cases.
+  float constant = 0.0f;
+  if (format.op2 != 3) {
+    if (Thread::isPerThreadConstant(format.src2 << 2, 4)) return false;
+    Emulator::getInstance()->ReadConstantMemory(format.src2 << 2, 4,
+                                                (char*)&constant);
+  }
+  RegValue* src2 = nullptr;
+  RegValue* src3 = nullptr;
+  if (format.op2 == 1) {
+    src3 = gpr[format.src3];
+  } else if (format.op2 == 2) {
+    src2 = gpr[format.src3];
+  } else {
+    src2 = gpr[format.src2];
+    src3 = gpr[format.src3];
+  }
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    float b = src2 ? src2[lane].f : constant;
+    float c = src3 ? src3[lane].f : constant;
+    float temp = src1[lane].f * b;
+    if (format.negate_ab)
+      temp = -temp;
+    else if (format.negate_c)
+      c = -c;
+    dst[lane].f = temp + c;
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_FMUL(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesGeneral0 format = inst_bytes.general0;
+
+  // Source B is either one constant or a register per lane
+  float srcB_const = 0.0f;
+  if (format.srcB_mod == 0) {
+    if (!ReadSharedConstant(format.srcB << 2, &srcB_const)) return false;
+  } else if (format.srcB >= 256) {
+    return false;
+  }
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* srcA = gpr[format.mod0];
+  RegValue* srcB = format.srcB_mod == 1 ? gpr[format.srcB] : nullptr;
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    float a = srcA[lane].f;
+    float b = srcB ? srcB[lane].f : srcB_const;
+    if ((format.mod1 >> 3) & 0x1) a = fabsf(a);
+    if ((format.mod1 >> 5) & 0x1) a = -a;
+    if ((format.mod1 >> 2) & 0x1) b = fabsf(b);
+    if ((format.mod1 >> 4) & 0x1) b = -b;
+    dst[lane].f = a * b;
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_IADD_A(Instruction* inst) {
+  // The thread-by-thread version dumps each thread in debug mode
+  if (isIsaDebug()) return false;
+
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesIADD format = inst_bytes.iadd;
+
+  // Source 2 is a 20-bit immediate
+  unsigned imm = ((format.op1 >> 5) & 1) ? format.src2 | 0xfff80000
+                                         : format.src2;
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    Thread* thread = threads_begin[lane].get();
+    unsigned a = src1[lane].u32;
+    unsigned b = imm;
+    unsigned carry_in = ApplyPlusOne(format.po, a, b);
+    if (format.x) carry_in = thread->ReadCC_CF();
+    dst[lane].u32 = AddWithFlags(thread, a, b, carry_in, format.x, format.cc);
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_IADD_B(Instruction* inst) {
+  // The thread-by-thread version dumps each thread in debug mode
+  if (isIsaDebug()) return false;
+
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesIADD format = inst_bytes.iadd;
+
+  // Source 2 is either a register per lane or one constant
+  unsigned src2_const = 0;
+  if (format.op0 == 2 && format.op2 == 3) {
+    if (format.src2 >= 256) return false;
+  } else if (format.op2 == 1) {
+    if (!ReadSharedConstant(format.src2 << 2, &src2_const)) return false;
+  } else {
+    return false;
+  }
+
+  // Execute, always updating the condition code flags
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  RegValue* src2 = format.op2 == 3 ? gpr[format.src2] : nullptr;
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    Thread* thread = threads_begin[lane].get();
+    unsigned a = src1[lane].u32;
+    unsigned b = src2 ? src2[lane].u32 : src2_const;
+    unsigned carry_in = ApplyPlusOne(format.po, a, b);
+    if (format.x) carry_in = thread->ReadCC_CF();
+    dst[lane].u32 = AddWithFlags(thread, a, b, carry_in, format.x, true);
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_IMAD(Instruction* inst) {
+  // The thread-by-thread version dumps each thread in debug mode
+  if (isIsaDebug()) return false;
+
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesGeneral0 format = inst_bytes.general0;
+
+  // Source B is either one constant or a register per lane
+  unsigned srcB_const = 0;
+  unsigned srcB_id = format.srcB & 0x1ff;
+  if (format.srcB_mod == 0) {
+    if (!ReadSharedConstant(format.srcB << 2, &srcB_const)) return false;
+  } else if (srcB_id >= 256) {
+    return false;
+  }
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* srcA = gpr[format.mod0];
+  RegValue* srcB = format.srcB_mod == 1 ? gpr[srcB_id] : nullptr;
+  RegValue* srcC = gpr[format.mod1 & 0xff];
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    unsigned b = srcB ? srcB[lane].u32 : srcB_const;
+    dst[lane].u32 = srcA[lane].u32 * b + srcC[lane].u32;
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_ISCADD_A(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesISCADD format = inst_bytes.iscadd;
+
+  // Source 2 is a 20-bit immediate
+  unsigned imm = format.src2 >> 18 ? format.src2 | 0xfff80000 : format.src2;
+
+  // Execute, always updating the condition code flags
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    unsigned a = src1[lane].u32 << format.shamt;
+    unsigned b = imm;
+    unsigned carry_in = ApplyPlusOne(format.po, a, b);
+    dst[lane].u32 = AddWithFlags(threads_begin[lane].get(), a, b, carry_in,
+                                 false, true);
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_ISCADD_B(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesISCADD format = inst_bytes.iscadd;
+
+  // Source 2 is either one constant or a register per lane
+  unsigned src2_const = 0;
+  if (format.op2 == 1) {
+    if (!ReadSharedConstant(format.src2 << 2, &src2_const)) return false;
+  } else if (format.op2 != 3 || format.src2 >= 256) {
+    return false;
+  }
+
+  // Execute, always updating the condition code flags
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  RegValue* src2 = format.op2 == 3 ? gpr[format.src2] : nullptr;
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    unsigned a = src1[lane].u32 << format.shamt;
+    unsigned b = src2 ? src2[lane].u32 : src2_const;
+    unsigned carry_in = ApplyPlusOne(format.po, a, b);
+    dst[lane].u32 = AddWithFlags(threads_begin[lane].get(), a, b, carry_in,
+                                 false, true);
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_ISETP_A(Instruction* inst) {
+  // The thread-by-thread version dumps each thread in debug mode
+  if (isIsaDebug()) return false;
+
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesGeneral0 format = inst_bytes.general0;
+  unsigned cmp_op = ((format.op1 & 0x1) << 2) | (format.mod1 >> 10);
+  unsigned bool_op = (format.mod1 >> 6) & 0x3;
+  if (!isSupportedISETP(cmp_op, bool_op)) return false;
+
+  // Source B is either one constant or a register per lane
+  int srcB_const = 0;
+  if (format.srcB_mod == 0) {
+    if (!ReadSharedConstant(format.srcB << 2, &srcB_const)) return false;
+  } else if (format.srcB >= 256) {
+    return false;
+  }
+
+  // Execute. With .X, the carry flag of each thread is subtracted from
+  // source A.
+  unsigned mask = getExecutionMask(format.pred);
+  bool x = (format.mod1 >> 4) & 0x1;
+  RegValue* srcA = gpr[format.mod0];
+  RegValue* srcB = format.srcB_mod == 1 ? gpr[format.srcB] : nullptr;
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    int a = srcA[lane].u32 -
+            (x ? threads_begin[lane]->ReadCC_CF() : 0);
+    int b = srcB ? srcB[lane].u32 : srcB_const;
+    WriteISETP(format, cmp_op, bool_op, a, b, lane);
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_ISETP_B(Instruction* inst) {
+  // The thread-by-thread version dumps each thread in debug mode
+  if (isIsaDebug()) return false;
+
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesGeneral0 format = inst_bytes.general0;
+  unsigned cmp_op = ((format.op1 & 0x1) << 2) | (format.mod1 >> 10);
+  unsigned bool_op = (format.mod1 >> 6) & 0x3;
+  if (!isSupportedISETP(cmp_op, bool_op)) return false;
+
+  // Source B is a 20-bit immediate
+  if (format.srcB_mod != 1) return false;
+  int imm = format.srcB >> 18 ? format.srcB | 0xfff80000 : format.srcB;
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* srcA = gpr[format.mod0];
+  for (unsigned lane = 0; lane < thread_count; lane++)
+    if ((mask >> lane) & 1)
+      WriteISETP(format, cmp_op, bool_op, srcA[lane].u32, imm, lane);
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+void Warp::WriteISETP(const Instruction::BytesGeneral0& format,
+                      unsigned cmp_op, unsigned bool_op, int srcA, int srcB,
+                      unsigned lane) {
+  // Compare
+  bool cmp_res;
+  switch (cmp_op) {
+    case 1:
+      cmp_res = srcA < srcB;
+      break;
+    case 2:
+      cmp_res = srcA == srcB;
+      break;
+    case 3:
+      cmp_res = srcA <= srcB;
+      break;
+    case 4:
+      cmp_res = srcA > srcB;
+      break;
+    case 5:
+      cmp_res = srcA != srcB;
+      break;
+    default:
+      cmp_res = srcA >= srcB;
+      break;
+  }
+
+  // Combine with predicate 3
+  bool pred_3 = pr[format.mod1 & 0x7][lane];
+  if ((format.mod1 >> 3) & 0x1) pred_3 = !pred_3;
+  bool pred_1, pred_2;
+  if (bool_op == 0) {
+    pred_1 = cmp_res && pred_3;
+    pred_2 = !cmp_res && pred_3;
+  } else if (bool_op == 1) {
+    pred_1 = cmp_res || pred_3;
+    pred_2 = !cmp_res || pred_3;
+  } else {
+    pred_1 = cmp_res != pred_3;
+    pred_2 = cmp_res == pred_3;
+  }
+
+  // Write, skipping the true predicate PT
+  unsigned pred_id_1 = (format.dst >> 3) & 0x7;
+  unsigned pred_id_2 = format.dst & 0x7;
+  if (pred_id_1 != 7) pr[pred_id_1][lane] = pred_1;
+  if (pred_id_2 != 7) pr[pred_id_2][lane] = pred_2;
+}
+
+bool Warp::ExecuteVectorInst_LOP_A(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesLOP format = inst_bytes.lop;
+
+  // Source 2 is a 20-bit immediate
+  if (format.op0 != 1) return false;
+  unsigned imm = format.src2 >> 18 ? format.src2 | 0xfff80000 : format.src2;
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  for (unsigned lane = 0; lane < thread_count; lane++)
+    if ((mask >> lane) & 1)
+      dst[lane].u32 = EvaluateLOP(format, src1[lane].u32, imm);
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_LOP_B(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesLOP format = inst_bytes.lop;
+
+  // Source 2 is either one constant or a register per lane
+  unsigned src2_const = 0;
+  if (format.op0 != 2) return false;
+  if (format.op2 == 1) {
+    if (!ReadSharedConstant(format.src2 << 2, &src2_const)) return false;
+  } else if (format.op2 != 3 || format.src2 >= 256) {
+    return false;
+  }
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  RegValue* src2 = format.op2 == 3 ? gpr[format.src2] : nullptr;
+  for (unsigned lane = 0; lane < thread_count; lane++)
+    if ((mask >> lane) & 1)
+      dst[lane].u32 = EvaluateLOP(format, src1[lane].u32,
+                                  src2 ? src2[lane].u32 : src2_const);
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_SHL_A(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesSHL format = inst_bytes.shl;
+  if (format.cc) return false;
+
+  // Source 2 is an immediate shift amount
+  if (format.op2 != 3 || format.op0 != 1) return false;
+  unsigned shift = getShiftAmount(format.src2, format.mode);
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  for (unsigned lane = 0; lane < thread_count; lane++)
+    if ((mask >> lane) & 1)
+      dst[lane].u32 = shift < 32 ? src1[lane].u32 << shift : 0;
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_SHL_B(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesSHL format = inst_bytes.shl;
+  if (format.cc) return false;
+
+  // Source 2 is either one constant or a register per lane
+  unsigned src2_const = 0;
+  if (format.op2 == 1) {
+    if (!ReadSharedConstant(format.src2 << 2, &src2_const)) return false;
+  } else if (format.op2 != 3 || format.src2 >= 256) {
+    return false;
+  }
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  RegValue* src2 = format.op2 == 3 ? gpr[format.src2] : nullptr;
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    unsigned shift = getShiftAmount(src2 ? src2[lane].u32 : src2_const,
+                                    format.mode);
+    dst[lane].u32 = shift < 32 ? src1[lane].u32 << shift : 0;
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_SHR_A(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesSHR format = inst_bytes.shr;
+  if (format.cc) return false;
+
+  // Source 2 is an immediate shift amount
+  if (format.op2 != 3 || format.op0 != 1) return false;
+  unsigned shift = getShiftAmount(format.src2, format.shift_mode);
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  for (unsigned lane = 0; lane < thread_count; lane++)
+    if ((mask >> lane) & 1)
+      dst[lane].u32 = EvaluateSHR(format, src1[lane].u32, shift);
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+bool Warp::ExecuteVectorInst_SHR_B(Instruction* inst) {
+  // Instruction bytes format
+  Instruction::Bytes inst_bytes = inst->getInstBytes();
+  Instruction::BytesSHR format = inst_bytes.shr;
+  if (format.cc) return false;
+
+  // Source 2 is either one constant or a register per lane
+  unsigned src2_const = 0;
+  if (format.op2 == 1) {
+    if (!ReadSharedConstant(format.src2 << 2, &src2_const)) return false;
+  } else if (format.op2 != 3 || format.src2 >= 256) {
+    return false;
+  }
+
+  // Execute
+  unsigned mask = getExecutionMask(format.pred);
+  RegValue* dst = gpr[format.dst];
+  RegValue* src1 = gpr[format.src1];
+  RegValue* src2 = format.op2 == 3 ? gpr[format.src2] : nullptr;
+  for (unsigned lane = 0; lane < thread_count; lane++) {
+    if (!((mask >> lane) & 1)) continue;
+
+    unsigned shift = getShiftAmount(src2 ? src2[lane].u32 : src2_const,
+                                    format.shift_mode);
+    dst[lane].u32 = EvaluateSHR(format, src1[lane].u32, shift);
+  }
+
+  target_pc = pc + inst_size;
+  return true;
+}
+
+}  // namespace Kepler
@@ -357,26 +357,12 @@ void Context::Execute() {
   // set PC to the next instruction pointer
   regs.setPC(next_ip);
 
-  // read 4 bytes mips instruction from memory into buffer
-  char buffer[4];
-
-  char* buffer_ptr =
-      memory->getBuffer(regs.getPC(), 4, mem::Memory::AccessExec);
-  if (!buffer_ptr) {
-    // Disable safe mode. If a part of the 4 read bytes does not
-    // belong to the actual instruction, and they lie on a page with
-    // no permissions, this would generate an undesired protection
-    // fault.
-    memory->setSafe(false);
-    buffer_ptr = buffer;
-    memory->Access(regs.getPC(), 4, buffer_ptr, mem::Memory::AccessExec);
-  }
-
-  // Return to default safe mode
-  memory->setSafeDefault();
-
-  // Disassemble
-  inst.Decode(regs.getPC(), buffer_ptr);
+  // Get the decoded instruction. Speculative execution may fetch from
+  // invalid addresses, so it does not use the basic block cache.
+  if (spec_mode)
+    DecodeInstruction(regs.getPC(), inst);
+  else
+    inst = getBasicBlockInstruction(regs.getPC());
 
   // Debug
   if (emulator->isa_debug) {
@@ -410,6 +396,116 @@ void Context::Execute() {
   emulator->incNumInstructions();
 }
 
+void Context::DecodeInstruction(unsigned address, Instruction& inst) {
+  // read 4 bytes mips instruction from memory into buffer
+  char buffer[4];
+
+  char* buffer_ptr = memory->getBuffer(address, 4, mem::Memory::AccessExec);
+  if (!buffer_ptr) {
+    // Disable safe mode. If a part of the 4 read bytes does not
+    // belong to the actual instruction, and they lie on a page with
+    // no permissions, this would generate an undesired protection
+    // fault.
+    memory->setSafe(false);
+    buffer_ptr = buffer;
+    memory->Access(address, 4, buffer_ptr, mem::Memory::AccessExec);
+  }
+
+  // Return to default safe mode
+  memory->setSafeDefault();
+
+  // Disassemble
+  inst.Decode(address, buffer_ptr);
+}
+
+// Return whether an instruction may transfer control to an address other
+// than the one following its delay slot
+static bool isControlInstruction(Instruction::Opcode opcode) {
+  switch (opcode) {
+    case Instruction::OpcodeJ:
+    case Instruction::OpcodeJAL:
+    case Instruction::OpcodeJR:
+    case Instruction::OpcodeJALR:
+    case Instruction::OpcodeBEQ:
+    case Instruction::OpcodeBNE:
+    case Instruction::OpcodeBLEZ:
+    case Instruction::OpcodeBGTZ:
+    case Instruction::OpcodeBEQL:
+    case Instruction::OpcodeBNEL:
+    case Instruction::OpcodeBLEZL:
+    case Instruction::OpcodeBGTZL:
+    case Instruction::OpcodeBLTZ:
+    case Instruction::OpcodeBGEZ:
+    case Instruction::OpcodeBLTZL:
+    case Instruction::OpcodeBGEZL:
+    case Instruction::OpcodeBLTZAL:
+    case Instruction::OpcodeBGEZAL:
+    case Instruction::OpcodeBLTZALL:
+    case Instruction::OpcodeBGEZALL:
+    case Instruction::OpcodeBC1F:
+    case Instruction::OpcodeBC1FL:
+    case Instruction::OpcodeBC1T:
+    case Instruction::OpcodeBC1TL:
+    case Instruction::OpcodeBC2F:
+    case Instruction::OpcodeBC2FL:
+    case Instruction::OpcodeBC2T:
+    case Instruction::OpcodeBC2TL:
+    case Instruction::OpcodeERET:
+    case Instruction::OpcodeDERET:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+const Instruction& Context::getBasicBlockInstruction(unsigned address) {
+  // Discard all basic blocks if code may have changed
+  if (basic_blocks_code_version != memory->getCodeVersion()) {
+    basic_blocks.clear();
+    current_basic_block = nullptr;
+    basic_blocks_code_version = memory->getCodeVersion();
+  }
+
+  // Sequential execution, or a branch within the current basic block. The
+  // instruction in a delay slot is found here after its branch.
+  if (current_basic_block) {
+    unsigned offset = address - current_basic_block->address;
+    if (!(offset & 3) &&
+        offset / 4 < current_basic_block->instructions.size())
+      return current_basic_block->instructions[offset / 4];
+  }
+
+  // Basic block decoded before
+  auto it = basic_blocks.find(address);
+  if (it != basic_blocks.end()) {
+    current_basic_block = it->second.get();
+    return current_basic_block->instructions[0];
+  }
+
+  // Decode a new basic block. It does not cross the end of the page, so
+  // that decoding never touches a page that is not executed.
+  auto basic_block = misc::new_unique<BasicBlock>();
+  basic_block->address = address;
+  unsigned num_instructions =
+      (mem::Memory::PageSize - (address & (mem::Memory::PageSize - 1))) / 4;
+  bool delay_slot = false;
+  for (unsigned i = 0; i < num_instructions; i++) {
+    basic_block->instructions.emplace_back();
+    Instruction& inst = basic_block->instructions.back();
+    DecodeInstruction(address + i * 4, inst);
+
+    // Stop after the delay slot of a branch
+    if (delay_slot) break;
+    delay_slot = isControlInstruction(inst.getOpcode());
+  }
+
+  // Save it
+  current_basic_block = basic_block.get();
+  basic_blocks[address] = std::move(basic_block);
+  return current_basic_block->instructions[0];
+}
+
 void Context::FinishGroup(int exit_code) {
   // Make call on group parent only
   if (group_parent) {
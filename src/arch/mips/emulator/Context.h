@@ -20,7 +20,9 @@
 #define ARCH_MIPS_EMU_CONTEXT_H
 
 #include <iostream>
+#include <map>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <arch/common/CallStack.h>
@@ -142,6 +144,35 @@ class Context {
   unsigned current_ip;   // Address of currently emulated instruction
   unsigned n_next_ip;  // Address of the second next instruction to be emulated
 
+  // Sequence of instructions decoded at consecutive addresses, ending
+  // after the delay slot of the first branch or jump, or at the end of a
+  // memory page
+  struct BasicBlock {
+    // Address of the first instruction
+    unsigned address;
+
+    // Decoded instructions
+    std::vector<Instruction> instructions;
+  };
+
+  // Basic blocks decoded so far, indexed by their start address
+  std::unordered_map<unsigned, std::unique_ptr<BasicBlock>> basic_blocks;
+
+  // Basic block containing the last emulated instruction
+  BasicBlock* current_basic_block = nullptr;
+
+  // Code version of the context memory when the basic blocks were decoded.
+  // Basic blocks are discarded when it changes.
+  long long basic_blocks_code_version = -1;
+
+  // Read and decode the instruction at the given address
+  void DecodeInstruction(unsigned address, Instruction& inst);
+
+  // Return the decoded instruction at the given address, decoding the
+  // basic block starting at that address if it is not in the current
+  // basic block nor in the basic block cache.
+  const Instruction& getBasicBlockInstruction(unsigned address);
+
   // Parent context
   Context* parent = nullptr;
 
@@ -197,6 +228,12 @@ class Context {
   void Suspend(CanWakeupFn can_wakeup_fn, WakeupFn wakeup_fn,
                ContextState wakeup_state);
 
+  // All pairs of wakeup callbacks, used to save them in checkpoints by
+  // their position in the table. The first entry is a pair of null
+  // callbacks.
+  static const std::pair<CanWakeupFn, WakeupFn> wakeup_callbacks[];
+  static const unsigned num_wakeup_callbacks;
+
   ///////////////////////////////////////////////////////////////////////
   //
   // Functions implemented in ContextLoader.cc. These are the functions
@@ -428,6 +465,16 @@ class Context {
             const std::string& stdin_file_name,
             const std::string& stdout_file_name);
 
+  /// Save the architectural state of the context into a checkpoint. The
+  /// context must not be in speculative mode.
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) const;
+
+  /// Restore the state saved with SaveCheckpoint() into a context just
+  /// created with Emulator::newContext(). Host file descriptors reopened
+  /// by previous contexts are recorded in \a host_indexes.
+  void LoadCheckpoint(misc::Checkpoint& checkpoint,
+                      std::map<int, int>& host_indexes);
+
   /// Given a file name, return its full path based on the current working
   /// directory for the context.
   std::string getFullPath(const std::string& path) {
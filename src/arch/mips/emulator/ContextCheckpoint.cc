@@ -0,0 +1,186 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/Checkpoint.h>
+
+#include "Context.h"
+#include "Emulator.h"
+
+namespace MIPS {
+
+const std::pair<Context::CanWakeupFn, Context::WakeupFn>
+    Context::wakeup_callbacks[] = {
+        {nullptr, nullptr},
+        {&Context::SyscallReadCanWakeup, &Context::SyscallReadWakeup},
+        {&Context::SyscallWriteCanWakeup, &Context::SyscallWriteWakeup}};
+
+const unsigned Context::num_wakeup_callbacks =
+    sizeof wakeup_callbacks / sizeof wakeup_callbacks[0];
+
+void Context::SaveCheckpoint(misc::Checkpoint& checkpoint) const {
+  // Speculative state is never saved
+  if (getState(ContextSpecMode))
+    throw misc::Panic("Context in speculative mode");
+
+  // Identity and state. Contexts are never shared resources, since system
+  // calls 'clone' and 'fork' are not supported.
+  checkpoint.WriteTag("Context");
+  checkpoint.WriteValue(pid);
+  checkpoint.WriteValue(state & ~(ContextAlloc | ContextMapped));
+
+  // Registers and instruction pointers
+  checkpoint.WriteValue(regs);
+  checkpoint.WriteValue(previous_ip);
+  checkpoint.WriteValue(current_ip);
+  checkpoint.WriteValue(next_ip);
+  checkpoint.WriteValue(n_next_ip);
+  checkpoint.WriteValue(ll_bit);
+
+  // Memory and file table. Signal handlers are not saved, since no system
+  // call can install them.
+  memory->SaveCheckpoint(checkpoint);
+  file_table->SaveCheckpoint(checkpoint);
+
+  // Loader information
+  checkpoint.WriteStrings(loader->args);
+  checkpoint.WriteStrings(loader->env);
+  checkpoint.WriteString(loader->interp);
+  checkpoint.WriteString(loader->exe);
+  checkpoint.WriteString(loader->cwd);
+  checkpoint.WriteString(loader->stdin_file_name);
+  checkpoint.WriteString(loader->stdout_file_name);
+  checkpoint.WriteValue(loader->stack_base);
+  checkpoint.WriteValue(loader->stack_top);
+  checkpoint.WriteValue(loader->stack_size);
+  checkpoint.WriteValue(loader->environ_base);
+  checkpoint.WriteValue(loader->bottom);
+  checkpoint.WriteValue(loader->prog_entry);
+  checkpoint.WriteValue(loader->interp_prog_entry);
+  checkpoint.WriteValue(loader->phdt_base);
+  checkpoint.WriteValue(loader->phdr_count);
+  checkpoint.WriteValue(loader->at_random_addr);
+  checkpoint.WriteValue(loader->at_random_addr_holder);
+
+  // Process information
+  checkpoint.WriteValue(exit_signal);
+  checkpoint.WriteValue(exit_code);
+  checkpoint.WriteValue(clear_child_tid);
+  checkpoint.WriteValue(robust_list_head);
+  checkpoint.WriteValue(glibc_segment_base);
+  checkpoint.WriteValue(glibc_segment_limit);
+  checkpoint.WriteValue(sched_policy);
+  checkpoint.WriteValue(sched_priority);
+
+  // Suspended system calls. Wakeup callbacks are saved as their position
+  // in table 'wakeup_callbacks'.
+  int callback_index = -1;
+  for (unsigned i = 0; i < num_wakeup_callbacks; i++)
+    if (wakeup_callbacks[i].first == can_wakeup_fn &&
+        wakeup_callbacks[i].second == wakeup_fn)
+      callback_index = i;
+  if (callback_index < 0) throw misc::Panic("Unknown wakeup callback");
+  checkpoint.WriteValue(callback_index);
+  checkpoint.WriteValue(getState(ContextCallback) ? wakeup_state
+                                                  : ContextInvalid);
+  checkpoint.WriteValue(syscall_nanosleep_wakeup_time);
+  checkpoint.WriteValue(syscall_read_fd);
+  checkpoint.WriteValue(syscall_write_fd);
+  checkpoint.WriteValue(syscall_poll_time);
+  checkpoint.WriteValue(syscall_poll_fd);
+  checkpoint.WriteValue(syscall_poll_events);
+}
+
+void Context::LoadCheckpoint(misc::Checkpoint& checkpoint,
+                             std::map<int, int>& host_indexes) {
+  // Identity
+  checkpoint.ReadTag("Context");
+  checkpoint.ReadValue(pid);
+  unsigned saved_state = checkpoint.ReadValue<unsigned>();
+
+  // Registers and instruction pointers
+  checkpoint.ReadValue(regs);
+  checkpoint.ReadValue(previous_ip);
+  checkpoint.ReadValue(current_ip);
+  checkpoint.ReadValue(next_ip);
+  checkpoint.ReadValue(n_next_ip);
+  checkpoint.ReadValue(ll_bit);
+
+  // Memory
+  memory = misc::new_shared<mem::Memory>();
+  memory->LoadCheckpoint(checkpoint);
+  address_space_index = emulator->getAddressSpaceIndex();
+  spec_mem = misc::new_unique<mem::SpecMem>(memory.get());
+  signal_handler_table = misc::new_shared<SignalHandlerTable>();
+
+  // File table
+  file_table = misc::new_shared<comm::FileTable>();
+  file_table->LoadCheckpoint(checkpoint, host_indexes);
+
+  // Loader information
+  loader = misc::new_shared<Loader>();
+  checkpoint.ReadStrings(loader->args);
+  checkpoint.ReadStrings(loader->env);
+  loader->interp = checkpoint.ReadString();
+  loader->exe = checkpoint.ReadString();
+  loader->cwd = checkpoint.ReadString();
+  loader->stdin_file_name = checkpoint.ReadString();
+  loader->stdout_file_name = checkpoint.ReadString();
+  checkpoint.ReadValue(loader->stack_base);
+  checkpoint.ReadValue(loader->stack_top);
+  checkpoint.ReadValue(loader->stack_size);
+  checkpoint.ReadValue(loader->environ_base);
+  checkpoint.ReadValue(loader->bottom);
+  checkpoint.ReadValue(loader->prog_entry);
+  checkpoint.ReadValue(loader->interp_prog_entry);
+  checkpoint.ReadValue(loader->phdt_base);
+  checkpoint.ReadValue(loader->phdr_count);
+  checkpoint.ReadValue(loader->at_random_addr);
+  checkpoint.ReadValue(loader->at_random_addr_holder);
+  call_stack = misc::new_unique<comm::CallStack>(loader->exe);
+
+  // Process information
+  checkpoint.ReadValue(exit_signal);
+  checkpoint.ReadValue(exit_code);
+  checkpoint.ReadValue(clear_child_tid);
+  checkpoint.ReadValue(robust_list_head);
+  checkpoint.ReadValue(glibc_segment_base);
+  checkpoint.ReadValue(glibc_segment_limit);
+  checkpoint.ReadValue(sched_policy);
+  checkpoint.ReadValue(sched_priority);
+
+  // Suspended system calls
+  int callback_index = checkpoint.ReadValue<int>();
+  if (callback_index < 0 || callback_index >= (int)num_wakeup_callbacks)
+    throw misc::Checkpoint::Error(checkpoint.getPath(),
+                                  "Invalid wakeup callback");
+  can_wakeup_fn = wakeup_callbacks[callback_index].first;
+  wakeup_fn = wakeup_callbacks[callback_index].second;
+  checkpoint.ReadValue(wakeup_state);
+  checkpoint.ReadValue(syscall_nanosleep_wakeup_time);
+  checkpoint.ReadValue(syscall_read_fd);
+  checkpoint.ReadValue(syscall_write_fd);
+  checkpoint.ReadValue(syscall_poll_time);
+  checkpoint.ReadValue(syscall_poll_fd);
+  checkpoint.ReadValue(syscall_poll_events);
+
+  // Set the state last, which places the context in the emulator lists
+  UpdateState(saved_state);
+}
+
+}  // namespace MIPS
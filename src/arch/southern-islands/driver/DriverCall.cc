@@ -119,10 +119,8 @@ int Driver::CallMemRead(comm::Context* context, mem::Memory* memory,
                   "allocated",
                   __FUNCTION__));
 
-  // Read memory from host to device
-  auto buffer = misc::new_unique_array<char>(size);
-  video_memory->Read(device_ptr, size, buffer.get());
-  memory->Write(host_ptr, size, buffer.get());
+  // Read memory from device to host
+  memory->Copy(host_ptr, video_memory, device_ptr, size);
 
   // Return
   return 0;
@@ -164,10 +162,8 @@ int Driver::CallMemWrite(comm::Context* context, mem::Memory* memory,
   if (device_ptr + size > emulator->getVideoMemoryTop())
     throw Error(misc::fmt("Device not allocated"));
 
-  // Read memory from host to device
-  auto buffer = misc::new_unique_array<char>(size);
-  memory->Read(host_ptr, size, buffer.get());
-  video_memory->Write(device_ptr, size, buffer.get());
+  // Write memory from host to device
+  video_memory->Copy(device_ptr, memory, host_ptr, size);
 
   // Return
   return 0;
@@ -212,10 +208,9 @@ int Driver::CallMemCopy(comm::Context* context, mem::Memory* memory,
                   "allocated",
                   __FUNCTION__));
 
-  // Read memory from host to device
-  auto buffer = misc::new_unique_array<char>(size);
-  video_memory->Read(src_ptr, size, buffer.get());
-  video_memory->Write(dest_ptr, size, buffer.get());
+  // Copy memory within the device. Overlapping regions are copied as
+  // with memmove().
+  video_memory->Copy(dest_ptr, video_memory, src_ptr, size);
 
   // Return
   return 0;
@@ -38,6 +38,8 @@ std::string Emulator::isa_debug_file;
 
 long long Emulator::max_instructions;
 
+int Emulator::num_host_threads = 1;
+
 std::string Emulator::scheduler_debug_file;
 
 misc::Debug Emulator::scheduler_debug;
@@ -64,6 +66,8 @@ Emulator::Emulator() : comm::Emulator("SouthernIslands") {
   global_memory = video_memory.get();
 }
 
+Emulator::~Emulator() { StopHostThreads(); }
+
 void Emulator::DumpSummary(std::ostream& os) const {
   // FIXME: basic statistics, such as instructions, time...
   comm::Emulator::DumpSummary(os);
@@ -91,6 +95,13 @@ bool Emulator::Run() {
     // Get NDRange
     NDRange* ndrange = it->get();
 
+    // Execute a batch of work-groups on multiple host threads. Tracing
+    // ISA execution forces the sequential emulation.
+    if (num_host_threads > 1 && !isa_debug) {
+      RunParallel(ndrange);
+      continue;
+    }
+
     // Setup WorkGroup pointer
     WorkGroup* work_group = nullptr;
 
@@ -107,21 +118,7 @@ bool Emulator::Run() {
     // Normally, we would iterate over the running work group list
     // but in this case there is only a single work group being
     // executed at a time so no loop is needed
-    while (!work_group->getFinished()) {
-      // Execute an instruction for each wavefront
-      for (auto wf_i = work_group->getWavefrontsBegin(),
-                wf_e = work_group->getWavefrontsEnd();
-           wf_i != wf_e; ++wf_i) {
-        // Get current wavefront
-        Wavefront* wavefront = (*wf_i).get();
-
-        // Check if the wavefront is finished or not
-        if (wavefront->getFinished() || wavefront->at_barrier) continue;
-
-        // Execute the wavefront
-        wavefront->Execute();
-      }
-    }
+    RunWorkGroup(work_group);
 
     // Now that the work group is finished, remove it from the
     // running work group list
@@ -136,6 +133,24 @@ bool Emulator::Run() {
   return true;
 }
 
+void Emulator::RunWorkGroup(WorkGroup* work_group) {
+  while (!work_group->getFinished()) {
+    // Execute an instruction for each wavefront
+    for (auto wf_i = work_group->getWavefrontsBegin(),
+              wf_e = work_group->getWavefrontsEnd();
+         wf_i != wf_e; ++wf_i) {
+      // Get current wavefront
+      Wavefront* wavefront = (*wf_i).get();
+
+      // Check if the wavefront is finished or not
+      if (wavefront->getFinished() || wavefront->at_barrier) continue;
+
+      // Execute the wavefront
+      wavefront->Execute();
+    }
+  }
+}
+
 void Emulator::createBufferDesc(unsigned base_addr, unsigned size,
                                 int num_elems, Argument::DataType data_type,
                                 WorkItem::BufferDescriptor* buffer_descriptor) {
@@ -343,6 +358,15 @@ void Emulator::RegisterOptions() {
       "executed by an entire wavefront counts as 1 toward "
       "this limit. Use 0 (default) for no limit.");
 
+  // Option --si-emu-threads <num>
+  command_line->RegisterInt32(
+      "--si-emu-threads <num>", num_host_threads,
+      "Number of host threads executing work-groups concurrently in "
+      "functional simulation. Global memory accesses are serialized, "
+      "atomic operations included, and statistics are added up in "
+      "work-group order. Tracing ISA execution with --si-debug-isa "
+      "forces a single host thread. The default is 1.");
+
   // Option --si-debug-scheduler
   command_line->RegisterString(
       "--si-debug-scheduler <file>", scheduler_debug_file,
@@ -353,6 +377,12 @@ void Emulator::RegisterOptions() {
 void Emulator::ProcessOptions() {
   isa_debug.setPath(isa_debug_file);
   scheduler_debug.setPath(scheduler_debug_file);
+
+  // Host threads
+  if (num_host_threads < 1)
+    throw Error(misc::fmt("Invalid number of host threads for option "
+                          "--si-emu-threads (%d)",
+                          num_host_threads));
 }
 
 NDRange* Emulator::addNDRange(int kernel_id) {
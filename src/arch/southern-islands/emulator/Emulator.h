@@ -23,14 +23,18 @@
 #include <iostream>
 #include <list>
 #include <memory>
+#include <pthread.h>
+#include <vector>
 
 #include <arch/common/Emulator.h>
 #include <arch/southern-islands/disassembler/Argument.h>
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
+#include <lib/cpp/HostThreadPool.h>
 #include <memory/Memory.h>
 
 #include "NDRange.h"
+#include "Wavefront.h"
 #include "WorkGroup.h"
 #include "WorkItem.h"
 
@@ -92,6 +96,9 @@ class Emulator : public comm::Emulator {
   // Maximum number of instructions
   static long long max_instructions;
 
+  // Number of host threads executing work-groups in parallel
+  static int num_host_threads;
+
   //
   // Class members
   //
@@ -117,6 +124,39 @@ class Emulator : public comm::Emulator {
   // Number of ndranges currently running
   int ndranges_running = 0;
 
+  //
+  // Parallel emulation
+  //
+
+  // Host threads executing work-groups, created the first time
+  // work-groups are executed in parallel
+  std::unique_ptr<misc::HostThreadPool> host_thread_pool;
+
+  // Batch of work-groups executed by the host threads, in the order in
+  // which they were scheduled
+  std::vector<WorkGroup*> batch_work_groups;
+
+  // Mutex serializing global memory accesses while host threads are
+  // active
+  pthread_mutex_t global_memory_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+  // Flag set while work-groups are executed by multiple host threads
+  bool parallel = false;
+
+  // Schedule a batch of waiting work-groups of the given ND-range and
+  // execute them on multiple host threads
+  void RunParallel(NDRange* ndrange);
+
+  // Add the pending instruction counts of the wavefronts of a work-group
+  // that ran on a host thread to the emulator statistics
+  void AddWorkGroupStatistics(WorkGroup* work_group);
+
+  // Create the host threads
+  void StartHostThreads();
+
+  // Make host threads finish and wait for them
+  void StopHostThreads();
+
  public:
   //
   // Statistics
@@ -194,6 +234,17 @@ class Emulator : public comm::Emulator {
   /// Simulator to determine if the max has been reached.
   static long long getMaxInstructions() { return max_instructions; }
 
+  /// Return the number of host threads executing work-groups in
+  /// parallel, as configured by the user
+  static int getNumHostThreads() { return num_host_threads; }
+
+  /// Set the number of host threads executing work-groups in parallel,
+  /// overriding option '--si-emu-threads'. An emulator instance that
+  /// already created its host threads keeps them.
+  static void setNumHostThreads(int num_host_threads) {
+    Emulator::num_host_threads = num_host_threads;
+  }
+
   //
   // Class members
   //
@@ -201,6 +252,31 @@ class Emulator : public comm::Emulator {
   /// Constructor
   Emulator();
 
+  /// Destructor
+  ~Emulator();
+
+  /// Set whether work-groups are executed by multiple host threads, in
+  /// which case global memory accesses are serialized
+  void setParallel(bool parallel) { this->parallel = parallel; }
+
+  /// Lock of the mutex serializing global memory accesses, held during
+  /// the lifetime of the object. Locking has no effect when work-groups
+  /// are executed by a single host thread.
+  class GlobalMemoryLock {
+    Emulator* emulator;
+
+   public:
+    GlobalMemoryLock(Emulator* emulator) : emulator(emulator) {
+      if (emulator->parallel)
+        pthread_mutex_lock(&emulator->global_memory_mutex);
+    }
+
+    ~GlobalMemoryLock() {
+      if (emulator->parallel)
+        pthread_mutex_unlock(&emulator->global_memory_mutex);
+    }
+  };
+
   /// Return the number of allocated ND-ranges
   int getNumNDRanges() const { return ndranges.size(); }
 
@@ -230,6 +306,9 @@ class Emulator : public comm::Emulator {
   /// Run one iteration of the emulation loop
   bool Run() override;
 
+  /// Execute a work-group functionally until all its wavefronts finish
+  static void RunWorkGroup(WorkGroup* work_group);
+
   /// Dump emulator state
   void Dump(std::ostream& os = std::cout) const;
 
@@ -300,6 +379,20 @@ class Emulator : public comm::Emulator {
   /// Increment export_inst_count
   void incExportInstCount() { num_export_instructions++; }
 
+  /// Add the instruction counts of a wavefront to the statistics and reset
+  /// them
+  void AddInstructionCounts(Wavefront::InstructionCounts* counts) {
+    num_instructions += counts->instructions;
+    num_scalar_memory_instructions += counts->scalar_memory_instructions;
+    num_scalar_alu_instructions += counts->scalar_alu_instructions;
+    num_branch_instructions += counts->branch_instructions;
+    num_vector_memory_instructions += counts->vector_memory_instructions;
+    num_vector_alu_instructions += counts->vector_alu_instructions;
+    num_lds_instructions += counts->lds_instructions;
+    num_export_instructions += counts->export_instructions;
+    *counts = Wavefront::InstructionCounts();
+  }
+
   /// Dump the statistics summary
   void DumpSummary(std::ostream& os) const;
 
@@ -0,0 +1,91 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2012  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cassert>
+
+#include "Emulator.h"
+#include "NDRange.h"
+#include "Wavefront.h"
+#include "WorkGroup.h"
+
+namespace SI {
+
+void Emulator::RunParallel(NDRange* ndrange) {
+  // Create host threads the first time
+  if (!host_thread_pool) StartHostThreads();
+
+  // Move a batch of waiting work-groups to the running work-group list
+  batch_work_groups.clear();
+  while (!ndrange->isWaitingWorkGroupsEmpty() &&
+         (int)batch_work_groups.size() < host_thread_pool->getBatchSize()) {
+    long work_group_id = ndrange->GetWaitingWorkGroup();
+    WorkGroup* work_group = ndrange->ScheduleWorkGroup(work_group_id);
+    work_group->setHostThread(true);
+    batch_work_groups.push_back(work_group);
+  }
+
+  // If there's no work groups to run, go to next nd-range
+  if (batch_work_groups.empty()) return;
+
+  // Execute the batch
+  host_thread_pool->Run(batch_work_groups.size(), [this](int index) {
+    RunWorkGroup(batch_work_groups[index]);
+  });
+
+  // Add up statistics and remove finished work-groups in the order in which
+  // they were scheduled, so that results do not depend on how work-groups
+  // were distributed among host threads.
+  for (WorkGroup* work_group : batch_work_groups) {
+    AddWorkGroupStatistics(work_group);
+    ndrange->RemoveWorkGroup(work_group);
+  }
+  batch_work_groups.clear();
+
+  // If a context has been suspended while waiting for the ndrange
+  // check if it can be woken up.
+  ndrange->WakeupContext();
+}
+
+void Emulator::AddWorkGroupStatistics(WorkGroup* work_group) {
+  for (auto it = work_group->getWavefrontsBegin(),
+            e = work_group->getWavefrontsEnd();
+       it != e; ++it)
+    AddInstructionCounts((*it)->getPendingInstructionCounts());
+}
+
+void Emulator::StartHostThreads() {
+  // Create host threads
+  assert(!host_thread_pool);
+  host_thread_pool = misc::new_unique<misc::HostThreadPool>(num_host_threads);
+
+  // Global memory accesses are locked from now on
+  parallel = true;
+}
+
+void Emulator::StopHostThreads() {
+  // Host threads not created
+  if (!host_thread_pool) return;
+
+  // Make host threads finish
+  parallel = false;
+  host_thread_pool = nullptr;
+}
+
+}  // namespace SI
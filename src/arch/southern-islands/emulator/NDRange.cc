@@ -18,7 +18,6 @@
  */
 
 #include <arch/southern-islands/disassembler/Argument.h>
-#include <arch/southern-islands/driver/Driver.h>
 #include <arch/southern-islands/driver/Kernel.h>
 #include <src/lib/cpp/Misc.h>
 
@@ -60,10 +59,9 @@ NDRange::NDRange(int kernel_id) {
   // Assign ID
   id = emulator->getNewNDRangeID();
 
-  // Set kernel ID
+  // Set kernel ID. The kernel name is set when the ND-range is
+  // initialized from the kernel.
   this->kernel_id = kernel_id;
-  auto kernel = Driver::getInstance()->getKernelById(kernel_id);
-  this->kernel_name = kernel->getName();
 
   // Initialize instruction memor - FIXME to be removed if allocated
   // statically.
@@ -127,9 +125,31 @@ void NDRange::SetupInstructionMemory(const char* buf, unsigned size,
   // Save a copy of buffer in NDRange
   instruction_buffer = misc::new_unique_array<char>(size);
   instruction_memory->Read(pc, size, instruction_buffer.get());
+
+  // Decode instructions. The kernel binary can contain trailing data or
+  // encodings that the disassembler does not support. Decoding stops at
+  // the first of them, leaving its entry and the rest empty so that they
+  // are decoded when executed, if ever.
+  instructions.clear();
+  instructions.resize((size + 3) / 4);
+  unsigned offset = 0;
+  while (offset < size) {
+    auto instruction = misc::new_unique<Instruction>();
+    try {
+      instruction->Decode(instruction_buffer.get() + offset, pc + offset);
+    } catch (misc::Exception&) {
+      break;
+    }
+    unsigned inst_size = instruction->getSize();
+    instructions[offset / 4] = std::move(instruction);
+    offset += inst_size;
+  }
 }
 
 void NDRange::InitializeFromKernel(Kernel* kernel) {
+  // Kernel name
+  kernel_name = kernel->getName();
+
   // Get SI encoding dictionary
   BinaryDictEntry* si_enc = kernel->getKernelBinaryFile()->GetSIDictEntry();
 
@@ -24,9 +24,11 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <arch/common/Context.h>
 #include <arch/southern-islands/disassembler/Binary.h>
+#include <arch/southern-islands/disassembler/Instruction.h>
 #include <memory/Memory.h>
 #include <memory/Mmu.h>
 
@@ -132,6 +134,11 @@ class NDRange {
   unsigned instruction_address = 0;
   unsigned instruction_buffer_size = 0;
 
+  // Instructions decoded once from the instruction buffer and shared by
+  // all wavefronts, indexed by their offset in the buffer divided by 4.
+  // Entries for offsets where no instruction starts are null.
+  std::vector<std::unique_ptr<Instruction>> instructions;
+
   // Local memory top to assign to local arguments.
   // Initially it is equal to the size of local variables in
   // kernel function.
@@ -181,6 +188,9 @@ class NDRange {
   // Associated memory address space
   mem::Mmu::Space* address_space = nullptr;
 
+  // Associated address space for instruction fetches
+  mem::Mmu::Space* instruction_space = nullptr;
+
   /// Constructor
   NDRange(int kernel_id);
 
@@ -312,6 +322,14 @@ class NDRange {
   /// Get size of instruction buffer
   unsigned getInstructionBufferSize() const { return instruction_buffer_size; }
 
+  /// Return the pre-decoded instruction starting at address \a pc of the
+  /// instruction memory, or null if no instruction was decoded there.
+  Instruction* getInstruction(unsigned pc) const {
+    unsigned offset = pc - instruction_address;
+    if (offset % 4 || offset / 4 >= instructions.size()) return nullptr;
+    return instructions[offset / 4].get();
+  }
+
   /// Get user element object
   BinaryUserElement* getUserElement(int idx) {
     assert(idx >= 0 && idx <= BinaryMaxUserElements);
@@ -137,7 +137,6 @@ void Wavefront::Execute() {
   NDRange* ndrange = work_group->getNDRange();
   Emulator* emulator = ndrange->getEmulator();
   WorkItem* work_item = NULL;
-  this->instruction = misc::new_unique<Instruction>();
 
   // Reset instruction flags
   vector_memory_write = 0;
@@ -154,27 +153,23 @@ void Wavefront::Execute() {
   // Make sure the program has not finished yet
   assert(!finished);
 
-  // Grab the instruction at PC and update the pointer
-
   // Make sure the program counter is not outside the instruction memory
   unsigned total_inst_buffer_size = ndrange->getInstructionBufferSize();
   assert(total_inst_buffer_size > pc);
 
-  // Find out the remaining size of the instruction memory
-  unsigned remaining_inst_buffer_size = total_inst_buffer_size - pc;
-
-  // Create a buffer based on the remaining instruction memory
-  auto inst_buffer = misc::new_unique_array<char>(remaining_inst_buffer_size);
-  ndrange->getInstructionMemory()->Read(pc, remaining_inst_buffer_size,
-                                        inst_buffer.get());
-
-  // Decode the next instruction in the instruction memory
-  // Note: We need to pass the whole buffer for a single instruction
-  // because we don't know the size of the next instruction yet
-  instruction->Decode(inst_buffer.get(), pc);
+  // Grab the pre-decoded instruction at PC. If the program counter does
+  // not point to the beginning of a decoded instruction, decode it now.
+  instruction = ndrange->getInstruction(pc);
+  if (!instruction) {
+    if (!own_instruction) own_instruction = misc::new_unique<Instruction>();
+    instruction = own_instruction.get();
+    instruction->Decode(ndrange->getInstructionBuffer() +
+                            (pc - ndrange->getInstructionAddress()),
+                        pc);
+  }
 
   // Update the statistics
-  emulator->incNumInstructions();
+  pending_instruction_counts.instructions++;
 
   // Extract the properties of the newest instruction
   this->inst_size = instruction->getSize();
@@ -198,12 +193,12 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incScalarAluInstCount();
+      pending_instruction_counts.scalar_alu_instructions++;
       scalar_alu_instruction_count++;
 
       // Only one work item executes the instruction
       work_item = scalar_work_item.get();
-      work_item->Execute(opcode, instruction.get());
+      work_item->Execute(opcode, instruction);
 
       // Add newlines between each instruction
       Emulator::isa_debug << "\n\n";
@@ -220,12 +215,12 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incScalarAluInstCount();
+      pending_instruction_counts.scalar_alu_instructions++;
       scalar_alu_instruction_count++;
 
       // Only one work item executes the instruction
       work_item = scalar_work_item.get();
-      work_item->Execute(opcode, instruction.get());
+      work_item->Execute(opcode, instruction);
 
       // Add newlines between each instruction
       Emulator::isa_debug << "\n\n";
@@ -243,16 +238,16 @@ void Wavefront::Execute() {
 
       // Stats
       if (bytes->sopp.op > 1 && bytes->sopp.op < 10) {
-        emulator->incBranchInstCount();
+        pending_instruction_counts.branch_instructions++;
         branch_instruction_count++;
       } else {
-        emulator->incScalarAluInstCount();
+        pending_instruction_counts.scalar_alu_instructions++;
         scalar_alu_instruction_count++;
       }
 
       // Only one work item executes the instruction
       work_item = scalar_work_item.get();
-      work_item->Execute(opcode, instruction.get());
+      work_item->Execute(opcode, instruction);
 
       // Add newlines between each instruction
       Emulator::isa_debug << "\n\n";
@@ -269,12 +264,12 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incScalarAluInstCount();
+      pending_instruction_counts.scalar_alu_instructions++;
       scalar_alu_instruction_count++;
 
       // Only one work item executes the instruction
       work_item = scalar_work_item.get();
-      work_item->Execute(opcode, instruction.get());
+      work_item->Execute(opcode, instruction);
 
       // Add newlines between each instruction
       Emulator::isa_debug << "\n\n";
@@ -291,12 +286,12 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incScalarAluInstCount();
+      pending_instruction_counts.scalar_alu_instructions++;
       scalar_alu_instruction_count++;
 
       // Only one work item executes the instruction
       work_item = scalar_work_item.get();
-      work_item->Execute(opcode, instruction.get());
+      work_item->Execute(opcode, instruction);
 
       // Add newlines between each instruction
       Emulator::isa_debug << "\n\n";
@@ -314,12 +309,12 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incScalarMemInstCount();
+      pending_instruction_counts.scalar_memory_instructions++;
       scalar_memory_instruction_count++;
 
       // Only one work item executes the instruction
       work_item = scalar_work_item.get();
-      work_item->Execute(opcode, instruction.get());
+      work_item->Execute(opcode, instruction);
 
       // Add newlines between each instruction
       Emulator::isa_debug << "\n\n";
@@ -337,14 +332,17 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incVectorAluInstCount();
+      pending_instruction_counts.vector_alu_instructions++;
       vector_alu_instruction_count++;
 
-      // Execute the instruction
-      for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
-        work_item = (*it).get();
-        if (isWorkItemActive(work_item->getIdInWavefront()))
-          work_item->Execute(opcode, instruction.get());
+      // Execute the instruction on the whole wavefront if possible, or on
+      // each active work-item otherwise
+      if (!ExecuteVectorAlu(instruction)) {
+        for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
+          work_item = (*it).get();
+          if (isWorkItemActive(work_item->getIdInWavefront()))
+            work_item->Execute(opcode, instruction);
+        }
       }
 
       // Add newlines between each instruction
@@ -362,7 +360,7 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incVectorAluInstCount();
+      pending_instruction_counts.vector_alu_instructions++;
       vector_alu_instruction_count++;
 
       // Special case: V_READFIRSTLANE_B32
@@ -374,21 +372,21 @@ void Wavefront::Execute() {
         work_item = (work_items_begin[0]).get();
         if (work_item->ReadSReg(Instruction::RegisterExec) == 0 &&
             work_item->ReadSReg(Instruction::RegisterExec + 1) == 0) {
-          work_item->Execute(opcode, instruction.get());
+          work_item->Execute(opcode, instruction);
         } else {
           for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
             work_item = (*it).get();
             if (isWorkItemActive(work_item->getIdInWavefront())) {
-              work_item->Execute(opcode, instruction.get());
+              work_item->Execute(opcode, instruction);
             }
           }
         }
-      } else {
-        // Execute the instruction
+      } else if (!ExecuteVectorAlu(instruction)) {
+        // Execute the instruction on each active work-item
         for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
           work_item = (*it).get();
           if (isWorkItemActive(work_item->getIdInWavefront())) {
-            work_item->Execute(opcode, instruction.get());
+            work_item->Execute(opcode, instruction);
           }
         }
       }
@@ -408,14 +406,17 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incVectorAluInstCount();
+      pending_instruction_counts.vector_alu_instructions++;
       vector_alu_instruction_count++;
 
-      // Execute the instruction
-      for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
-        work_item = (*it).get();
-        if (isWorkItemActive(work_item->getIdInWavefront())) {
-          work_item->Execute(opcode, instruction.get());
+      // Execute the instruction on the whole wavefront if possible, or on
+      // each active work-item otherwise
+      if (!ExecuteVectorAlu(instruction)) {
+        for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
+          work_item = (*it).get();
+          if (isWorkItemActive(work_item->getIdInWavefront())) {
+            work_item->Execute(opcode, instruction);
+          }
         }
       }
 
@@ -434,14 +435,16 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incVectorAluInstCount();
+      pending_instruction_counts.vector_alu_instructions++;
       vector_alu_instruction_count++;
 
-      // Execute the instruction
-      for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
-        work_item = (*it).get();
-        if (isWorkItemActive(work_item->getIdInWavefront())) {
-          work_item->Execute(opcode, instruction.get());
+      // Execute the instruction on the whole wavefront if possible, or on
+      // each active work-item otherwise
+      if (!ExecuteVectorAlu(instruction)) {
+        for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
+          work_item = (*it).get();
+          if (isWorkItemActive(work_item->getIdInWavefront()))
+            work_item->Execute(opcode, instruction);
         }
       }
 
@@ -460,14 +463,14 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incVectorAluInstCount();
+      pending_instruction_counts.vector_alu_instructions++;
       vector_alu_instruction_count++;
 
       // Execute the instruction
       for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
         work_item = (*it).get();
         if (isWorkItemActive(work_item->getIdInWavefront())) {
-          work_item->Execute(opcode, instruction.get());
+          work_item->Execute(opcode, instruction);
         }
       }
 
@@ -486,14 +489,14 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incVectorAluInstCount();
+      pending_instruction_counts.vector_alu_instructions++;
       vector_alu_instruction_count++;
 
       // Execute the instruction
       for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
         work_item = (*it).get();
         if (isWorkItemActive(work_item->getIdInWavefront())) {
-          work_item->Execute(opcode, instruction.get());
+          work_item->Execute(opcode, instruction);
         }
       }
 
@@ -512,7 +515,7 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incLdsInstCount();
+      pending_instruction_counts.lds_instructions++;
       lds_instruction_count++;
 
       // Record access type
@@ -529,7 +532,7 @@ void Wavefront::Execute() {
       for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
         work_item = (*it).get();
         if (isWorkItemActive(work_item->getIdInWavefront())) {
-          work_item->Execute(opcode, instruction.get());
+          work_item->Execute(opcode, instruction);
         }
       }
 
@@ -549,7 +552,7 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incVectorMemInstCount();
+      pending_instruction_counts.vector_memory_instructions++;
       vector_memory_instruction_count++;
 
       // Record access type
@@ -565,7 +568,7 @@ void Wavefront::Execute() {
       for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
         work_item = (*it).get();
         if (isWorkItemActive(work_item->getIdInWavefront())) {
-          work_item->Execute(opcode, instruction.get());
+          work_item->Execute(opcode, instruction);
         }
       }
 
@@ -584,7 +587,7 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incVectorMemInstCount();
+      pending_instruction_counts.vector_memory_instructions++;
       vector_memory_instruction_count++;
 
       // Record access type
@@ -605,7 +608,7 @@ void Wavefront::Execute() {
       for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
         work_item = (*it).get();
         if (isWorkItemActive(work_item->getIdInWavefront())) {
-          work_item->Execute(opcode, instruction.get());
+          work_item->Execute(opcode, instruction);
         }
       }
 
@@ -624,7 +627,7 @@ void Wavefront::Execute() {
       }
 
       // Stats
-      emulator->incExportInstCount();
+      pending_instruction_counts.export_instructions++;
       export_instruction_count++;
 
       // Record access type
@@ -634,7 +637,7 @@ void Wavefront::Execute() {
       for (auto it = work_items_begin, e = work_items_end; it != e; ++it) {
         work_item = (*it).get();
         if (isWorkItemActive(work_item->getIdInWavefront())) {
-          work_item->Execute(opcode, instruction.get());
+          work_item->Execute(opcode, instruction);
         }
       }
 
@@ -661,6 +664,12 @@ void Wavefront::Execute() {
       work_group->setFinished(true);
     }
   }
+
+  // Update the emulator statistics. Work-groups running on other host
+  // threads leave them alone, and the main simulation thread adds the
+  // pending instruction counts later.
+  if (!work_group->getHostThread())
+    emulator->AddInstructionCounts(&pending_instruction_counts);
 }
 
 bool Wavefront::isWorkItemActive(int id_in_wavefront) {
@@ -44,6 +44,15 @@ class WavefrontData {
 /// wavefront is composed of 64 work-items that fetch one instruction and
 /// execute it multiple times.
 class Wavefront {
+ public:
+  /// Number of work-items in a wavefront, each of them mapped to one lane
+  /// of the vector registers
+  static const int NumLanes = 64;
+
+  /// Number of vector registers
+  static const int NumVregs = 256;
+
+ private:
   // Global wavefront identifier
   int id;
 
@@ -62,10 +71,15 @@ class Wavefront {
   // next instruction to be executed.
   unsigned pc = 0;
 
-  // Current instruction
-  std::unique_ptr<Instruction> instruction;
+  // Current instruction, owned by the NDRange's table of pre-decoded
+  // instructions
+  Instruction* instruction = nullptr;
   int inst_size = 0;
 
+  // Instruction decoded by the wavefront itself, used only when the
+  // program counter does not point to a pre-decoded instruction
+  std::unique_ptr<Instruction> own_instruction;
+
   // Associated scalar work-item
   std::unique_ptr<WorkItem> scalar_work_item;
 
@@ -85,6 +99,11 @@ class Wavefront {
   // Scalar registers
   Instruction::Register sreg[256];
 
+  // Vector registers of all work-items in the wavefront, stored as an
+  // array of lanes for each register. Vector ALU instructions operate on
+  // whole rows of this array.
+  Instruction::Register vreg[NumVregs][NumLanes];
+
   // Associated wavefront pool entry
   WavefrontPoolEntry* wavefront_pool_entry = nullptr;
 
@@ -119,6 +138,26 @@ class Wavefront {
   // Number of export instructions executed
   long long export_instruction_count = 0;
 
+ public:
+  /// Number of instructions of each kind executed by a wavefront
+  struct InstructionCounts {
+    long long instructions = 0;
+    long long scalar_memory_instructions = 0;
+    long long scalar_alu_instructions = 0;
+    long long branch_instructions = 0;
+    long long vector_memory_instructions = 0;
+    long long vector_alu_instructions = 0;
+    long long lds_instructions = 0;
+    long long export_instructions = 0;
+  };
+
+ private:
+  // Instructions executed by the wavefront that have not been added to
+  // the emulator statistics yet. They are added after every instruction,
+  // unless the work-group runs on a host thread other than the main
+  // simulation thread.
+  InstructionCounts pending_instruction_counts;
+
  public:
   /// Constructor
   ///
@@ -194,6 +233,14 @@ class Wavefront {
   /// Return content in scalar register as unsigned integer
   unsigned getSregUint(int sreg_id) const;
 
+  /// Return content of vector register \a vreg_id in lane \a lane as an
+  /// unsigned integer
+  unsigned getVregUint(int vreg_id, int lane) const {
+    assert(vreg_id >= 0 && vreg_id < NumVregs);
+    assert(lane >= 0 && lane < NumLanes);
+    return vreg[vreg_id][lane].as_uint;
+  }
+
   /// Return pointer to a workitem inside this wavefront
   WorkItem* getWorkItem(int id_in_wavefront) {
     assert(id_in_wavefront >= 0 && id_in_wavefront < (int)work_item_count);
@@ -215,7 +262,7 @@ class Wavefront {
   unsigned getWorkItemCount() const { return work_item_count; }
 
   /// Get the associated instruction
-  Instruction* getInstruction() const { return instruction.get(); }
+  Instruction* getInstruction() const { return instruction; }
 
   /// Return true if work-item is active. The work-item identifier is
   /// given relative to the first work-item in the wavefront
@@ -234,6 +281,12 @@ class Wavefront {
     return vector_memory_global_coherency;
   }
 
+  /// Return the instruction counts not yet added to the emulator
+  /// statistics
+  InstructionCounts* getPendingInstructionCounts() {
+    return &pending_instruction_counts;
+  }
+
   //
   // Setters
   //
@@ -284,6 +337,13 @@ class Wavefront {
   /// Set scalar register as an unsigned int
   void setSregUint(int id, unsigned int value);
 
+  /// Set vector register \a vreg_id in lane \a lane as an unsigned integer
+  void setVregUint(int vreg_id, int lane, unsigned value) {
+    assert(vreg_id >= 0 && vreg_id < NumVregs);
+    assert(lane >= 0 && lane < NumLanes);
+    vreg[vreg_id][lane].as_uint = value;
+  }
+
   /// Set the wavefront pool entry associated with the wavefront
   void setWavefrontPoolEntry(WavefrontPoolEntry* entry) {
     wavefront_pool_entry = entry;
@@ -351,6 +411,12 @@ class Wavefront {
   /// position of the program counter
   void Execute();
 
+  /// Execute vector ALU instruction \a instruction, in the VOP1, VOP2,
+  /// VOPC, or VOP3a format, on all active lanes of the wavefront at once. Return false if the instruction has no
+  /// whole-wavefront implementation, in which case the caller must execute
+  /// it on each active work-item instead.
+  bool ExecuteVectorAlu(Instruction* instruction);
+
   /// Return an iterator to the first work-item in the wavefront. The
   /// work-items can be conveniently traversed with a loop using these
   /// iterators. This is an example of how to dump all work-items in the
@@ -374,6 +440,9 @@ class Wavefront {
   /// Return a new unique sequential identifier for a uop associated with
   /// the wavefront. This function is used by the timing simulator.
   long long getUopId() { return ++uop_id_counter; }
+
+  /// Return the number of uops created so far for the wavefront
+  long long getNumUops() const { return uop_id_counter; }
 };
 
 }  // namespace SI
@@ -0,0 +1,707 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <lib/cpp/Misc.h>
+
+#include "Emulator.h"
+#include "Wavefront.h"
+#include "WorkGroup.h"
+
+namespace SI {
+
+namespace {
+
+// Content of one vector register for all lanes of a wavefront
+typedef Instruction::Register Lanes[Wavefront::NumLanes];
+
+// Compute all lanes of 'result' by invoking 'function' with a reference to
+// each destination lane and its index. Lanes are computed regardless of the
+// execution mask, which is applied later when the result is written back.
+template <typename Function>
+inline void ComputeLanes(Lanes& result, Function function) {
+  for (int lane = 0; lane < Wavefront::NumLanes; lane++)
+    function(result[lane], lane);
+}
+
+// Return a mask with one bit per lane, set for the lanes where 'function'
+// returns true.
+template <typename Function>
+inline unsigned long long ComputeLaneMask(Function function) {
+  unsigned long long mask = 0;
+  for (int lane = 0; lane < Wavefront::NumLanes; lane++)
+    mask |= (unsigned long long)function(lane) << lane;
+  return mask;
+}
+
+// Copy the lanes of 'source' whose bit is set in 'mask' into 'destination'
+void WriteLanes(Instruction::Register* destination,
+                const Instruction::Register* source, unsigned long long mask) {
+#if defined(__AVX2__)
+  const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  for (int lane = 0; lane < Wavefront::NumLanes; lane += 8) {
+    int lane_bits = (mask >> lane) & 0xff;
+    if (!lane_bits) continue;
+    __m256i value = _mm256_loadu_si256((const __m256i*)(source + lane));
+    if (lane_bits == 0xff) {
+      _mm256_storeu_si256((__m256i*)(destination + lane), value);
+      continue;
+    }
+    __m256i select = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(lane_bits), bits), bits);
+    _mm256_maskstore_epi32((int*)(destination + lane), select, value);
+  }
+#elif defined(__SSE2__)
+  const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+  for (int lane = 0; lane < Wavefront::NumLanes; lane += 4) {
+    int lane_bits = (mask >> lane) & 0xf;
+    if (!lane_bits) continue;
+    __m128i value = _mm_loadu_si128((const __m128i*)(source + lane));
+    if (lane_bits != 0xf) {
+      __m128i select = _mm_cmpeq_epi32(
+          _mm_and_si128(_mm_set1_epi32(lane_bits), bits), bits);
+      __m128i old_value =
+          _mm_loadu_si128((const __m128i*)(destination + lane));
+      value = _mm_or_si128(_mm_and_si128(select, value),
+                           _mm_andnot_si128(select, old_value));
+    }
+    _mm_storeu_si128((__m128i*)(destination + lane), value);
+  }
+#else
+  for (int lane = 0; lane < Wavefront::NumLanes; lane++)
+    if ((mask >> lane) & 1) destination[lane] = source[lane];
+#endif
+}
+
+// Kinds of instructions with a whole-wavefront implementation
+enum VectorAluKind {
+  VectorAluInvalid = 0,
+  VectorAluMove,     // VOP1, D = S0
+  VectorAluBinary,   // VOP2, D = S0 op S1
+  VectorAluCarry,    // VOP2, D = S0 op S1, VCC = carry
+  VectorAluCompare,  // VOPC, VCC = S0 op S1
+};
+
+// Return the kind of whole-wavefront implementation for an opcode, or
+// VectorAluInvalid if the instruction must be executed per work-item.
+VectorAluKind getVectorAluKind(Instruction::Opcode opcode) {
+  switch (opcode) {
+    case Instruction::Opcode_V_MOV_B32:
+      return VectorAluMove;
+
+    case Instruction::Opcode_V_CNDMASK_B32:
+    case Instruction::Opcode_V_ADD_F32:
+    case Instruction::Opcode_V_SUB_F32:
+    case Instruction::Opcode_V_SUBREV_F32:
+    case Instruction::Opcode_V_MUL_F32:
+    case Instruction::Opcode_V_MUL_I32_I24:
+    case Instruction::Opcode_V_MIN_F32:
+    case Instruction::Opcode_V_MAX_F32:
+    case Instruction::Opcode_V_MIN_I32:
+    case Instruction::Opcode_V_MAX_I32:
+    case Instruction::Opcode_V_MIN_U32:
+    case Instruction::Opcode_V_MAX_U32:
+    case Instruction::Opcode_V_LSHRREV_B32:
+    case Instruction::Opcode_V_ASHRREV_I32:
+    case Instruction::Opcode_V_LSHL_B32:
+    case Instruction::Opcode_V_LSHLREV_B32:
+    case Instruction::Opcode_V_AND_B32:
+    case Instruction::Opcode_V_OR_B32:
+    case Instruction::Opcode_V_XOR_B32:
+    case Instruction::Opcode_V_MAC_F32:
+    case Instruction::Opcode_V_MADMK_F32:
+    case Instruction::Opcode_V_MADAK_F32:
+      return VectorAluBinary;
+
+    case Instruction::Opcode_V_ADD_I32:
+    case Instruction::Opcode_V_SUB_I32:
+    case Instruction::Opcode_V_SUBREV_I32:
+      return VectorAluCarry;
+
+    case Instruction::Opcode_V_CMP_LT_F32:
+    case Instruction::Opcode_V_CMP_GT_F32:
+    case Instruction::Opcode_V_CMP_GE_F32:
+    case Instruction::Opcode_V_CMP_NGT_F32:
+    case Instruction::Opcode_V_CMP_NEQ_F32:
+    case Instruction::Opcode_V_CMP_LT_I32:
+    case Instruction::Opcode_V_CMP_EQ_I32:
+    case Instruction::Opcode_V_CMP_LE_I32:
+    case Instruction::Opcode_V_CMP_GT_I32:
+    case Instruction::Opcode_V_CMP_NE_I32:
+    case Instruction::Opcode_V_CMP_GE_I32:
+    case Instruction::Opcode_V_CMP_LT_U32:
+    case Instruction::Opcode_V_CMP_LE_U32:
+    case Instruction::Opcode_V_CMP_GT_U32:
+    case Instruction::Opcode_V_CMP_NE_U32:
+    case Instruction::Opcode_V_CMP_GE_U32:
+      return VectorAluCompare;
+
+    default:
+      return VectorAluInvalid;
+  }
+}
+
+// Return the VOP1, VOP2, or VOPC opcode that a VOP3a opcode encodes in 64
+// bits. Other opcodes are returned unchanged.
+Instruction::Opcode getVectorAluOpcode(Instruction::Opcode opcode) {
+  switch (opcode) {
+    case Instruction::Opcode_V_CNDMASK_B32_VOP3a:
+      return Instruction::Opcode_V_CNDMASK_B32;
+    case Instruction::Opcode_V_ADD_F32_VOP3a:
+      return Instruction::Opcode_V_ADD_F32;
+    case Instruction::Opcode_V_SUBREV_F32_VOP3a:
+      return Instruction::Opcode_V_SUBREV_F32;
+    case Instruction::Opcode_V_MUL_F32_VOP3a:
+      return Instruction::Opcode_V_MUL_F32;
+    case Instruction::Opcode_V_MUL_I32_I24_VOP3a:
+      return Instruction::Opcode_V_MUL_I32_I24;
+    case Instruction::Opcode_V_MAX_F32_VOP3a:
+      return Instruction::Opcode_V_MAX_F32;
+    case Instruction::Opcode_V_CMP_LT_F32_VOP3a:
+      return Instruction::Opcode_V_CMP_LT_F32;
+    case Instruction::Opcode_V_CMP_GT_F32_VOP3a:
+      return Instruction::Opcode_V_CMP_GT_F32;
+    case Instruction::Opcode_V_CMP_GE_F32_VOP3a:
+      return Instruction::Opcode_V_CMP_GE_F32;
+    case Instruction::Opcode_V_CMP_NEQ_F32_VOP3a:
+      return Instruction::Opcode_V_CMP_NEQ_F32;
+    case Instruction::Opcode_V_CMP_LT_I32_VOP3a:
+      return Instruction::Opcode_V_CMP_LT_I32;
+    case Instruction::Opcode_V_CMP_EQ_I32_VOP3a:
+      return Instruction::Opcode_V_CMP_EQ_I32;
+    case Instruction::Opcode_V_CMP_LE_I32_VOP3a:
+      return Instruction::Opcode_V_CMP_LE_I32;
+    case Instruction::Opcode_V_CMP_GT_I32_VOP3a:
+      return Instruction::Opcode_V_CMP_GT_I32;
+    case Instruction::Opcode_V_CMP_NE_I32_VOP3a:
+      return Instruction::Opcode_V_CMP_NE_I32;
+    case Instruction::Opcode_V_CMP_GE_I32_VOP3a:
+      return Instruction::Opcode_V_CMP_GE_I32;
+    case Instruction::Opcode_V_CMP_LT_U32_VOP3a:
+      return Instruction::Opcode_V_CMP_LT_U32;
+    case Instruction::Opcode_V_CMP_LE_U32_VOP3a:
+      return Instruction::Opcode_V_CMP_LE_U32;
+    case Instruction::Opcode_V_CMP_GT_U32_VOP3a:
+      return Instruction::Opcode_V_CMP_GT_U32;
+    case Instruction::Opcode_V_CMP_GE_U32_VOP3a:
+      return Instruction::Opcode_V_CMP_GE_U32;
+    default:
+      return opcode;
+  }
+}
+
+// Kinds of source operand modifiers of the VOP3a encoding
+enum ModifierKind {
+  ModifierInvalid = 0,
+  ModifierNone,     // No modifiers allowed
+  ModifierFloat,    // Absolute value and negation of floats
+  ModifierInteger,  // Absolute value and negation of signed integers
+};
+
+// Return how an instruction applies the VOP3a source modifiers
+ModifierKind getModifierKind(Instruction::Opcode opcode) {
+  switch (opcode) {
+    case Instruction::Opcode_V_CNDMASK_B32:
+    case Instruction::Opcode_V_ADD_F32:
+    case Instruction::Opcode_V_SUBREV_F32:
+    case Instruction::Opcode_V_MUL_F32:
+    case Instruction::Opcode_V_MAX_F32:
+    case Instruction::Opcode_V_CMP_LT_F32:
+    case Instruction::Opcode_V_CMP_GT_F32:
+    case Instruction::Opcode_V_CMP_GE_F32:
+    case Instruction::Opcode_V_CMP_NEQ_F32:
+      return ModifierFloat;
+
+    case Instruction::Opcode_V_CMP_LT_I32:
+    case Instruction::Opcode_V_CMP_EQ_I32:
+    case Instruction::Opcode_V_CMP_LE_I32:
+    case Instruction::Opcode_V_CMP_GT_I32:
+    case Instruction::Opcode_V_CMP_NE_I32:
+    case Instruction::Opcode_V_CMP_GE_I32:
+      return ModifierInteger;
+
+    default:
+      return ModifierNone;
+  }
+}
+
+// Copy all lanes of 'source' into 'result' applying the absolute value
+// and negation modifiers, in this order, as the work-items do
+void ApplyModifiers(Lanes& result, const Instruction::Register* source,
+                    ModifierKind kind, bool abs_modifier, bool neg_modifier) {
+  ComputeLanes(result, [&](Instruction::Register& d, int i) {
+    d = source[i];
+    if (kind == ModifierFloat) {
+      if (abs_modifier) d.as_float = fabsf(d.as_float);
+      if (neg_modifier) d.as_float = -d.as_float;
+    } else {
+      if (abs_modifier) d.as_int = abs(d.as_int);
+      if (neg_modifier) d.as_int = -d.as_int;
+    }
+  });
+}
+
+}  // namespace
+
+bool Wavefront::ExecuteVectorAlu(Instruction* instruction) {
+  // Debug information is dumped by each work-item
+  if (Emulator::isa_debug) return false;
+
+  // Check if there is a whole-wavefront implementation. VOP3a forms are
+  // computed as their VOP1, VOP2, or VOPC counterparts.
+  bool vop3 = instruction->getFormat() == Instruction::FormatVOP3a;
+  Instruction::Opcode opcode = getVectorAluOpcode(instruction->getOpcode());
+  VectorAluKind kind = getVectorAluKind(opcode);
+  if (kind == VectorAluInvalid) return false;
+
+  // Fields 'src0', 'vsrc1', and 'vdst' are at the same position in the
+  // VOP1, VOP2, and VOPC formats, as far as they are present. Operand S1
+  // of these formats is always a vector register.
+  Instruction::BytesVOP2& bytes = instruction->getBytes()->vop2;
+  Instruction::BytesVOP3A& bytes_vop3 = instruction->getBytes()->vop3a;
+  int src0 = vop3 ? bytes_vop3.src0 : bytes.src0;
+  int src1 = vop3 ? bytes_vop3.src1 : bytes.vsrc1 + 256;
+  int vdst = vop3 ? bytes_vop3.vdst : bytes.vdst;
+  unsigned literal = vop3 ? 0 : bytes.lit_cnst;
+
+  // Destination of the carry-out or compare mask. In the VOP3a encoding,
+  // compares write the scalar register pair given in 'vdst'.
+  int sdst = Instruction::RegisterVcc;
+  if (vop3 && kind == VectorAluCompare) sdst = vdst;
+  bool write_sdst = kind == VectorAluCarry || kind == VectorAluCompare;
+
+  // Lane mask read by V_CNDMASK_B32. In the VOP3a encoding, it is the
+  // scalar register pair given in 'src2'.
+  int mask_src = Instruction::RegisterVcc;
+  if (vop3 && opcode == Instruction::Opcode_V_CNDMASK_B32)
+    mask_src = bytes_vop3.src2;
+
+  // The VOP3a encoding has no literal constants. Output modifiers, and
+  // source modifiers of instructions that do not take them, are left to
+  // the work-items.
+  ModifierKind modifier_kind = getModifierKind(opcode);
+  if (vop3) {
+    if (src0 == 0xff || src1 == 0xff) return false;
+    if (mask_src >= (int)Instruction::RegisterVccz) return false;
+    if (bytes_vop3.clamp || bytes_vop3.omod) return false;
+    if ((bytes_vop3.abs | bytes_vop3.neg) & 4) return false;
+    if (modifier_kind == ModifierNone && (bytes_vop3.abs || bytes_vop3.neg))
+      return false;
+    if (opcode == Instruction::Opcode_V_CNDMASK_B32 && bytes_vop3.abs)
+      return false;
+  }
+
+  // Instructions with a 32-bit constant K take operand S0 from a register
+  bool constant_k = opcode == Instruction::Opcode_V_MADMK_F32 ||
+                    opcode == Instruction::Opcode_V_MADAK_F32;
+  if (constant_k && src0 == 0xff) return false;
+
+  // Shift amounts given as literal constants must be lower than 32
+  if ((opcode == Instruction::Opcode_V_LSHRREV_B32 ||
+       opcode == Instruction::Opcode_V_LSHLREV_B32) &&
+      src0 == 0xff && literal >= 32)
+    return false;
+
+  // Work-items update the mask destination one at a time, so an
+  // instruction writing it must not read it.
+  if (write_sdst) {
+    int sdst_zero = -1;
+    if (sdst == (int)Instruction::RegisterVcc)
+      sdst_zero = Instruction::RegisterVccz;
+    else if (sdst == (int)Instruction::RegisterExec)
+      sdst_zero = Instruction::RegisterExecz;
+    for (int src : {src0, src1})
+      if (src == sdst || src == sdst + 1 || src == sdst_zero) return false;
+  }
+
+  // Lanes of existing and active work-items
+  unsigned long long exec =
+      (unsigned long long)sreg[Instruction::RegisterExec + 1].as_uint << 32 |
+      sreg[Instruction::RegisterExec].as_uint;
+  if (work_item_count < NumLanes) exec &= (1ull << work_item_count) - 1;
+  if (!exec) return true;
+  int num_active = __builtin_popcountll(exec);
+
+  // Source operands. Vector registers are read in place, while scalar
+  // registers and constants are broadcast to all lanes.
+  long long sreg_reads = 0;
+  long long vreg_reads = 0;
+  Lanes broadcast[2];
+  auto read_operand = [&](int src, Lanes& lanes) {
+    if (src >= 256) {
+      vreg_reads += num_active;
+      return (const Instruction::Register*)vreg[src - 256];
+    }
+    Instruction::Register value;
+    if (src == 0xff) {
+      value.as_uint = literal;
+    } else {
+      value.as_uint = getSregUint(src);
+      sreg_reads += num_active - 1;
+    }
+    for (int lane = 0; lane < NumLanes; lane++) lanes[lane] = value;
+    return (const Instruction::Register*)lanes;
+  };
+  const Instruction::Register* s0 = read_operand(src0, broadcast[0]);
+  const Instruction::Register* s1 = s0;
+  if (kind != VectorAluMove) s1 = read_operand(src1, broadcast[1]);
+
+  // Source modifiers
+  Lanes modified[2];
+  if (vop3 && (bytes_vop3.abs & 1 || bytes_vop3.neg & 1)) {
+    ApplyModifiers(modified[0], s0, modifier_kind, bytes_vop3.abs & 1,
+                   bytes_vop3.neg & 1);
+    s0 = modified[0];
+  }
+  if (vop3 && (bytes_vop3.abs & 2 || bytes_vop3.neg & 2)) {
+    ApplyModifiers(modified[1], s1, modifier_kind, bytes_vop3.abs & 2,
+                   bytes_vop3.neg & 2);
+    s1 = modified[1];
+  }
+
+  // Literal constant K
+  Instruction::Register k;
+  k.as_uint = literal;
+
+  // Compute result
+  Lanes result;
+  unsigned long long mask = 0;
+  switch (opcode) {
+    // D.u = S0.u
+    case Instruction::Opcode_V_MOV_B32:
+      ComputeLanes(result,
+                   [&](Instruction::Register& d, int i) { d = s0[i]; });
+      break;
+
+    // D.u = VCC[i] ? S1.u : S0.u
+    case Instruction::Opcode_V_CNDMASK_B32: {
+      unsigned long long vcc =
+          (unsigned long long)sreg[mask_src + 1].as_uint << 32 |
+          sreg[mask_src].as_uint;
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d = (vcc >> i) & 1 ? s1[i] : s0[i];
+      });
+      sreg_reads += num_active;
+      break;
+    }
+
+    // D.f = S0.f + S1.f
+    case Instruction::Opcode_V_ADD_F32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_float = s0[i].as_float + s1[i].as_float;
+      });
+      break;
+
+    // D.f = S0.f - S1.f
+    case Instruction::Opcode_V_SUB_F32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_float = s0[i].as_float - s1[i].as_float;
+      });
+      break;
+
+    // D.f = S1.f - S0.f
+    case Instruction::Opcode_V_SUBREV_F32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_float = s1[i].as_float - s0[i].as_float;
+      });
+      break;
+
+    // D.f = S0.f * S1.f
+    case Instruction::Opcode_V_MUL_F32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_float = s0[i].as_float * s1[i].as_float;
+      });
+      break;
+
+    // D.i = S0.i[23:0] * S1.i[23:0]
+    case Instruction::Opcode_V_MUL_I32_I24:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = misc::SignExtend32(s0[i].as_uint, 24) *
+                    misc::SignExtend32(s1[i].as_uint, 24);
+      });
+      break;
+
+    // D.f = min(S0.f, S1.f)
+    case Instruction::Opcode_V_MIN_F32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d = s0[i].as_float < s1[i].as_float ? s0[i] : s1[i];
+      });
+      break;
+
+    // D.f = max(S0.f, S1.f)
+    case Instruction::Opcode_V_MAX_F32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d = s0[i].as_float > s1[i].as_float ? s0[i] : s1[i];
+      });
+      break;
+
+    // D.i = min(S0.i, S1.i)
+    case Instruction::Opcode_V_MIN_I32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d = s0[i].as_int < s1[i].as_int ? s0[i] : s1[i];
+      });
+      break;
+
+    // D.i = max(S0.i, S1.i)
+    case Instruction::Opcode_V_MAX_I32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d = s0[i].as_int > s1[i].as_int ? s0[i] : s1[i];
+      });
+      break;
+
+    // D.u = min(S0.u, S1.u)
+    case Instruction::Opcode_V_MIN_U32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d = s0[i].as_uint < s1[i].as_uint ? s0[i] : s1[i];
+      });
+      break;
+
+    // D.u = max(S0.u, S1.u)
+    case Instruction::Opcode_V_MAX_U32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d = s0[i].as_uint > s1[i].as_uint ? s0[i] : s1[i];
+      });
+      break;
+
+    // D.u = S1.u >> S0.u[4:0]
+    case Instruction::Opcode_V_LSHRREV_B32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s1[i].as_uint >> (s0[i].as_uint & 0x1f);
+      });
+      break;
+
+    // D.i = S1.i >> S0.i[4:0]
+    case Instruction::Opcode_V_ASHRREV_I32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_int = s1[i].as_int >> (s0[i].as_uint & 0x1f);
+      });
+      break;
+
+    // D.u = S0.u << S1.u[4:0]
+    case Instruction::Opcode_V_LSHL_B32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s0[i].as_uint << (s1[i].as_uint & 0x1f);
+      });
+      break;
+
+    // D.u = S1.u << S0.u[4:0]
+    case Instruction::Opcode_V_LSHLREV_B32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s1[i].as_uint << (s0[i].as_uint & 0x1f);
+      });
+      break;
+
+    // D.u = S0.u & S1.u
+    case Instruction::Opcode_V_AND_B32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s0[i].as_uint & s1[i].as_uint;
+      });
+      break;
+
+    // D.u = S0.u | S1.u
+    case Instruction::Opcode_V_OR_B32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s0[i].as_uint | s1[i].as_uint;
+      });
+      break;
+
+    // D.u = S0.u ^ S1.u
+    case Instruction::Opcode_V_XOR_B32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s0[i].as_uint ^ s1[i].as_uint;
+      });
+      break;
+
+    // D.f = S0.f * S1.f + D.f
+    case Instruction::Opcode_V_MAC_F32: {
+      const Instruction::Register* d0 = vreg[vdst];
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_float = s0[i].as_float * s1[i].as_float + d0[i].as_float;
+      });
+      vreg_reads += num_active;
+      break;
+    }
+
+    // D.f = S0.f * K + S1.f
+    case Instruction::Opcode_V_MADMK_F32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_float = s0[i].as_float * k.as_float + s1[i].as_float;
+      });
+      break;
+
+    // D.f = S0.f * S1.f + K
+    case Instruction::Opcode_V_MADAK_F32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_float = s0[i].as_float * s1[i].as_float + k.as_float;
+      });
+      break;
+
+    // D.u = S0.u + S1.u, VCC = carry-out
+    case Instruction::Opcode_V_ADD_I32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s0[i].as_uint + s1[i].as_uint;
+      });
+      mask = ComputeLaneMask([&](int i) {
+        return !!(((long long)s0[i].as_int + (long long)s1[i].as_int) >> 32);
+      });
+      break;
+
+    // D.u = S0.u - S1.u, VCC = carry-out
+    case Instruction::Opcode_V_SUB_I32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s0[i].as_uint - s1[i].as_uint;
+      });
+      mask = ComputeLaneMask(
+          [&](int i) { return s1[i].as_int > s0[i].as_int; });
+      break;
+
+    // D.u = S1.u - S0.u, VCC = carry-out
+    case Instruction::Opcode_V_SUBREV_I32:
+      ComputeLanes(result, [&](Instruction::Register& d, int i) {
+        d.as_uint = s1[i].as_uint - s0[i].as_uint;
+      });
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_int > s1[i].as_int; });
+      break;
+
+    // VCC = S0 op S1
+    case Instruction::Opcode_V_CMP_LT_F32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_float < s1[i].as_float; });
+      break;
+
+    case Instruction::Opcode_V_CMP_GT_F32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_float > s1[i].as_float; });
+      break;
+
+    case Instruction::Opcode_V_CMP_GE_F32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_float >= s1[i].as_float; });
+      break;
+
+    case Instruction::Opcode_V_CMP_NGT_F32:
+      mask = ComputeLaneMask(
+          [&](int i) { return !(s0[i].as_float > s1[i].as_float); });
+      break;
+
+    case Instruction::Opcode_V_CMP_NEQ_F32:
+      mask = ComputeLaneMask(
+          [&](int i) { return !(s0[i].as_float == s1[i].as_float); });
+      break;
+
+    case Instruction::Opcode_V_CMP_LT_I32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_int < s1[i].as_int; });
+      break;
+
+    case Instruction::Opcode_V_CMP_EQ_I32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_int == s1[i].as_int; });
+      break;
+
+    case Instruction::Opcode_V_CMP_LE_I32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_int <= s1[i].as_int; });
+      break;
+
+    case Instruction::Opcode_V_CMP_GT_I32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_int > s1[i].as_int; });
+      break;
+
+    case Instruction::Opcode_V_CMP_NE_I32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_int != s1[i].as_int; });
+      break;
+
+    case Instruction::Opcode_V_CMP_GE_I32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_int >= s1[i].as_int; });
+      break;
+
+    case Instruction::Opcode_V_CMP_LT_U32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_uint < s1[i].as_uint; });
+      break;
+
+    case Instruction::Opcode_V_CMP_LE_U32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_uint <= s1[i].as_uint; });
+      break;
+
+    case Instruction::Opcode_V_CMP_GT_U32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_uint > s1[i].as_uint; });
+      break;
+
+    case Instruction::Opcode_V_CMP_NE_U32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_uint != s1[i].as_uint; });
+      break;
+
+    case Instruction::Opcode_V_CMP_GE_U32:
+      mask = ComputeLaneMask(
+          [&](int i) { return s0[i].as_uint >= s1[i].as_uint; });
+      break;
+
+    default:
+      throw misc::Panic(misc::fmt("%s: Invalid opcode", __FUNCTION__));
+  }
+
+  // Write destination register in active lanes
+  long long sreg_writes = 0;
+  long long vreg_writes = 0;
+  if (kind != VectorAluCompare) {
+    WriteLanes(vreg[vdst], result, exec);
+    vreg_writes += num_active;
+  }
+
+  // Write bits of the mask destination for active lanes
+  if (write_sdst) {
+    unsigned long long value =
+        (unsigned long long)sreg[sdst + 1].as_uint << 32 | sreg[sdst].as_uint;
+    value = (value & ~exec) | (mask & exec);
+    sreg[sdst].as_uint = value;
+    sreg[sdst + 1].as_uint = value >> 32;
+    if (sdst == (int)Instruction::RegisterVcc)
+      sreg[Instruction::RegisterVccz].as_uint = !value;
+    else if (sdst == (int)Instruction::RegisterExec)
+      sreg[Instruction::RegisterExecz].as_uint = !value;
+    sreg_reads += num_active;
+    sreg_writes += num_active;
+  }
+
+  // Statistics, counting the register accesses of each work-item
+  work_group->incSregReadCount(sreg_reads);
+  work_group->incSregWriteCount(sreg_writes);
+  work_group->incVregReadCount(vreg_reads);
+  work_group->incVregWriteCount(vreg_writes);
+  return true;
+}
+
+}  // namespace SI
@@ -97,6 +97,11 @@ class WorkGroup {
   // Number of vectorr registers being written to
   long long vreg_write_count = 0;
 
+  // Flag indicating that the work-group runs on a host thread other than
+  // the main simulation thread. Its wavefronts then do not update the
+  // emulator statistics, which are added up once the work-group finishes.
+  bool host_thread = false;
+
  public:
   /// Constructor
   ///
@@ -203,6 +208,10 @@ class WorkGroup {
   /// Get finished flag
   bool getFinished() { return finished; }
 
+  /// Return whether the work-group runs on a host thread other than the
+  /// main simulation thread
+  bool getHostThread() const { return host_thread; }
+
   /// Get a pointer to the local memory of the work group
   mem::Memory* getLocalMemory() { return &local_memory; }
 
@@ -219,17 +228,17 @@ class WorkGroup {
   /// Increase wavefronts_completed_emu counter
   void incWavefrontsCompletedTiming() { wavefronts_completed_timing++; }
 
-  /// Increase scalar register read counter
-  void incSregReadCount() { sreg_read_count++; }
+  /// Increase scalar register read counter by \a count
+  void incSregReadCount(long long count = 1) { sreg_read_count += count; }
 
-  /// Increase scalar register write counter
-  void incSregWriteCount() { sreg_write_count++; }
+  /// Increase scalar register write counter by \a count
+  void incSregWriteCount(long long count = 1) { sreg_write_count += count; }
 
-  /// Increase vector register read counter
-  void incVregReadCount() { vreg_read_count++; }
+  /// Increase vector register read counter by \a count
+  void incVregReadCount(long long count = 1) { vreg_read_count += count; }
 
-  /// Increase vector register write counter
-  void incVregWriteCount() { vreg_write_count++; }
+  /// Increase vector register write counter by \a count
+  void incVregWriteCount(long long count = 1) { vreg_write_count += count; }
 
   /// Set wavefront_at_barrier counter
   void setWavefrontsAtBarrier(unsigned counter) {
@@ -246,6 +255,10 @@ class WorkGroup {
   /// Set finished flag
   void setFinished(bool flag) { finished = flag; }
 
+  /// Set whether the work-group runs on a host thread other than the main
+  /// simulation thread
+  void setHostThread(bool host_thread) { this->host_thread = host_thread; }
+
   /// Get the number of wavefronts
   int getNumWavefronts() const { return wavefronts.size(); }
 
@@ -19,6 +19,8 @@
 
 #include <lib/cpp/Misc.h>
 
+#include "Emulator.h"
+#include "NDRange.h"
 #include "Wavefront.h"
 #include "WorkGroup.h"
 #include "WorkItem.h"
@@ -238,19 +240,14 @@ void WorkItem::WriteSReg(int sreg, unsigned value) {
 }
 
 unsigned WorkItem::ReadVReg(int vreg) {
-  assert(vreg >= 0);
-  assert(vreg < 256);
-
   // Statistics
   work_group->incVregReadCount();
 
-  return this->vreg[vreg].as_uint;
+  return wavefront->getVregUint(vreg, id_in_wavefront);
 }
 
 void WorkItem::WriteVReg(int vreg, unsigned value) {
-  assert(vreg >= 0);
-  assert(vreg < 256);
-  this->vreg[vreg].as_uint = value;
+  wavefront->setVregUint(vreg, id_in_wavefront, value);
 
   // Statistics
   work_group->incVregWriteCount();
@@ -309,4 +306,15 @@ void WorkItem::ReadMemPtr(int sreg, WorkItem::MemoryPointer& mem_ptr) {
   ((unsigned*)&mem_ptr)[1] = wavefront->getSregUint(sreg + 1);
 }
 
+void WorkItem::ReadGlobalMemory(unsigned address, unsigned size, char* buffer) {
+  Emulator::GlobalMemoryLock lock(work_group->getNDRange()->getEmulator());
+  global_mem->Read(address, size, buffer);
+}
+
+void WorkItem::WriteGlobalMemory(unsigned address, unsigned size,
+                                 const char* buffer) {
+  Emulator::GlobalMemoryLock lock(work_group->getNDRange()->getEmulator());
+  global_mem->Write(address, size, buffer);
+}
+
 }  // namespace SI
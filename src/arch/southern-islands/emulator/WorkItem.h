@@ -178,9 +178,6 @@ class WorkItem {
   // Local memory
   mem::Memory* lds = nullptr;
 
-  // Vector registers
-  Instruction::Register vreg[256];
-
 // Emulation of ISA. This code expands to one function per ISA
 // instruction. For example: ISA_s_mov_b32_Impl(Instruction *inst)
 #define DEFINST(_name, _fmt_str, _fmt, _opcode, _size, _flags) \
@@ -355,7 +352,9 @@ class WorkItem {
   ///
   void WriteSReg(int sreg, unsigned value);
 
-  /// Get value of a vector register
+  /// Get value of a vector register. Vector registers are stored in the
+  /// wavefront, in the lane given by the work-item identifier within the
+  /// wavefront.
   ///
   /// \param vreg Vector register identifier
   ///
@@ -404,6 +403,14 @@ class WorkItem {
   /// \param mem_ptr Reference of a memory pointer descriptor
   ///
   void ReadMemPtr(int sreg, MemoryPointer& memory_pointer);
+
+  /// Read from global memory. The access is serialized with those of
+  /// work-groups running on other host threads.
+  void ReadGlobalMemory(unsigned address, unsigned size, char* buffer);
+
+  /// Write into global memory. The access is serialized with those of
+  /// work-groups running on other host threads.
+  void WriteGlobalMemory(unsigned address, unsigned size, const char* buffer);
 };
 
 }  // namespace SI
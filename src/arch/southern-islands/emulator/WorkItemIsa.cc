@@ -70,7 +70,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORD_Impl(Instruction *instruction) {
 
   // Read value from global memory
   Instruction::Register value;
-  global_mem->Read(addr, 4, (char *)&value);
+  ReadGlobalMemory(addr, 4, (char *)&value);
 
   // Store the data in the destination register
   WriteSReg(INST.sdst, value.as_uint);
@@ -104,7 +104,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX2_Impl(Instruction *instruction) {
   Instruction::Register value[2];
   for (int i = 0; i < 2; i++) {
     // Read value from global memory
-    global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+    ReadGlobalMemory(addr + i * 4, 4, (char *)&value[i]);
     // Store the data in the destination register
     WriteSReg(INST.sdst + i, value[i].as_uint);
   }
@@ -142,7 +142,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX4_Impl(Instruction *instruction) {
   Instruction::Register value[4];
   for (int i = 0; i < 4; i++) {
     // Read value from global memory
-    global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+    ReadGlobalMemory(addr + i * 4, 4, (char *)&value[i]);
     // Store the data in the destination register
     WriteSReg(INST.sdst + i, value[i].as_uint);
   }
@@ -180,7 +180,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX8_Impl(Instruction *instruction) {
   Instruction::Register value[8];
   for (int i = 0; i < 8; i++) {
     // Read value from global memory
-    global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+    ReadGlobalMemory(addr + i * 4, 4, (char *)&value[i]);
     // Store the data in the destination register
     WriteSReg(INST.sdst + i, value[i].as_uint);
   }
@@ -218,7 +218,7 @@ void WorkItem::ISA_S_BUFFER_LOAD_DWORDX16_Impl(Instruction *instruction) {
   Instruction::Register value[16];
   for (int i = 0; i < 16; i++) {
     // Read value from global memory
-    global_mem->Read(addr + i * 4, 4, (char *)&value[i]);
+    ReadGlobalMemory(addr + i * 4, 4, (char *)&value[i]);
     // Store the data in the destination register
     WriteSReg(INST.sdst + i, value[i].as_uint);
   }
@@ -261,7 +261,7 @@ void WorkItem::ISA_S_LOAD_DWORDX2_Impl(Instruction *instruction) {
   Instruction::Register value[2];
   for (int i = 0; i < 2; i++) {
     // Read value from global memory
-    global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+    ReadGlobalMemory(m_addr + i * 4, 4, (char *)&value[i]);
     // Store the data in the destination register
     WriteSReg(INST.sdst + i, value[i].as_uint);
   }
@@ -303,7 +303,7 @@ void WorkItem::ISA_S_LOAD_DWORDX4_Impl(Instruction *instruction) {
   Instruction::Register value[4];
   for (int i = 0; i < 4; i++) {
     // Read value from global memory
-    global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+    ReadGlobalMemory(m_addr + i * 4, 4, (char *)&value[i]);
     // Store the data in the destination register
     WriteSReg(INST.sdst + i, value[i].as_uint);
   }
@@ -346,7 +346,7 @@ void WorkItem::ISA_S_LOAD_DWORDX8_Impl(Instruction *instruction) {
   Instruction::Register value[8];
   for (int i = 0; i < 8; i++) {
     // Read value from global memory
-    global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+    ReadGlobalMemory(m_addr + i * 4, 4, (char *)&value[i]);
     // Store the data in the destination register
     WriteSReg(INST.sdst + i, value[i].as_uint);
   }
@@ -389,7 +389,7 @@ void WorkItem::ISA_S_LOAD_DWORDX16_Impl(Instruction *instruction) {
   Instruction::Register value[16];
   for (int i = 0; i < 16; i++) {
     // Read value from global memory
-    global_mem->Read(m_addr + i * 4, 4, (char *)&value[i]);
+    ReadGlobalMemory(m_addr + i * 4, 4, (char *)&value[i]);
     // Store the data in the destination register
     WriteSReg(INST.sdst + i, value[i].as_uint);
   }
@@ -6854,7 +6854,7 @@ void WorkItem::ISA_BUFFER_LOAD_SBYTE_Impl(Instruction *instruction) {
   unsigned addr = base + mem_offset + inst_offset + off_vgpr +
                   stride * (idx_vgpr + id_in_wavefront);
 
-  global_mem->Read(addr, bytes_to_read, (char *)&value);
+  ReadGlobalMemory(addr, bytes_to_read, (char *)&value);
 
   // Sign extend
   value.as_int = (int)value.as_byte[0];
@@ -6915,7 +6915,7 @@ void WorkItem::ISA_BUFFER_LOAD_USHORT_Impl(Instruction *instruction) {
   unsigned addr = base + mem_offset + inst_offset + off_vgpr +
                   stride * (idx_vgpr + id_in_wavefront);
 
-  global_mem->Read(addr, bytes_to_read, (char *)&value);
+  ReadGlobalMemory(addr, bytes_to_read, (char *)&value);
 
   WriteVReg(INST.vdata, value.as_uint);
 
@@ -6973,7 +6973,7 @@ void WorkItem::ISA_BUFFER_LOAD_SSHORT_Impl(Instruction *instruction) {
   unsigned addr = base + mem_offset + inst_offset + off_vgpr +
                   stride * (idx_vgpr + id_in_wavefront);
 
-  global_mem->Read(addr, bytes_to_read, (char *)&value);
+  ReadGlobalMemory(addr, bytes_to_read, (char *)&value);
 
   value.as_int = (int)value.as_byte[0];
 
@@ -7033,7 +7033,7 @@ void WorkItem::ISA_BUFFER_LOAD_DWORD_Impl(Instruction *instruction) {
   unsigned addr = base + mem_offset + inst_offset + off_vgpr +
                   stride * (idx_vgpr + id_in_wavefront);
 
-  global_mem->Read(addr, bytes_to_read, (char *)&value);
+  ReadGlobalMemory(addr, bytes_to_read, (char *)&value);
 
   // Sign extend
   value.as_int = (int)value.as_byte[0];
@@ -7099,7 +7099,7 @@ void WorkItem::ISA_BUFFER_STORE_BYTE_Impl(Instruction *instruction) {
 
   value.as_int = ReadVReg(INST.vdata);
 
-  global_mem->Write(addr, bytes_to_write, (char *)&value);
+  WriteGlobalMemory(addr, bytes_to_write, (char *)&value);
 
   // Sign extend
   // value.as_int = (int) value.as_byte[0];
@@ -7171,7 +7171,7 @@ void WorkItem::ISA_BUFFER_STORE_DWORD_Impl(Instruction *instruction) {
 
   value.as_int = ReadVReg(INST.vdata);
 
-  global_mem->Write(addr, bytes_to_write, (char *)&value);
+  WriteGlobalMemory(addr, bytes_to_write, (char *)&value);
 
   // Record last memory access for the detailed simulator.
   global_memory_access_address = addr;
@@ -7246,16 +7246,18 @@ void WorkItem::ISA_BUFFER_ATOMIC_ADD_Impl(Instruction *instruction) {
   unsigned addr = base + mem_offset + inst_offset + off_vgpr +
                   stride * (idx_vgpr + id_in_wavefront);
 
-  // Read existing value from global memory
-
-  global_mem->Read(addr, bytes_to_read, prev_value.as_byte);
-
   // Read value to add to existing value from a register
   value.as_int = ReadVReg(INST.vdata);
 
-  // Compute and store the updated value
-  value.as_int += prev_value.as_int;
-  global_mem->Write(addr, bytes_to_write, (char *)&value);
+  // Read existing value from global memory, compute and store the updated
+  // value. The lock is held across the read-modify-write, so that atomics
+  // from work-groups running on other host threads are serialized.
+  {
+    Emulator::GlobalMemoryLock lock(work_group->getNDRange()->getEmulator());
+    global_mem->Read(addr, bytes_to_read, prev_value.as_byte);
+    value.as_int += prev_value.as_int;
+    global_mem->Write(addr, bytes_to_write, (char *)&value);
+  }
 
   // If glc bit set, return the previous value in a register
   if (INST.glc) {
@@ -7333,7 +7335,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_X_Impl(Instruction *instruction) {
   unsigned addr = base + mem_offset + inst_offset + off_vgpr +
                   stride * (idx_vgpr + 0 /*work_item->id_in_wavefront*/);
 
-  global_mem->Read(addr, bytes_to_read, (char *)&value);
+  ReadGlobalMemory(addr, bytes_to_read, (char *)&value);
 
   WriteVReg(INST.vdata, value.as_uint);
 
@@ -7403,7 +7405,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_XY_Impl(Instruction *instruction) {
                   stride * (idx_vgpr + 0 /*work_item->id_in_wavefront*/);
 
   for (i = 0; i < 2; i++) {
-    global_mem->Read(addr + 4 * i, 4, (char *)&value);
+    ReadGlobalMemory(addr + 4 * i, 4, (char *)&value);
 
     WriteVReg(INST.vdata + i, value.as_uint);
 
@@ -7480,7 +7482,7 @@ void WorkItem::ISA_TBUFFER_LOAD_FORMAT_XYZW_Impl(Instruction *instruction) {
                   stride * (idx_vgpr + id_in_wavefront);
 
   for (i = 0; i < 4; i++) {
-    global_mem->Read(addr + 4 * i, 4, (char *)&value);
+    ReadGlobalMemory(addr + 4 * i, 4, (char *)&value);
 
     WriteVReg(INST.vdata + i, value.as_uint);
 
@@ -7544,7 +7546,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_X_Impl(Instruction *instruction) {
 
   value.as_uint = ReadVReg(INST.vdata);
 
-  global_mem->Write(addr, bytes_to_write, (char *)&value);
+  WriteGlobalMemory(addr, bytes_to_write, (char *)&value);
 
   // Record last memory access for the detailed simulator.
   global_memory_access_address = addr;
@@ -7605,7 +7607,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_XY_Impl(Instruction *instruction) {
   for (unsigned i = 0; i < 2; i++) {
     value.as_uint = ReadVReg(INST.vdata + i);
 
-    global_mem->Write(addr + 4 * i, 4, (char *)&value);
+    WriteGlobalMemory(addr + 4 * i, 4, (char *)&value);
 
     // TODO Print value based on type
     if (Emulator::isa_debug) {
@@ -7669,7 +7671,7 @@ void WorkItem::ISA_TBUFFER_STORE_FORMAT_XYZW_Impl(Instruction *instruction) {
   for (unsigned i = 0; i < 4; i++) {
     value.as_uint = ReadVReg(INST.vdata + i);
 
-    global_mem->Write(addr + 4 * i, 4, (char *)&value);
+    WriteGlobalMemory(addr + 4 * i, 4, (char *)&value);
 
     // TODO Print value based on type
     if (Emulator::isa_debug)
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
 
@@ -105,10 +107,31 @@ bool BranchUnit::isValidUop(Uop* uop) const {
          instruction->getBytes()->sopp.op < 10;
 }
 
+long long BranchUnit::getWakeupCycle(long long cycle, int*& witness) const {
+  // Instructions in more than one stage can advance in the next cycle
+  int num_busy_stages = !issue_buffer.empty() + !decode_buffer.empty() +
+                        !read_buffer.empty() + !exec_buffer.empty() +
+                        !write_buffer.empty();
+  if (!num_busy_stages) return NoWakeup;
+  if (num_busy_stages > 1) return cycle + 1;
+
+  // Otherwise, the oldest instruction of the only busy stage is the first
+  // one to advance
+  if (!write_buffer.empty())
+    return std::max(cycle + 1, write_buffer.front()->write_ready);
+  if (!exec_buffer.empty())
+    return std::max(cycle + 1, exec_buffer.front()->execute_ready);
+  if (!read_buffer.empty())
+    return std::max(cycle + 1, read_buffer.front()->read_ready);
+  if (!decode_buffer.empty())
+    return std::max(cycle + 1, decode_buffer.front()->decode_ready);
+  return std::max(cycle + 1, issue_buffer.front()->issue_ready);
+}
+
 void BranchUnit::Issue(std::unique_ptr<Uop> uop) {
   // One more instruction of this kind
   ComputeUnit* compute_unit = getComputeUnit();
-  compute_unit->stats.num_lds_insts_++;
+  compute_unit->stats.Increment(CounterBranchInstructions);
 
   // Issue it
   ExecutionUnit::Issue(std::move(uop));
@@ -118,9 +141,8 @@ void BranchUnit::Issue(std::unique_ptr<Uop> uop) {
 }
 
 void BranchUnit::Complete() {
-  // Get compute unit and GPU objects
+  // Get compute unit
   ComputeUnit* compute_unit = getComputeUnit();
-  Gpu* gpu = compute_unit->getGpu();
 
   // Sanity check the write buffer
   assert((int)write_buffer.size() <= write_latency * width);
@@ -142,7 +164,7 @@ void BranchUnit::Complete() {
     uop->cycle_length = uop->cycle_finish - uop->cycle_start;
 
     // Trace for m2svis
-    Timing::m2svis << uop->getLifeCycleInCSV("branch");
+    if (Timing::m2svis) Timing::m2svis << uop->getLifeCycleInCSV("branch");
 
     // Update statistics
     if (overview_file_)
@@ -172,7 +194,7 @@ void BranchUnit::Complete() {
 
     // Statistics
     num_instructions++;
-    gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+    compute_unit->CompleteUop();
 
     // Update info if statistics enables
     if (Timing::statistics_level >= 2) {
@@ -252,8 +274,7 @@ void BranchUnit::Write() {
       WriteStatus = Stall;
 
       // Per interval stats
-      if (overview_file_) overview_stats_.num_stall_write_++;
-      if (interval_file_) interval_stats_.num_stall_write_++;
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -291,8 +312,7 @@ void BranchUnit::Write() {
       // Update pipeline stage status
       WriteStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_write_++;
-      if (interval_file_) interval_stats_.num_stall_write_++;
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -380,8 +400,7 @@ void BranchUnit::Execute() {
       // Update pipeline stage status
       ExecutionStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_execution_++;
-      if (interval_file_) interval_stats_.num_stall_execution_++;
+      Count(CounterStallExecution);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -417,8 +436,7 @@ void BranchUnit::Execute() {
       // Update pipeline stage status
       ExecutionStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_execution_++;
-      if (interval_file_) interval_stats_.num_stall_execution_++;
+      Count(CounterStallExecution);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -506,8 +524,7 @@ void BranchUnit::Read() {
       // Update pipeline stage status
       ReadStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_read_++;
-      if (interval_file_) interval_stats_.num_stall_read_++;
+      Count(CounterStallRead);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -545,8 +562,7 @@ void BranchUnit::Read() {
       // Update pipeline stage status
       ReadStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_read_++;
-      if (interval_file_) interval_stats_.num_stall_read_++;
+      Count(CounterStallRead);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -634,8 +650,7 @@ void BranchUnit::Decode() {
       // Update pipeline stage status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -673,8 +688,7 @@ void BranchUnit::Decode() {
       // Update pipeline stage status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -120,6 +120,10 @@ class BranchUnit : public ExecutionUnit {
   /// Return whether the given uop is a branch instruction.
   bool isValidUop(Uop* uop) const override;
 
+  /// Return the first cycle after \a cycle in which the branch unit can
+  /// change state.
+  long long getWakeupCycle(long long cycle, int*& witness) const override;
+
   /// Issue the given instruction into the branch unit.
   void Issue(std::unique_ptr<Uop> uop) override;
 
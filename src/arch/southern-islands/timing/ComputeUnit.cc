@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/southern-islands/disassembler/Instruction.h>
 #include <arch/southern-islands/emulator/Emulator.h>
 #include <arch/southern-islands/emulator/NDRange.h>
@@ -40,6 +42,9 @@ int ComputeUnit::fetch_buffer_size = 10;
 int ComputeUnit::issue_latency = 1;
 int ComputeUnit::issue_width = 5;
 int ComputeUnit::max_instructions_issued_per_type = 1;
+ComputeUnit::IssueKind ComputeUnit::issue_kind = IssueKindRoundRobin;
+bool ComputeUnit::rotate_fetch = false;
+bool ComputeUnit::skip_idle_cycles = true;
 int ComputeUnit::lds_size = 65536;
 int ComputeUnit::lds_alloc_size = 64;
 int ComputeUnit::lds_latency = 2;
@@ -50,6 +55,10 @@ int ComputeUnit::num_scalar_registers = 2048;
 int ComputeUnit::num_vector_registers = 65536;
 long long ComputeUnit::cycle_map_first_wg = 0;
 
+misc::StringMap ComputeUnit::issue_kind_map = {
+    {"RoundRobin", IssueKindRoundRobin},
+    {"FetchPressure", IssueKindFetchPressure}};
+
 ComputeUnit::ComputeUnit(int index, Gpu* gpu)
     : gpu(gpu),
       index(index),
@@ -64,6 +73,7 @@ ComputeUnit::ComputeUnit(int index, Gpu* gpu)
 
   // Create wavefront pools, and SIMD units
   wavefront_pools.resize(num_wavefront_pools);
+  wavefront_pool_resources.resize(num_wavefront_pools);
   fetch_buffers.resize(num_wavefront_pools);
   simd_units.resize(num_wavefront_pools);
   for (int i = 0; i < num_wavefront_pools; i++) {
@@ -208,6 +218,7 @@ void ComputeUnit::Issue(FetchBuffer* fetch_buffer) {
 
     // Update UOP info for m2svis
     uop->cycle_issue_stall++;
+    stats.Increment(CounterStallIssue);
 
     if (Timing::statistics_level >= 2) {
       if (branch_unit.isValidUop(uop)) {
@@ -271,6 +282,59 @@ void ComputeUnit::Issue(FetchBuffer* fetch_buffer) {
   }
 }
 
+void InstructionCachePort::Arbitrate() {
+  owner = -1;
+  for (int i = 1; i <= num_sharers; i++) {
+    int sharer = (last_owner + i + num_sharers) % num_sharers;
+    if (requests[sharer]) {
+      owner = sharer;
+      last_owner = sharer;
+      break;
+    }
+  }
+  std::fill(requests.begin(), requests.end(), false);
+}
+
+bool ComputeUnit::FetchInstructionBlock(
+    WavefrontPoolEntry* wavefront_pool_entry) {
+  // Block containing the next instruction
+  Wavefront* wavefront = wavefront_pool_entry->getWavefront();
+  unsigned block_size = instruction_cache->getBlockSize();
+  unsigned block = wavefront->getPC() & ~(block_size - 1);
+
+  // Block already requested into the instruction buffer
+  if (wavefront_pool_entry->instruction_block_valid &&
+      wavefront_pool_entry->instruction_block == block) {
+    if (wavefront_pool_entry->instruction_fetch_witness) return false;
+    stats.Increment(CounterInstructionBufferHits);
+    return true;
+  }
+
+  // The port of a shared instruction cache is owned by one compute unit in
+  // each cycle, and serves one block per cycle. Otherwise, the port is
+  // requested for a later cycle.
+  long long cycle = timing->getCycle();
+  if (cycle == last_instruction_cache_cycle ||
+      (instruction_cache_port &&
+       !instruction_cache_port->isOwner(instruction_cache_sharer))) {
+    if (instruction_cache_port)
+      instruction_cache_port->Request(instruction_cache_sharer);
+    return false;
+  }
+
+  // Request the block into the instruction buffer
+  assert(!wavefront_pool_entry->instruction_fetch_witness);
+  wavefront_pool_entry->instruction_block_valid = true;
+  wavefront_pool_entry->instruction_block = block;
+  wavefront_pool_entry->instruction_fetch_witness--;
+  last_instruction_cache_cycle = cycle;
+  stats.Increment(CounterInstructionCacheAccesses);
+  Access(instruction_cache, mem::Module::AccessType::AccessLoad,
+         wavefront->getWorkGroup()->getNDRange()->instruction_space, block,
+         &wavefront_pool_entry->instruction_fetch_witness);
+  return false;
+}
+
 void ComputeUnit::Fetch(FetchBuffer* fetch_buffer,
                         WavefrontPool* wavefront_pool) {
   // Checks
@@ -357,9 +421,14 @@ void ComputeUnit::Fetch(FetchBuffer* fetch_buffer,
     assert(fetch_buffer->getSize() <= fetch_buffer_size);
     if (fetch_buffer->getSize() == fetch_buffer_size) continue;
 
+    // Stall until the instruction is in the instruction buffer
+    if (instruction_cache && !FetchInstructionBlock(wavefront_pool_entry))
+      continue;
+
     // Emulate instructions
     wavefront->Execute();
     wavefront_pool_entry->ready = false;
+    if (parallel) buffered_executed_wavefronts.push_back(wavefront);
 
     // Create uop
     auto uop = misc::new_unique<Uop>(
@@ -438,10 +507,12 @@ void ComputeUnit::Fetch(FetchBuffer* fetch_buffer,
       }
     }
 
-    // Access instruction cache. Record the time when the
-    // instruction will have been fetched, as per the latency
-    // of the instruction memory.
-    uop->fetch_ready = timing->getCycle() + fetch_latency;
+    // Record the time when the instruction will have been fetched. With
+    // an instruction cache, the instruction was already read into the
+    // instruction buffer, otherwise use the latency of the instruction
+    // memory.
+    uop->fetch_ready =
+        timing->getCycle() + (instruction_cache ? 1 : fetch_latency);
 
     // Update UOP info for m2svis
     uop->cycle_start = timing->getCycle();
@@ -453,7 +524,7 @@ void ComputeUnit::Fetch(FetchBuffer* fetch_buffer,
     fetch_buffer->addUop(std::move(uop));
 
     instructions_processed++;
-    stats.num_total_insts_++;
+    stats.Increment(CounterInstructions);
   }
 }
 
@@ -487,8 +558,8 @@ void ComputeUnit::SetInitialPC(WorkGroup* work_group) {
   if (pattern) pattern_val = atoi(pattern);
 
   /* Calculate number of active wavefront/workgroups per CU */
-  int active_wg_per_cu = gpu->getWorkGroupsPerComputeUnit();
-  int active_wf_per_cu = gpu->getWavefrontsPerComputeUnit();
+  int active_wg_per_cu = gpu->getWorkGroupsPerComputeUnit(ndrange);
+  int active_wf_per_cu = gpu->getWavefrontsPerComputeUnit(ndrange);
 
   if (getIndex() == 0)
     Emulator::scheduler_debug
@@ -557,20 +628,62 @@ void ComputeUnit::SetInitialPC(WorkGroup* work_group) {
   }
 }
 
+int ComputeUnit::getMaxWorkGroups() {
+  int max_work_groups = num_wavefront_pools * max_work_groups_per_wavefront_pool;
+  if (Gpu::max_work_groups_per_compute_unit)
+    max_work_groups =
+        std::min(max_work_groups, Gpu::max_work_groups_per_compute_unit);
+  return max_work_groups;
+}
+
+int ComputeUnit::FindWorkGroupSlot(const WorkGroupResources& resources) const {
+  // Slots are assigned to wavefront pools in round-robin order. Take the
+  // first free slot whose wavefront pool can fit the work-group.
+  for (int slot = 0; slot < getMaxWorkGroups(); slot++) {
+    // Slot in use
+    if (slot < (int)work_groups.size() && work_groups[slot]) continue;
+
+    // Wavefront pool out of resources
+    const WorkGroupResources& used =
+        wavefront_pool_resources[slot % num_wavefront_pools];
+    if (used.work_groups + resources.work_groups >
+            max_work_groups_per_wavefront_pool ||
+        used.wavefronts + resources.wavefronts >
+            max_wavefronts_per_wavefront_pool ||
+        used.vector_registers + resources.vector_registers >
+            num_vector_registers ||
+        used.scalar_registers + resources.scalar_registers >
+            num_scalar_registers ||
+        used.local_memory + resources.local_memory > lds_size)
+      continue;
+
+    // Found
+    return slot;
+  }
+
+  // No slot available
+  return -1;
+}
+
+bool ComputeUnit::canMapWorkGroup(NDRange* ndrange) const {
+  const WorkGroupResources* resources = gpu->getWorkGroupResources(ndrange);
+  assert(resources);
+  return FindWorkGroupSlot(*resources) >= 0;
+}
+
 void ComputeUnit::MapWorkGroup(WorkGroup* work_group) {
   // Checks
   assert(work_group);
-  assert((int)work_groups.size() <= gpu->getWorkGroupsPerComputeUnit());
   assert(!work_group->id_in_compute_unit);
 
   // Find an available slot
-  while (work_group->id_in_compute_unit < gpu->getWorkGroupsPerComputeUnit() &&
-         (work_group->id_in_compute_unit < (int)work_groups.size()) &&
-         (work_groups[work_group->id_in_compute_unit] != nullptr))
-    work_group->id_in_compute_unit++;
+  const WorkGroupResources* resources =
+      gpu->getWorkGroupResources(work_group->getNDRange());
+  assert(resources);
+  work_group->id_in_compute_unit = FindWorkGroupSlot(*resources);
 
   // Checks
-  assert(work_group->id_in_compute_unit < gpu->getWorkGroupsPerComputeUnit());
+  assert(work_group->id_in_compute_unit >= 0);
 
   // Save timing simulator
   timing = Timing::getInstance();
@@ -581,11 +694,28 @@ void ComputeUnit::MapWorkGroup(WorkGroup* work_group) {
       "found in compute unit %d\n",
       timing->getCycle(), work_group->id_in_compute_unit, index);
 
-  // Insert work group into the list
+  // Insert work group into the list, waking up the compute unit
   AddWorkGroup(work_group);
+  wakeup_cycle = 0;
+
+  // Allocate resources in the wavefront pool
+  WorkGroupResources& used =
+      wavefront_pool_resources[work_group->id_in_compute_unit %
+                               num_wavefront_pools];
+  used.work_groups += resources->work_groups;
+  used.wavefronts += resources->wavefronts;
+  used.vector_registers += resources->vector_registers;
+  used.scalar_registers += resources->scalar_registers;
+  used.local_memory += resources->local_memory;
+  work_group_resources[work_group->id_in_compute_unit] = *resources;
+
+  // Wavefronts of a compute unit simulated on a host thread leave the
+  // emulator statistics to the main simulation thread
+  work_group->setHostThread(parallel);
 
   // Record the cycle when the first WG is mapped
   if (cycle_map_first_wg == 0) cycle_map_first_wg = timing->getCycle();
+  gpu->getSampler()->MapWorkGroup(work_group);
 
   // Update info if statistics enables
   if (Timing::statistics_level >= 1) {
@@ -594,10 +724,10 @@ void ComputeUnit::MapWorkGroup(WorkGroup* work_group) {
   }
 
   // Checks
-  assert((int)work_groups.size() <= gpu->getWorkGroupsPerComputeUnit());
+  assert((int)work_groups.size() <= getMaxWorkGroups());
 
   // If compute unit is not full, add it back to the available list
-  if ((int)work_groups.size() < gpu->getWorkGroupsPerComputeUnit()) {
+  if (gpu->canMapWorkGroup(this)) {
     if (!in_available_compute_units) gpu->InsertInAvailableComputeUnits(this);
   }
 
@@ -639,7 +769,7 @@ void ComputeUnit::MapWorkGroup(WorkGroup* work_group) {
   SetInitialPC(work_group);
 
   // Increment count of mapped work groups
-  stats.num_mapped_work_groups_++;
+  stats.Increment(CounterWorkGroups);
 
   // Debug info
   Emulator::scheduler_debug << misc::fmt(
@@ -667,18 +797,19 @@ void ComputeUnit::AddWorkGroup(WorkGroup* work_group) {
   // Add a work group only if the id in compute unit is the id for a new
   // work group in the compute unit's list
   int index = work_group->id_in_compute_unit;
-  if (index == (int)work_groups.size() &&
-      (int)work_groups.size() < gpu->getWorkGroupsPerComputeUnit()) {
-    work_groups.push_back(work_group);
-  } else {
-    // Make sure an entry is emptied up
-    assert(work_groups[index] == nullptr);
-    assert(work_groups.size() <= (unsigned)gpu->getWorkGroupsPerComputeUnit());
-
-    // Set the new work group to the empty entry
-    work_groups[index] = work_group;
+  assert(index < getMaxWorkGroups());
+  if (index >= (int)work_groups.size()) {
+    work_groups.resize(index + 1);
+    work_group_resources.resize(index + 1);
   }
 
+  // Make sure an entry is emptied up
+  assert(work_groups[index] == nullptr);
+
+  // Set the new work group to the empty entry
+  work_groups[index] = work_group;
+  num_work_groups++;
+
   // Checks
   assert(work_group->id_in_compute_unit == index);
 
@@ -705,6 +836,20 @@ void ComputeUnit::RemoveWorkGroup(WorkGroup* work_group) {
   // Unmap work group from the compute unit
   assert(work_group->compute_unit_work_groups_iterator != work_groups.end());
   work_groups[work_group->id_in_compute_unit] = nullptr;
+  num_work_groups--;
+
+  // Release the resources of the work-group in its wavefront pool
+  WorkGroupResources& resources =
+      work_group_resources[work_group->id_in_compute_unit];
+  WorkGroupResources& used =
+      wavefront_pool_resources[work_group->id_in_compute_unit %
+                               num_wavefront_pools];
+  used.work_groups -= resources.work_groups;
+  used.wavefronts -= resources.wavefronts;
+  used.vector_registers -= resources.vector_registers;
+  used.scalar_registers -= resources.scalar_registers;
+  used.local_memory -= resources.local_memory;
+  resources = WorkGroupResources();
 }
 
 void ComputeUnit::Reset() {
@@ -720,21 +865,34 @@ void ComputeUnit::Reset() {
 
   // Reset the workgroups size to 0
   work_groups.resize(0);
+  work_group_resources.resize(0);
+  num_work_groups = 0;
+  wakeup_cycle = 0;
+  for (auto& resources : wavefront_pool_resources)
+    resources = WorkGroupResources();
 }
 
 void ComputeUnit::UnmapWorkGroup(WorkGroup* work_group) {
+  // Unmap at the end of the cycle if simulated on a host thread
+  if (parallel) {
+    buffered_unmapped_work_groups.push_back(work_group);
+    return;
+  }
+
   // Get Gpu object
   Gpu* gpu = getGpu();
 
   // Add work group register access statistics to compute unit
-  stats.num_sreg_reads_ += work_group->getSregReadCount();
-  stats.num_sreg_writes_ += work_group->getSregWriteCount();
-  stats.num_vreg_reads_ += work_group->getVregReadCount();
-  stats.num_vreg_writes_ += work_group->getVregWriteCount();
+  stats.Increment(CounterScalarRegReads, work_group->getSregReadCount());
+  stats.Increment(CounterScalarRegWrites, work_group->getSregWriteCount());
+  stats.Increment(CounterVectorRegReads, work_group->getVregReadCount());
+  stats.Increment(CounterVectorRegWrites, work_group->getVregWriteCount());
 
   // Remove the work group from the list
   assert(work_groups.size() > 0);
   RemoveWorkGroup(work_group);
+  gpu->getSampler()->UnmapWorkGroup(work_group);
+  wakeup_cycle = 0;
 
   // Update info if statistics enables
   if (Timing::statistics_level >= 1) {
@@ -757,7 +915,7 @@ void ComputeUnit::UnmapWorkGroup(WorkGroup* work_group) {
   // If compute unit is not already in the available list, place
   // it there. The vector list of work groups does not shrink,
   // when we unmap a workgroup.
-  assert((int)work_groups.size() <= gpu->getWorkGroupsPerComputeUnit());
+  assert((int)work_groups.size() <= getMaxWorkGroups());
   if (!in_available_compute_units) gpu->InsertInAvailableComputeUnits(this);
 
   // Trace
@@ -769,6 +927,70 @@ void ComputeUnit::UnmapWorkGroup(WorkGroup* work_group) {
   ndrange->RemoveWorkGroup(work_group);
 }
 
+void ComputeUnit::Access(mem::Module* module, mem::Module::AccessType type,
+                         mem::Mmu::Space* space, unsigned address,
+                         int* witness) {
+  // Buffer the access if simulated on a host thread. Address translation
+  // is delayed as well, since it may allocate physical pages.
+  if (parallel) {
+    buffered_memory_accesses.push_back({module, type, space, address, witness});
+    return;
+  }
+
+  // Translate virtual address to physical address
+  if (space) address = gpu->getMmu()->TranslateVirtualAddress(space, address);
+
+  // Start access
+  module->Access(type, address, witness);
+}
+
+void ComputeUnit::CompleteUop() {
+  if (parallel)
+    buffered_uop_completed = true;
+  else
+    gpu->last_complete_cycle = timing->getCycle();
+}
+
+void ComputeUnit::CompleteWavefront() {
+  if (parallel)
+    buffered_completed_wavefronts++;
+  else
+    Gpu::count_completed_wavefronts++;
+}
+
+void ComputeUnit::setParallel(bool parallel) {
+  this->parallel = parallel;
+  for (WorkGroup* work_group : work_groups)
+    if (work_group) work_group->setHostThread(parallel);
+}
+
+void ComputeUnit::SubmitBufferedRequests() {
+  // Emulator statistics
+  Emulator* emulator = Emulator::getInstance();
+  for (Wavefront* wavefront : buffered_executed_wavefronts)
+    emulator->AddInstructionCounts(wavefront->getPendingInstructionCounts());
+  buffered_executed_wavefronts.clear();
+
+  // GPU statistics
+  if (buffered_uop_completed) gpu->last_complete_cycle = timing->getCycle();
+  Gpu::count_completed_wavefronts += buffered_completed_wavefronts;
+  buffered_uop_completed = false;
+  buffered_completed_wavefronts = 0;
+
+  // Memory accesses, in the order in which they were issued
+  parallel = false;
+  for (MemoryAccess& access : buffered_memory_accesses)
+    Access(access.module, access.type, access.space, access.address,
+           access.witness);
+  buffered_memory_accesses.clear();
+
+  // Finished work-groups
+  for (WorkGroup* work_group : buffered_unmapped_work_groups)
+    UnmapWorkGroup(work_group);
+  buffered_unmapped_work_groups.clear();
+  parallel = true;
+}
+
 void ComputeUnit::UpdateFetchVisualization(FetchBuffer* fetch_buffer) {
   for (auto it = fetch_buffer->begin(), e = fetch_buffer->end(); it != e;
        ++it) {
@@ -794,20 +1016,79 @@ void ComputeUnit::UpdateFetchVisualization(FetchBuffer* fetch_buffer) {
   }
 }
 
+bool ComputeUnit::isSleeping() {
+  // Awake
+  if (!wakeup_cycle) return false;
+
+  // Wake up in the given cycle, or when a memory access completes
+  bool wakeup = timing->getCycle() >= wakeup_cycle;
+  for (int* witness : wakeup_witnesses)
+    if (!*witness) wakeup = true;
+  if (wakeup) wakeup_cycle = 0;
+  return !wakeup;
+}
+
+void ComputeUnit::Sleep() {
+  // Stay awake while per-cycle traces or statistics are collected
+  wakeup_cycle = 0;
+  if (!skip_idle_cycles || Timing::trace || Timing::pipeline_debug ||
+      Timing::m2svis || Timing::statistics_level)
+    return;
+
+  // Instructions waiting to be issued
+  for (auto& fetch_buffer : fetch_buffers)
+    if (fetch_buffer->getSize()) return;
+
+  // Wavefronts that can be fetched
+  wakeup_witnesses.clear();
+  for (auto& wavefront_pool : wavefront_pools)
+    if (!wavefront_pool->isWaiting(wakeup_witnesses)) return;
+
+  // Earliest cycle in which an execution unit can change state
+  long long cycle = timing->getCycle();
+  long long wakeup = ExecutionUnit::NoWakeup;
+  auto add_execution_unit = [&](const ExecutionUnit* execution_unit) {
+    int* witness = nullptr;
+    wakeup = std::min(wakeup, execution_unit->getWakeupCycle(cycle, witness));
+    if (witness) wakeup_witnesses.push_back(witness);
+  };
+  for (auto& simd_unit : simd_units) add_execution_unit(simd_unit.get());
+  add_execution_unit(&vector_memory_unit);
+  add_execution_unit(&lds_unit);
+  add_execution_unit(&scalar_unit);
+  add_execution_unit(&branch_unit);
+
+  // Sleep if the next cycle does not change any state
+  if (wakeup > cycle + 1) wakeup_cycle = wakeup;
+}
+
 void ComputeUnit::Run() {
   // Return if no work groups are mapped to this compute unit
+  asleep = false;
   if (!work_groups.size()) return;
 
   // Save timing simulator
   timing = Timing::getInstance();
 
+  // Wavefronts resident in this cycle, for the occupancy
+  int num_wavefronts = 0;
+  for (auto& resources : wavefront_pool_resources)
+    num_wavefronts += resources.wavefronts;
+  stats.Increment(CounterWavefrontCycles, num_wavefronts);
+
+  // Skip the cycle if the compute unit is sleeping
+  if (isSleeping()) {
+    asleep = true;
+    num_sleeping_cycles++;
+    return;
+  }
+
   // Issue buffer chosen to issue this cycle, round-robin
   int active_issue_buffer = timing->getCycle() % num_wavefront_pools;
   assert(active_issue_buffer >= 0 && active_issue_buffer < num_wavefront_pools);
 
   // Issue from fetch buffer with greatest pressure
-  char* isFetchPressureScheduler = getenv("M2S_FP_SCHED");
-  if (isFetchPressureScheduler) {
+  if (issue_kind == IssueKindFetchPressure) {
     int pressure = 0;
     for (unsigned i = 0; i < fetch_buffers.size(); ++i) {
       if (fetch_buffers[i]->getSize() > pressure) {
@@ -842,9 +1123,8 @@ void ComputeUnit::Run() {
     }
   }
 
-  // Fetch, randomized
-  char* isRandom = getenv("M2S_RANDOM_FETCH");
-  if (isRandom) {
+  // Fetch, starting at the active issue buffer
+  if (rotate_fetch) {
     for (int i = 0; i < num_wavefront_pools; i++) {
       int index = (i + active_issue_buffer) % num_wavefront_pools;
       Fetch(fetch_buffers[index].get(), wavefront_pools[index].get());
@@ -854,6 +1134,9 @@ void ComputeUnit::Run() {
       Fetch(fetch_buffers[i].get(), wavefront_pools[i].get());
     }
   }
+
+  // Sleep until the next cycle that can change any state
+  Sleep();
 }
 
 void ComputeUnit::Dump(std::ostream& os) const {
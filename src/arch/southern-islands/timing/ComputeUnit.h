@@ -22,6 +22,8 @@
 
 #include <list>
 
+#include <lib/cpp/String.h>
+#include <memory/Mmu.h>
 #include <memory/Module.h>
 
 #include "BranchUnit.h"
@@ -37,8 +39,63 @@ namespace SI {
 
 // Forward declarations
 class Timing;
+class Wavefront;
 class WorkGroup;
 class Gpu;
+class NDRange;
+
+/// Resources of a wavefront pool allocated to work-groups
+struct WorkGroupResources {
+  /// Number of work-groups
+  int work_groups = 0;
+
+  /// Number of wavefronts
+  int wavefronts = 0;
+
+  /// Number of vector registers
+  int vector_registers = 0;
+
+  /// Number of scalar registers
+  int scalar_registers = 0;
+
+  /// Local memory in bytes
+  int local_memory = 0;
+};
+
+/// Port of an instruction cache shared by several compute units. The port
+/// is owned by one compute unit in each cycle, granted in round-robin order
+/// among the compute units that requested it in the previous cycle.
+class InstructionCachePort {
+  // Number of compute units sharing the instruction cache
+  int num_sharers;
+
+  // Flag set by each sharer that needs the port. Each compute unit only
+  // writes its own flag, so they can be simulated on different host
+  // threads.
+  std::vector<char> requests;
+
+  // Sharer owning the port in the current cycle, or -1 if none
+  int owner = -1;
+
+  // Last sharer that was granted the port
+  int last_owner = -1;
+
+ public:
+  /// Constructor
+  explicit InstructionCachePort(int num_sharers)
+      : num_sharers(num_sharers), requests(num_sharers) {}
+
+  /// Return whether the given sharer owns the port in the current cycle
+  bool isOwner(int sharer) const { return owner == sharer; }
+
+  /// Request the port for the next cycle on behalf of the given sharer
+  void Request(int sharer) { requests[sharer] = true; }
+
+  /// Grant the port for the next cycle to the first sharer after the last
+  /// owner that requested it, and clear all requests. This function is
+  /// called once all compute units finished the current cycle.
+  void Arbitrate();
+};
 
 /// Class representing one compute unit in the GPU device.
 class ComputeUnit {
@@ -57,9 +114,21 @@ class ComputeUnit {
   // Update the visualization states for non-issued instructions
   void UpdateFetchVisualization(FetchBuffer* fetch_buffer);
 
+  // Make the block of instruction memory containing the wavefront's next
+  // instruction available in the wavefront's instruction buffer. Return
+  // true if the block is available in the current cycle. Otherwise, an
+  // access to the instruction cache is started if the compute unit owns
+  // the instruction cache port in this cycle, and false is returned.
+  bool FetchInstructionBlock(WavefrontPoolEntry* wavefront_pool_entry);
+
   // Set initial PC for TwinKernel execution mode
   void SetInitialPC(WorkGroup* work_group);
 
+  // Return the first free work-group slot whose wavefront pool has enough
+  // free resources for a work-group allocating the given resources, or -1
+  // if there is none.
+  int FindWorkGroupSlot(const WorkGroupResources& resources) const;
+
   // Associated timing simulator, saved for performance
   Timing* timing = nullptr;
 
@@ -70,9 +139,19 @@ class ComputeUnit {
   // constructor.
   int index;
 
-  // List of work-groups currently mapped to the compute unit
+  // List of work-groups currently mapped to the compute unit, indexed by
+  // the work-group slot. Free slots contain nullptr.
   std::vector<WorkGroup*> work_groups;
 
+  // Resources allocated by the work-group in each slot
+  std::vector<WorkGroupResources> work_group_resources;
+
+  // Resources allocated in each wavefront pool
+  std::vector<WorkGroupResources> wavefront_pool_resources;
+
+  // Number of work-groups currently mapped to the compute unit
+  int num_work_groups = 0;
+
   // Variable number of wavefront pools
   std::vector<std::unique_ptr<WavefrontPool>> wavefront_pools;
 
@@ -100,6 +179,92 @@ class ComputeUnit {
   // Counter of identifiers assigned to uops in this compute unit
   long long uop_id_counter = 0;
 
+  //
+  // Instruction fetch
+  //
+
+  // Port of the instruction cache if it is shared with other compute
+  // units, or null otherwise
+  InstructionCachePort* instruction_cache_port = nullptr;
+
+  // Position of the compute unit among the sharers of the instruction
+  // cache port
+  int instruction_cache_sharer = 0;
+
+  // Last cycle in which the instruction cache was accessed
+  long long last_instruction_cache_cycle = -1;
+
+  //
+  // Idle cycle skipping
+  //
+
+  // Cycle in which a sleeping compute unit wakes up, or 0 if the compute
+  // unit is awake
+  long long wakeup_cycle = 0;
+
+  // Witnesses of the memory accesses that wake up a sleeping compute unit
+  // when any of them completes
+  std::vector<int*> wakeup_witnesses;
+
+  // Flag set when the last call to Run() skipped the cycle
+  bool asleep = false;
+
+  // Number of cycles skipped while sleeping
+  long long num_sleeping_cycles = 0;
+
+  // Return whether the compute unit is sleeping in the current cycle,
+  // waking it up if its wakeup cycle was reached or any of its memory
+  // accesses completed
+  bool isSleeping();
+
+  // Put the compute unit to sleep at the end of a cycle if no state can
+  // change until a future cycle or until a memory access completes
+  void Sleep();
+
+  //
+  // Parallel simulation
+  //
+
+  // Access to a memory module buffered until the end of the cycle
+  struct MemoryAccess {
+    // Module accessed
+    mem::Module* module;
+
+    // Type of access
+    mem::Module::AccessType type;
+
+    // Address space of a virtual address, or nullptr if the address is
+    // already physical
+    mem::Mmu::Space* space;
+
+    // Accessed address
+    unsigned address;
+
+    // Witness decremented when the access completes
+    int* witness;
+  };
+
+  // Flag set while the compute unit is simulated on a host thread. Memory
+  // accesses, address translations, work-group unmappings, and updates of
+  // the GPU and emulator statistics are then buffered and submitted by the
+  // main simulation thread at the end of the cycle.
+  bool parallel = false;
+
+  // Memory accesses buffered in the current cycle, in program order
+  std::vector<MemoryAccess> buffered_memory_accesses;
+
+  // Work-groups that finished in the current cycle
+  std::vector<WorkGroup*> buffered_unmapped_work_groups;
+
+  // Wavefronts that executed an instruction in the current cycle
+  std::vector<Wavefront*> buffered_executed_wavefronts;
+
+  // Number of wavefronts that completed in the current cycle
+  int buffered_completed_wavefronts = 0;
+
+  // Flag set when a uop completed in the current cycle
+  bool buffered_uop_completed = false;
+
  public:
   //
   // Static fields
@@ -127,6 +292,27 @@ class ComputeUnit {
   /// (vector, scalar, branch, ...)
   static int max_instructions_issued_per_type;
 
+  /// Policy choosing the fetch buffer to issue from in each cycle
+  enum IssueKind {
+    IssueKindInvalid = 0,
+    IssueKindRoundRobin,
+    IssueKindFetchPressure
+  };
+
+  /// String map for values of type IssueKind
+  static misc::StringMap issue_kind_map;
+
+  /// Issue policy, configured by the user
+  static IssueKind issue_kind;
+
+  /// Fetch from the wavefront pools starting at the pool issuing in the
+  /// current cycle, instead of always starting at pool 0
+  static bool rotate_fetch;
+
+  /// Skip the cycles in which the compute unit only waits on outstanding
+  /// memory accesses, barriers, or pipeline latencies
+  static bool skip_idle_cycles;
+
   /// The maximum number of work_groups in a wavefront pool
   static int max_work_groups_per_wavefront_pool;
 
@@ -183,12 +369,60 @@ class ComputeUnit {
   /// Return the associated timing simulator
   Timing* getTiming() const { return timing; }
 
-  /// Map a work group to the compute unit
+  /// Return the number of work-groups currently mapped to the compute unit
+  int getNumWorkGroups() const { return num_work_groups; }
+
+  /// Return whether the compute unit skipped the last simulated cycle
+  bool isAsleep() const { return asleep; }
+
+  /// Return the number of cycles skipped by the compute unit while
+  /// waiting with work-groups mapped
+  long long getNumSleepingCycles() const { return num_sleeping_cycles; }
+
+  /// Return the maximum number of work-groups that can be mapped to the
+  /// compute unit at a time, regardless of their resource usage
+  static int getMaxWorkGroups();
+
+  /// Return whether the compute unit has enough free resources for a
+  /// work-group of the given NDRange, which must be mapped to the GPU
+  bool canMapWorkGroup(NDRange* ndrange) const;
+
+  /// Map a work group to the compute unit. The compute unit must have
+  /// enough free resources for it.
   void MapWorkGroup(WorkGroup* work_group);
 
-  /// Unmap a work group from the compute unit
+  /// Unmap a work group from the compute unit. While the compute unit is
+  /// simulated on a host thread, the work-group is unmapped at the end of
+  /// the cycle.
   void UnmapWorkGroup(WorkGroup* work_group);
 
+  /// Start an access to a memory module. If an address space is given,
+  /// the address is translated from that virtual address space first.
+  /// While the compute unit is simulated on a host thread, the access is
+  /// started at the end of the cycle.
+  void Access(mem::Module* module, mem::Module::AccessType type,
+              mem::Mmu::Space* space, unsigned address, int* witness);
+
+  /// Record that a uop completed execution in the current cycle
+  void CompleteUop();
+
+  /// Record that a wavefront completed execution in the current cycle
+  void CompleteWavefront();
+
+  /// Set the port of an instruction cache shared with other compute units,
+  /// and the position of the compute unit among its sharers
+  void setInstructionCachePort(InstructionCachePort* port, int sharer) {
+    instruction_cache_port = port;
+    instruction_cache_sharer = sharer;
+  }
+
+  /// Set whether the compute unit is simulated on a host thread
+  void setParallel(bool parallel);
+
+  /// Submit the requests buffered while the compute unit was simulated on
+  /// a host thread in the current cycle
+  void SubmitBufferedRequests();
+
   /// Add a work group pointer to the work_groups list
   void AddWorkGroup(WorkGroup* work_group);
 
@@ -218,6 +452,10 @@ class ComputeUnit {
   /// Cache used for scalar data
   mem::Module* scalar_cache = nullptr;
 
+  /// Cache used for instructions, or `nullptr` if instruction fetches
+  /// take a fixed latency given by option FetchLatency
+  mem::Module* instruction_cache = nullptr;
+
   /// Iterator of the compute unit location in the available compute
   /// units list
   std::list<ComputeUnit*>::iterator available_compute_units_iterator;
@@ -18,23 +18,53 @@
  */
 
 #include "ComputeUnitStatistics.h"
-#include <lib/cpp/String.h>
 
 namespace SI {
 
+const misc::StringMap ComputeUnitStats::counter_map = {
+    {"WorkGroupCount", CounterWorkGroups},
+    {"Instructions", CounterInstructions},
+    {"ScalarALUInstructions", CounterScalarAluInstructions},
+    {"ScalarMemInstructions", CounterScalarMemoryInstructions},
+    {"BranchInstructions", CounterBranchInstructions},
+    {"SIMDInstructions", CounterSimdInstructions},
+    {"VectorMemInstructions", CounterVectorMemoryInstructions},
+    {"LDSInstructions", CounterLdsInstructions},
+    {"ScalarRegReads", CounterScalarRegReads},
+    {"ScalarRegWrites", CounterScalarRegWrites},
+    {"VectorRegReads", CounterVectorRegReads},
+    {"VectorRegWrites", CounterVectorRegWrites},
+    {"InstructionCacheAccesses", CounterInstructionCacheAccesses},
+    {"InstructionBufferHits", CounterInstructionBufferHits},
+    {"WavefrontCycles", CounterWavefrontCycles},
+    {"StallIssue", CounterStallIssue},
+    {"StallDecode", CounterStallDecode},
+    {"StallRead", CounterStallRead},
+    {"StallExecution", CounterStallExecution},
+    {"StallWrite", CounterStallWrite},
+    {"VectorMemDivergence", CounterVectorMemoryDivergence}};
+
+void ComputeUnitStats::Add(const ComputeUnitStats& stats) {
+  for (int i = 0; i < CounterMax; i++) counters[i] += stats.counters[i];
+}
+
+void ComputeUnitStats::Subtract(const ComputeUnitStats& stats) {
+  for (int i = 0; i < CounterMax; i++) counters[i] -= stats.counters[i];
+}
+
 void ComputeUnitStats::Dump(std::ostream& os) const {
-  os << misc::fmt("WorkGroupCount = %lld\n", num_mapped_work_groups_);
-  os << misc::fmt("Instructions = %lld\n", num_total_insts_);
-  os << misc::fmt("ScalarALUInstructions = %lld\n", num_scalar_alu_insts_);
-  os << misc::fmt("ScalarMemInstructions = %lld\n", num_scalar_memory_insts_);
-  os << misc::fmt("BranchInstructions = %lld\n", num_branch_insts_);
-  os << misc::fmt("SIMDInstructions = %lld\n", num_simd_insts_);
-  os << misc::fmt("VectorMemInstructions = %lld\n", num_vector_memory_insts_);
-  os << misc::fmt("LDSInstructions = %lld\n", num_lds_insts_);
-  os << misc::fmt("ScalarRegReads= %lld\n", num_sreg_reads_);
-  os << misc::fmt("ScalarRegWrites= %lld\n", num_sreg_writes_);
-  os << misc::fmt("VectorRegReads= %lld\n", num_vreg_reads_);
-  os << misc::fmt("VectorRegWrites= %lld\n", num_vreg_writes_);
+  for (int i = 0; i < CounterMax; i++)
+    os << misc::fmt("%s = %lld\n", counter_map[i], counters[i]);
+}
+
+void ComputeUnitStats::DumpFields(std::ostream& os) {
+  for (int i = 0; i < CounterMax; i++)
+    os << (i ? "," : "") << counter_map[i];
+}
+
+void ComputeUnitStats::DumpValues(std::ostream& os) const {
+  for (int i = 0; i < CounterMax; i++)
+    os << (i ? "," : "") << counters[i];
 }
 
-}  // namespace SI
\ No newline at end of file
+}  // namespace SI
@@ -22,31 +22,73 @@
 
 #include <iostream>
 
+#include <lib/cpp/String.h>
+
 namespace SI {
+
+/// Counters of the compute unit statistics. Every counter of the
+/// Southern Islands timing model is registered here and in
+/// ComputeUnitStats::counter_map, which gives its name in the report and
+/// in the counters time series.
+enum Counter {
+  CounterWorkGroups = 0,
+  CounterInstructions,
+  CounterScalarAluInstructions,
+  CounterScalarMemoryInstructions,
+  CounterBranchInstructions,
+  CounterSimdInstructions,
+  CounterVectorMemoryInstructions,
+  CounterLdsInstructions,
+  CounterScalarRegReads,
+  CounterScalarRegWrites,
+  CounterVectorRegReads,
+  CounterVectorRegWrites,
+  CounterInstructionCacheAccesses,
+  CounterInstructionBufferHits,
+  CounterWavefrontCycles,
+  CounterStallIssue,
+  CounterStallDecode,
+  CounterStallRead,
+  CounterStallExecution,
+  CounterStallWrite,
+  CounterVectorMemoryDivergence,
+  CounterMax
+};
+
+/// Array of counters, one per value of enumeration Counter. Each compute
+/// unit owns one array, so that it can be incremented without sharing
+/// cache lines with other compute units simulated on host threads.
 class ComputeUnitStats {
- public:
-  long long end_cycle_ = 0;
-
-  // Instruction counters
-  long long num_total_insts_ = 0;
-  long long num_branch_insts_ = 0;
-  long long num_scalar_memory_insts_ = 0;
-  long long num_scalar_alu_insts_ = 0;
-  long long num_simd_insts_ = 0;
-  long long num_vector_memory_insts_ = 0;
-  long long num_lds_insts_ = 0;
-
-  // Register counters
-  long long num_sreg_reads_ = 0;
-  long long num_sreg_writes_ = 0;
-  long long num_vreg_reads_ = 0;
-  long long num_vreg_writes_ = 0;
-  long long num_mapped_work_groups_ = 0;
+  // Counter values
+  long long counters[CounterMax] = {};
 
  public:
-  /// Dump statistics
+  /// Names of the counters
+  static const misc::StringMap counter_map;
+
+  /// Increment a counter
+  void Increment(Counter counter, long long value = 1) {
+    counters[counter] += value;
+  }
+
+  /// Return the value of a counter
+  long long operator[](Counter counter) const { return counters[counter]; }
+
+  /// Add the counters of \a stats to this array
+  void Add(const ComputeUnitStats& stats);
+
+  /// Subtract the counters of \a stats from this array
+  void Subtract(const ComputeUnitStats& stats);
+
+  /// Dump statistics as `<name> = <value>` lines
   void Dump(std::ostream& os = std::cout) const;
 
+  /// Dump the counter names as comma-separated fields
+  static void DumpFields(std::ostream& os = std::cout);
+
+  /// Dump the counter values as comma-separated fields
+  void DumpValues(std::ostream& os = std::cout) const;
+
   /// Same as Dump()
   friend std::ostream& operator<<(std::ostream& os,
                                   const ComputeUnitStats& info) {
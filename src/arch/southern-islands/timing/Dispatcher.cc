@@ -0,0 +1,138 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <algorithm>
+
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <lib/cpp/Error.h>
+
+#include "ComputeUnit.h"
+#include "Dispatcher.h"
+#include "Gpu.h"
+
+namespace SI {
+
+misc::StringMap Dispatcher::kind_map = {{"RoundRobin", KindRoundRobin},
+                                        {"LeastLoaded", KindLeastLoaded},
+                                        {"TailAware", KindTailAware},
+                                        {"Spatial", KindSpatial}};
+
+Dispatcher::Kind Dispatcher::kind = KindRoundRobin;
+
+std::unique_ptr<Dispatcher> Dispatcher::New(Gpu* gpu) {
+  switch (kind) {
+    case KindRoundRobin:
+      return misc::new_unique<RoundRobinDispatcher>(gpu);
+
+    case KindLeastLoaded:
+      return misc::new_unique<LeastLoadedDispatcher>(gpu);
+
+    case KindTailAware:
+      return misc::new_unique<TailAwareDispatcher>(gpu);
+
+    case KindSpatial:
+      return misc::new_unique<SpatialDispatcher>(gpu);
+
+    default:
+      throw misc::Panic("Invalid dispatcher kind");
+  }
+}
+
+ComputeUnit* RoundRobinDispatcher::getComputeUnit(NDRange* ndrange) {
+  for (auto it = gpu->getAvailableComputeUnitsBegin(),
+            e = gpu->getAvailableComputeUnitsEnd();
+       it != e; ++it) {
+    ComputeUnit* compute_unit = *it;
+    if (compute_unit->canMapWorkGroup(ndrange)) return compute_unit;
+  }
+  return nullptr;
+}
+
+ComputeUnit* LeastLoadedDispatcher::getComputeUnit(NDRange* ndrange) {
+  ComputeUnit* least_loaded_compute_unit = nullptr;
+  for (auto it = gpu->getAvailableComputeUnitsBegin(),
+            e = gpu->getAvailableComputeUnitsEnd();
+       it != e; ++it) {
+    ComputeUnit* compute_unit = *it;
+    if (!compute_unit->canMapWorkGroup(ndrange)) continue;
+    if (!least_loaded_compute_unit ||
+        compute_unit->getNumWorkGroups() <
+            least_loaded_compute_unit->getNumWorkGroups())
+      least_loaded_compute_unit = compute_unit;
+  }
+  return least_loaded_compute_unit;
+}
+
+ComputeUnit* TailAwareDispatcher::getComputeUnit(NDRange* ndrange) {
+  // Even share of work-groups per compute unit
+  unsigned num_work_groups =
+      ndrange->getGlobalSize1D() / ndrange->getLocalSize1D();
+  int work_groups_per_compute_unit =
+      num_work_groups / Gpu::num_compute_units + 1;
+
+  // Skip compute units that already received their share
+  std::vector<int>& counts = num_mapped_work_groups[ndrange->getId()];
+  counts.resize(Gpu::num_compute_units);
+  for (auto it = gpu->getAvailableComputeUnitsBegin(),
+            e = gpu->getAvailableComputeUnitsEnd();
+       it != e; ++it) {
+    ComputeUnit* compute_unit = *it;
+    if (counts[compute_unit->getIndex()] >= work_groups_per_compute_unit)
+      continue;
+    if (compute_unit->canMapWorkGroup(ndrange)) return compute_unit;
+  }
+  return nullptr;
+}
+
+void TailAwareDispatcher::MapWorkGroup(NDRange* ndrange,
+                                       ComputeUnit* compute_unit) {
+  std::vector<int>& counts = num_mapped_work_groups[ndrange->getId()];
+  counts.resize(Gpu::num_compute_units);
+  counts[compute_unit->getIndex()]++;
+}
+
+void TailAwareDispatcher::UnmapNDRange(NDRange* ndrange) {
+  num_mapped_work_groups.erase(ndrange->getId());
+}
+
+ComputeUnit* SpatialDispatcher::getComputeUnit(NDRange* ndrange) {
+  // Range of compute units owned by the NDRange. When there are more
+  // NDRanges than compute units, partitions contain one compute unit and
+  // are shared.
+  int num_ndranges = gpu->getNumMappedNDRanges();
+  int ndrange_index = gpu->getMappedNDRangeIndex(ndrange);
+  assert(ndrange_index >= 0);
+  int first = ndrange_index * Gpu::num_compute_units / num_ndranges;
+  int last = (ndrange_index + 1) * Gpu::num_compute_units / num_ndranges - 1;
+  last = std::max(first, last);
+
+  // First available compute unit in the partition
+  for (auto it = gpu->getAvailableComputeUnitsBegin(),
+            e = gpu->getAvailableComputeUnitsEnd();
+       it != e; ++it) {
+    ComputeUnit* compute_unit = *it;
+    if (compute_unit->getIndex() < first || compute_unit->getIndex() > last)
+      continue;
+    if (compute_unit->canMapWorkGroup(ndrange)) return compute_unit;
+  }
+  return nullptr;
+}
+
+}  // namespace SI
@@ -0,0 +1,142 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef ARCH_SOUTHERN_ISLANDS_TIMING_DISPATCHER_H
+#define ARCH_SOUTHERN_ISLANDS_TIMING_DISPATCHER_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <lib/cpp/String.h>
+
+namespace SI {
+
+// Forward declarations
+class ComputeUnit;
+class Gpu;
+class NDRange;
+
+/// Work-group dispatcher, choosing the compute unit where the next waiting
+/// work-group of an NDRange is mapped. Candidates are taken from the list
+/// of available compute units of the GPU, and only compute units with
+/// enough free resources for a work-group of the NDRange are returned.
+class Dispatcher {
+ public:
+  /// Dispatch policy
+  enum Kind {
+    KindInvalid = 0,
+    KindRoundRobin,
+    KindLeastLoaded,
+    KindTailAware,
+    KindSpatial
+  };
+
+  /// String map for values of type Kind
+  static misc::StringMap kind_map;
+
+  /// Dispatch policy, configured by the user
+  static Kind kind;
+
+ protected:
+  // GPU that the dispatcher maps work-groups to
+  Gpu* gpu;
+
+ public:
+  /// Constructor
+  Dispatcher(Gpu* gpu) : gpu(gpu) {}
+
+  /// Virtual destructor
+  virtual ~Dispatcher() {}
+
+  /// Create a dispatcher for the given GPU implementing the policy given
+  /// in static field \a kind.
+  static std::unique_ptr<Dispatcher> New(Gpu* gpu);
+
+  /// Return the compute unit where the next waiting work-group of the
+  /// given NDRange should be mapped, or nullptr if no compute unit can
+  /// take it in the current cycle.
+  virtual ComputeUnit* getComputeUnit(NDRange* ndrange) = 0;
+
+  /// Notify the dispatcher that a work-group of the given NDRange was
+  /// mapped to the given compute unit.
+  virtual void MapWorkGroup(NDRange* ndrange, ComputeUnit* compute_unit) {}
+
+  /// Notify the dispatcher that the given NDRange was unmapped from the
+  /// GPU.
+  virtual void UnmapNDRange(NDRange* ndrange) {}
+};
+
+/// Dispatcher taking the first available compute unit, in the order in
+/// which compute units became available. This is the default policy.
+class RoundRobinDispatcher : public Dispatcher {
+ public:
+  /// Constructor
+  RoundRobinDispatcher(Gpu* gpu) : Dispatcher(gpu) {}
+
+  ComputeUnit* getComputeUnit(NDRange* ndrange) override;
+};
+
+/// Dispatcher taking the available compute unit with the lowest number of
+/// mapped work-groups, from any NDRange.
+class LeastLoadedDispatcher : public Dispatcher {
+ public:
+  /// Constructor
+  LeastLoadedDispatcher(Gpu* gpu) : Dispatcher(gpu) {}
+
+  ComputeUnit* getComputeUnit(NDRange* ndrange) override;
+};
+
+/// Round-robin dispatcher that stops mapping work-groups of an NDRange to
+/// a compute unit once it received its even share of the NDRange's
+/// work-groups. This avoids a few compute units running a long tail of
+/// work-groups after the rest of the GPU went idle.
+class TailAwareDispatcher : public Dispatcher {
+  // Number of work-groups mapped to each compute unit, indexed by NDRange
+  // identifier
+  std::map<int, std::vector<int>> num_mapped_work_groups;
+
+ public:
+  /// Constructor
+  TailAwareDispatcher(Gpu* gpu) : Dispatcher(gpu) {}
+
+  ComputeUnit* getComputeUnit(NDRange* ndrange) override;
+
+  void MapWorkGroup(NDRange* ndrange, ComputeUnit* compute_unit) override;
+
+  void UnmapNDRange(NDRange* ndrange) override;
+};
+
+/// Dispatcher splitting the compute units into as many contiguous
+/// partitions as NDRanges are mapped to the GPU, with each NDRange mapping
+/// its work-groups only to its own partition. Partitions are recomputed
+/// as NDRanges are mapped and unmapped, while running work-groups stay on
+/// their compute units.
+class SpatialDispatcher : public Dispatcher {
+ public:
+  /// Constructor
+  SpatialDispatcher(Gpu* gpu) : Dispatcher(gpu) {}
+
+  ComputeUnit* getComputeUnit(NDRange* ndrange) override;
+};
+
+}  // namespace SI
+
+#endif
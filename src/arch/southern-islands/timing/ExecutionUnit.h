@@ -20,6 +20,7 @@
 #ifndef ARCH_SOUTHERN_ISLANDS_TIMING_EXECUTION_UNIT_H
 #define ARCH_SOUTHERN_ISLANDS_TIMING_EXECUTION_UNIT_H
 
+#include <climits>
 #include <deque>
 #include <memory>
 
@@ -59,6 +60,19 @@ class ExecutionUnit : public ExecutionUnitStatisticsModule {
   /// virtual function that every execution unit must implement.
   virtual bool isValidUop(Uop* uop) const = 0;
 
+  /// Value returned by getWakeupCycle() for an execution unit that does
+  /// not change state until new instructions are issued into it or a
+  /// memory access completes.
+  static const long long NoWakeup = LLONG_MAX;
+
+  /// Return the first cycle after \a cycle in which Run() can change the
+  /// state of the execution unit, assuming no more instructions are
+  /// issued into it. If the oldest instruction is waiting for a memory
+  /// access, \a witness is set to the witness of that access and the
+  /// unit does not wake up before it completes. This is a pure virtual
+  /// function that every execution unit must implement.
+  virtual long long getWakeupCycle(long long cycle, int*& witness) const = 0;
+
   /// Return whether the execution unit can absorb one more instruction.
   /// This is a pure virtual function that every execution unit must
   /// implement.
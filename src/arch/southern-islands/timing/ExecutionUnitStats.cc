@@ -17,6 +17,7 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include "ComputeUnit.h"
 #include "ExecutionUnitStats.h"
 #include "Timing.h"
 #include "Uop.h"
@@ -238,4 +239,36 @@ void ExecutionUnitStatisticsModule::PostRun() {
   UpdateStatus();
 }
 
+void ExecutionUnitStatisticsModule::Count(Counter counter) {
+  // Compute unit counter
+  compute_unit_->stats.Increment(counter);
+
+  // No need to proceed if statistics is not enabled
+  if (!overview_file_ && !interval_file_) return;
+
+  // Matching execution unit counter
+  long long ExecutionUnitStatistics::*member;
+  switch (counter) {
+    case CounterStallDecode:
+      member = &ExecutionUnitStatistics::num_stall_decode_;
+      break;
+    case CounterStallRead:
+      member = &ExecutionUnitStatistics::num_stall_read_;
+      break;
+    case CounterStallExecution:
+      member = &ExecutionUnitStatistics::num_stall_execution_;
+      break;
+    case CounterStallWrite:
+      member = &ExecutionUnitStatistics::num_stall_write_;
+      break;
+    case CounterVectorMemoryDivergence:
+      member = &ExecutionUnitStatistics::num_vmem_divergence_;
+      break;
+    default:
+      return;
+  }
+  if (overview_file_) overview_stats_.*member += 1;
+  if (interval_file_) interval_stats_.*member += 1;
+}
+
 }  // namespace SI
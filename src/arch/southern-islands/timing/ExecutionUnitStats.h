@@ -27,6 +27,8 @@
 #include <map>
 #include <string>
 
+#include "ComputeUnitStatistics.h"
+
 namespace SI {
 
 // Forward declaration
@@ -194,6 +196,10 @@ class ExecutionUnitStatisticsModule {
 
   // After execution unit run, update counter
   void PostRun();
+
+  // Increment a counter of the compute unit, together with the matching
+  // counter of the overview and interval statistics, if enabled
+  void Count(Counter counter);
 };
 }
 
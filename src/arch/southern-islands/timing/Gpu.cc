@@ -28,6 +28,10 @@ namespace SI {
 
 // Static variables
 int Gpu::num_compute_units = 32;
+int Gpu::compute_units_per_cluster = 4;
+int Gpu::num_host_threads = 1;
+int Gpu::max_work_groups_per_compute_unit = 0;
+bool Gpu::rotate_compute_units = false;
 long long Gpu::max_cycles = 0;
 
 double Gpu::max_wavefront_ratio = 1.0f;
@@ -54,13 +58,28 @@ Gpu::Gpu() {
     InsertInAvailableComputeUnits(compute_unit);
   }
 
+  // Create work-group dispatcher and sampler
+  dispatcher = Dispatcher::New(this);
+  sampler = misc::new_unique<Sampler>(this);
+
   if (Timing::statistics_level >= 1) {
     ndrange_stats_file.setPath("cu_all.ndrange");
     ndrange_stats_file << "ndrange_id,len_map,clk_map,clk_unmap,len_uop,clk_"
                           "uop_begin,clk_uop_end\n";
   }
+
+  // Time series of the compute unit counters
+  if (!Timing::counters_file.empty()) {
+    counters_series.setPath(Timing::counters_file);
+    counters_series << "cycle,compute_unit,";
+    ComputeUnitStats::DumpFields(counters_series);
+    counters_series << '\n';
+    sampled_counters.resize(num_compute_units);
+  }
 }
 
+Gpu::~Gpu() { StopHostThreads(); }
+
 ComputeUnit* Gpu::getAvailableComputeUnit() {
   if (available_compute_units.empty())
     return nullptr;
@@ -90,12 +109,33 @@ void Gpu::RemoveFromAvailableComputeUnits(ComputeUnit* compute_unit) {
       available_compute_units.end();
 }
 
+Gpu::MappedNDRange* Gpu::getMappedNDRange(NDRange* ndrange) const {
+  for (auto& mapped_ndrange : mapped_ndranges)
+    if (mapped_ndrange->ndrange == ndrange) return mapped_ndrange.get();
+  return nullptr;
+}
+
+int Gpu::getMappedNDRangeIndex(NDRange* ndrange) const {
+  for (int i = 0; i < (int)mapped_ndranges.size(); i++)
+    if (mapped_ndranges[i]->ndrange == ndrange) return i;
+  return -1;
+}
+
+bool Gpu::canMapWorkGroup(ComputeUnit* compute_unit) const {
+  for (auto& mapped_ndrange : mapped_ndranges)
+    if (compute_unit->canMapWorkGroup(mapped_ndrange->ndrange)) return true;
+  return false;
+}
+
 void Gpu::MapNDRange(NDRange* ndrange) {
   // Check that at least one work-group can be allocated per
   // wavefront pool
-  Gpu::CalcGetWorkGroupsPerWavefrontPool(
+  auto mapped_ndrange = misc::new_unique<MappedNDRange>();
+  mapped_ndrange->ndrange = ndrange;
+  int work_groups_per_wavefront_pool = CalcGetWorkGroupsPerWavefrontPool(
       ndrange->getLocalSize1D(), ndrange->getNumVgprUsed(),
-      ndrange->getNumSgprUsed(), ndrange->getLocalMemTop());
+      ndrange->getNumSgprUsed(), ndrange->getLocalMemTop(),
+      &mapped_ndrange->work_group_resources);
 
   // Make sure the number of work groups per wavefront pool is non-zero
   if (!work_groups_per_wavefront_pool) {
@@ -109,27 +149,22 @@ void Gpu::MapNDRange(NDRange* ndrange) {
   }
 
   // Calculate limit of work groups per compute unit
-  work_groups_per_compute_unit =
+  int work_groups_per_compute_unit =
       work_groups_per_wavefront_pool * ComputeUnit::num_wavefront_pools;
   Emulator::scheduler_debug << misc::fmt("Hardware limit: %d WG per CU\n",
                                          work_groups_per_compute_unit);
 
-  wavefronts_per_compute_unit =
-      work_groups_per_compute_unit * ndrange->getLocalSize1D() / 64;
-
-  // Limit work groups per compute unit from environment variable
-  char* env = getenv("M2S_WG_LIMIT");
-  if (env) {
-    int wg_limit = atoi(env);
-    if (wg_limit > work_groups_per_compute_unit) {
-      Emulator::scheduler_debug
-          << misc::fmt("Manual limit > Hardware limit, aborting...\n");
-      exit(-1);
-    }
-    work_groups_per_compute_unit = wg_limit;
+  // Apply the user limit of work groups per compute unit
+  if (max_work_groups_per_compute_unit &&
+      max_work_groups_per_compute_unit < work_groups_per_compute_unit) {
+    work_groups_per_compute_unit = max_work_groups_per_compute_unit;
     Emulator::scheduler_debug << misc::fmt("Manual limit: %d WG per CU\n",
                                            work_groups_per_compute_unit);
   }
+  mapped_ndrange->work_groups_per_compute_unit = work_groups_per_compute_unit;
+  mapped_ndrange->wavefronts_per_compute_unit =
+      work_groups_per_compute_unit * ndrange->getLocalSize1D() / 64;
+  mapped_ndrange->counters = getCounters();
 
   assert(work_groups_per_wavefront_pool <=
          ComputeUnit::max_work_groups_per_wavefront_pool);
@@ -142,8 +177,22 @@ void Gpu::MapNDRange(NDRange* ndrange) {
       ndrange->getId(), work_groups_per_wavefront_pool,
       work_groups_per_compute_unit);
 
+  // Counters of NDRanges running at the same time cannot be told apart
+  if (!mapped_ndranges.empty()) {
+    mapped_ndrange->overlapped = true;
+    for (auto& other : mapped_ndranges) other->overlapped = true;
+  }
+
   // Map ndrange
-  mapped_ndrange = ndrange;
+  mapped_ndranges.push_back(std::move(mapped_ndrange));
+  sampler->MapNDRange(ndrange);
+
+  // Compute units left out of the available list by other NDRanges may
+  // have room for work-groups of this one
+  for (auto& compute_unit : compute_units)
+    if (!compute_unit->in_available_compute_units &&
+        compute_unit->canMapWorkGroup(ndrange))
+      InsertInAvailableComputeUnits(compute_unit.get());
 
   // Calculate max wavefronts to run in this NDRange
   auto all_wavefront_count = (ndrange->getGlobalSize1D() + 64 - 1) / 64;
@@ -170,20 +219,38 @@ void Gpu::MapNDRange(NDRange* ndrange) {
 
 void Gpu::UnmapNDRange(NDRange* ndrange) {
   // Unmap NDRange
-  mapped_ndrange = nullptr;
+  int index = getMappedNDRangeIndex(ndrange);
+  if (index >= 0) {
+    // Record the counters of the NDRange if it ran alone. An NDRange
+    // mapped again for a later batch of work-groups accumulates them.
+    int id = ndrange->getId();
+    if (mapped_ndranges[index]->overlapped) {
+      overlapped_ndrange_ids.insert(id);
+      ndrange_counters.erase(id);
+    } else if (!overlapped_ndrange_ids.count(id)) {
+      ComputeUnitStats counters = getCounters();
+      counters.Subtract(mapped_ndranges[index]->counters);
+      ndrange_counters[id].Add(counters);
+    }
+    sampler->UnmapNDRange(ndrange);
+    mapped_ndranges.erase(mapped_ndranges.begin() + index);
+    dispatcher->UnmapNDRange(ndrange);
+  }
 
   // Erase every workgroup in each compute unit, setting the
-  // work_groups size to 0
-  for (auto& compute_unit : compute_units) compute_unit->Reset();
+  // work_groups size to 0, once no NDRange is left running
+  if (mapped_ndranges.empty())
+    for (auto& compute_unit : compute_units) compute_unit->Reset();
 
   // Update info if statistics enables
   FlushStats(ndrange);
 }
 
-void Gpu::CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
-                                            int vector_registers_per_work_item,
-                                            int scalar_registers_per_wavefront,
-                                            int local_memory_per_work_group) {
+int Gpu::CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
+                                           int vector_registers_per_work_item,
+                                           int scalar_registers_per_wavefront,
+                                           int local_memory_per_work_group,
+                                           WorkGroupResources* resources) {
   // Get maximum number of work-groups per SIMD as limited by the
   // maximum number of wavefronts, given the number of wavefronts per
   // work-group in the NDRange
@@ -255,9 +322,16 @@ void Gpu::CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
   Emulator::scheduler_debug
       << misc::fmt("\tlds/workgroup: %d\n", local_memory_per_work_group);
 
+  // Resources allocated by each work-group
+  resources->work_groups = 1;
+  resources->wavefronts = wavefronts_per_work_group;
+  resources->vector_registers = vector_registers_per_work_group;
+  resources->scalar_registers = scalar_registers_per_work_group;
+  resources->local_memory = local_memory_per_work_group;
+
   // Based on the limits above, calculate the actual limit of work-groups
   // per SIMD.
-  work_groups_per_wavefront_pool =
+  int work_groups_per_wavefront_pool =
       ComputeUnit::max_work_groups_per_wavefront_pool;
   work_groups_per_wavefront_pool =
       std::min(work_groups_per_wavefront_pool,
@@ -291,20 +365,71 @@ void Gpu::CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
              max_work_groups_limited_by_num_registers) {
     Emulator::scheduler_debug << "\tWG is limited by number of registers\n";
   }
+
+  return work_groups_per_wavefront_pool;
 }
 
-void Gpu::Run() {
-  // Advance one cycle in each compute unit
-  if (getenv("M2S_RANDOM_CU")) {
+int Gpu::getFirstComputeUnit() const {
+  if (rotate_compute_units) {
     auto timing = Timing::getInstance();
-    int start_cu = timing->getCycle() % num_compute_units;
+    return timing->getCycle() % num_compute_units;
+  }
+  return 0;
+}
 
+void Gpu::Run() {
+  // Advance one cycle in each compute unit, on multiple host threads if
+  // possible
+  if (num_host_threads > 1 && canRunParallel()) {
+    RunParallel();
+  } else {
+    int start_cu = getFirstComputeUnit();
     for (int i = 0; i < num_compute_units; ++i) {
       int index = (i + start_cu) % num_compute_units;
       compute_units[index]->Run();
     }
-  } else {
-    for (auto& compute_unit : compute_units) compute_unit->Run();
+  }
+
+  // Grant the ports of shared instruction caches for the next cycle
+  for (auto& port : instruction_cache_ports) port->Arbitrate();
+
+  // The GPU is stalled if all compute units with work-groups mapped were
+  // sleeping in this cycle
+  bool stalled = false;
+  for (auto& compute_unit : compute_units) {
+    if (compute_unit->isAsleep()) {
+      stalled = true;
+    } else if (compute_unit->getNumWorkGroups()) {
+      stalled = false;
+      break;
+    }
+  }
+  if (stalled) num_stalled_cycles++;
+
+  // Sample the counters
+  if (counters_series) SampleCounters();
+}
+
+ComputeUnitStats Gpu::getCounters() const {
+  ComputeUnitStats counters;
+  for (auto& compute_unit : compute_units) counters.Add(compute_unit->stats);
+  return counters;
+}
+
+void Gpu::SampleCounters() {
+  // Only at the end of a sampling interval
+  long long cycle = Timing::getInstance()->getCycle();
+  if (cycle % Timing::statistics_sampling_cycle) return;
+
+  // Increment of the counters of each compute unit in the interval
+  for (auto& compute_unit : compute_units) {
+    ComputeUnitStats& sampled = sampled_counters[compute_unit->getIndex()];
+    ComputeUnitStats counters = compute_unit->stats;
+    counters.Subtract(sampled);
+    counters_series << cycle << ',' << compute_unit->getIndex() << ',';
+    counters.DumpValues(counters_series);
+    counters_series << '\n';
+    sampled = compute_unit->stats;
   }
 }
 
@@ -20,12 +20,16 @@
 #ifndef ARCH_SOUTHERN_ISLANDS_TIMING_GPU_H
 #define ARCH_SOUTHERN_ISLANDS_TIMING_GPU_H
 
+#include <set>
 #include <vector>
 
+#include <lib/cpp/HostThreadPool.h>
 #include <lib/cpp/Misc.h>
 #include <memory/Mmu.h>
 
 #include "ComputeUnit.h"
+#include "Dispatcher.h"
+#include "Sampler.h"
 #include "Statistics.h"
 
 namespace SI {
@@ -61,22 +65,102 @@ class Gpu {
   RegisterAllocationGranularity register_allocation_granularity =
       RegisterAllocationInvalid;
 
-  /// Number of work groups allowed in a wavefront pool
-  int work_groups_per_wavefront_pool = 0;
+  // NDRange mapped to the GPU
+  struct MappedNDRange {
+    // The NDRange
+    NDRange* ndrange;
 
-  /// Number of work_groups allowed in a compute unit
-  int work_groups_per_compute_unit = 0;
+    // Resources allocated in a wavefront pool by each work-group
+    WorkGroupResources work_group_resources;
 
-  /// Number of wavefronts allowed in a compute unit
-  int wavefronts_per_compute_unit = 0;
+    // Number of work-groups of the NDRange alone that fit in a compute
+    // unit
+    int work_groups_per_compute_unit;
 
-  /// Mapped NDRange to the GPU
-  NDRange* mapped_ndrange = nullptr;
+    // Number of wavefronts of the NDRange alone that fit in a compute unit
+    int wavefronts_per_compute_unit;
+
+    // Counters of all compute units when the NDRange was mapped
+    ComputeUnitStats counters;
+
+    // Whether another NDRange was mapped at the same time
+    bool overlapped = false;
+  };
+
+  // NDRanges mapped to the GPU, in the order in which they were mapped.
+  // Work-groups of all of them can run concurrently and share compute
+  // units.
+  std::vector<std::unique_ptr<MappedNDRange>> mapped_ndranges;
+
+  // Work-group dispatcher
+  std::unique_ptr<Dispatcher> dispatcher;
+
+  // Work-group sampler
+  std::unique_ptr<Sampler> sampler;
+
+  // Return the mapping information of the given NDRange, or nullptr if
+  // it is not mapped to the GPU
+  MappedNDRange* getMappedNDRange(NDRange* ndrange) const;
 
   // Statistics
   std::map<unsigned, std::unique_ptr<class CycleStats>> ndrange_stats;
   misc::Debug ndrange_stats_file;
 
+  // Counters of all compute units accumulated while each NDRange was
+  // mapped, indexed by NDRange identifier. Counters are not tagged with
+  // the NDRange that incremented them, so only NDRanges that never ran
+  // at the same time as another one are recorded.
+  std::map<int, ComputeUnitStats> ndrange_counters;
+
+  // Identifiers of NDRanges that were mapped at the same time as another
+  // one, left out of the counters above
+  std::set<int> overlapped_ndrange_ids;
+
+  // Time series of the compute unit counters
+  misc::Debug counters_series;
+
+  // Counters of each compute unit when last sampled into the time series
+  std::vector<ComputeUnitStats> sampled_counters;
+
+  // Return the sum of the counters of all compute units
+  ComputeUnitStats getCounters() const;
+
+  // Dump the increment of the counters of each compute unit into the time
+  // series, if the current cycle ends a sampling interval
+  void SampleCounters();
+
+  // Ports of the instruction caches shared by several compute units
+  std::vector<std::unique_ptr<InstructionCachePort>> instruction_cache_ports;
+
+  //
+  // Parallel simulation
+  //
+
+  // Host threads simulating the compute units, created the first time
+  // compute units are simulated in parallel
+  std::unique_ptr<misc::HostThreadPool> host_thread_pool;
+
+  // Flag set while compute units are simulated by multiple host threads
+  bool parallel = false;
+
+  // Return the index of the compute unit that runs first in the current
+  // cycle. Compute units run in increasing index order from it.
+  int getFirstComputeUnit() const;
+
+  // Return whether compute units can be simulated on multiple host
+  // threads. Traces, debug information, and statistics are written to
+  // shared files, so they force the sequential simulation.
+  static bool canRunParallel();
+
+  // Simulate one cycle of all compute units on multiple host threads
+  void RunParallel();
+
+  // Create the host threads
+  void StartHostThreads();
+
+  // Make host threads finish and wait for them
+  void StopHostThreads();
+
  public:
   //
   // Static members
@@ -93,6 +177,20 @@ class Gpu {
   // Number of compute units
   static int num_compute_units;
 
+  // Number of compute units sharing scalar and instruction caches in the
+  // default memory configuration
+  static int compute_units_per_cluster;
+
+  // Maximum number of work-groups mapped to a compute unit at a time, or
+  // 0 if only limited by the compute unit resources
+  static int max_work_groups_per_compute_unit;
+
+  // Rotate the compute unit that runs first in each cycle
+  static bool rotate_compute_units;
+
+  // Number of host threads simulating compute units in parallel
+  static int num_host_threads;
+
   //
   // Configuration
   //
@@ -104,9 +202,19 @@ class Gpu {
   /// Last cycle when uop completed execution
   long long last_complete_cycle = 0;
 
+  /// Number of cycles in which all compute units with work-groups mapped
+  /// were sleeping, waiting on the memory hierarchy or pipeline latencies
+  long long num_stalled_cycles = 0;
+
   /// Constructor
   Gpu();
 
+  /// Destructor
+  ~Gpu();
+
+  /// Return whether compute units are simulated by multiple host threads
+  bool isParallel() const { return parallel; }
+
   /// Return the iterator of an available compute unit. If no compute
   /// units are available a nullptr is returned.
   ComputeUnit* getAvailableComputeUnit();
@@ -125,30 +233,66 @@ class Gpu {
     return compute_units[index].get();
   }
 
-  /// Return the number of work groups per compute unit
-  int getWorkGroupsPerComputeUnit() const {
-    return work_groups_per_compute_unit;
+  /// Return the number of work-groups of the given mapped NDRange that
+  /// fit in a compute unit
+  int getWorkGroupsPerComputeUnit(NDRange* ndrange) const {
+    MappedNDRange* mapped_ndrange = getMappedNDRange(ndrange);
+    assert(mapped_ndrange);
+    return mapped_ndrange->work_groups_per_compute_unit;
+  }
+
+  /// Return the number of wavefronts of the given mapped NDRange that fit
+  /// in a compute unit
+  int getWavefrontsPerComputeUnit(NDRange* ndrange) const {
+    MappedNDRange* mapped_ndrange = getMappedNDRange(ndrange);
+    assert(mapped_ndrange);
+    return mapped_ndrange->wavefronts_per_compute_unit;
   }
 
-  /// Return the number of wavefronts per compute unit
-  int getWavefrontsPerComputeUnit() const {
-    return wavefronts_per_compute_unit;
+  /// Return the resources allocated in a wavefront pool by each
+  /// work-group of the given NDRange, or nullptr if the NDRange is not
+  /// mapped to the GPU
+  const WorkGroupResources* getWorkGroupResources(NDRange* ndrange) const {
+    MappedNDRange* mapped_ndrange = getMappedNDRange(ndrange);
+    return mapped_ndrange ? &mapped_ndrange->work_group_resources : nullptr;
   }
 
+  /// Return the number of NDRanges mapped to the GPU
+  int getNumMappedNDRanges() const { return mapped_ndranges.size(); }
+
+  /// Return the position of the given NDRange among the NDRanges mapped
+  /// to the GPU, in mapping order, or -1 if it is not mapped
+  int getMappedNDRangeIndex(NDRange* ndrange) const;
+
+  /// Return whether the given compute unit can take a work-group of any
+  /// of the mapped NDRanges
+  bool canMapWorkGroup(ComputeUnit* compute_unit) const;
+
+  /// Return the work-group dispatcher
+  Dispatcher* getDispatcher() const { return dispatcher.get(); }
+
+  /// Return the work-group sampler
+  Sampler* getSampler() const { return sampler.get(); }
+
   /// Return the associated MMU
   mem::Mmu* getMmu() const { return mmu.get(); }
 
-  /// Map an NDRange to the GPU object
+  /// Map an NDRange to the GPU object. NDRanges already mapped keep
+  /// running.
   void MapNDRange(NDRange* ndrange);
 
-  // Unmap an NDRange from the GPU
+  /// Unmap an NDRange from the GPU. Compute units are reset once no
+  /// NDRange is left.
   void UnmapNDRange(NDRange* ndrange);
 
-  // Calculate the number of allowed work groups per wavefront pool
-  void CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
-                                         int vector_registers_per_work_item,
-                                         int scalar_registers_per_wavefront,
-                                         int local_memory_per_work_group);
+  /// Calculate the number of allowed work groups per wavefront pool, and
+  /// the resources allocated in a wavefront pool by each work-group,
+  /// returned in \a resources.
+  int CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
+                                        int vector_registers_per_work_item,
+                                        int scalar_registers_per_wavefront,
+                                        int local_memory_per_work_group,
+                                        WorkGroupResources* resources);
 
   /// Return an iterator to the first compute unit
   std::vector<std::unique_ptr<ComputeUnit>>::iterator getComputeUnitsBegin() {
@@ -173,12 +317,17 @@ class Gpu {
   /// Advance one cycle in the GPU state
   void Run();
 
+  /// Create the port of an instruction cache shared by \a num_sharers
+  /// compute units. The port is arbitrated at the end of every cycle.
+  InstructionCachePort* addInstructionCachePort(int num_sharers) {
+    instruction_cache_ports.emplace_back(
+        misc::new_unique<InstructionCachePort>(num_sharers));
+    return instruction_cache_ports.back().get();
+  }
+
   /// Add a compute unit to the list of available compute units
   ComputeUnit* AddComputeUnit(ComputeUnit* compute_unit);
 
-  /// Getter for the mapped NDRange of the GPU
-  NDRange* getNDRange() const { return mapped_ndrange; }
-
   /// Getter for ndrange_stats
   class CycleStats* getNDRangeStatsById(unsigned ndrange_id) {
     auto it = ndrange_stats.find(ndrange_id);
@@ -197,6 +346,14 @@ class Gpu {
   /// Flush statistics info
   void FlushStats(NDRange* ndrange);
 
+  /// Return the counters of all compute units accumulated while each
+  /// NDRange was mapped, indexed by NDRange identifier. NDRanges that
+  /// overlapped with another one are left out, since the counters of
+  /// their shared cycles cannot be split among them.
+  const std::map<int, ComputeUnitStats>& getNDRangeCounters() const {
+    return ndrange_counters;
+  }
+
   /// GPU compute units statistics
   std::unique_ptr<ExecutionUnitStatisticsModule> gpu_stats;
 };
@@ -0,0 +1,84 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cassert>
+
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/WorkGroup.h>
+
+#include "Gpu.h"
+#include "Timing.h"
+
+namespace SI {
+
+bool Gpu::canRunParallel() {
+  return !Timing::trace && !Timing::pipeline_debug && !Timing::m2svis &&
+         !Timing::statistics_level && !Emulator::isa_debug &&
+         !Emulator::scheduler_debug;
+}
+
+void Gpu::RunParallel() {
+  // Create host threads the first time
+  if (!host_thread_pool) StartHostThreads();
+
+  // Run the cycle. Global memory accesses of the emulator are locked only
+  // while compute units run on multiple host threads.
+  Emulator* emulator = Emulator::getInstance();
+  emulator->setParallel(true);
+  try {
+    host_thread_pool->Run(num_compute_units,
+                          [this](int index) { compute_units[index]->Run(); });
+  } catch (...) {
+    emulator->setParallel(false);
+    throw;
+  }
+  emulator->setParallel(false);
+
+  // Submit the memory accesses and work-group unmappings buffered by each
+  // compute unit, in the same order in which compute units run in the
+  // sequential simulation. The memory hierarchy then sees the same
+  // sequence of accesses regardless of the number of host threads.
+  int start_cu = getFirstComputeUnit();
+  for (int i = 0; i < num_compute_units; ++i) {
+    int index = (i + start_cu) % num_compute_units;
+    compute_units[index]->SubmitBufferedRequests();
+  }
+}
+
+void Gpu::StartHostThreads() {
+  // Create host threads
+  assert(!host_thread_pool);
+  host_thread_pool = misc::new_unique<misc::HostThreadPool>(num_host_threads);
+
+  // Compute units buffer their requests to shared structures from now on
+  parallel = true;
+  for (auto& compute_unit : compute_units) compute_unit->setParallel(true);
+}
+
+void Gpu::StopHostThreads() {
+  // Host threads not created
+  if (!host_thread_pool) return;
+
+  // Make host threads finish
+  parallel = false;
+  host_thread_pool = nullptr;
+}
+
+}  // namespace SI
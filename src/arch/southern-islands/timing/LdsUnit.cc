@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
 #include <arch/southern-islands/emulator/WorkItem.h>
@@ -105,12 +107,37 @@ bool LdsUnit::isValidUop(Uop* uop) const {
   return true;
 }
 
+long long LdsUnit::getWakeupCycle(long long cycle, int*& witness) const {
+  // Instructions in more than one stage can advance in the next cycle
+  int num_busy_stages = !issue_buffer.empty() + !decode_buffer.empty() +
+                        !read_buffer.empty() + !mem_buffer.empty() +
+                        !write_buffer.empty();
+  if (!num_busy_stages) return NoWakeup;
+  if (num_busy_stages > 1) return cycle + 1;
+
+  // Otherwise, the oldest instruction of the only busy stage is the first
+  // one to advance
+  if (!write_buffer.empty())
+    return std::max(cycle + 1, write_buffer.front()->write_ready);
+  if (!mem_buffer.empty()) {
+    Uop* uop = mem_buffer.front().get();
+    if (!uop->lds_witness) return cycle + 1;
+    witness = &uop->lds_witness;
+    return NoWakeup;
+  }
+  if (!read_buffer.empty())
+    return std::max(cycle + 1, read_buffer.front()->read_ready);
+  if (!decode_buffer.empty())
+    return std::max(cycle + 1, decode_buffer.front()->decode_ready);
+  return std::max(cycle + 1, issue_buffer.front()->issue_ready);
+}
+
 void LdsUnit::Issue(std::unique_ptr<Uop> uop) {
   // Get compute unit
   ComputeUnit* compute_unit = getComputeUnit();
 
   // One more instruction of this kind
-  compute_unit->stats.num_lds_insts_++;
+  compute_unit->stats.Increment(CounterLdsInstructions);
   uop->getWavefrontPoolEntry()->lgkm_cnt++;
 
   // Issue it
@@ -150,7 +177,7 @@ void LdsUnit::Complete() {
     uop->cycle_length = uop->cycle_finish - uop->cycle_start;
 
     // Trace for m2svis
-    Timing::m2svis << uop->getLifeCycleInCSV("lds");
+    if (Timing::m2svis) Timing::m2svis << uop->getLifeCycleInCSV("lds");
 
     // Update pipeline stage status
     WriteStatus = Active;
@@ -176,8 +203,7 @@ void LdsUnit::Complete() {
 
     // Statistics
     num_instructions++;
-    compute_unit->getGpu()->last_complete_cycle =
-        compute_unit->getTiming()->getCycle();
+    compute_unit->CompleteUop();
 
     // Update info if statistics enables
     if (Timing::statistics_level >= 2) {
@@ -258,8 +284,7 @@ void LdsUnit::Write() {
       // Update pipeline stage status
       WriteStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_write_++;
-      if (interval_file_) interval_stats_.num_stall_write_++;
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -297,8 +322,7 @@ void LdsUnit::Write() {
       // Update pipeline stage status
       WriteStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_write_++;
-      if (interval_file_) interval_stats_.num_stall_write_++;
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -394,8 +418,7 @@ void LdsUnit::Mem() {
       // Update pipeline stage status
       ExecutionStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_execution_++;
-      if (interval_file_) interval_stats_.num_stall_execution_++;
+      Count(CounterStallExecution);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -436,8 +459,7 @@ void LdsUnit::Mem() {
       // Update pipeline stage status
       ExecutionStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_execution_++;
-      if (interval_file_) interval_stats_.num_stall_execution_++;
+      Count(CounterStallExecution);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -484,8 +506,9 @@ void LdsUnit::Mem() {
         }
 
         // Start access
-        compute_unit->getLdsModule()->Access(
-            access_type, work_item_info->lds_access[i].addr, &uop->lds_witness);
+        compute_unit->Access(compute_unit->getLdsModule(), access_type,
+                             nullptr, work_item_info->lds_access[i].addr,
+                             &uop->lds_witness);
         uop->lds_witness--;
       }
     }
@@ -559,8 +582,7 @@ void LdsUnit::Read() {
       // Update pipeline stage status
       ReadStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_read_++;
-      if (interval_file_) interval_stats_.num_stall_read_++;
+      Count(CounterStallRead);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -595,8 +617,7 @@ void LdsUnit::Read() {
       // Update pipeline stage status
       ReadStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_read_++;
-      if (interval_file_) interval_stats_.num_stall_read_++;
+      Count(CounterStallRead);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -692,8 +713,7 @@ void LdsUnit::Decode() {
       // Update pipeline stage status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -729,8 +749,7 @@ void LdsUnit::Decode() {
       // Update pipeline stage status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
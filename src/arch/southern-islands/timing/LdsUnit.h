@@ -92,6 +92,10 @@ class LdsUnit : public ExecutionUnit {
   /// Return whether the given uop is a LDS instruction.
   bool isValidUop(Uop* uop) const override;
 
+  /// Return the first cycle after \a cycle in which the LDS unit can
+  /// change state, or wait for the LDS access of its oldest instruction.
+  long long getWakeupCycle(long long cycle, int*& witness) const override;
+
   /// Issue the given instruction into the LDS unit.
   void Issue(std::unique_ptr<Uop> uop) override;
 
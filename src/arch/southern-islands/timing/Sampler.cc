@@ -0,0 +1,296 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cmath>
+#include <set>
+
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/southern-islands/emulator/Wavefront.h>
+#include <arch/southern-islands/emulator/WorkGroup.h>
+#include <lib/cpp/Misc.h>
+
+#include "Gpu.h"
+#include "Sampler.h"
+#include "Timing.h"
+
+namespace SI {
+
+misc::StringMap Sampler::kind_map = {{"None", KindNone},
+                                     {"First", KindFirst},
+                                     {"Random", KindRandom},
+                                     {"Stratified", KindStratified}};
+
+Sampler::Kind Sampler::kind = KindNone;
+int Sampler::num_detailed_work_groups = 0;
+unsigned Sampler::seed = 1;
+
+Sampler::Sampler(Gpu* gpu) : gpu(gpu), random_engine(seed) {}
+
+Sampler::NDRangeSample* Sampler::getSample(NDRange* ndrange) {
+  auto it = samples.find(ndrange->getId());
+  return it == samples.end() ? nullptr : it->second.get();
+}
+
+void Sampler::getCacheStatistics(long long& accesses, long long& hits) const {
+  // Caches may be shared by several compute units
+  std::set<mem::Module*> modules;
+  for (auto it = gpu->getComputeUnitsBegin(), e = gpu->getComputeUnitsEnd();
+       it != e; ++it) {
+    ComputeUnit* compute_unit = it->get();
+    if (compute_unit->vector_cache) modules.insert(compute_unit->vector_cache);
+    if (compute_unit->scalar_cache) modules.insert(compute_unit->scalar_cache);
+  }
+
+  // Add up statistics
+  accesses = 0;
+  hits = 0;
+  for (mem::Module* module : modules) {
+    accesses += module->num_reads + module->num_writes + module->num_nc_writes;
+    hits += module->num_read_hits + module->num_write_hits +
+            module->num_nc_write_hits;
+  }
+}
+
+void Sampler::MapNDRange(NDRange* ndrange) {
+  // Nothing to do without sampling
+  if (!isEnabled()) return;
+
+  // An NDRange mapped again after the driver sent more work-groups keeps
+  // its sample, which is closed again when it is next unmapped
+  auto it = samples.find(ndrange->getId());
+  if (it != samples.end()) {
+    it->second->finished = false;
+    return;
+  }
+
+  // Create sample
+  auto sample = misc::new_unique<NDRangeSample>();
+  sample->id = ndrange->getId();
+  sample->kernel_name = ndrange->getKernelName();
+  sample->num_work_groups = ndrange->getGroupCount(0) *
+                            ndrange->getGroupCount(1) *
+                            ndrange->getGroupCount(2);
+  sample->max_running_work_groups =
+      gpu->getWorkGroupsPerComputeUnit(ndrange) * Gpu::num_compute_units;
+  sample->map_cycle = Timing::getInstance()->getCycle();
+  getCacheStatistics(sample->cache_accesses_begin, sample->cache_hits_begin);
+
+  // The stratified policy picks one work-group at random from each of
+  // 'num_detailed_work_groups' equally sized groups of consecutive
+  // work-groups
+  if (kind == KindStratified) {
+    int num_strata =
+        std::min(num_detailed_work_groups, sample->num_work_groups);
+    for (int i = 0; i < num_strata; i++) {
+      int first = (long long)i * sample->num_work_groups / num_strata;
+      int last = (long long)(i + 1) * sample->num_work_groups / num_strata - 1;
+      std::uniform_int_distribution<int> distribution(first, last);
+      sample->detailed_positions.push_back(distribution(random_engine));
+    }
+  }
+
+  // Save it
+  samples[sample->id] = std::move(sample);
+}
+
+void Sampler::UnmapNDRange(NDRange* ndrange) {
+  // Only the first unmapping after each mapping counts
+  NDRangeSample* sample = getSample(ndrange);
+  if (!sample || sample->finished) return;
+
+  // Record cycles and cache statistics
+  sample->finished = true;
+  sample->unmap_cycle = Timing::getInstance()->getCycle();
+  long long cache_accesses;
+  long long cache_hits;
+  getCacheStatistics(cache_accesses, cache_hits);
+  sample->cache_accesses = cache_accesses - sample->cache_accesses_begin;
+  sample->cache_hits = cache_hits - sample->cache_hits_begin;
+}
+
+bool Sampler::isNextWorkGroupDetailed(NDRange* ndrange) {
+  // Everything is detailed without sampling
+  NDRangeSample* sample = getSample(ndrange);
+  if (!sample) return true;
+
+  // Decision already taken
+  if (sample->next_detailed >= 0) return sample->next_detailed;
+
+  // Take decision
+  bool detailed = false;
+  switch (kind) {
+    case KindFirst:
+      detailed = sample->num_dispatched < num_detailed_work_groups;
+      break;
+
+    case KindRandom: {
+      // Selection sampling, picking exactly 'num_detailed_work_groups'
+      // work-groups with equal probability
+      int num_left = sample->num_work_groups - sample->num_dispatched;
+      int num_needed = num_detailed_work_groups - sample->num_detailed;
+      if (num_left > 0 && num_needed > 0) {
+        std::uniform_int_distribution<int> distribution(0, num_left - 1);
+        detailed = distribution(random_engine) < num_needed;
+      }
+      break;
+    }
+
+    case KindStratified:
+      detailed =
+          sample->num_detailed < (int)sample->detailed_positions.size() &&
+          sample->detailed_positions[sample->num_detailed] ==
+              sample->num_dispatched;
+      break;
+
+    default:
+      throw misc::Panic("Invalid sampling kind");
+  }
+  sample->next_detailed = detailed;
+  return detailed;
+}
+
+bool Sampler::DispatchWorkGroup(WorkGroup* work_group) {
+  // Everything is detailed without sampling
+  NDRange* ndrange = work_group->getNDRange();
+  NDRangeSample* sample = getSample(ndrange);
+  if (!sample) return true;
+
+  // Consume decision
+  bool detailed = isNextWorkGroupDetailed(ndrange);
+  sample->next_detailed = -1;
+  sample->num_dispatched++;
+  if (detailed) {
+    sample->num_detailed++;
+    return true;
+  }
+
+  // Execute the work-group functionally and release it
+  Emulator* emulator = Emulator::getInstance();
+  long long num_instructions = emulator->getNumInstructions();
+  Emulator::RunWorkGroup(work_group);
+  sample->functional_instructions +=
+      emulator->getNumInstructions() - num_instructions;
+  ndrange->RemoveWorkGroup(work_group);
+  return false;
+}
+
+void Sampler::MapWorkGroup(WorkGroup* work_group) {
+  NDRangeSample* sample = getSample(work_group->getNDRange());
+  if (!sample) return;
+  sample->work_group_map_cycles[work_group->getId()] =
+      Timing::getInstance()->getCycle();
+}
+
+void Sampler::UnmapWorkGroup(WorkGroup* work_group) {
+  // Get map cycle
+  NDRangeSample* sample = getSample(work_group->getNDRange());
+  if (!sample) return;
+  auto it = sample->work_group_map_cycles.find(work_group->getId());
+  if (it == sample->work_group_map_cycles.end()) return;
+
+  // Record latency
+  double latency = Timing::getInstance()->getCycle() - it->second;
+  sample->work_group_map_cycles.erase(it);
+  sample->latency_sum += latency;
+  sample->latency_sum_squares += latency * latency;
+  sample->num_completed++;
+
+  // Record instructions, one uop per instruction
+  for (auto wf_it = work_group->getWavefrontsBegin(),
+            wf_e = work_group->getWavefrontsEnd();
+       wf_it != wf_e; ++wf_it)
+    sample->detailed_instructions += (*wf_it)->getNumUops();
+}
+
+void Sampler::DumpReport(std::ostream& os) const {
+  for (auto& it : samples) {
+    NDRangeSample* sample = it.second.get();
+
+    // Detailed cycles. NDRanges cut short by a simulation limit end now.
+    long long cycles =
+        (sample->finished ? sample->unmap_cycle
+                          : Timing::getInstance()->getCycle()) -
+        sample->map_cycle;
+
+    // Cycles are extrapolated by the number of waves of work-groups that
+    // fill up the GPU, so that samples smaller than the GPU are not
+    // scaled up linearly.
+    int num_work_groups = sample->num_work_groups;
+    int num_detailed = sample->num_detailed;
+    int max_running = std::max(sample->max_running_work_groups, 1);
+    int num_waves = (num_work_groups + max_running - 1) / max_running;
+    int num_detailed_waves = (num_detailed + max_running - 1) / max_running;
+    double estimated_cycles =
+        num_detailed_waves ? (double)cycles * num_waves / num_detailed_waves
+                           : 0.0;
+
+    // Error estimate, as the 95% confidence interval of the mean latency
+    // of detailed work-groups, relative to the mean
+    double cycles_error = 0.0;
+    int n = sample->num_completed;
+    if (n > 1 && num_work_groups > 1 && sample->latency_sum > 0.0) {
+      double mean = sample->latency_sum / n;
+      double variance =
+          std::max(0.0, (sample->latency_sum_squares - n * mean * mean) /
+                            (n - 1));
+      double population_correction =
+          std::sqrt((double)(num_work_groups - n) / (num_work_groups - 1));
+      cycles_error = 1.96 * std::sqrt(variance / n) * population_correction /
+                     mean * 100.0;
+    }
+
+    // Instructions and cache accesses are extrapolated by the ratio of
+    // total to detailed instructions
+    long long instructions =
+        sample->detailed_instructions + sample->functional_instructions;
+    double instruction_ratio =
+        sample->detailed_instructions
+            ? (double)instructions / sample->detailed_instructions
+            : 0.0;
+    double instructions_per_cycle =
+        cycles ? (double)sample->detailed_instructions / cycles : 0.0;
+    double hit_ratio = sample->cache_accesses
+                           ? (double)sample->cache_hits / sample->cache_accesses
+                           : 0.0;
+
+    // Dump
+    os << misc::fmt("[ Sample.NDRange %d ]\n\n", sample->id);
+    os << misc::fmt("Kernel = %s\n", sample->kernel_name.c_str());
+    os << misc::fmt("WorkGroups = %d\n", num_work_groups);
+    os << misc::fmt("DetailedWorkGroups = %d\n", num_detailed);
+    os << misc::fmt("FunctionalWorkGroups = %d\n",
+                    sample->num_dispatched - num_detailed);
+    os << misc::fmt("DetailedCycles = %lld\n", cycles);
+    os << misc::fmt("DetailedInstructions = %lld\n",
+                    sample->detailed_instructions);
+    os << misc::fmt("Instructions = %lld\n", instructions);
+    os << misc::fmt("InstructionsPerCycle = %.4g\n", instructions_per_cycle);
+    os << misc::fmt("EstimatedCycles = %.0f\n", estimated_cycles);
+    os << misc::fmt("EstimatedCyclesError = %.2f%%\n", cycles_error);
+    os << misc::fmt("CacheAccesses = %lld\n", sample->cache_accesses);
+    os << misc::fmt("CacheHitRatio = %.4g\n", hit_ratio);
+    os << misc::fmt("EstimatedCacheAccesses = %.0f\n",
+                    sample->cache_accesses * instruction_ratio);
+    os << "\n\n";
+  }
+}
+
+}  // namespace SI
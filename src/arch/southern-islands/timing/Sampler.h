@@ -0,0 +1,179 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef ARCH_SOUTHERN_ISLANDS_TIMING_SAMPLER_H
+#define ARCH_SOUTHERN_ISLANDS_TIMING_SAMPLER_H
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <lib/cpp/String.h>
+
+namespace SI {
+
+// Forward declarations
+class Gpu;
+class NDRange;
+class WorkGroup;
+
+/// Work-group sampler. Only a subset of the work-groups of each NDRange is
+/// simulated in detail. The rest are executed functionally as soon as they
+/// are dispatched, so the program output is not affected, and the cycles,
+/// IPC, and cache statistics of the NDRange are extrapolated from the
+/// detailed work-groups.
+class Sampler {
+ public:
+  /// Sampling policy
+  enum Kind {
+    KindInvalid = 0,
+    KindNone,
+    KindFirst,
+    KindRandom,
+    KindStratified
+  };
+
+  /// String map for values of type Kind
+  static misc::StringMap kind_map;
+
+  /// Sampling policy, configured by the user
+  static Kind kind;
+
+  /// Number of work-groups simulated in detail per NDRange
+  static int num_detailed_work_groups;
+
+  /// Seed for the random sampling policies
+  static unsigned seed;
+
+ private:
+  // Sampling state and statistics of an NDRange
+  struct NDRangeSample {
+    // NDRange identifier
+    int id;
+
+    // Kernel name
+    std::string kernel_name;
+
+    // Total number of work-groups in the NDRange
+    int num_work_groups;
+
+    // Number of work-groups of the NDRange that can run on the GPU at a
+    // time
+    int max_running_work_groups;
+
+    // Positions in dispatch order of the work-groups simulated in detail,
+    // for the stratified policy
+    std::vector<int> detailed_positions;
+
+    // Decision for the next work-group, or -1 if not taken yet
+    int next_detailed = -1;
+
+    // Number of work-groups dispatched so far
+    int num_dispatched = 0;
+
+    // Number of work-groups selected for detailed simulation
+    int num_detailed = 0;
+
+    // Number of detailed work-groups completed
+    int num_completed = 0;
+
+    // Cycles when the NDRange was mapped and unmapped
+    long long map_cycle = 0;
+    long long unmap_cycle = 0;
+
+    // Flag set when the NDRange was unmapped
+    bool finished = false;
+
+    // Instructions executed by detailed and functional work-groups
+    long long detailed_instructions = 0;
+    long long functional_instructions = 0;
+
+    // Cycle when each running detailed work-group was mapped, indexed by
+    // work-group identifier
+    std::unordered_map<int, long long> work_group_map_cycles;
+
+    // Sum and sum of squares of detailed work-group latencies
+    double latency_sum = 0.0;
+    double latency_sum_squares = 0.0;
+
+    // Cache accesses and hits when the NDRange was mapped, and while it
+    // ran
+    long long cache_accesses_begin = 0;
+    long long cache_hits_begin = 0;
+    long long cache_accesses = 0;
+    long long cache_hits = 0;
+  };
+
+  // Associated GPU
+  Gpu* gpu;
+
+  // Random number generator for the random sampling policies
+  std::mt19937 random_engine;
+
+  // Samples of all NDRanges mapped so far, indexed by NDRange identifier
+  std::map<int, std::unique_ptr<NDRangeSample>> samples;
+
+  // Return the sample of the given NDRange, or nullptr if it was not
+  // mapped with sampling enabled
+  NDRangeSample* getSample(NDRange* ndrange);
+
+  // Add up the accesses and hits of the caches used by the compute units
+  void getCacheStatistics(long long& accesses, long long& hits) const;
+
+ public:
+  /// Constructor
+  Sampler(Gpu* gpu);
+
+  /// Return whether work-group sampling is enabled
+  static bool isEnabled() { return kind != KindNone; }
+
+  /// Start sampling the given NDRange, just mapped to the GPU
+  void MapNDRange(NDRange* ndrange);
+
+  /// Finish sampling the given NDRange, about to be unmapped from the GPU
+  void UnmapNDRange(NDRange* ndrange);
+
+  /// Return whether the next work-group dispatched from the given NDRange
+  /// is simulated in detail. The decision holds until the work-group is
+  /// dispatched with DispatchWorkGroup().
+  bool isNextWorkGroupDetailed(NDRange* ndrange);
+
+  /// Record that the next work-group of its NDRange was dispatched. If it
+  /// is not simulated in detail, it is executed functionally and removed
+  /// from the NDRange, and the function returns false.
+  bool DispatchWorkGroup(WorkGroup* work_group);
+
+  /// Record that a detailed work-group was mapped to a compute unit
+  void MapWorkGroup(WorkGroup* work_group);
+
+  /// Record that a detailed work-group was unmapped from its compute unit
+  void UnmapWorkGroup(WorkGroup* work_group);
+
+  /// Dump the extrapolated statistics of all sampled NDRanges
+  void DumpReport(std::ostream& os) const;
+};
+
+}  // namespace SI
+
+#endif
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/southern-islands/emulator/NDRange.h>
 #include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
@@ -118,6 +120,33 @@ bool ScalarUnit::isValidUop(Uop* uop) const {
   return true;
 }
 
+long long ScalarUnit::getWakeupCycle(long long cycle, int*& witness) const {
+  // Instructions in more than one stage can advance in the next cycle
+  int num_busy_stages = !issue_buffer.empty() + !decode_buffer.empty() +
+                        !read_buffer.empty() + !exec_buffer.empty() +
+                        !write_buffer.empty();
+  if (!num_busy_stages) return NoWakeup;
+  if (num_busy_stages > 1) return cycle + 1;
+
+  // Otherwise, the oldest instruction of the only busy stage is the first
+  // one to advance
+  if (!write_buffer.empty())
+    return std::max(cycle + 1, write_buffer.front()->write_ready);
+  if (!exec_buffer.empty()) {
+    Uop* uop = exec_buffer.front().get();
+    if (!uop->scalar_memory_read)
+      return std::max(cycle + 1, uop->execute_ready);
+    if (!uop->global_memory_witness) return cycle + 1;
+    witness = &uop->global_memory_witness;
+    return NoWakeup;
+  }
+  if (!read_buffer.empty())
+    return std::max(cycle + 1, read_buffer.front()->read_ready);
+  if (!decode_buffer.empty())
+    return std::max(cycle + 1, decode_buffer.front()->decode_ready);
+  return std::max(cycle + 1, issue_buffer.front()->issue_ready);
+}
+
 void ScalarUnit::Issue(std::unique_ptr<Uop> uop) {
   // One more instruction of this kind
   ComputeUnit* compute_unit = getComputeUnit();
@@ -126,12 +155,12 @@ void ScalarUnit::Issue(std::unique_ptr<Uop> uop) {
     uop->getWavefrontPoolEntry()->ready_next_cycle = true;
 
     // Keep track of statistics
-    compute_unit->stats.num_scalar_memory_insts_++;
+    compute_unit->stats.Increment(CounterScalarMemoryInstructions);
     uop->getWavefrontPoolEntry()->lgkm_cnt++;
   } else {
     // Scalar ALU instructions must complete before the next
     // instruction can be fetched.
-    compute_unit->stats.num_scalar_alu_insts_++;
+    compute_unit->stats.Increment(CounterScalarAluInstructions);
   }
 
   // Issue it
@@ -144,7 +173,6 @@ void ScalarUnit::Issue(std::unique_ptr<Uop> uop) {
 void ScalarUnit::Complete() {
   // Get useful objects
   ComputeUnit* compute_unit = getComputeUnit();
-  Gpu* gpu = compute_unit->getGpu();
 
   // Initialize iterator
   auto it = write_buffer.begin();
@@ -175,8 +203,7 @@ void ScalarUnit::Complete() {
       // Update pipeline stage status
       WriteStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_write_++;
-      if (interval_file_) interval_stats_.num_stall_write_++;
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -247,6 +274,9 @@ void ScalarUnit::Complete() {
       }
     }
 
+    // Whether the uop finishes its work group
+    bool work_group_finished = false;
+
     if (uop->wavefront_last_instruction) {
       // If the Uop completes the wavefront, set a bit
       // so that the hardware wont try to fetch any
@@ -255,7 +285,7 @@ void ScalarUnit::Complete() {
       work_group->incWavefrontsCompletedTiming();
 
       // Global count of completed wavefronts
-      Gpu::count_completed_wavefronts++;
+      compute_unit->CompleteWavefront();
       // printf("Complete WF %d in CU %d, %d completed globally.\n",
       //        uop->getWavefront()->getIdInComputeUnit(),
       //        uop->getComputeUnit()->getIndex(),
@@ -271,15 +301,15 @@ void ScalarUnit::Complete() {
       assert(work_group->getWavefrontsCompletedTiming() <=
              work_group->getWavefrontsInWorkgroup());
 
-      // Check if the work group is finished. If so, unmap
-      // the work group
+      // Check if the work group is finished. If so, it is unmapped
+      // once the uop is done with it below.
       if (work_group->finished_timing &&
           work_group->inflight_instructions == 1) {
         Timing::pipeline_debug << misc::fmt(
             "wg=%d "
             "WGFinished\n",
             work_group->getId());
-        compute_unit->UnmapWorkGroup(uop->getWorkGroup());
+        work_group_finished = true;
       }
     }
 
@@ -291,7 +321,7 @@ void ScalarUnit::Complete() {
     WriteStatus = Active;
 
     // Trace for m2svis
-    Timing::m2svis << uop->getLifeCycleInCSV("scalar");
+    if (Timing::m2svis) Timing::m2svis << uop->getLifeCycleInCSV("scalar");
 
     // Update statistics
     if (overview_file_)
@@ -314,7 +344,7 @@ void ScalarUnit::Complete() {
 
     // Statistics
     num_instructions++;
-    gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+    compute_unit->CompleteUop();
 
     // Update info if statistics enables
     if (Timing::statistics_level >= 2) {
@@ -345,6 +375,10 @@ void ScalarUnit::Complete() {
         }
       }
     }
+
+    // Unmapping the work group releases its wavefronts, so it is done
+    // after the last access to them through the uop
+    if (work_group_finished) compute_unit->UnmapWorkGroup(work_group);
   }
 }
 
@@ -396,8 +430,7 @@ void ScalarUnit::Write() {
         // Update pipeline status
         WriteStatus = Stall;
 
-        if (overview_file_) overview_stats_.num_stall_write_++;
-        if (interval_file_) interval_stats_.num_stall_write_++;
+        Count(CounterStallWrite);
 
         // Trace
         Timing::trace << misc::fmt(
@@ -435,8 +468,7 @@ void ScalarUnit::Write() {
         // Update pipeline status
         WriteStatus = Stall;
 
-        if (overview_file_) overview_stats_.num_stall_write_++;
-        if (interval_file_) interval_stats_.num_stall_write_++;
+        Count(CounterStallWrite);
 
         // Trace
         Timing::trace << misc::fmt(
@@ -504,8 +536,7 @@ void ScalarUnit::Write() {
         // Update pipeline status
         WriteStatus = Stall;
 
-        if (overview_file_) overview_stats_.num_stall_write_++;
-        if (interval_file_) interval_stats_.num_stall_write_++;
+        Count(CounterStallWrite);
 
         // Trace
         Timing::trace << misc::fmt(
@@ -542,8 +573,7 @@ void ScalarUnit::Write() {
         // Update pipeline status
         WriteStatus = Stall;
 
-        if (overview_file_) overview_stats_.num_stall_write_++;
-        if (interval_file_) interval_stats_.num_stall_write_++;
+        Count(CounterStallWrite);
 
         // Trace
         Timing::trace << misc::fmt(
@@ -635,8 +665,7 @@ void ScalarUnit::Execute() {
       // Update pipeline status
       ExecutionStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_execution_++;
-      if (interval_file_) interval_stats_.num_stall_execution_++;
+      Count(CounterStallExecution);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -680,8 +709,7 @@ void ScalarUnit::Execute() {
       // Update pipeline status
       ExecutionStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_execution_++;
-      if (interval_file_) interval_stats_.num_stall_execution_++;
+      Count(CounterStallExecution);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -706,16 +734,13 @@ void ScalarUnit::Execute() {
                                               ->getScalarWorkItem()
                                               ->global_memory_access_address;
 
-      // Translate virtual address to physical address
-      unsigned phys_addr =
-          compute_unit->getGpu()->getMmu()->TranslateVirtualAddress(
-              uop->getWorkGroup()->getNDRange()->address_space,
-              uop->global_memory_access_address);
-
-      // Submit the access
-      compute_unit->scalar_cache->Access(mem::Module::AccessType::AccessLoad,
-                                         phys_addr,
-                                         &uop->global_memory_witness);
+      // Submit the access, translating the virtual address to a physical
+      // address
+      compute_unit->Access(compute_unit->scalar_cache,
+                           mem::Module::AccessType::AccessLoad,
+                           uop->getWorkGroup()->getNDRange()->address_space,
+                           uop->global_memory_access_address,
+                           &uop->global_memory_witness);
 
       // Update uop cycle
       uop->cycle_execute_begin = uop->read_ready;
@@ -818,8 +843,7 @@ void ScalarUnit::Read() {
       // Update pipeline status
       ReadStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_read_++;
-      if (interval_file_) interval_stats_.num_stall_read_++;
+      Count(CounterStallRead);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -857,8 +881,7 @@ void ScalarUnit::Read() {
       // Update pipeline status
       ReadStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_read_++;
-      if (interval_file_) interval_stats_.num_stall_read_++;
+      Count(CounterStallRead);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -945,8 +968,7 @@ void ScalarUnit::Decode() {
       // Update pipeline status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -984,8 +1006,7 @@ void ScalarUnit::Decode() {
       // Update pipeline status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -98,6 +98,11 @@ class ScalarUnit : public ExecutionUnit {
   /// Return whether the given uop is a scalar instruction.
   bool isValidUop(Uop* uop) const override;
 
+  /// Return the first cycle after \a cycle in which the scalar unit can
+  /// change state, or wait for the scalar memory read of its oldest
+  /// instruction.
+  long long getWakeupCycle(long long cycle, int*& witness) const override;
+
   /// Issue the given instruction into the scalar unit.
   void Issue(std::unique_ptr<Uop> uop) override;
 
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
 
@@ -93,10 +95,26 @@ bool SimdUnit::isValidUop(Uop* uop) const {
   return true;
 }
 
+long long SimdUnit::getWakeupCycle(long long cycle, int*& witness) const {
+  // Instructions in more than one stage can advance in the next cycle
+  int num_busy_stages =
+      !issue_buffer.empty() + !decode_buffer.empty() + !exec_buffer.empty();
+  if (!num_busy_stages) return NoWakeup;
+  if (num_busy_stages > 1) return cycle + 1;
+
+  // Otherwise, the oldest instruction of the only busy stage is the first
+  // one to advance
+  if (!exec_buffer.empty())
+    return std::max(cycle + 1, exec_buffer.front()->execute_ready);
+  if (!decode_buffer.empty())
+    return std::max(cycle + 1, decode_buffer.front()->decode_ready);
+  return std::max(cycle + 1, issue_buffer.front()->issue_ready);
+}
+
 void SimdUnit::Issue(std::unique_ptr<Uop> uop) {
   // One more instruction of this kind
   ComputeUnit* compute_unit = getComputeUnit();
-  compute_unit->stats.num_simd_insts_++;
+  compute_unit->stats.Increment(CounterSimdInstructions);
 
   // Issue it
   ExecutionUnit::Issue(std::move(uop));
@@ -108,7 +126,6 @@ void SimdUnit::Issue(std::unique_ptr<Uop> uop) {
 void SimdUnit::Complete() {
   // Get useful objects
   ComputeUnit* compute_unit = getComputeUnit();
-  Gpu* gpu = compute_unit->getGpu();
 
   // Sanity check exec buffer
   assert(int(exec_buffer.size()) <= exec_buffer_size);
@@ -136,7 +153,7 @@ void SimdUnit::Complete() {
     uop->cycle_length = uop->cycle_finish - uop->cycle_start;
 
     // Trace for m2svis
-    Timing::m2svis << uop->getLifeCycleInCSV("simd");
+    if (Timing::m2svis) Timing::m2svis << uop->getLifeCycleInCSV("simd");
 
     // Update pipeline stage status
     WriteStatus = Active;
@@ -156,7 +173,7 @@ void SimdUnit::Complete() {
 
     // Statistics
     num_instructions++;
-    gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+    compute_unit->CompleteUop();
 
     // Remove uop from the exec buffer and get the iterator to the
     // next element
@@ -244,17 +261,9 @@ void SimdUnit::Execute() {
       ExecutionStatus = Stall;
       WriteStatus = Stall;
 
-      if (overview_file_) {
-        overview_stats_.num_stall_read_++;
-        overview_stats_.num_stall_execution_++;
-        overview_stats_.num_stall_write_++;
-      }
-
-      if (interval_file_) {
-        interval_stats_.num_stall_read_++;
-        interval_stats_.num_stall_execution_++;
-        interval_stats_.num_stall_write_++;
-      }
+      Count(CounterStallRead);
+      Count(CounterStallExecution);
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -294,16 +303,9 @@ void SimdUnit::Execute() {
       ExecutionStatus = Stall;
       WriteStatus = Stall;
 
-      if (overview_file_) {
-        overview_stats_.num_stall_read_++;
-        overview_stats_.num_stall_execution_++;
-        overview_stats_.num_stall_write_++;
-      }
-      if (interval_file_) {
-        interval_stats_.num_stall_read_++;
-        interval_stats_.num_stall_execution_++;
-        interval_stats_.num_stall_write_++;
-      }
+      Count(CounterStallRead);
+      Count(CounterStallExecution);
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -411,8 +413,7 @@ void SimdUnit::Decode() {
       // Update pipeline stage status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -450,8 +451,7 @@ void SimdUnit::Decode() {
       // Update pipeline stage status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -94,6 +94,10 @@ class SimdUnit : public ExecutionUnit {
   /// Return whether the given uop is a SIMD instruction.
   bool isValidUop(Uop* uop) const override;
 
+  /// Return the first cycle after \a cycle in which the SIMD unit can
+  /// change state.
+  long long getWakeupCycle(long long cycle, int*& witness) const override;
+
   /// Issue the given instruction into the SIMD unit.
   void Issue(std::unique_ptr<Uop> uop) override;
 
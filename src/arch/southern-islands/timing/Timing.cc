@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <map>
+
 #include <arch/common/Arch.h>
 #include <arch/southern-islands/emulator/Emulator.h>
 #include <lib/cpp/CommandLine.h>
@@ -54,6 +56,7 @@ misc::Debug Timing::m2svis;
 
 int Timing::statistics_level = 0;
 int Timing::statistics_sampling_cycle = 1000;
+std::string Timing::counters_file;
 
 const std::string Timing::help_message =
     "The Southern Islands GPU configuration file is a plain text INI file\n"
@@ -72,6 +75,32 @@ const std::string Timing::help_message =
     "      Frequency for the Southern Islands GPU in MHz.\n"
     "  NumComputeUnits = <num> (Default = 32)\n"
     "      Number of compute units in the GPU.\n"
+    "  ComputeUnitsPerCluster = <num> (Default = 4)\n"
+    "      Number of consecutive compute units sharing a scalar cache and an\n"
+    "      instruction cache in the default memory configuration. The\n"
+    "      compute units sharing an instruction cache access it one per\n"
+    "      cycle, in round-robin order among those fetching a block.\n"
+    "  HostThreads = <num> (Default = 1)\n"
+    "      Number of host threads simulating compute units in parallel.\n"
+    "      Memory accesses are buffered by each compute unit and submitted\n"
+    "      to the memory hierarchy at the end of the cycle, in compute unit\n"
+    "      order. Traces, debug information, and statistics force a single\n"
+    "      host thread.\n"
+    "  DispatchKind = {RoundRobin|LeastLoaded|TailAware|Spatial}\n"
+    "      (Default = RoundRobin)\n"
+    "      Policy choosing the compute unit for each work-group. Work-groups\n"
+    "      of all running ND-Ranges share the compute units.\n"
+    "        RoundRobin: compute units in the order they became available.\n"
+    "        LeastLoaded: compute unit with the fewest mapped work-groups.\n"
+    "        TailAware: round-robin, with no compute unit receiving more\n"
+    "            than its even share of the work-groups of an ND-Range.\n"
+    "        Spatial: compute units are evenly partitioned among running\n"
+    "            ND-Ranges.\n"
+    "  MaxWorkGroupsPerComputeUnit = <num> (Default = 0)\n"
+    "      Maximum number of work-groups mapped to a compute unit at a time.\n"
+    "      A value of 0 only limits work-groups by the available resources.\n"
+    "  RotateComputeUnits = {t|f} (Default = False)\n"
+    "      Rotate the compute unit simulated first in each cycle.\n"
     "\n"
     "Section '[ ComputeUnit ]': parameters for the Compute Units.\n"
     "\n"
@@ -89,6 +118,11 @@ const std::string Timing::help_message =
     "  NumScalarRegisters = <num> (Default = 2048)\n"
     "      Number of scalar registers per compute unit. These are\n"
     "      shared by all wavefront pools/SIMDs.\n"
+    "  SkipIdleCycles = {t|f} (Default = True)\n"
+    "      Skip the cycles in which a compute unit only waits on memory\n"
+    "      accesses, barriers, or pipeline latencies. The simulation\n"
+    "      results do not change. Traces, debug information, and\n"
+    "      statistics disable skipping.\n"
     "\n"
     "Section '[ FrontEnd ]': parameters for fetch and issue.\n"
     "\n"
@@ -105,6 +139,13 @@ const std::string Timing::help_message =
     "  MaxInstIssuedPerType = <num> (Default = 1)\n"
     "      Maximum number of instructions that can be issued of each type\n"
     "      (SIMD, scalar, etc.) in a single cycle.\n"
+    "  IssueKind = {RoundRobin|FetchPressure} (Default = RoundRobin)\n"
+    "      Policy choosing the fetch buffer to issue from in each cycle,\n"
+    "      either in round-robin order or the one holding most\n"
+    "      instructions.\n"
+    "  RotateFetch = {t|f} (Default = False)\n"
+    "      Fetch from the wavefront pools starting at the one issuing in the\n"
+    "      current cycle, instead of starting at the first one.\n"
     "\n"
     "Section '[ SIMDUnit ]': parameters for the SIMD Units.\n"
     "\n"
@@ -237,6 +278,23 @@ const std::string Timing::help_message =
     "      Latency for an access in number of cycles.\n"
     "  Ports = <num> (Default = 4)\n"
     "      Number of ports.\n"
+    "\n"
+    "Section '[ Sampling ]': simulation of a subset of the work-groups of\n"
+    "each ND-Range. The rest of the work-groups are executed functionally\n"
+    "when dispatched, and the cycles and cache accesses of the ND-Range are\n"
+    "extrapolated in the report.\n"
+    "\n"
+    "  Kind = {None|First|Random|Stratified} (Default = None)\n"
+    "      Work-groups simulated in detail.\n"
+    "        None: all work-groups.\n"
+    "        First: the first work-groups dispatched.\n"
+    "        Random: work-groups picked at random.\n"
+    "        Stratified: one work-group picked at random from each of\n"
+    "            'WorkGroups' groups of consecutive work-groups.\n"
+    "  WorkGroups = <num> (Default = 0)\n"
+    "      Number of work-groups simulated in detail per ND-Range.\n"
+    "  Seed = <num> (Default = 1)\n"
+    "      Seed for the random sampling kinds.\n"
     "\n";
 
 bool Timing::help = false;
@@ -287,6 +345,14 @@ void Timing::WriteMemoryConfiguration(misc::IniFile* ini_file) {
   ini_file->WriteInt(section, "Latency", 1);
   ini_file->WriteString(section, "Policy", "LRU");
 
+  // Cache geometry for instruction L1
+  section = "CacheGeometry si-geo-inst-l1";
+  ini_file->WriteInt(section, "Sets", 128);
+  ini_file->WriteInt(section, "Assoc", 4);
+  ini_file->WriteInt(section, "BlockSize", 64);
+  ini_file->WriteInt(section, "Latency", 1);
+  ini_file->WriteString(section, "Policy", "LRU");
+
   // Cache geometry for L2
   section = "CacheGeometry si-geo-l2";
   ini_file->WriteInt(section, "Sets", 128);
@@ -295,14 +361,24 @@ void Timing::WriteMemoryConfiguration(misc::IniFile* ini_file) {
   ini_file->WriteInt(section, "Latency", 10);
   ini_file->WriteString(section, "Policy", "LRU");
 
-  // Create scalar L1 caches
-  for (int i = 0; i < (Gpu::num_compute_units + 3) / 4; i++) {
+  // Create scalar and instruction L1 caches, shared by the compute units
+  // of each cluster
+  int cluster_size = Gpu::compute_units_per_cluster;
+  int num_clusters = (Gpu::num_compute_units + cluster_size - 1) / cluster_size;
+  for (int i = 0; i < num_clusters; i++) {
     section = misc::fmt("Module si-scalar-l1-%d", i);
     ini_file->WriteString(section, "Type", "Cache");
     ini_file->WriteString(section, "Geometry", "si-geo-scalar-l1");
     ini_file->WriteString(section, "LowNetwork", "si-net-l1-l2");
     ini_file->WriteString(section, "LowModules",
                           "si-l2-0 si-l2-1 si-l2-2 si-l2-3 si-l2-4 si-l2-5");
+
+    section = misc::fmt("Module si-inst-l1-%d", i);
+    ini_file->WriteString(section, "Type", "Cache");
+    ini_file->WriteString(section, "Geometry", "si-geo-inst-l1");
+    ini_file->WriteString(section, "LowNetwork", "si-net-l1-l2");
+    ini_file->WriteString(section, "LowModules",
+                          "si-l2-0 si-l2-1 si-l2-2 si-l2-3 si-l2-4 si-l2-5");
   }
 
   // Create vector L1 caches
@@ -325,8 +401,11 @@ void Timing::WriteMemoryConfiguration(misc::IniFile* ini_file) {
     std::string value = misc::fmt("si-vector-l1-%d", i);
     ini_file->WriteString(section, "DataModule", value);
 
-    value = misc::fmt("si-scalar-l1-%d", i / 4);
+    value = misc::fmt("si-scalar-l1-%d", i / cluster_size);
     ini_file->WriteString(section, "ConstantDataModule", value);
+
+    value = misc::fmt("si-inst-l1-%d", i / cluster_size);
+    ini_file->WriteString(section, "InstructionModule", value);
   }
 
   // L2 caches
@@ -465,6 +544,7 @@ void Timing::ParseMemoryConfigurationEntry(misc::IniFile* ini_file,
   ini_file->Allow(section, "DataModule");
   ini_file->Allow(section, "ConstantDataModule");
   ini_file->Allow(section, "Module");
+  ini_file->Allow(section, "InstructionModule");
 
   // Unified or separate data and constant memory
   bool unified_present = ini_file->Exists(section, "Module");
@@ -560,9 +640,27 @@ void Timing::ParseMemoryConfigurationEntry(misc::IniFile* ini_file,
                   ini_file->getPath().c_str(), section.c_str(),
                   scalar_cache_name.c_str()));
 
+  // Assign optional instruction cache
+  std::string instruction_cache_name =
+      ini_file->ReadString(section, "InstructionModule");
+  if (!instruction_cache_name.empty()) {
+    compute_unit->instruction_cache =
+        mem_system->getModule(instruction_cache_name);
+    if (!compute_unit->instruction_cache)
+      throw misc::Error(
+          misc::fmt("%s: [%s]: '%s' is not a valid "
+                    "module name: The given module name must match "
+                    "a module declared in a section [Module <name>] "
+                    "in the memory configuration file.\n",
+                    ini_file->getPath().c_str(), section.c_str(),
+                    instruction_cache_name.c_str()));
+  }
+
   // Add modules to list of memory entries
   entry_modules.push_back(compute_unit->vector_cache);
   entry_modules.push_back(compute_unit->scalar_cache);
+  if (compute_unit->instruction_cache)
+    entry_modules.push_back(compute_unit->instruction_cache);
 
   // Debug
   mem::System::debug << misc::fmt("\tSouthern Islands compute unit %d\n",
@@ -570,8 +668,11 @@ void Timing::ParseMemoryConfigurationEntry(misc::IniFile* ini_file,
                      << "\t\tEntry for vector mem -> "
                      << compute_unit->vector_cache->getName() << '\n'
                      << "\t\tEntry for scalar mem -> "
-                     << compute_unit->scalar_cache->getName() << '\n'
-                     << '\n';
+                     << compute_unit->scalar_cache->getName() << '\n';
+  if (compute_unit->instruction_cache)
+    mem::System::debug << "\t\tEntry for instructions -> "
+                       << compute_unit->instruction_cache->getName() << '\n';
+  mem::System::debug << '\n';
 }
 
 void Timing::CheckMemoryConfiguration(misc::IniFile* ini_file) {
@@ -588,6 +689,24 @@ void Timing::CheckMemoryConfiguration(misc::IniFile* ini_file) {
                     "this compute unit with a memory module.\n",
                     ini_file->getPath().c_str(), compute_unit->getIndex()));
   }
+
+  // The compute units sharing an instruction cache arbitrate for its port
+  std::map<mem::Module*, std::vector<ComputeUnit*>> instruction_cache_sharers;
+  for (auto it = gpu->getComputeUnitsBegin(), e = gpu->getComputeUnitsEnd();
+       it != e; ++it) {
+    ComputeUnit* compute_unit = it->get();
+    if (compute_unit->instruction_cache)
+      instruction_cache_sharers[compute_unit->instruction_cache].push_back(
+          compute_unit);
+  }
+  for (auto& pair : instruction_cache_sharers) {
+    std::vector<ComputeUnit*>& compute_units = pair.second;
+    if (compute_units.size() < 2) continue;
+    InstructionCachePort* port =
+        gpu->addInstructionCachePort(compute_units.size());
+    for (unsigned i = 0; i < compute_units.size(); i++)
+      compute_units[i]->setInstructionCachePort(port, i);
+  }
 }
 
 void Timing::RegisterOptions() {
@@ -649,6 +768,15 @@ void Timing::RegisterOptions() {
   command_line->RegisterInt32("--si-sampling-cycle", statistics_sampling_cycle,
                               "Sampling cycles of the statistics.");
 
+  // Option --si-counters <file>
+  command_line->RegisterString(
+      "--si-counters <file>", counters_file,
+      "File to dump a time series of the compute unit counters, such as "
+      "instructions, resident wavefronts, pipeline stalls, and vector "
+      "memory divergence. One comma-separated line is dumped per compute "
+      "unit every '--si-sampling-cycle' cycles, with the increment of "
+      "each counter in the last interval.");
+
   // Option --si-min-ratio
   command_line->RegisterDouble("--si-max-ratio", Gpu::max_wavefront_ratio,
                                "Maximum wavefront ratio to simulate.");
@@ -664,6 +792,11 @@ void Timing::ProcessOptions() {
     // Set the debug file only if this is a detailed simulation
     pipeline_debug.setPath(pipeline_debug_file);
 
+    // Sampling interval of the statistics
+    if (statistics_sampling_cycle < 1)
+      throw Error("The value for option '--si-sampling-cycle' must be at "
+                  "least 1.");
+
     // Statistics
     switch (statistics_level) {
       // Disabled
@@ -713,6 +846,29 @@ void Timing::ParseConfiguration(misc::IniFile* ini_file) {
                   ini_file->getPath().c_str()));
   Gpu::num_compute_units =
       ini_file->ReadInt(section, "NumComputeUnits", Gpu::num_compute_units);
+  Gpu::compute_units_per_cluster = ini_file->ReadInt(
+      section, "ComputeUnitsPerCluster", Gpu::compute_units_per_cluster);
+  if (Gpu::compute_units_per_cluster < 1)
+    throw Error(misc::fmt("%s: The value for 'ComputeUnitsPerCluster' must "
+                          "be at least 1.\n",
+                          ini_file->getPath().c_str()));
+  Gpu::num_host_threads =
+      ini_file->ReadInt(section, "HostThreads", Gpu::num_host_threads);
+  if (Gpu::num_host_threads < 1)
+    throw Error(misc::fmt("%s: The value for 'HostThreads' must be at "
+                          "least 1.\n",
+                          ini_file->getPath().c_str()));
+  Dispatcher::kind = (Dispatcher::Kind)ini_file->ReadEnum(
+      section, "DispatchKind", Dispatcher::kind_map, Dispatcher::kind);
+  Gpu::max_work_groups_per_compute_unit =
+      ini_file->ReadInt(section, "MaxWorkGroupsPerComputeUnit",
+                        Gpu::max_work_groups_per_compute_unit);
+  if (Gpu::max_work_groups_per_compute_unit < 0)
+    throw Error(misc::fmt("%s: The value for 'MaxWorkGroupsPerComputeUnit' "
+                          "cannot be negative.\n",
+                          ini_file->getPath().c_str()));
+  Gpu::rotate_compute_units = ini_file->ReadBool(
+      section, "RotateComputeUnits", Gpu::rotate_compute_units);
 
   // Section [ComputeUnit]
   section = "ComputeUnit";
@@ -728,6 +884,8 @@ void Timing::ParseConfiguration(misc::IniFile* ini_file) {
       section, "NumVectorRegisters", ComputeUnit::num_vector_registers);
   ComputeUnit::num_scalar_registers = ini_file->ReadInt(
       section, "NumScalarRegisters", ComputeUnit::num_scalar_registers);
+  ComputeUnit::skip_idle_cycles = ini_file->ReadBool(
+      section, "SkipIdleCycles", ComputeUnit::skip_idle_cycles);
 
   // Section [FrontEnd]
   section = "FrontEnd";
@@ -744,6 +902,11 @@ void Timing::ParseConfiguration(misc::IniFile* ini_file) {
   ComputeUnit::max_instructions_issued_per_type =
       ini_file->ReadInt(section, "MaxInstructionsIssuedPerType",
                         ComputeUnit::max_instructions_issued_per_type);
+  ComputeUnit::issue_kind = (ComputeUnit::IssueKind)ini_file->ReadEnum(
+      section, "IssueKind", ComputeUnit::issue_kind_map,
+      ComputeUnit::issue_kind);
+  ComputeUnit::rotate_fetch =
+      ini_file->ReadBool(section, "RotateFetch", ComputeUnit::rotate_fetch);
 
   // Section [SimdUnit]
   section = "SimdUnit";
@@ -889,6 +1052,18 @@ void Timing::ParseConfiguration(misc::IniFile* ini_file) {
                   ini_file->getPath().c_str(), section.c_str(), section.c_str(),
                   section.c_str()));
 
+  // Section [Sampling]
+  section = "Sampling";
+  Sampler::kind = (Sampler::Kind)ini_file->ReadEnum(
+      section, "Kind", Sampler::kind_map, Sampler::kind);
+  Sampler::num_detailed_work_groups = ini_file->ReadInt(
+      section, "WorkGroups", Sampler::num_detailed_work_groups);
+  Sampler::seed = ini_file->ReadInt(section, "Seed", Sampler::seed);
+  if (Sampler::isEnabled() && Sampler::num_detailed_work_groups < 1)
+    throw Error(misc::fmt("%s: %s->WorkGroups must be at least 1 when "
+                          "sampling is enabled.\n",
+                          ini_file->getPath().c_str(), section.c_str()));
+
   // Enforce only the allowed variables
   ini_file->Check();
 }
@@ -898,6 +1073,15 @@ void Timing::DumpConfiguration(std::ofstream& os) const {
   os << misc::fmt("[ Config.Device ]\n");
   os << misc::fmt("Frequency = %d\n", frequency);
   os << misc::fmt("NumComputeUnits = %d\n", Gpu::num_compute_units);
+  os << misc::fmt("ComputeUnitsPerCluster = %d\n",
+                  Gpu::compute_units_per_cluster);
+  os << misc::fmt("HostThreads = %d\n", Gpu::num_host_threads);
+  os << misc::fmt("DispatchKind = %s\n",
+                  Dispatcher::kind_map[Dispatcher::kind]);
+  os << misc::fmt("MaxWorkGroupsPerComputeUnit = %d\n",
+                  Gpu::max_work_groups_per_compute_unit);
+  os << misc::fmt("RotateComputeUnits = %s\n",
+                  Gpu::rotate_compute_units ? "True" : "False");
   os << misc::fmt("\n");
 
   // Compute Unit
@@ -911,6 +1095,8 @@ void Timing::DumpConfiguration(std::ofstream& os) const {
                   ComputeUnit::max_work_groups_per_wavefront_pool);
   os << misc::fmt("MaxWavefrontsPerWavefrontPool = %d\n",
                   ComputeUnit::max_wavefronts_per_wavefront_pool);
+  os << misc::fmt("SkipIdleCycles = %s\n",
+                  ComputeUnit::skip_idle_cycles ? "True" : "False");
   os << misc::fmt("\n");
 
   // Front-End
@@ -922,6 +1108,10 @@ void Timing::DumpConfiguration(std::ofstream& os) const {
   os << misc::fmt("IssueWidth = %d\n", ComputeUnit::issue_width);
   os << misc::fmt("MaxInstIssuedPerType = %d\n",
                   ComputeUnit::max_instructions_issued_per_type);
+  os << misc::fmt("IssueKind = %s\n",
+                  ComputeUnit::issue_kind_map[ComputeUnit::issue_kind]);
+  os << misc::fmt("RotateFetch = %s\n",
+                  ComputeUnit::rotate_fetch ? "True" : "False");
   os << misc::fmt("\n");
 
   // SIMD Unit
@@ -1003,6 +1193,13 @@ void Timing::DumpConfiguration(std::ofstream& os) const {
   os << misc::fmt("Ports = %d\n", ComputeUnit::lds_num_ports);
   os << misc::fmt("\n");
 
+  // Sampling
+  os << misc::fmt("[ Config.Sampling ]\n");
+  os << misc::fmt("Kind = %s\n", Sampler::kind_map[Sampler::kind]);
+  os << misc::fmt("WorkGroups = %d\n", Sampler::num_detailed_work_groups);
+  os << misc::fmt("Seed = %u\n", Sampler::seed);
+  os << misc::fmt("\n");
+
   // End of configuration
   os << misc::fmt("\n");
 }
@@ -1063,6 +1260,7 @@ void Timing::DumpReport() const {
   report << misc::fmt("VectorMemInstructions = %lld\n",
                       emulator->num_vector_memory_instructions);
   report << misc::fmt("Cycles = %lld\n", getCycle());
+  report << misc::fmt("StalledCycles = %lld\n", gpu->num_stalled_cycles);
   report << misc::fmt("InstructionsPerCycle = %.4g\n", instructions_per_cycle);
   report << misc::fmt("\n\n");
 
@@ -1076,40 +1274,25 @@ void Timing::DumpReport() const {
     long long coalesced_writes =
         compute_unit->getLdsModule()->num_coalesced_writes;
     instructions_per_cycle =
-        getCycle() ? ((double)compute_unit->stats.num_total_insts_ /
+        getCycle() ? ((double)compute_unit->stats[CounterInstructions] /
                       (double)getCycle())
                    : 0.0;
+    double occupancy =
+        getCycle() ? ((double)compute_unit->stats[CounterWavefrontCycles] /
+                      (double)getCycle() /
+                      (ComputeUnit::num_wavefront_pools *
+                       ComputeUnit::max_wavefronts_per_wavefront_pool))
+                   : 0.0;
 
     // Report statistics for each compute unit
     report << misc::fmt("[ ComputeUnit %d ]\n\n", compute_unit->getIndex());
-
-    report << misc::fmt("WorkGroupCount = %lld\n",
-                        compute_unit->stats.num_mapped_work_groups_);
-    report << misc::fmt("Instructions = %lld\n",
-                        compute_unit->stats.num_total_insts_);
-    report << misc::fmt("ScalarALUInstructions = %lld\n",
-                        compute_unit->stats.num_scalar_alu_insts_);
-    report << misc::fmt("ScalarMemInstructions = %lld\n",
-                        compute_unit->stats.num_scalar_memory_insts_);
-    report << misc::fmt("BranchInstructions = %lld\n",
-                        compute_unit->stats.num_branch_insts_);
-    report << misc::fmt("SIMDInstructions = %lld\n",
-                        compute_unit->stats.num_simd_insts_);
-    report << misc::fmt("VectorMemInstructions = %lld\n",
-                        compute_unit->stats.num_vector_memory_insts_);
-    report << misc::fmt("LDSInstructions = %lld\n",
-                        compute_unit->stats.num_lds_insts_);
+    report << compute_unit->stats;
     report << misc::fmt("Cycles = %lld\n", getCycle());
-    report << misc::fmt("InstructionsPerCycle = %.4g\n\n",
+    report << misc::fmt("SleepingCycles = %lld\n",
+                        compute_unit->getNumSleepingCycles());
+    report << misc::fmt("InstructionsPerCycle = %.4g\n",
                         instructions_per_cycle);
-    report << misc::fmt("ScalarRegReads= %lld\n",
-                        compute_unit->stats.num_sreg_reads_);
-    report << misc::fmt("ScalarRegWrites= %lld\n",
-                        compute_unit->stats.num_sreg_writes_);
-    report << misc::fmt("VectorRegReads= %lld\n",
-                        compute_unit->stats.num_vreg_reads_);
-    report << misc::fmt("VectorRegWrites= %lld\n",
-                        compute_unit->stats.num_vreg_writes_);
+    report << misc::fmt("Occupancy = %.4g\n", occupancy);
     report << misc::fmt("\n");
     report << misc::fmt("LDS.Accesses = %lld\n",
                         compute_unit->getLdsModule()->num_reads +
@@ -1123,6 +1306,18 @@ void Timing::DumpReport() const {
     report << misc::fmt("\n\n");
   }
 
+  // Counters of each ND-Range that did not run at the same time as any
+  // other one. Counters are shared by concurrent ND-Ranges, so no section
+  // is dumped for them.
+  for (auto& pair : gpu->getNDRangeCounters()) {
+    report << misc::fmt("[ NDRange %d ]\n\n", pair.first);
+    report << pair.second;
+    report << misc::fmt("\n\n");
+  }
+
+  // Extrapolated statistics of sampled ND-Ranges
+  gpu->getSampler()->DumpReport(report);
+
   // Close the report file
   report.close();
 }
@@ -1135,11 +1330,11 @@ bool Timing::Run() {
   // exit here if the list of existing ND-Ranges is empty.
   if (!emulator->getNumNDRanges()) return false;
 
-  // TODO instead of statically allocating the whole GPU to one NDRange
-  // which wastes the resources, dynamically add the workgroups of
-  // different NDRanges to the compute units, if all work groups of
-  // the current NDRange is scheduled, and resources are available
-  // Add any available work groups to the waiting list
+  // Map the waiting work-groups of all NDRanges to compute units with
+  // free resources, as chosen by the dispatcher. Work-groups of different
+  // NDRanges share the compute units.
+  Dispatcher* dispatcher = gpu->getDispatcher();
+  Sampler* sampler = gpu->getSampler();
   for (auto it = emulator->getNDRangesBegin(); it != emulator->getNDRangesEnd();
        ++it) {
     // Get pointer to NDRange
@@ -1149,11 +1344,15 @@ bool Timing::Run() {
     WorkGroup* work_group = nullptr;
 
     if (ndrange->address_space == nullptr) {
-      // TODO the problem is that the NDRange keeps getting
-      // mapped and unmapped since the waitingworkgroups list
-      // of ndrange only grows with the driver calls.
-      // This solution doesn't work.
       ndrange->address_space = gpu->getMmu()->newSpace("Southern Islands");
+      ndrange->instruction_space =
+          gpu->getMmu()->newSpace("Southern Islands Instructions");
+      gpu->MapNDRange(ndrange);
+    } else if (gpu->getMappedNDRangeIndex(ndrange) < 0 &&
+               !ndrange->isWaitingWorkGroupsEmpty()) {
+      // The NDRange was unmapped when its waiting list drained, and the
+      // driver has sent more work-groups since. Map it again.
+      ndrange->setLastWorkgroupSent(false);
       gpu->MapNDRange(ndrange);
     }
 
@@ -1164,25 +1363,14 @@ bool Timing::Run() {
 
       // Map work groups to compute units
       for (unsigned i = 0; i < num_waiting_work_groups; i++) {
-        // Get an available compute unit
-        ComputeUnit* available_compute_unit = gpu->getAvailableComputeUnit();
+        // Get an available compute unit. Work-groups left out of the
+        // sample do not need one.
+        bool detailed = sampler->isNextWorkGroupDetailed(ndrange);
+        ComputeUnit* available_compute_unit =
+            detailed ? dispatcher->getComputeUnit(ndrange) : nullptr;
 
         // Exit if no compute unit available
-        if (!available_compute_unit) break;
-
-        // Exit if mapped work group is considerably larger than average
-        if (getenv("M2S_WG_TAIL_FIX")) {
-          int num_cu = gpu->num_compute_units;
-          unsigned num_wgs =
-              ndrange->getGlobalSize1D() / ndrange->getLocalSize1D();
-          unsigned avg_wgs = num_wgs / num_cu + 1;
-
-          if (available_compute_unit->stats.num_mapped_work_groups_ >=
-              avg_wgs) {
-            gpu->RemoveFromAvailableComputeUnits(available_compute_unit);
-            break;
-          }
-        }
+        if (detailed && !available_compute_unit) break;
 
         // Remove work group from list and get its ID
         long work_group_id = ndrange->GetWaitingWorkGroup();
@@ -1193,6 +1381,9 @@ bool Timing::Run() {
         if (ndrange->isWaitingWorkGroupsEmpty())
           ndrange->setLastWorkgroupSent(true);
 
+        // Work-groups left out of the sample are executed functionally
+        if (!sampler->DispatchWorkGroup(work_group)) continue;
+
         // Remove it from the available compute units list.
         // It will be re-added later if it still has room for
         // more work groups.
@@ -1200,6 +1391,7 @@ bool Timing::Run() {
 
         // Map the work group to a compute unit
         available_compute_unit->MapWorkGroup(work_group);
+        dispatcher->MapWorkGroup(ndrange, available_compute_unit);
       }
     }
 
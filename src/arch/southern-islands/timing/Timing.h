@@ -119,6 +119,9 @@ class Timing : public comm::Timing {
   static int statistics_level;
   static int statistics_sampling_cycle;
 
+  // File for the time series of the compute unit counters
+  static std::string counters_file;
+
   //
   // Class members
   //
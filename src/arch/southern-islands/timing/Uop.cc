@@ -22,14 +22,13 @@
 #include <arch/southern-islands/emulator/WorkGroup.h>
 
 #include "ComputeUnit.h"
+#include "Gpu.h"
 #include "Timing.h"
 #include "Uop.h"
 #include "WavefrontPool.h"
 
 namespace SI {
 
-long long Uop::id_counter = 0;
-
 Uop::Uop(Wavefront* wavefront, WavefrontPoolEntry* wavefront_pool_entry,
          long long cycle_created, WorkGroup* work_group, int wavefront_pool_id,
          unsigned ndrange_id)
@@ -38,11 +37,12 @@ Uop::Uop(Wavefront* wavefront, WavefrontPoolEntry* wavefront_pool_entry,
       work_group(work_group),
       wavefront_pool_id(wavefront_pool_id),
       ndrange_id((ndrange_id)) {
-  // Assign unique identifier
-  id = ++id_counter;
+  // Assign unique identifiers
   id_in_wavefront = wavefront->getUopId();
   compute_unit = wavefront_pool_entry->getWavefrontPool()->getComputeUnit();
   id_in_compute_unit = compute_unit->getUopId();
+  id = (id_in_compute_unit - 1) * Gpu::num_compute_units +
+       compute_unit->getIndex() + 1;
 
   // Allocate room for the work-item info structures
   work_item_info_list.resize(WorkGroup::WavefrontSize);
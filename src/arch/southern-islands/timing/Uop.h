@@ -34,18 +34,14 @@ class WorkGroup;
 /// Class representing an instruction flowing through the pipelines of the
 /// GPU compute units.
 class Uop {
-  //
-  // Static fields
-  //
-
-  // Counter tracking the ID assigned to the last uop created
-  static long long id_counter;
-
   //
   // Class members
   //
 
-  // Unique identifier of the instruction, assigned when created
+  // Unique identifier of the instruction, assigned when created. It is
+  // derived from the compute unit index and the identifier in the compute
+  // unit, so that it does not depend on the order in which host threads
+  // simulate compute units.
   long long id;
 
   // Unique identifier of the instruction in the wavefront that it
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/southern-islands/emulator/NDRange.h>
 #include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
@@ -110,6 +112,32 @@ bool VectorMemoryUnit::isValidUop(Uop* uop) const {
   return true;
 }
 
+long long VectorMemoryUnit::getWakeupCycle(long long cycle,
+                                           int*& witness) const {
+  // Instructions in more than one stage can advance in the next cycle
+  int num_busy_stages = !issue_buffer.empty() + !decode_buffer.empty() +
+                        !read_buffer.empty() + !mem_buffer.empty() +
+                        !write_buffer.empty();
+  if (!num_busy_stages) return NoWakeup;
+  if (num_busy_stages > 1) return cycle + 1;
+
+  // Otherwise, the oldest instruction of the only busy stage is the first
+  // one to advance
+  if (!write_buffer.empty())
+    return std::max(cycle + 1, write_buffer.front()->write_ready);
+  if (!mem_buffer.empty()) {
+    Uop* uop = mem_buffer.front().get();
+    if (!uop->global_memory_witness) return cycle + 1;
+    witness = &uop->global_memory_witness;
+    return NoWakeup;
+  }
+  if (!read_buffer.empty())
+    return std::max(cycle + 1, read_buffer.front()->read_ready);
+  if (!decode_buffer.empty())
+    return std::max(cycle + 1, decode_buffer.front()->decode_ready);
+  return std::max(cycle + 1, issue_buffer.front()->issue_ready);
+}
+
 void VectorMemoryUnit::Issue(std::unique_ptr<Uop> uop) {
   // One more instruction of this kind
   ComputeUnit* compute_unit = getComputeUnit();
@@ -118,7 +146,7 @@ void VectorMemoryUnit::Issue(std::unique_ptr<Uop> uop) {
   uop->getWavefrontPoolEntry()->ready_next_cycle = true;
 
   // One more instruction of this kind
-  compute_unit->stats.num_vector_memory_insts_++;
+  compute_unit->stats.Increment(CounterVectorMemoryInstructions);
   uop->getWavefrontPoolEntry()->lgkm_cnt++;
 
   // Issue it
@@ -129,9 +157,8 @@ void VectorMemoryUnit::Issue(std::unique_ptr<Uop> uop) {
 }
 
 void VectorMemoryUnit::Complete() {
-  // Get compute unit and GPU objects
+  // Get compute unit
   ComputeUnit* compute_unit = getComputeUnit();
-  Gpu* gpu = compute_unit->getGpu();
 
   // Sanity check the write buffer
   assert((int)write_buffer.size() <= width);
@@ -157,7 +184,7 @@ void VectorMemoryUnit::Complete() {
     uop->cycle_length = uop->cycle_finish - uop->cycle_start;
 
     // Trace for m2svis
-    Timing::m2svis << uop->getLifeCycleInCSV("simd-m");
+    if (Timing::m2svis) Timing::m2svis << uop->getLifeCycleInCSV("simd-m");
 
     // Update pipeline stage status
     WriteStatus = Active;
@@ -184,7 +211,7 @@ void VectorMemoryUnit::Complete() {
 
     // Statistics
     num_instructions++;
-    gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+    compute_unit->CompleteUop();
 
     // Update info if statistics enables
     if (Timing::statistics_level >= 2) {
@@ -263,8 +290,7 @@ void VectorMemoryUnit::Write() {
       // Update pipeline stage status
       WriteStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_write_++;
-      if (interval_file_) interval_stats_.num_stall_write_++;
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -302,8 +328,7 @@ void VectorMemoryUnit::Write() {
       // Update pipeline stage status
       WriteStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_write_++;
-      if (interval_file_) interval_stats_.num_stall_write_++;
+      Count(CounterStallWrite);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -395,8 +420,7 @@ void VectorMemoryUnit::Memory() {
       // Update pipeline stage status
       ExecutionStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_execution_++;
-      if (interval_file_) interval_stats_.num_stall_execution_++;
+      Count(CounterStallExecution);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -434,8 +458,7 @@ void VectorMemoryUnit::Memory() {
       // Update pipeline stage status
       ExecutionStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_execution_++;
-      if (interval_file_) interval_stats_.num_stall_execution_++;
+      Count(CounterStallExecution);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -494,21 +517,18 @@ void VectorMemoryUnit::Memory() {
         // access. If so, move on to the next work item.
         if (work_item_info->accessed_cache) continue;
 
-        // Translate virtual address to a physical
-        // address
-        unsigned physical_address =
-            compute_unit->getGpu()->getMmu()->TranslateVirtualAddress(
-                uop->getWorkGroup()->getNDRange()->address_space,
-                work_item_info->global_memory_access_address);
-
         // Make sure we can access the vector cache. If
-        // so, submit the access. If we can access the
-        // cache, mark the accessed flag of the work
-        // item info struct.
-        if (compute_unit->vector_cache->canAccess(physical_address)) {
-          compute_unit->vector_cache->Access(module_access_type,
-                                             physical_address,
-                                             &uop->global_memory_witness);
+        // so, submit the access, translating the virtual
+        // address to a physical address. If we can access
+        // the cache, mark the accessed flag of the work
+        // item info struct. The availability of the cache
+        // does not depend on the address.
+        if (compute_unit->vector_cache->canAccess(
+                work_item_info->global_memory_access_address)) {
+          compute_unit->Access(compute_unit->vector_cache, module_access_type,
+                               uop->getWorkGroup()->getNDRange()->address_space,
+                               work_item_info->global_memory_access_address,
+                               &uop->global_memory_witness);
           work_item_info->accessed_cache = true;
 
           // Access global memory
@@ -528,8 +548,7 @@ void VectorMemoryUnit::Memory() {
     // be re-processed next cycle. Once all work items access
     // the vector cache, the uop will be moved to the write buffer.
     if (!all_work_items_accessed) {
-      if (overview_file_) overview_stats_.num_vmem_divergence_++;
-      if (interval_file_) interval_stats_.num_vmem_divergence_++;
+      Count(CounterVectorMemoryDivergence);
       continue;
     }
 
@@ -603,8 +622,7 @@ void VectorMemoryUnit::Read() {
       // Update pipeline stage status
       ReadStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_read_++;
-      if (interval_file_) interval_stats_.num_stall_read_++;
+      Count(CounterStallRead);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -642,8 +660,7 @@ void VectorMemoryUnit::Read() {
       // Update pipeline stage status
       ReadStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_read_++;
-      if (interval_file_) interval_stats_.num_stall_read_++;
+      Count(CounterStallRead);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -731,8 +748,7 @@ void VectorMemoryUnit::Decode() {
       // Update pipeline stage status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
@@ -770,8 +786,7 @@ void VectorMemoryUnit::Decode() {
       // Update pipeline stage status
       DecodeStatus = Stall;
 
-      if (overview_file_) overview_stats_.num_stall_decode_++;
-      if (interval_file_) interval_stats_.num_stall_decode_++;
+      Count(CounterStallDecode);
 
       // Trace
       Timing::trace << misc::fmt(
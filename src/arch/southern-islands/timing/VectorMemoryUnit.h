@@ -116,6 +116,11 @@ class VectorMemoryUnit : public ExecutionUnit {
   /// instruction.
   bool isValidUop(Uop* uop) const override;
 
+  /// Return the first cycle after \a cycle in which the vector memory
+  /// unit can change state, or wait for the memory accesses of its oldest
+  /// instruction.
+  long long getWakeupCycle(long long cycle, int*& witness) const override;
+
   /// Issue the given instruction into the vector memory unit
   void Issue(std::unique_ptr<Uop> uop) override;
 
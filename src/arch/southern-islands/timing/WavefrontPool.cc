@@ -18,6 +18,7 @@
  */
 
 #include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
 
 #include "ComputeUnit.h"
@@ -34,6 +35,11 @@ void WavefrontPoolEntry::Clear() {
   assert(!lgkm_cnt);
   assert(!mem_wait);
   assert(!wait_for_barrier);
+  assert(!instruction_fetch_witness);
+
+  // Reset the instruction buffer
+  instruction_block_valid = false;
+  instruction_block = 0;
 
   // Reset the wavefront flags
   wavefront = nullptr;
@@ -53,12 +59,9 @@ WavefrontPool::WavefrontPool(int id, ComputeUnit* compute_unit)
 }
 
 void WavefrontPool::MapWavefronts(WorkGroup* work_group) {
-  // Determine starting ID for wavefronts in the instruction buffer
-  int wg_id_in_wfp =
-      work_group->getIdInComputeUnit() / ComputeUnit::num_wavefront_pools;
-  int first_entry = wg_id_in_wfp * work_group->getWavefrontsInWorkgroup();
-
-  // Initialize entry index within wavefront pool
+  // Initialize entry index within wavefront pool. Work-groups of different
+  // NDRanges may have different sizes, so wavefronts take the first free
+  // entries in the pool.
   int entry_index = 0;
 
   // Assign wavefronts to the wavefront pool
@@ -68,9 +71,15 @@ void WavefrontPool::MapWavefronts(WorkGroup* work_group) {
     // Get the wavefront object
     Wavefront* wavefront = it->get();
 
+    // Find the next free entry
+    while (entry_index < (int)wavefront_pool_entries.size() &&
+           wavefront_pool_entries[entry_index]->valid)
+      entry_index++;
+    assert(entry_index < (int)wavefront_pool_entries.size());
+
     // Set entry pointer to an entry in the wavefront pool
     WavefrontPoolEntry* wavefront_pool_entry =
-        wavefront_pool_entries[first_entry + entry_index].get();
+        wavefront_pool_entries[entry_index].get();
 
     // Make sure the entry was set and that it is not yet valid.
     // Having the valid field set would indicate that it was
@@ -142,4 +151,44 @@ void WavefrontPool::UnmapWavefronts(WorkGroup* work_group) {
   num_wavefronts -= work_group->getWavefrontsInWorkgroup();
 }
 
+bool WavefrontPool::isWaiting(std::vector<int*>& witnesses) const {
+  for (auto& wavefront_pool_entry : wavefront_pool_entries) {
+    // No wavefront
+    Wavefront* wavefront = wavefront_pool_entry->getWavefront();
+    if (!wavefront) continue;
+
+    // The wavefront becomes ready in the next cycle
+    if (wavefront_pool_entry->ready_next_cycle) return false;
+
+    // Previous instruction still in flight, or no more instructions
+    if (!wavefront_pool_entry->ready ||
+        wavefront_pool_entry->wavefront_finished || wavefront->getFinished())
+      continue;
+
+    // Waiting on outstanding memory instructions, which can only complete
+    // in the execution units
+    if (wavefront_pool_entry->mem_wait &&
+        (wavefront_pool_entry->lgkm_cnt || wavefront_pool_entry->exp_cnt ||
+         wavefront_pool_entry->vm_cnt))
+      continue;
+
+    // Waiting at a barrier
+    if (!wavefront_pool_entry->mem_wait &&
+        wavefront_pool_entry->wait_for_barrier)
+      continue;
+
+    // Waiting on the instruction cache
+    if (wavefront_pool_entry->instruction_fetch_witness) {
+      witnesses.push_back(&wavefront_pool_entry->instruction_fetch_witness);
+      continue;
+    }
+
+    // The wavefront can be fetched
+    return false;
+  }
+
+  // No wavefront can be fetched
+  return true;
+}
+
 }  // SI namespace
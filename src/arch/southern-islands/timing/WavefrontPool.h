@@ -108,6 +108,22 @@ class WavefrontPoolEntry {
 
   /// Indicates whether the wavefront needs to wait for a memory access
   bool mem_wait = false;
+
+  //
+  // Instruction buffer
+  //
+
+  /// Indicates whether a block of instruction memory was requested into
+  /// the wavefront's instruction buffer
+  bool instruction_block_valid = false;
+
+  /// Address of the block of instruction memory requested into the
+  /// instruction buffer
+  unsigned instruction_block = 0;
+
+  /// Witness of the instruction cache access filling the instruction
+  /// buffer, zero once the block is available
+  int instruction_fetch_witness = 0;
 };
 
 /// Class representing the wavefront pool in the compute unit front-end
@@ -140,6 +156,14 @@ class WavefrontPool {
   /// Unmap wavefronts from the wavefront pool
   void UnmapWavefronts(WorkGroup* work_group);
 
+  /// Return whether no wavefront in the pool can be fetched or change
+  /// state in the next cycle, because each one is waiting on an
+  /// instruction in flight, on outstanding memory instructions, at a
+  /// barrier, or on an instruction cache access, or has finished. The
+  /// witnesses of the instruction cache accesses are added to \a
+  /// witnesses.
+  bool isWaiting(std::vector<int*>& witnesses) const;
+
   /// Return an iterator to the first wavefront pool entry
   /// in wavefront_pool_entries
   std::vector<std::unique_ptr<WavefrontPoolEntry>>::iterator begin() {
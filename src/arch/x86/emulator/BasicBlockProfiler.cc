@@ -0,0 +1,79 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2012  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/String.h>
+
+#include "BasicBlockProfiler.h"
+#include "Emulator.h"
+
+namespace x86 {
+
+BasicBlockProfiler::BasicBlockProfiler(const std::string& path,
+                                       long long interval_size)
+    : path(path), interval_size(interval_size) {
+  // Open output file
+  os.open(path);
+  if (!os.good())
+    throw Error(misc::fmt("%s: cannot open basic block vector file",
+                          path.c_str()));
+}
+
+BasicBlockProfiler::~BasicBlockProfiler() {
+  // Dump last interval
+  if (!interval_counts.empty()) DumpInterval();
+}
+
+void BasicBlockProfiler::DumpInterval() {
+  // One line per interval
+  os << 'T';
+  for (auto& it : interval_counts)
+    os << misc::fmt(":%d:%lld ", it.first, it.second);
+  os << '\n';
+
+  // Reset interval
+  interval_counts.clear();
+  num_intervals++;
+}
+
+void BasicBlockProfiler::RecordBlock(unsigned eip, int size) {
+  // Find block identifier, or assign a new one
+  auto it = block_ids.find(eip);
+  int id;
+  if (it == block_ids.end()) {
+    id = block_ids.size() + 1;
+    block_ids.emplace(eip, id);
+  } else {
+    id = it->second;
+  }
+
+  // Accumulate instructions
+  interval_counts[id] += size;
+  num_interval_instructions += size;
+  num_instructions += size;
+
+  // End of interval. The excess instructions are carried over to the next
+  // interval, so that interval boundaries stay aligned with multiples of
+  // the interval size as closely as block granularity allows.
+  if (num_interval_instructions >= interval_size) {
+    DumpInterval();
+    num_interval_instructions -= interval_size;
+  }
+}
+
+}  // namespace x86
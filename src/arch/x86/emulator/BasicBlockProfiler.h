@@ -0,0 +1,114 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2012  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_EMULATOR_BASIC_BLOCK_PROFILER_H
+#define ARCH_X86_EMULATOR_BASIC_BLOCK_PROFILER_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+namespace x86 {
+
+/// Basic block vector (BBV) profiler. Instructions emulated in
+/// non-speculative mode are grouped into dynamic basic blocks, and the
+/// number of instructions executed in each block is accumulated over
+/// intervals of a fixed number of instructions. At the end of every
+/// interval, one line is dumped to the output file in the frequency vector
+/// format consumed by SimPoint:
+///
+///	T:<block_id>:<count> :<block_id>:<count> ...
+///
+/// Block identifiers start at 1 and are assigned in order of first
+/// execution. Field <count> is the number of instructions executed within
+/// the block during the interval.
+class BasicBlockProfiler {
+  // Output file
+  std::ofstream os;
+
+  // Path of the output file
+  std::string path;
+
+  // Number of instructions per interval
+  long long interval_size;
+
+  // Number of instructions accumulated in the current interval
+  long long num_interval_instructions = 0;
+
+  // Number of intervals dumped so far
+  long long num_intervals = 0;
+
+  // Total number of profiled instructions
+  long long num_instructions = 0;
+
+  // Block identifiers, indexed by the address of the first instruction
+  // in the block
+  std::unordered_map<unsigned, int> block_ids;
+
+  // Number of instructions executed in each block during the current
+  // interval, indexed by block identifier. An ordered map is used so that
+  // vectors are dumped with increasing block identifiers.
+  std::map<int, long long> interval_counts;
+
+  // Dump the vector for the current interval and reset it
+  void DumpInterval();
+
+ public:
+  /// Constructor
+  ///
+  /// \param path
+  ///	Output file where basic block vectors are dumped.
+  ///
+  /// \param interval_size
+  ///	Number of instructions in each profiling interval.
+  BasicBlockProfiler(const std::string& path, long long interval_size);
+
+  /// Destructor. The vector for the last, possibly incomplete, interval
+  /// is dumped here.
+  ~BasicBlockProfiler();
+
+  /// Record the execution of a dynamic basic block.
+  ///
+  /// \param eip
+  ///	Address of the first instruction in the block.
+  ///
+  /// \param size
+  ///	Number of instructions executed in the block.
+  void RecordBlock(unsigned eip, int size);
+
+  /// Return the number of instructions per interval
+  long long getIntervalSize() const { return interval_size; }
+
+  /// Return the number of instructions left to complete the current
+  /// interval
+  long long getNumIntervalInstructionsLeft() const {
+    return interval_size - num_interval_instructions;
+  }
+
+  /// Return the number of intervals dumped so far
+  long long getNumIntervals() const { return num_intervals; }
+
+  /// Return the number of different basic blocks found so far
+  int getNumBlocks() const { return block_ids.size(); }
+};
+
+}  // namespace x86
+
+#endif
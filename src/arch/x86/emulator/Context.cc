@@ -44,8 +44,8 @@ const misc::StringMap Context::StateMap = {
     {"futex", StateFutex},         {"alloc", StateAlloc},
     {"callback", StateCallback},   {"mapped", StateMapped}};
 
-long Context::host_flags;
-unsigned char Context::host_fpenv[28];
+thread_local long Context::host_flags;
+thread_local unsigned char Context::host_fpenv[28];
 
 Context::Context()
     : comm::Context(Emulator::getInstance()),
@@ -721,6 +721,7 @@ void Context::Execute() {
   regs.incEip(inst.getSize());
 
   // Call instruction emulation function
+  num_extra_rep_iterations = 0;
   if (inst.getOpcode()) {
     try {
       ExecuteInstFn fn = execute_inst_fn[inst.getOpcode()];
@@ -751,8 +752,38 @@ void Context::Execute() {
   emulator->isa_debug << '\n';
   if (emulator->call_debug) DebugCallInst();
 
+  // Basic block vector profiling. A basic block ends with any control
+  // transfer instruction, taken or not, or with any other instruction that
+  // breaks the sequential flow, such as a repeated string operation.
+  BasicBlockProfiler* profiler = emulator->getBasicBlockProfiler();
+  if (profiler && !spec_mode) {
+    if (!bbv_block_size) bbv_block_eip = current_eip;
+    bbv_block_size++;
+
+    // Iterations of a repeated string instruction run in a chunk are
+    // recorded as if run one by one. The first one ends the current block,
+    // and each of the others is a block made of the instruction alone.
+    if (num_extra_rep_iterations) {
+      profiler->RecordBlock(bbv_block_eip, bbv_block_size);
+      if (num_extra_rep_iterations > 1)
+        profiler->RecordBlock(current_eip, num_extra_rep_iterations - 1);
+      bbv_block_eip = current_eip;
+      bbv_block_size = 1;
+    }
+
+    if (target_eip || regs.getEip() != current_eip + inst.getSize()) {
+      profiler->RecordBlock(bbv_block_eip, bbv_block_size);
+      bbv_block_size = 0;
+    }
+  }
+
   // Stats
-  emulator->incNumInstructions();
+  emulator->incNumInstructions(1 + num_extra_rep_iterations);
+}
+
+bool Context::isSharingEmulatorState() const {
+  return memory.use_count() > 1 || emulator->getBasicBlockProfiler() ||
+         Emulator::isa_debug || Emulator::call_debug;
 }
 
 void Context::FinishGroup(int exit_code) {
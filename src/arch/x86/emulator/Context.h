@@ -21,7 +21,10 @@
 #define ARCH_X86_EMULATOR_CONTEXT_H
 
 #include <deque>
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <arch/common/CallStack.h>
 #include <arch/common/Context.h>
@@ -129,11 +132,13 @@ class Context : public comm::Context {
   static const misc::StringMap StateMap;
 
  private:
-  // Saved host flags during instruction emulation
-  static long host_flags;
+  // Saved host flags during instruction emulation, private to each host
+  // thread emulating contexts
+  static thread_local long host_flags;
 
-  // Saved host floating-point environment during instruction emulation
-  static unsigned char host_fpenv[28];
+  // Saved host floating-point environment during instruction emulation,
+  // private to each host thread emulating contexts
+  static thread_local unsigned char host_fpenv[28];
 
   // Emulator that it belongs to
   Emulator *emulator;
@@ -182,6 +187,17 @@ class Context : public comm::Context {
   // Target address for branch, even if not taken
   unsigned target_eip = 0;
 
+  // Address of the first instruction of the basic block currently being
+  // profiled with the basic block vector profiler
+  unsigned bbv_block_eip = 0;
+
+  // Number of instructions emulated so far in the current basic block
+  int bbv_block_size = 0;
+
+  // Number of iterations beyond the first one run by the last emulated
+  // instruction, when a repeated string instruction runs in chunks
+  unsigned num_extra_rep_iterations = 0;
+
   // Parent context
   Context *parent = nullptr;
 
@@ -302,6 +318,12 @@ class Context : public comm::Context {
   void Suspend(CanWakeupFn can_wakeup_fn, WakeupFn wakeup_fn,
                State wakeup_state);
 
+  // All pairs of wakeup callbacks, used to save them in checkpoints by
+  // their position in the table. The first entry is a pair of null
+  // callbacks.
+  static const std::pair<CanWakeupFn, WakeupFn> wakeup_callbacks[];
+  static const unsigned num_wakeup_callbacks;
+
   //
   // Program loading (ContextLoader.cc)
   //
@@ -523,6 +545,34 @@ class Context : public comm::Context {
   // 'repXXX' prefixes.
   void StartRepInst();
 
+  // Return whether iterations of string instructions with 'repXXX'
+  // prefixes are executed in chunks. This is only done in functional
+  // simulation, where no micro-instructions are needed for each iteration.
+  bool isRepChunkActive() const {
+    return !uinst_active && !getState(StateSpecMode);
+  }
+
+  // Return the number of iterations of a repeated string instruction
+  // accessing elements of \a size bytes, starting at \a address in the
+  // direction given by the DF flag, that fall within the current page.
+  // The result is 0 if the first element crosses a page boundary.
+  unsigned getRepPageIterations(unsigned address, int size);
+
+  // Return the maximum number of iterations of a repeated string
+  // instruction that a chunk can run. A chunk stops at the instruction
+  // limit given with '--x86-max-inst', and does not cross the end of an
+  // interval of the basic block vector profiler. The result is at least 1.
+  unsigned getRepChunkLimit();
+
+  // Execute a chunk of iterations of 'rep movs' or 'rep stos' with
+  // elements of \a size bytes. A chunk never goes past the current ECX,
+  // the end of the pages accessed, or the limit given by
+  // getRepChunkLimit(), so that a page fault leaves registers as an
+  // iteration-by-iteration execution would. Return the number of
+  // iterations executed.
+  unsigned ExecuteRepMovsChunk(int size);
+  unsigned ExecuteRepStosChunk(int size);
+
   // Load from register/memory
   unsigned char LoadRm8();
   unsigned short LoadRm16();
@@ -850,6 +900,12 @@ class Context : public comm::Context {
   /// Return an pointer to the memory
   mem::Memory *getMemory() const { return memory.get(); }
 
+  /// Return whether emulating an instruction of this context, other than
+  /// a system call, may access state shared with other contexts. This is
+  /// the case with a guest memory shared with other contexts, or with
+  /// emulator-wide profiling or debug output.
+  bool isSharingEmulatorState() const;
+
   /// Force a new 'eip' value for the context. The forced value should be
   /// the same as the current 'eip' under normal circumstances. If it is
   /// not, speculative execution starts, which will end on the next call
@@ -862,6 +918,44 @@ class Context : public comm::Context {
   /// Get Target EIP
   int getTargetEip() { return target_eip; }
 
+  //
+  // Checkpoints (ContextCheckpoint.cc)
+  //
+
+  /// Objects shared among contexts while a checkpoint is saved or loaded.
+  /// A shared object is stored only the first time a context referring to
+  /// it is found, and later contexts refer to it by its index.
+  struct CheckpointObjects {
+    // Index of each shared object already saved, for each kind of object
+    std::unordered_map<const void *, int> memory_indexes;
+    std::unordered_map<const void *, int> file_table_indexes;
+    std::unordered_map<const void *, int> signal_handler_table_indexes;
+    std::unordered_map<const void *, int> loader_indexes;
+
+    // Shared objects already loaded, indexed by their position in the
+    // checkpoint. Memory objects and virtual address spaces always go
+    // together.
+    std::vector<std::shared_ptr<mem::Memory>> memories;
+    std::vector<mem::Mmu::Space *> mmu_spaces;
+    std::vector<std::shared_ptr<comm::FileTable>> file_tables;
+    std::vector<std::shared_ptr<SignalHandlerTable>> signal_handler_tables;
+    std::vector<std::shared_ptr<Loader>> loaders;
+
+    // Host file descriptors reopened while loading file tables
+    std::map<int, int> host_indexes;
+  };
+
+  /// Save the architectural state of the context into a checkpoint. The
+  /// context must not be in speculative mode.
+  void SaveCheckpoint(misc::Checkpoint &checkpoint,
+                      CheckpointObjects &objects) const;
+
+  /// Restore the state saved with SaveCheckpoint() into a context just
+  /// created with Emulator::newContext(). The parent contexts must have
+  /// been restored before.
+  void LoadCheckpoint(misc::Checkpoint &checkpoint,
+                      CheckpointObjects &objects);
+
   //
   // Context lists
   //
@@ -0,0 +1,269 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/cpp/Checkpoint.h>
+
+#include "Context.h"
+#include "Emulator.h"
+
+namespace x86 {
+
+// Write the index of a shared object, and return true if it is the first
+// time the object is found, in which case the caller must save its content
+// right after.
+static bool SaveSharedIndex(misc::Checkpoint& checkpoint,
+                            std::unordered_map<const void*, int>& indexes,
+                            const void* object) {
+  auto it = indexes.find(object);
+  bool first = it == indexes.end();
+  int index = first ? indexes.size() : it->second;
+  if (first) indexes[object] = index;
+  checkpoint.WriteValue(index);
+  return first;
+}
+
+// Read the index of a shared object. If the index is equal to 'size', the
+// number of objects of the same kind loaded so far, the content of a new
+// object follows.
+static int LoadSharedIndex(misc::Checkpoint& checkpoint, int size) {
+  int index = checkpoint.ReadValue<int>();
+  if (index < 0 || index > size)
+    throw misc::Checkpoint::Error(checkpoint.getPath(),
+                                  misc::fmt("Invalid object index %d", index));
+  return index;
+}
+
+const std::pair<Context::CanWakeupFn, Context::WakeupFn>
+    Context::wakeup_callbacks[] = {
+        {nullptr, nullptr},
+        {&Context::SyscallNanosleepCanWakeup, &Context::SyscallNanosleepWakeup},
+        {&Context::SyscallReadCanWakeup, &Context::SyscallReadWakeup},
+        {&Context::SyscallPread64CanWakeup, &Context::SyscallPread64Wakeup},
+        {&Context::SyscallWriteCanWakeup, &Context::SyscallWriteWakeup},
+        {&Context::SyscallPollCanWakeup, &Context::SyscallPollWakeup},
+        {&Context::SyscallSigsuspendCanWakeup,
+         &Context::SyscallSigsuspendWakeup},
+        {&Context::SyscallWaitpidCanWakeup, &Context::SyscallWaitpidWakeup}};
+
+const unsigned Context::num_wakeup_callbacks =
+    sizeof wakeup_callbacks / sizeof wakeup_callbacks[0];
+
+void Context::SaveCheckpoint(misc::Checkpoint& checkpoint,
+                             CheckpointObjects& objects) const {
+  // Speculative state is never saved
+  if (getState(StateSpecMode))
+    throw misc::Panic("Context in speculative mode");
+
+  // Identity and state. Mapping of the context to hardware threads is
+  // decided again by the timing simulator after the checkpoint is loaded.
+  checkpoint.WriteTag("Context");
+  checkpoint.WriteValue(getId());
+  checkpoint.WriteValue(state & ~(StateAlloc | StateMapped));
+  checkpoint.WriteValue(parent ? parent->getId() : 0);
+  checkpoint.WriteValue(group_parent ? group_parent->getId() : 0);
+
+  // Registers
+  checkpoint.WriteValue(regs);
+  checkpoint.WriteValue(last_eip);
+  checkpoint.WriteValue(current_eip);
+
+  // Memory, shared among cloned contexts
+  if (SaveSharedIndex(checkpoint, objects.memory_indexes, memory.get()))
+    memory->SaveCheckpoint(checkpoint);
+
+  // File table
+  if (SaveSharedIndex(checkpoint, objects.file_table_indexes,
+                      file_table.get()))
+    file_table->SaveCheckpoint(checkpoint);
+
+  // Signal handlers and masks
+  if (SaveSharedIndex(checkpoint, objects.signal_handler_table_indexes,
+                      signal_handler_table.get()))
+    signal_handler_table->SaveCheckpoint(checkpoint);
+  signal_mask_table.SaveCheckpoint(checkpoint);
+
+  // Loader information
+  if (SaveSharedIndex(checkpoint, objects.loader_indexes, loader.get())) {
+    checkpoint.WriteStrings(loader->args);
+    checkpoint.WriteStrings(loader->env);
+    checkpoint.WriteString(loader->interpreter);
+    checkpoint.WriteString(loader->exe);
+    checkpoint.WriteString(loader->cwd);
+    checkpoint.WriteString(loader->stdin_file_name);
+    checkpoint.WriteString(loader->stdout_file_name);
+    checkpoint.WriteValue(loader->stack_base);
+    checkpoint.WriteValue(loader->stack_top);
+    checkpoint.WriteValue(loader->stack_size);
+    checkpoint.WriteValue(loader->environ_base);
+    checkpoint.WriteValue(loader->prog_entry);
+    checkpoint.WriteValue(loader->interp_prog_entry);
+    checkpoint.WriteValue(loader->at_random_addr);
+    checkpoint.WriteValue(loader->at_random_addr_holder);
+    checkpoint.WriteValue(loader->at_platform_ptr);
+  }
+
+  // Process information
+  checkpoint.WriteValue(exit_signal);
+  checkpoint.WriteValue(exit_code);
+  checkpoint.WriteValue(clear_child_tid);
+  checkpoint.WriteValue(robust_list_head);
+  checkpoint.WriteValue(glibc_segment_base);
+  checkpoint.WriteValue(glibc_segment_limit);
+  checkpoint.WriteValue(sched_policy);
+  checkpoint.WriteValue(sched_priority);
+
+  // Futexes
+  checkpoint.WriteValue(wakeup_futex);
+  checkpoint.WriteValue(wakeup_futex_bitset);
+  checkpoint.WriteValue(wakeup_futex_sleep);
+
+  // Suspended system calls. Wakeup callbacks are saved as their position
+  // in table 'wakeup_callbacks'.
+  int callback_index = -1;
+  for (unsigned i = 0; i < num_wakeup_callbacks; i++)
+    if (wakeup_callbacks[i].first == can_wakeup_fn &&
+        wakeup_callbacks[i].second == wakeup_fn)
+      callback_index = i;
+  if (callback_index < 0) throw misc::Panic("Unknown wakeup callback");
+  checkpoint.WriteValue(callback_index);
+  checkpoint.WriteValue(getState(StateCallback) ? wakeup_state : StateInvalid);
+  checkpoint.WriteValue(syscall_nanosleep_wakeup_time);
+  checkpoint.WriteValue(syscall_read_fd);
+  checkpoint.WriteValue(syscall_pread64_fd);
+  checkpoint.WriteValue(syscall_write_fd);
+  checkpoint.WriteValue(syscall_poll_time);
+  checkpoint.WriteValue(syscall_poll_fd);
+  checkpoint.WriteValue(syscall_poll_events);
+  checkpoint.WriteValue(syscall_waitpid_pid);
+}
+
+void Context::LoadCheckpoint(misc::Checkpoint& checkpoint,
+                             CheckpointObjects& objects) {
+  // Identity
+  checkpoint.ReadTag("Context");
+  setId(checkpoint.ReadValue<int>());
+  unsigned saved_state = checkpoint.ReadValue<unsigned>();
+  int parent_id = checkpoint.ReadValue<int>();
+  int group_parent_id = checkpoint.ReadValue<int>();
+  parent = parent_id ? emulator->getContext(parent_id) : nullptr;
+  group_parent = group_parent_id ? emulator->getContext(group_parent_id)
+                                 : nullptr;
+  if ((parent_id && !parent) || (group_parent_id && !group_parent))
+    throw misc::Checkpoint::Error(
+        checkpoint.getPath(),
+        misc::fmt("%s: Parent context not found", getName().c_str()));
+
+  // Registers
+  checkpoint.ReadValue(regs);
+  checkpoint.ReadValue(last_eip);
+  checkpoint.ReadValue(current_eip);
+
+  // Memory and virtual address space
+  int index = LoadSharedIndex(checkpoint, objects.memories.size());
+  if (index == (int)objects.memories.size()) {
+    objects.memories.push_back(misc::new_shared<mem::Memory>());
+    objects.memories.back()->LoadCheckpoint(checkpoint);
+    objects.mmu_spaces.push_back(mmu->newSpace());
+  }
+  memory = objects.memories[index];
+  mmu_space = objects.mmu_spaces[index];
+  spec_mem = misc::new_unique<mem::SpecMem>(memory.get());
+
+  // File table
+  index = LoadSharedIndex(checkpoint, objects.file_tables.size());
+  if (index == (int)objects.file_tables.size()) {
+    objects.file_tables.push_back(misc::new_shared<comm::FileTable>());
+    objects.file_tables.back()->LoadCheckpoint(checkpoint,
+                                               objects.host_indexes);
+  }
+  file_table = objects.file_tables[index];
+
+  // Signal handlers and masks
+  index = LoadSharedIndex(checkpoint, objects.signal_handler_tables.size());
+  if (index == (int)objects.signal_handler_tables.size()) {
+    objects.signal_handler_tables.push_back(
+        misc::new_shared<SignalHandlerTable>());
+    objects.signal_handler_tables.back()->LoadCheckpoint(checkpoint);
+  }
+  signal_handler_table = objects.signal_handler_tables[index];
+  signal_mask_table.LoadCheckpoint(checkpoint);
+
+  // Loader information. The ELF binary is not reloaded, since it is only
+  // needed while the program is being loaded.
+  index = LoadSharedIndex(checkpoint, objects.loaders.size());
+  if (index == (int)objects.loaders.size()) {
+    auto loader = misc::new_shared<Loader>();
+    checkpoint.ReadStrings(loader->args);
+    checkpoint.ReadStrings(loader->env);
+    loader->interpreter = checkpoint.ReadString();
+    loader->exe = checkpoint.ReadString();
+    loader->cwd = checkpoint.ReadString();
+    loader->stdin_file_name = checkpoint.ReadString();
+    loader->stdout_file_name = checkpoint.ReadString();
+    checkpoint.ReadValue(loader->stack_base);
+    checkpoint.ReadValue(loader->stack_top);
+    checkpoint.ReadValue(loader->stack_size);
+    checkpoint.ReadValue(loader->environ_base);
+    checkpoint.ReadValue(loader->prog_entry);
+    checkpoint.ReadValue(loader->interp_prog_entry);
+    checkpoint.ReadValue(loader->at_random_addr);
+    checkpoint.ReadValue(loader->at_random_addr_holder);
+    checkpoint.ReadValue(loader->at_platform_ptr);
+    objects.loaders.push_back(loader);
+  }
+  loader = objects.loaders[index];
+  call_stack = misc::new_unique<comm::CallStack>(loader->exe);
+
+  // Process information
+  checkpoint.ReadValue(exit_signal);
+  checkpoint.ReadValue(exit_code);
+  checkpoint.ReadValue(clear_child_tid);
+  checkpoint.ReadValue(robust_list_head);
+  checkpoint.ReadValue(glibc_segment_base);
+  checkpoint.ReadValue(glibc_segment_limit);
+  checkpoint.ReadValue(sched_policy);
+  checkpoint.ReadValue(sched_priority);
+
+  // Futexes
+  checkpoint.ReadValue(wakeup_futex);
+  checkpoint.ReadValue(wakeup_futex_bitset);
+  checkpoint.ReadValue(wakeup_futex_sleep);
+
+  // Suspended system calls
+  int callback_index = checkpoint.ReadValue<int>();
+  if (callback_index < 0 || callback_index >= (int)num_wakeup_callbacks)
+    throw misc::Checkpoint::Error(checkpoint.getPath(),
+                                  "Invalid wakeup callback");
+  can_wakeup_fn = wakeup_callbacks[callback_index].first;
+  wakeup_fn = wakeup_callbacks[callback_index].second;
+  checkpoint.ReadValue(wakeup_state);
+  checkpoint.ReadValue(syscall_nanosleep_wakeup_time);
+  checkpoint.ReadValue(syscall_read_fd);
+  checkpoint.ReadValue(syscall_pread64_fd);
+  checkpoint.ReadValue(syscall_write_fd);
+  checkpoint.ReadValue(syscall_poll_time);
+  checkpoint.ReadValue(syscall_poll_fd);
+  checkpoint.ReadValue(syscall_poll_events);
+  checkpoint.ReadValue(syscall_waitpid_pid);
+
+  // Set the state last, which places the context in the emulator lists
+  UpdateState(saved_state);
+}
+
+}  // namespace x86
@@ -17,9 +17,15 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 #include <lib/cpp/Misc.h>
 
+#include "BasicBlockProfiler.h"
 #include "Context.h"
+#include "Emulator.h"
 
 namespace x86 {
 
@@ -43,6 +49,91 @@ void Context::StartRepInst() {
   }
 }
 
+unsigned Context::getRepPageIterations(unsigned address, int size) {
+  unsigned offset = address & (mem::Memory::PageSize - 1);
+  if (offset + size > mem::Memory::PageSize) return 0;
+  if (regs.getFlag(Instruction::FlagDF)) return offset / size + 1;
+  return (mem::Memory::PageSize - offset) / size;
+}
+
+unsigned Context::getRepChunkLimit() {
+  long long limit = std::numeric_limits<unsigned>::max();
+
+  // Instructions left before the instruction limit, counting this one
+  long long max_instructions = Emulator::getMaxInstructions();
+  if (max_instructions)
+    limit = std::min(limit, max_instructions - emulator->getNumInstructions());
+
+  // Execute() records the first iteration as the end of the current basic
+  // block, and all others but the last one as a single block. That block
+  // must end within an interval, as iterations recorded one by one would.
+  BasicBlockProfiler* profiler = emulator->getBasicBlockProfiler();
+  if (profiler) {
+    long long left =
+        profiler->getNumIntervalInstructionsLeft() - (bbv_block_size + 1);
+    if (left <= 0) left += profiler->getIntervalSize();
+    limit = std::min(limit, left + 2);
+  }
+
+  // At least one iteration
+  return std::max(limit, 1LL);
+}
+
+unsigned Context::ExecuteRepMovsChunk(int size) {
+  // Limit chunk to the current count and the pages of source and destination
+  unsigned esi = regs.getEsi();
+  unsigned edi = regs.getEdi();
+  unsigned count = std::min(regs.getEcx(), getRepPageIterations(esi, size));
+  count = std::min(count, getRepPageIterations(edi, size));
+  count = std::min(count, getRepChunkLimit());
+
+  // Overlapping source and destination must observe the values written by
+  // previous iterations, so the chunk cannot cover the distance between them.
+  unsigned distance = std::min(esi - edi, edi - esi);
+  if (distance && distance < count * size) count = distance / size;
+  if (!count) count = 1;
+
+  // Copy block, from its lowest address when going backward
+  char buffer[mem::Memory::PageSize];
+  unsigned bytes = count * size;
+  bool backward = regs.getFlag(Instruction::FlagDF);
+  unsigned offset = backward ? bytes - size : 0;
+  MemoryRead(esi - offset, bytes, buffer);
+  MemoryWrite(edi - offset, bytes, buffer);
+
+  // Update registers
+  int step = backward ? -(int)bytes : bytes;
+  regs.incEsi(step);
+  regs.incEdi(step);
+  regs.setEcx(regs.getEcx() - count);
+  return count;
+}
+
+unsigned Context::ExecuteRepStosChunk(int size) {
+  // Limit chunk to the current count and the destination page
+  unsigned edi = regs.getEdi();
+  unsigned count = std::min(regs.getEcx(), getRepPageIterations(edi, size));
+  count = std::min(count, getRepChunkLimit());
+  if (!count) count = 1;
+
+  // Replicate value
+  char buffer[mem::Memory::PageSize];
+  unsigned bytes = count * size;
+  unsigned value = size == 1 ? regs.Read(Instruction::RegAl)
+                             : regs.Read(Instruction::RegEax);
+  for (unsigned i = 0; i < bytes; i += size) memcpy(buffer + i, &value, size);
+
+  // Fill block, from its lowest address when going backward
+  bool backward = regs.getFlag(Instruction::FlagDF);
+  unsigned offset = backward ? bytes - size : 0;
+  MemoryWrite(edi - offset, bytes, buffer);
+
+  // Update registers
+  regs.incEdi(backward ? -(int)bytes : bytes);
+  regs.setEcx(regs.getEcx() - count);
+  return count;
+}
+
 #define OP_REP_IMPL(X, SIZE)                                                 \
   void Context::ExecuteInst_rep_##X() {                                      \
     StartRepInst();                                                          \
@@ -59,10 +150,62 @@ void Context::StartRepInst() {
     newUinst(Uinst::OpcodeIbranch, Uinst::DepEcx, 0, 0, 0, 0, 0, 0);         \
   }
 
+// In functional simulation, 'rep movs' and 'rep stos' run a whole chunk of
+// iterations at once. The instruction pointer is still rewound, so the
+// final iteration with ECX equal to 0 is executed as usual. Execute()
+// accounts for the extra iterations.
+#define OP_REP_CHUNK_IMPL(X, SIZE, CHUNK)                                    \
+  void Context::ExecuteInst_rep_##X() {                                      \
+    StartRepInst();                                                          \
+                                                                             \
+    if (isRepChunkActive()) {                                                \
+      if (regs.getEcx()) {                                                   \
+        unsigned count = CHUNK(SIZE);                                        \
+        regs.decEip(inst.getSize());                                         \
+        num_extra_rep_iterations = count - 1;                                \
+      }                                                                      \
+      return;                                                                \
+    }                                                                        \
+                                                                             \
+    if (regs.getEcx()) {                                                     \
+      ExecuteStringInst_##X();                                               \
+      regs.decEcx();                                                         \
+      regs.decEip(inst.getSize());                                           \
+    }                                                                        \
+                                                                             \
+    newUinst_##X(str_op_esi + str_op_count * (SIZE)*str_op_dir,              \
+                 str_op_edi + str_op_count * (SIZE)*str_op_dir);             \
+    newUinst(Uinst::OpcodeSub, Uinst::DepEcx, 0, 0, Uinst::DepEcx, 0, 0, 0); \
+    newUinst(Uinst::OpcodeIbranch, Uinst::DepEcx, 0, 0, 0, 0, 0, 0);         \
+  }
+
+// In functional simulation, 'repz' and 'repnz' iterate within a single call
+// until the repetition ends, a page worth of elements has been compared, or
+// the limit given by getRepChunkLimit() is reached.
+#define OP_REP_COND_LOOP(X, SIZE, COND)                                      \
+  if (isRepChunkActive()) {                                                  \
+    unsigned limit =                                                         \
+        std::min(getRepChunkLimit(), mem::Memory::PageSize / (SIZE));        \
+    unsigned count = 0;                                                      \
+    bool repeat = false;                                                     \
+    while (regs.getEcx() && count < limit) {                                 \
+      ExecuteStringInst_##X();                                               \
+      regs.decEcx();                                                         \
+      count++;                                                               \
+      repeat = (COND);                                                       \
+      if (!repeat) break;                                                    \
+    }                                                                        \
+    if (repeat) regs.decEip(inst.getSize());                                 \
+    if (count) num_extra_rep_iterations = count - 1;                         \
+    return;                                                                  \
+  }
+
 #define OP_REPZ_IMPL(X, SIZE)                                                \
   void Context::ExecuteInst_repz_##X() {                                     \
     StartRepInst();                                                          \
                                                                              \
+    OP_REP_COND_LOOP(X, SIZE, regs.getFlag(Instruction::FlagZF))             \
+                                                                             \
     if (regs.getEcx()) {                                                     \
       ExecuteStringInst_##X();                                               \
       regs.decEcx();                                                         \
@@ -80,6 +223,8 @@ void Context::StartRepInst() {
   void Context::ExecuteInst_repnz_##X() {                                    \
     StartRepInst();                                                          \
                                                                              \
+    OP_REP_COND_LOOP(X, SIZE, !regs.getFlag(Instruction::FlagZF))            \
+                                                                             \
     if (regs.getEcx()) {                                                     \
       ExecuteStringInst_##X();                                               \
       regs.decEcx();                                                         \
@@ -533,8 +678,8 @@ void Context::ExecuteInst_stosd() {
 OP_REP_IMPL(insb, 1)
 OP_REP_IMPL(insd, 4)
 
-OP_REP_IMPL(movsb, 1)
-OP_REP_IMPL(movsd, 4)
+OP_REP_CHUNK_IMPL(movsb, 1, ExecuteRepMovsChunk)
+OP_REP_CHUNK_IMPL(movsd, 4, ExecuteRepMovsChunk)
 
 OP_REP_IMPL(outsb, 1)
 OP_REP_IMPL(outsd, 4)
@@ -542,8 +687,8 @@ OP_REP_IMPL(outsd, 4)
 OP_REP_IMPL(lodsb, 1)
 OP_REP_IMPL(lodsd, 4)
 
-OP_REP_IMPL(stosb, 1)
-OP_REP_IMPL(stosd, 4)
+OP_REP_CHUNK_IMPL(stosb, 1, ExecuteRepStosChunk)
+OP_REP_CHUNK_IMPL(stosd, 4, ExecuteRepStosChunk)
 
 OP_REPZ_IMPL(cmpsb, 1)
 OP_REPZ_IMPL(cmpsd, 4)
@@ -200,6 +200,10 @@ struct sim_user_desc {
 //
 
 void Context::ExecuteSyscall() {
+  // System calls access the emulator and other contexts, which the timing
+  // simulator may be emulating on other host threads
+  Emulator::SharedLock lock(emulator);
+
   // Get system call code from register eax
   int code = regs.getEax();
 
@@ -18,6 +18,7 @@
  */
 
 #include <arch/x86/disassembler/Disassembler.h>
+#include <lib/cpp/Checkpoint.h>
 #include <lib/esim/Engine.h>
 
 #include "Context.h"
@@ -33,6 +34,9 @@ std::string Emulator::syscall_debug_file;
 
 long long Emulator::max_instructions;
 
+std::string Emulator::bbv_file;
+long long Emulator::bbv_interval = 100000000;
+
 std::unique_ptr<Emulator> Emulator::instance;
 
 misc::Debug Emulator::call_debug;
@@ -92,6 +96,20 @@ void Emulator::RegisterOptions() {
       "instructions. On x86 detailed simulation, it is given as "
       "the number of committed (non-speculative) instructions. "
       "A value of 0 means no limit.");
+
+  // Option --x86-bbv <file>
+  command_line->RegisterString(
+      "--x86-bbv <file>", bbv_file,
+      "Profile basic blocks executed by the x86 program and dump their "
+      "basic block vectors into <file>, one line per interval, using the "
+      "frequency vector format of SimPoint. Only instructions executed in "
+      "non-speculative mode are profiled.");
+
+  // Option --x86-bbv-interval <number>
+  command_line->RegisterInt64(
+      "--x86-bbv-interval <number> (default = 100M)", bbv_interval,
+      "Number of x86 instructions in each basic block vector interval "
+      "dumped with option '--x86-bbv'.");
 }
 
 void Emulator::ProcessOptions() {
@@ -101,6 +119,18 @@ void Emulator::ProcessOptions() {
   isa_debug.setPath(isa_debug_file);
   loader_debug.setPath(loader_debug_file);
   syscall_debug.setPath(syscall_debug_file);
+
+  // Basic block vector interval
+  if (bbv_interval < 1)
+    throw Error(misc::fmt("Invalid value for '--x86-bbv-interval': %lld",
+                          bbv_interval));
+}
+
+Emulator::Emulator() : comm::Emulator("x86") {
+  // Basic block vector profiler
+  if (!bbv_file.empty())
+    basic_block_profiler =
+        misc::new_unique<BasicBlockProfiler>(bbv_file, bbv_interval);
 }
 
 void Emulator::InsertInRunningContexts(Context* context) {
@@ -239,6 +269,64 @@ void Emulator::LoadProgram(const std::vector<std::string>& args,
   context->Load(args, env, cwd, stdin_file_name, stdout_file_name);
 }
 
+void Emulator::SaveCheckpoint(misc::Checkpoint& checkpoint) {
+  // Emulator state
+  checkpoint.WriteTag("x86");
+  checkpoint.WriteValue(pid);
+  checkpoint.WriteValue(futex_sleep_count);
+
+  // Contexts, in the order of the main list. Parents always appear before
+  // their children.
+  Context::CheckpointObjects objects;
+  checkpoint.WriteValue((int)contexts.size());
+  for (auto& context : contexts) context->SaveCheckpoint(checkpoint, objects);
+
+  // Order of the running and suspended lists
+  checkpoint.WriteValue((int)running_contexts.size());
+  for (Context* context : running_contexts)
+    checkpoint.WriteValue(context->getId());
+  checkpoint.WriteValue((int)suspended_contexts.size());
+  for (Context* context : suspended_contexts)
+    checkpoint.WriteValue(context->getId());
+}
+
+void Emulator::LoadCheckpoint(misc::Checkpoint& checkpoint) {
+  // Contexts must be created from the checkpoint only
+  if (contexts.size())
+    throw Error("Cannot load a checkpoint after loading a program");
+
+  // Emulator state
+  checkpoint.ReadTag("x86");
+  checkpoint.ReadValue(pid);
+  checkpoint.ReadValue(futex_sleep_count);
+
+  // Contexts
+  Context::CheckpointObjects objects;
+  int num_contexts = checkpoint.ReadValue<int>();
+  for (int i = 0; i < num_contexts; i++)
+    newContext()->LoadCheckpoint(checkpoint, objects);
+
+  // Restore the order of the running and suspended lists by moving each
+  // context to the end of its list in the saved order.
+  for (int list = 0; list < 2; list++) {
+    int size = checkpoint.ReadValue<int>();
+    for (int i = 0; i < size; i++) {
+      Context* context = getContext(checkpoint.ReadValue<int>());
+      if (!context) throw Error("Invalid context in checkpoint");
+      if (list == 0 && context->in_running_contexts) {
+        RemoveFromRunningContexts(context);
+        InsertInRunningContexts(context);
+      } else if (list == 1 && context->in_suspended_contexts) {
+        RemoveFromSuspendedContexts(context);
+        InsertInSuspendedContexts(context);
+      }
+    }
+  }
+
+  // Let suspended contexts check whether they can wake up
+  ProcessEventsSchedule();
+}
+
 void Emulator::FreeContext(Context* context) {
   // Remove context from all context lists
   UpdateRunningContexts(context, false);
@@ -28,6 +28,7 @@
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
 
+#include "BasicBlockProfiler.h"
 #include "Context.h"
 
 namespace x86 {
@@ -61,6 +62,13 @@ class Emulator : public comm::Emulator {
   // Maximum number of instructions
   static long long max_instructions;
 
+  // Basic block vector file, set with option '--x86-bbv'
+  static std::string bbv_file;
+
+  // Basic block vector interval size, set with option
+  // '--x86-bbv-interval'
+  static long long bbv_interval;
+
   // Unique instance of singleton
   static std::unique_ptr<Emulator> instance;
 
@@ -100,6 +108,13 @@ class Emulator : public comm::Emulator {
   // for FIFO wakeups.
   long long futex_sleep_count = 0;
 
+  // Basic block vector profiler, or null if profiling is not active
+  std::unique_ptr<BasicBlockProfiler> basic_block_profiler;
+
+  // Mutex locked by system calls while a timing simulator emulates
+  // contexts on multiple host threads, or null otherwise
+  pthread_mutex_t* shared_mutex = nullptr;
+
  public:
   //
   // Static fields
@@ -140,7 +155,7 @@ class Emulator : public comm::Emulator {
   //
 
   /// Constructor
-  Emulator() : comm::Emulator("x86") {}
+  Emulator();
 
   /// Create a new context associated with the emulator. The context is
   /// inserted in the main emulator context list. Its state is set to
@@ -163,6 +178,19 @@ class Emulator : public comm::Emulator {
                    const std::string& stdin_file_name = "",
                    const std::string& stdout_file_name = "");
 
+  /// Save all contexts into a checkpoint. See comm::Emulator for details.
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) override;
+
+  /// Create the contexts saved in a checkpoint. See comm::Emulator for
+  /// details.
+  void LoadCheckpoint(misc::Checkpoint& checkpoint) override;
+
+  /// Return the basic block vector profiler, or null if option
+  /// '--x86-bbv' was not given.
+  BasicBlockProfiler* getBasicBlockProfiler() const {
+    return basic_block_profiler.get();
+  }
+
   /// Return a unique process ID. Contexts can call this function when
   /// created to obtain their unique identifier.
   int getPid() { return pid++; }
@@ -173,6 +201,28 @@ class Emulator : public comm::Emulator {
   /// Unlock the emulator mutex
   void UnlockMutex() { pthread_mutex_unlock(&mutex); }
 
+  /// Set the mutex locked by system calls while a timing simulator
+  /// emulates contexts on multiple host threads, or null when it stops
+  /// doing so. The mutex must be recursive.
+  void setSharedMutex(pthread_mutex_t* shared_mutex) {
+    this->shared_mutex = shared_mutex;
+  }
+
+  /// Lock of the mutex set with setSharedMutex(), held during the
+  /// lifetime of the object. Locking has no effect if no mutex is set.
+  class SharedLock {
+    pthread_mutex_t* mutex;
+
+   public:
+    SharedLock(Emulator* emulator) : mutex(emulator->shared_mutex) {
+      if (mutex) pthread_mutex_lock(mutex);
+    }
+
+    ~SharedLock() {
+      if (mutex) pthread_mutex_unlock(mutex);
+    }
+  };
+
   // Check for events detected in spawned host threads, such as waking up
   // contexts or sending signals. The list is only effectively processed
   // if events have been scheduled to get processed with a previous call
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <lib/cpp/Checkpoint.h>
+
 #include "Signal.h"
 
 namespace x86 {
@@ -63,6 +65,57 @@ void SignalSet::Dump(std::ostream& os) const {
   os << " }";
 }
 
+void SignalSet::SaveCheckpoint(misc::Checkpoint& checkpoint) const {
+  checkpoint.Write(bitmap.getBuffer(), bitmap.getSizeInBytes());
+}
+
+void SignalSet::LoadCheckpoint(misc::Checkpoint& checkpoint) {
+  checkpoint.Read(bitmap.getBuffer(), bitmap.getSizeInBytes());
+}
+
+void SignalMaskTable::SaveCheckpoint(misc::Checkpoint& checkpoint) const {
+  pending.SaveCheckpoint(checkpoint);
+  blocked.SaveCheckpoint(checkpoint);
+  backup.SaveCheckpoint(checkpoint);
+  checkpoint.WriteValue(ret_code_ptr);
+  checkpoint.WriteValue(regs != nullptr);
+  if (regs) checkpoint.WriteValue(*regs);
+}
+
+void SignalMaskTable::LoadCheckpoint(misc::Checkpoint& checkpoint) {
+  pending.LoadCheckpoint(checkpoint);
+  blocked.LoadCheckpoint(checkpoint);
+  backup.LoadCheckpoint(checkpoint);
+  checkpoint.ReadValue(ret_code_ptr);
+  regs.reset();
+  if (checkpoint.ReadValue<bool>()) {
+    regs.reset(new Regs());
+    checkpoint.ReadValue(*regs);
+  }
+}
+
+void SignalHandler::SaveCheckpoint(misc::Checkpoint& checkpoint) const {
+  checkpoint.WriteValue(handler);
+  checkpoint.WriteValue(flags);
+  checkpoint.WriteValue(restorer);
+  mask.SaveCheckpoint(checkpoint);
+}
+
+void SignalHandler::LoadCheckpoint(misc::Checkpoint& checkpoint) {
+  checkpoint.ReadValue(handler);
+  checkpoint.ReadValue(flags);
+  checkpoint.ReadValue(restorer);
+  mask.LoadCheckpoint(checkpoint);
+}
+
+void SignalHandlerTable::SaveCheckpoint(misc::Checkpoint& checkpoint) const {
+  for (auto& handler : signal_handler) handler.SaveCheckpoint(checkpoint);
+}
+
+void SignalHandlerTable::LoadCheckpoint(misc::Checkpoint& checkpoint) {
+  for (auto& handler : signal_handler) handler.LoadCheckpoint(checkpoint);
+}
+
 void SignalHandler::ReadFromMemory(mem::Memory* memory, unsigned address) {
   memory->Read(address, 4, (char*)&handler);
   memory->Read(address + 4, 4, (char*)&flags);
@@ -28,6 +28,10 @@
 
 #include "Regs.h"
 
+namespace misc {
+class Checkpoint;
+}
+
 namespace x86 {
 
 class Regs;
@@ -186,6 +190,12 @@ class SignalSet {
     assert(bitmap.getSizeInBytes() == 8);
     memory->Write(address, 8, bitmap.getBuffer());
   }
+
+  /// Save signal set into a checkpoint
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) const;
+
+  /// Load signal set from a checkpoint
+  void LoadCheckpoint(misc::Checkpoint& checkpoint);
 };
 
 /// Signal mask table. Each context has its own table, including parent and
@@ -248,6 +258,12 @@ class SignalMaskTable {
 
   /// Return address where the return code can be found.
   unsigned getRetCodePtr() const { return ret_code_ptr; }
+
+  /// Save signal masks and the register backup into a checkpoint
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) const;
+
+  /// Load signal masks and the register backup from a checkpoint
+  void LoadCheckpoint(misc::Checkpoint& checkpoint);
 };
 
 /// Signal handler information. This structure corresponds to the Unix \c
@@ -287,6 +303,12 @@ class SignalHandler {
 
   /// Write the content of the signal handler to memory
   void WriteToMemory(mem::Memory* memory, unsigned address);
+
+  /// Save signal handler into a checkpoint
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) const;
+
+  /// Load signal handler from a checkpoint
+  void LoadCheckpoint(misc::Checkpoint& checkpoint);
 };
 
 /// Table of signal handlers. Multiple contexts can share the same time, so they
@@ -302,6 +324,12 @@ class SignalHandlerTable {
     assert(misc::inRange(sig, 1, 64));
     return &signal_handler[sig - 1];
   }
+
+  /// Save all signal handlers into a checkpoint
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) const;
+
+  /// Load all signal handlers from a checkpoint
+  void LoadCheckpoint(misc::Checkpoint& checkpoint);
 };
 
 }  // namespace x86
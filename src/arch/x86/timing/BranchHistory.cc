@@ -0,0 +1,42 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <lib/cpp/Misc.h>
+
+#include "BranchHistory.h"
+
+namespace x86 {
+
+BranchHistory::BranchHistory(int max_length) {
+  // Round buffer size up to a power of 2. One more outcome than the
+  // maximum length is needed by the folded histories.
+  int size = 1;
+  while (size < max_length + 1) size <<= 1;
+  mask = size - 1;
+  outcomes = misc::new_unique_array<char>(size);
+}
+
+void BranchHistory::Push(bool taken, unsigned eip) {
+  head = (head - 1) & mask;
+  outcomes[head] = taken;
+  path = ((path << 1) | ((eip ^ (eip >> 2)) & 1)) & 0xffff;
+}
+
+}  // namespace x86
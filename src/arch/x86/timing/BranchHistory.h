@@ -0,0 +1,123 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef ARCH_X86_TIMING_BRANCH_HISTORY_H
+#define ARCH_X86_TIMING_BRANCH_HISTORY_H
+
+#include <memory>
+
+namespace x86 {
+
+/// Global history of conditional branch outcomes, used by the predictors
+/// that index their tables with long histories (TAGE, hashed perceptron,
+/// and ITTAGE). Outcomes are kept in a circular buffer. Each predictor
+/// keeps folded copies of the history segments it uses, which are updated
+/// in constant time as new outcomes are shifted in.
+class BranchHistory {
+ public:
+  /// A history of \a length outcomes folded into \a width bits by XOR-ing
+  /// consecutive chunks of the original history.
+  class Folded {
+    // Folded value
+    unsigned value = 0;
+
+    // Number of outcomes of the original history
+    int length = 0;
+
+    // Number of bits of the folded value
+    int width = 0;
+
+    // Bit position where the outcome leaving the original history is
+    // removed from the folded value
+    int outpoint = 0;
+
+   public:
+    /// Empty folded history, always equal to 0
+    Folded() {}
+
+    /// Constructor
+    Folded(int length, int width)
+        : length(length), width(width), outpoint(width ? length % width : 0) {}
+
+    /// Return the length of the original history
+    int getLength() const { return length; }
+
+    /// Return the folded value
+    unsigned getValue() const { return value; }
+
+    /// Shift outcome \a in into the folded history. Argument \a out is
+    /// the outcome at position 'length' of the original history after
+    /// \a in was shifted in, i.e., the one leaving the segment.
+    void Update(bool in, bool out) {
+      if (!width) return;
+      value = (value << 1) | in;
+      value ^= (unsigned)out << outpoint;
+      value ^= value >> width;
+      value &= (1u << width) - 1;
+    }
+  };
+
+ private:
+  // Circular buffer of outcomes. Its size is a power of 2.
+  std::unique_ptr<char[]> outcomes;
+
+  // Mask used to wrap positions around the circular buffer
+  int mask = 0;
+
+  // Position of the most recent outcome in the circular buffer
+  int head = 0;
+
+  // Path history, containing one address bit of each recent branch
+  unsigned path = 0;
+
+ public:
+  /// Create a history able to provide segments of up to \a max_length
+  /// outcomes.
+  explicit BranchHistory(int max_length);
+
+  /// Return the outcome at position \a index, where 0 is the most recent.
+  bool operator[](int index) const {
+    return outcomes[(head + index) & mask];
+  }
+
+  /// Return the outcome at position \a index of the history after shifting
+  /// in \a count predicted outcomes, given in \a predictions with the
+  /// oldest one in bit 0. The history itself is not modified.
+  bool getOutcome(int index, unsigned predictions, int count) const {
+    return index < count ? (predictions >> (count - 1 - index)) & 1
+                         : (*this)[index - count];
+  }
+
+  /// Return the path history
+  unsigned getPath() const { return path; }
+
+  /// Shift in the outcome of the branch at address \a eip
+  void Push(bool taken, unsigned eip);
+
+  /// Update a folded copy of the history after an outcome was shifted in
+  /// with Push().
+  void Update(Folded& folded) const {
+    folded.Update((*this)[0], (*this)[folded.getLength()]);
+  }
+};
+
+}  // namespace x86
+
+#endif
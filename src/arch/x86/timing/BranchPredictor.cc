@@ -17,7 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
 
 #include "BranchPredictor.h"
 #include "Uop.h"
@@ -25,6 +28,8 @@
 namespace x86 {
 
 BranchPredictor::Kind BranchPredictor::kind;
+BranchPredictor::IndirectKind BranchPredictor::indirect_kind;
+int BranchPredictor::storage_budget;
 int BranchPredictor::btb_num_sets;
 int BranchPredictor::btb_num_ways;
 int BranchPredictor::ras_size;
@@ -38,7 +43,20 @@ int BranchPredictor::two_level_l2_height;
 misc::StringMap BranchPredictor::KindMap = {
     {"Perfect", KindPerfect},   {"Taken", KindTaken},
     {"NotTaken", KindNottaken}, {"Bimodal", KindBimod},
-    {"TwoLevel", KindTwoLevel}, {"Combined", KindCombined}};
+    {"TwoLevel", KindTwoLevel}, {"Combined", KindCombined},
+    {"TAGE", KindTage},         {"Perceptron", KindPerceptron}};
+
+misc::StringMap BranchPredictor::IndirectKindMap = {
+    {"BTB", IndirectKindBtb}, {"ITTAGE", IndirectKindIttage}};
+
+// Return true if the uop is a jump or call whose target is read from a
+// register or memory, rather than encoded in the instruction.
+static bool isIndirectBranch(Uop* uop) {
+  Uinst* uinst = uop->getUinst();
+  return (uinst->getOpcode() == Uinst::OpcodeJump ||
+          uinst->getOpcode() == Uinst::OpcodeCall) &&
+         uinst->getIDep(0) != Uinst::DepNone;
+}
 
 BranchPredictor::BranchPredictor(const std::string& name) : name(name) {
   // Initialize
@@ -65,6 +83,22 @@ BranchPredictor::BranchPredictor(const std::string& name) : name(name) {
     for (int i = 0; i < choice_size; i++) choice[i] = 2;
   }
 
+  // Predictors based on a long global history
+  int max_history = 0;
+  if (kind == KindTage) {
+    tage = misc::new_unique<Tage>();
+    max_history = std::max(max_history, Tage::getMaxHistory());
+  }
+  if (kind == KindPerceptron) {
+    perceptron = misc::new_unique<Perceptron>();
+    max_history = std::max(max_history, Perceptron::getMaxHistory());
+  }
+  if (indirect_kind == IndirectKindIttage) {
+    ittage = misc::new_unique<Ittage>();
+    max_history = std::max(max_history, Ittage::getMaxHistory());
+  }
+  if (max_history) history = misc::new_unique<BranchHistory>(max_history);
+
   // Allocate BTB and assign LRU counters
   btb = misc::new_unique_array<BtbEntry>(btb_num_sets * btb_num_ways);
   for (int i = 0; i < btb_num_sets; i++)
@@ -93,6 +127,14 @@ void BranchPredictor::ParseConfiguration(misc::IniFile* ini_file) {
   // Two-level branch predictor parameter
   two_level_l2_height = 1 << two_level_history_size;
 
+  // Global history predictors
+  Tage::ParseConfiguration(ini_file, section);
+  Perceptron::ParseConfiguration(ini_file, section);
+  indirect_kind = (IndirectKind)ini_file->ReadEnum(
+      section, "Indirect", IndirectKindMap, IndirectKindBtb);
+  Ittage::ParseConfiguration(ini_file, section);
+  storage_budget = ini_file->ReadInt(section, "StorageBudget", 0);
+
   // Integrity
   if (bimod_size & (bimod_size - 1))
     throw Error("number of entries in bimodal precitor must be a power of 2");
@@ -108,6 +150,34 @@ void BranchPredictor::ParseConfiguration(misc::IniFile* ini_file) {
     throw Error("two-level predictor sizes must be power of 2");
   if (two_level_l2_size & (two_level_l2_size - 1))
     throw Error("two-level predictor sizes must be power of 2");
+  if (storage_budget < 0) throw Error("storage budget must be 0 or positive");
+
+  // Storage budget
+  long long storage_bits = getStorageBits();
+  if (storage_budget && storage_bits > storage_budget * 8192LL)
+    throw Error(
+        misc::fmt("predictor tables need %lld bytes, exceeding the storage "
+                  "budget of %d KB",
+                  (storage_bits + 7) / 8, storage_budget));
+}
+
+long long BranchPredictor::getStorageBits() {
+  // BTB entries with source and target addresses, and RAS
+  long long bits = (long long)btb_num_sets * btb_num_ways * 64;
+  bits += ras_size * 32;
+
+  // Direction predictor
+  if (kind == KindBimod || kind == KindCombined) bits += bimod_size * 2;
+  if (kind == KindTwoLevel || kind == KindCombined)
+    bits += (long long)two_level_l1_size * two_level_history_size +
+            (long long)two_level_l2_size * two_level_l2_height * 2;
+  if (kind == KindCombined) bits += choice_size * 2;
+  if (kind == KindTage) bits += Tage::getStorageBits();
+  if (kind == KindPerceptron) bits += Perceptron::getStorageBits();
+
+  // Indirect predictor
+  if (indirect_kind == IndirectKindIttage) bits += Ittage::getStorageBits();
+  return bits;
 }
 
 void BranchPredictor::DumpConfiguration(std::ostream& os) {
@@ -121,6 +191,54 @@ void BranchPredictor::DumpConfiguration(std::ostream& os) {
   os << misc::fmt("\tTwoLevel.L1Size: %d\n", two_level_l1_size);
   os << misc::fmt("\tTwoLevel.L2Size: %d\n", two_level_l2_size);
   os << misc::fmt("\tTwoLevel.HistorySize: %d\n", two_level_history_size);
+  os << misc::fmt("\tIndirect: %s\n", IndirectKindMap[indirect_kind]);
+  os << misc::fmt("\tStorageBudget: %d\n", storage_budget);
+}
+
+void BranchPredictor::DumpReport(std::ostream& os,
+                                 long long num_instructions) const {
+  // Mispredictions per kilo-instruction
+  auto mpki = [num_instructions](long long mispredictions) {
+    return num_instructions ? 1000.0 * mispredictions / num_instructions
+                            : 0.0;
+  };
+
+  // Conditional branches
+  os << misc::fmt("BranchPredictor.Direction.Branches = %lld\n",
+                  num_direction_branches);
+  os << misc::fmt("BranchPredictor.Direction.Mispred = %lld\n",
+                  num_direction_mispredictions);
+  os << misc::fmt("BranchPredictor.Direction.MPKI = %.4g\n",
+                  mpki(num_direction_mispredictions));
+
+  // Indirect jumps and calls
+  os << misc::fmt("BranchPredictor.Indirect.Branches = %lld\n",
+                  num_indirect_branches);
+  os << misc::fmt("BranchPredictor.Indirect.Mispred = %lld\n",
+                  num_indirect_mispredictions);
+  os << misc::fmt("BranchPredictor.Indirect.MPKI = %.4g\n",
+                  mpki(num_indirect_mispredictions));
+
+  // Returns
+  os << misc::fmt("BranchPredictor.Return.Branches = %lld\n",
+                  num_return_branches);
+  os << misc::fmt("BranchPredictor.Return.Mispred = %lld\n",
+                  num_return_mispredictions);
+  os << misc::fmt("BranchPredictor.Return.MPKI = %.4g\n",
+                  mpki(num_return_mispredictions));
+
+  // All branches
+  os << misc::fmt("BranchPredictor.MPKI = %.4g\n", mpki(accesses - hits));
+
+  // Components
+  if (tage) tage->DumpReport(os, num_instructions);
+}
+
+void BranchPredictor::UpdateHistory(bool taken, unsigned eip) {
+  history->Push(taken, eip);
+  if (tage) tage->UpdateHistory(*history);
+  if (perceptron) perceptron->UpdateHistory(*history);
+  if (ittage) ittage->UpdateHistory(*history);
 }
 
 BranchPredictor::Prediction BranchPredictor::Lookup(Uop* uop) {
@@ -197,6 +315,29 @@ BranchPredictor::Prediction BranchPredictor::Lookup(Uop* uop) {
     uop->prediction = choice_prediction;
   }
 
+  // TAGE-SC-L
+  if (kind == KindTage) {
+    if (!uop->tage_info) uop->tage_info = misc::new_unique<Tage::Info>();
+    uop->prediction = tage->Lookup(uop->eip, *uop->tage_info)
+                          ? PredictionTaken
+                          : PredictionNotTaken;
+  }
+
+  // Hashed perceptron
+  if (kind == KindPerceptron) {
+    if (!uop->perceptron_info)
+      uop->perceptron_info = misc::new_unique<Perceptron::Info>();
+    uop->prediction = perceptron->Lookup(uop->eip, *uop->perceptron_info)
+                          ? PredictionTaken
+                          : PredictionNotTaken;
+  }
+
+  // Branches in the correct path shift their actual outcome into the
+  // global history, which is available since the instruction has already
+  // been emulated.
+  if (history && !uop->speculative_mode)
+    UpdateHistory(uop->neip != uop->eip + uop->mop_size, uop->eip);
+
   // Return prediction
   assert(uop->prediction == PredictionTaken ||
          uop->prediction == PredictionNotTaken);
@@ -204,11 +345,29 @@ BranchPredictor::Prediction BranchPredictor::Lookup(Uop* uop) {
 }
 
 int BranchPredictor::LookupMultiple(unsigned int eip, int count) {
+  // Predictors with global history
+  if (kind == KindTwoLevel) return LookupMultipleTwoLevel(eip, count);
+  if (kind == KindTage) return tage->LookupMultiple(eip, count, *history);
+  if (kind == KindPerceptron)
+    return perceptron->LookupMultiple(eip, count, *history);
+
+  // Predictors without global history repeat the primary prediction
+  bool taken = false;
+  if (kind == KindTaken) taken = true;
+  if (kind == KindBimod) taken = bimod[eip & (bimod_size - 1)] > 1;
+  if (kind == KindCombined) {
+    if (choice[eip & (choice_size - 1)] > 1)
+      return LookupMultipleTwoLevel(eip, count);
+    taken = bimod[eip & (bimod_size - 1)] > 1;
+  }
+  return taken ? (1 << count) - 1 : 0;
+}
+
+int BranchPredictor::LookupMultipleTwoLevel(unsigned eip, int count) {
   // First make a regular prediction. This updates the necessary fields in
   // the uop for a later call to UpdateBranchPredictor(), and makes the
   // first prediction considering known characteristics of the primary
   // branch.
-  assert(kind == KindTwoLevel);
   int bht_index = eip & (two_level_l1_size - 1);
   int pht_row = two_level_bht[bht_index];
   assert(pht_row < two_level_l2_height);
@@ -253,6 +412,18 @@ void BranchPredictor::Update(Uop* uop) {
   // Stats
   accesses++;
   if (uop->neip == uop->predicted_neip) hits++;
+  if (uop->getUinst()->getOpcode() == Uinst::OpcodeRet) {
+    num_return_branches++;
+    if (uop->neip != uop->predicted_neip) num_return_mispredictions++;
+  } else if (isIndirectBranch(uop)) {
+    num_indirect_branches++;
+    if (uop->neip != uop->predicted_neip) num_indirect_mispredictions++;
+  } else if (!(uop->getFlags() & Uinst::FlagUncond) &&
+             uop->getUinst()->getOpcode() != Uinst::OpcodeIbranch) {
+    num_direction_branches++;
+    if (uop->prediction != (taken ? PredictionTaken : PredictionNotTaken))
+      num_direction_mispredictions++;
+  }
 
   // Update predictors. This is only done for conditional branches. Thus,
   // exit now if instruction is a call, ret, or jmp.
@@ -260,6 +431,14 @@ void BranchPredictor::Update(Uop* uop) {
   if (kind == KindPerfect) return;
   if (uop->getFlags() & Uinst::FlagUncond) return;
 
+  // Predictors based on global history. Internal branches do not access
+  // them.
+  if (kind == KindTage && uop->tage_info && uop->tage_info->valid)
+    tage->Update(*uop->tage_info, uop->eip, taken);
+  if (kind == KindPerceptron && uop->perceptron_info &&
+      uop->perceptron_info->valid)
+    perceptron->Update(*uop->perceptron_info, taken);
+
   // Bimodal predictor was used
   if (kind == KindBimod ||
       (kind == KindCombined && uop->choice_prediction == PredictionNotTaken)) {
@@ -323,6 +502,16 @@ unsigned int BranchPredictor::LookupBtb(Uop* uop) {
     break;
   }
 
+  // Indirect jumps and calls use the BTB target as the base prediction of
+  // ITTAGE. The lookup is done even on a BTB miss, so that the predictor
+  // is updated at commit with the history seen at fetch.
+  if (ittage && isIndirectBranch(uop)) {
+    if (!uop->ittage_info) uop->ittage_info = misc::new_unique<Ittage::Info>();
+    unsigned ittage_target =
+        ittage->Lookup(uop->eip, target, *uop->ittage_info);
+    if (hit) target = ittage_target;
+  }
+
   // If there was a hit, we know whether branch is a call.
   // In this case, push return address into RAS. To avoid
   // updates at recovery, do it only for non-spec instructions.
@@ -353,6 +542,16 @@ void BranchPredictor::UpdateBtb(Uop* uop) {
   // No update for perfect branch predictor
   if (kind == KindPerfect) return;
 
+  // Indirect target predictor. Branches fetched from the trace cache did
+  // not access it, so it is looked up now with the current history.
+  if (ittage && isIndirectBranch(uop)) {
+    if (!uop->ittage_info) {
+      uop->ittage_info = misc::new_unique<Ittage::Info>();
+      ittage->Lookup(uop->eip, 0, *uop->ittage_info);
+    }
+    ittage->Update(*uop->ittage_info, uop->neip);
+  }
+
   // Search address in BTB
   int set = uop->eip & (btb_num_sets - 1);
   for (int way = 0; way < btb_num_ways; way++) {
@@ -26,6 +26,11 @@
 #include <lib/cpp/Error.h>
 #include <lib/cpp/IniFile.h>
 
+#include "BranchHistory.h"
+#include "Ittage.h"
+#include "Perceptron.h"
+#include "Tage.h"
+
 namespace x86 {
 
 // Forward declaration
@@ -45,12 +50,24 @@ class BranchPredictor {
     KindNottaken,
     KindBimod,
     KindTwoLevel,
-    KindCombined
+    KindCombined,
+    KindTage,
+    KindPerceptron
   };
 
   /// string map of branch predictor kind
   static misc::StringMap KindMap;
 
+  /// Predictor used for the targets of indirect jumps and calls
+  enum IndirectKind {
+    IndirectKindInvalid = 0,
+    IndirectKindBtb,
+    IndirectKindIttage
+  };
+
+  /// String map of indirect predictor kinds
+  static misc::StringMap IndirectKindMap;
+
  private:
   //
   // Static fields
@@ -59,6 +76,12 @@ class BranchPredictor {
   // Branch predictor kind
   static Kind kind;
 
+  // Indirect branch target predictor kind
+  static IndirectKind indirect_kind;
+
+  // Maximum storage of all predictor tables in KB, or 0 for no limit
+  static int storage_budget;
+
   // Number of sets in the BTB
   static int btb_num_sets;
 
@@ -126,9 +149,37 @@ class BranchPredictor {
   //   2,3 - Use two-level adaptive predictor
   std::unique_ptr<char[]> choice;
 
+  // Global history of conditional branches, used by TAGE, the hashed
+  // perceptron, and ITTAGE. Only branches in the correct path shift
+  // their outcome in when they are fetched, so the history never needs
+  // to be repaired after a misprediction.
+  std::unique_ptr<BranchHistory> history;
+
+  // TAGE-SC-L direction predictor
+  std::unique_ptr<Tage> tage;
+
+  // Hashed perceptron direction predictor
+  std::unique_ptr<Perceptron> perceptron;
+
+  // ITTAGE indirect target predictor
+  std::unique_ptr<Ittage> ittage;
+
+  // Return the two-level predictions for a trace, as described in
+  // LookupMultiple().
+  int LookupMultipleTwoLevel(unsigned eip, int count);
+
+  // Shift the outcome of a conditional branch into the global history
+  void UpdateHistory(bool taken, unsigned eip);
+
   // Stats
   long long accesses = 0;
   long long hits = 0;
+  long long num_direction_branches = 0;
+  long long num_direction_mispredictions = 0;
+  long long num_indirect_branches = 0;
+  long long num_indirect_mispredictions = 0;
+  long long num_return_branches = 0;
+  long long num_return_mispredictions = 0;
 
  public:
   //
@@ -149,6 +200,14 @@ class BranchPredictor {
 
   static Kind getKind() { return kind; }
 
+  static IndirectKind getIndirectKind() { return indirect_kind; }
+
+  static int getStorageBudget() { return storage_budget; }
+
+  /// Return the number of storage bits used by the tables of each branch
+  /// predictor, including the BTB and the RAS.
+  static long long getStorageBits();
+
   static int getBtbNumSets() { return btb_num_sets; }
 
   static int getBtbNumWays() { return btb_num_ways; }
@@ -180,6 +239,10 @@ class BranchPredictor {
   /// Dump configuration
   void DumpConfiguration(std::ostream& os = std::cout);
 
+  /// Dump statistics, with mispredictions per kilo-instruction computed
+  /// over \a num_instructions committed x86 instructions.
+  void DumpReport(std::ostream& os, long long num_instructions) const;
+
   char getBimodStatus(int index) const { return bimod[index]; }
 
   int getTwoLevelBhtStatus(int index) const { return two_level_bht[index]; }
@@ -201,11 +264,13 @@ class BranchPredictor {
   ///
   Prediction Lookup(Uop* uop);
 
-  /// Return multiple predictions for an address. This can only be done
-  /// for two-level adaptive predictors, since they use global history.
-  /// The prediction of the primary branch is stored in the least
-  /// significant bit (bit 0), whereas the prediction of the last branch
-  /// is stored in bit 'count - 1'.
+  /// Return multiple predictions for an address, used to access the
+  /// trace cache. Predictors using global history (two-level, TAGE, and
+  /// hashed perceptron) shift each prediction into a copy of their
+  /// history before making the next one, while the rest repeat the
+  /// prediction of the primary branch. The prediction of the primary
+  /// branch is stored in the least significant bit (bit 0), whereas the
+  /// prediction of the last branch is stored in bit 'count - 1'.
   ///
   /// \param eip
   /// 	The instruction address
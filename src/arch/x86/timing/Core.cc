@@ -44,7 +44,7 @@ void Core::InsertInEventQueue(std::shared_ptr<Uop> uop, int latency) {
 
   // Set completion time for the instruction
   assert(!uop->completed);
-  uop->complete_when = cpu->getCycle() + latency;
+  uop->complete_when = getCycle() + latency;
 
   // Find position in event queue
   auto it = event_queue.begin();
@@ -265,7 +265,7 @@ void Core::Writeback() {
 
     // If the uop is set to complete later than the current cycle,
     // there is nothing else to extract from the event queue.
-    if (uop->complete_when > cpu->getCycle()) break;
+    if (uop->complete_when > getCycle()) break;
 
     // Sanity
     assert(uop->ready);
@@ -274,6 +274,15 @@ void Core::Writeback() {
     // Extract element from event queue
     ExtractFromEventQueue(uop.get());
 
+    // A load that read stale data due to a memory-ordering violation
+    // does not complete, and is replayed instead. Squashed loads are
+    // not replayed.
+    Thread* thread = uop->getThread();
+    if (uop->memory_violation && uop->in_reorder_buffer) {
+      thread->ReplayLoad(uop);
+      continue;
+    }
+
     // If this instruction is the first in speculative mode
     // (typically a mispredicted branch), and recovery is configured
     // to happen at writeback, schedule recovery.
@@ -303,7 +312,6 @@ void Core::Writeback() {
     uop->completed = true;
 
     // Write output registers
-    Thread* thread = uop->getThread();
     RegisterFile* register_file = thread->getRegisterFile();
     register_file->WriteUop(uop.get());
 
@@ -382,13 +390,18 @@ void Core::Commit() {
   }
 }
 
-void Core::Run() {
-  // Run stages in reverse order
-  Commit();
-  Writeback();
-  Issue();
-  Dispatch();
-  Decode();
-  Fetch();
+long long Core::getCycle() const { return cpu->getCycle() + cycle_offset; }
+
+void Core::Run(int num_cycles) {
+  for (cycle_offset = 0; cycle_offset < num_cycles; cycle_offset++) {
+    // Run stages in reverse order
+    Commit();
+    Writeback();
+    Issue();
+    Dispatch();
+    Decode();
+    Fetch();
+  }
+  cycle_offset = 0;
 }
 }
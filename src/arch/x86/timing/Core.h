@@ -63,6 +63,10 @@ class Core {
   // Counter used to assign per-core identifiers to uops
   long long uop_id_counter = 0;
 
+  // Number of cycles that the core is ahead of the CPU cycle, while it is
+  // simulated for a synchronization quantum of several cycles
+  int cycle_offset = 0;
+
   // Number of occupied integer registers
   int num_occupied_integer_registers = 0;
 
@@ -190,6 +194,11 @@ class Core {
   /// Return a new unique identifier for a uop in this core
   long long getUopId() { return ++uop_id_counter; }
 
+  /// Return the cycle being simulated in this core. Pipeline stages use
+  /// this cycle instead of the CPU cycle, since the core may be simulated
+  /// ahead of it within a synchronization quantum.
+  long long getCycle() const;
+
   /// Return the core's arithmetic-logic unit
   Alu* getAlu() { return &alu; }
 
@@ -326,8 +335,9 @@ class Core {
   // Pipeline stages
   //
 
-  /// Run one simulation cycle for all pipeline stages of the core.
-  void Run();
+  /// Run \a num_cycles simulation cycles for all pipeline stages of the
+  /// core, starting at the current CPU cycle.
+  void Run(int num_cycles);
 
   /// Fetch stage
   void Fetch();
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <memory/Frame.h>
+
 #include "Cpu.h"
 #include "Timing.h"
 
@@ -54,12 +56,20 @@ misc::StringMap Cpu::load_store_queue_kind_map = {
     {"Private", LoadStoreQueueKindPrivate},
 };
 
+misc::StringMap Cpu::memory_dependence_kind_map = {
+    {"Aggressive", MemoryDependenceKindAggressive},
+    {"Conservative", MemoryDependenceKindConservative},
+    {"StoreSets", MemoryDependenceKindStoreSets},
+};
+
 int Cpu::num_cores = 1;
 int Cpu::num_threads = 1;
 int Cpu::context_quantum;
 int Cpu::thread_quantum;
 int Cpu::thread_switch_penalty;
 long long Cpu::num_fast_forward_instructions;
+int Cpu::num_host_threads = 1;
+int Cpu::sync_quantum = 1;
 long long Cpu::max_cycles = 0;
 int Cpu::recover_penalty;
 Cpu::RecoverKind Cpu::recover_kind;
@@ -79,6 +89,11 @@ Cpu::InstructionQueueKind Cpu::instruction_queue_kind;
 int Cpu::instruction_queue_size;
 Cpu::LoadStoreQueueKind Cpu::load_store_queue_kind;
 int Cpu::load_store_queue_size;
+bool Cpu::store_forwarding;
+int Cpu::store_forward_latency;
+Cpu::MemoryDependenceKind Cpu::memory_dependence_kind;
+int Cpu::store_sets_size;
+int Cpu::store_sets_clear_interval;
 int Cpu::uop_queue_size;
 
 esim::Event* Cpu::event_memory_access_start;
@@ -89,6 +104,13 @@ Cpu::Cpu(Timing* timing) : timing(timing) {
   emulator = Emulator::getInstance();
   mmu = misc::new_unique<mem::Mmu>("x86");
 
+  // Recursive mutex for structures shared among cores
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&shared_mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+
   // Memory access events
   esim::Engine* esim_engine = esim::Engine::getInstance();
   event_memory_access_start = esim_engine->RegisterEvent(
@@ -100,6 +122,12 @@ Cpu::Cpu(Timing* timing) : timing(timing) {
   cores.reserve(num_cores);
   for (int i = 0; i < num_cores; i++)
     cores.emplace_back(misc::new_unique<Core>(this, i));
+  buffered_accesses.resize(num_cores);
+}
+
+Cpu::~Cpu() {
+  StopHostThreads();
+  pthread_mutex_destroy(&shared_mutex);
 }
 
 void Cpu::ParseConfiguration(misc::IniFile* ini_file) {
@@ -116,6 +144,10 @@ void Cpu::ParseConfiguration(misc::IniFile* ini_file) {
   recover_kind = (RecoverKind)ini_file->ReadEnum(
       section, "RecoverKind", recover_kind_map, RecoverKindWriteback);
   recover_penalty = ini_file->ReadInt(section, "RecoverPenalty", 0);
+  num_fast_forward_instructions =
+      ini_file->ReadInt64(section, "FastForward", 0);
+  num_host_threads = ini_file->ReadInt(section, "HostThreads", 1);
+  sync_quantum = ini_file->ReadInt(section, "SyncQuantum", 1);
 
   // Section '[ Pipeline ]'
   section = "Pipeline";
@@ -147,19 +179,88 @@ void Cpu::ParseConfiguration(misc::IniFile* ini_file) {
   load_store_queue_kind = (LoadStoreQueueKind)ini_file->ReadEnum(
       section, "LsqKind", load_store_queue_kind_map, LoadStoreQueueKindPrivate);
   load_store_queue_size = ini_file->ReadInt(section, "LsqSize", 20);
+  store_forwarding = ini_file->ReadBool(section, "StoreForwarding", true);
+  store_forward_latency = ini_file->ReadInt(section, "StoreForwardLatency", 1);
+  memory_dependence_kind = (MemoryDependenceKind)ini_file->ReadEnum(
+      section, "MemDepKind", memory_dependence_kind_map,
+      MemoryDependenceKindStoreSets);
+  store_sets_size = ini_file->ReadInt(section, "StoreSetsSize", 1024);
+  store_sets_clear_interval =
+      ini_file->ReadInt(section, "StoreSetsClearInterval", 1000000);
   uop_queue_size = ini_file->ReadInt(section, "UopQueueSize", 32);
+
+  // Integrity
+  if (num_host_threads < 1)
+    throw Timing::Error(misc::fmt("%s: HostThreads must be at least 1",
+                                  ini_file->getPath().c_str()));
+  if (sync_quantum < 1)
+    throw Timing::Error(misc::fmt("%s: SyncQuantum must be at least 1",
+                                  ini_file->getPath().c_str()));
+  if (store_forward_latency < 1)
+    throw Timing::Error(misc::fmt("%s: StoreForwardLatency must be at least 1",
+                                  ini_file->getPath().c_str()));
+  if (store_sets_size < 1 || (store_sets_size & (store_sets_size - 1)))
+    throw Timing::Error(misc::fmt("%s: StoreSetsSize must be a power of 2",
+                                  ini_file->getPath().c_str()));
 }
 
 void Cpu::Run() {
+  // Cores are simulated for a whole synchronization quantum at once. The
+  // pipeline trace is dumped cycle by cycle, so it forces a quantum of one
+  // cycle and a single host thread.
+  long long cycle = getCycle();
+  if (cycle < next_sync_cycle) return;
+  int num_cycles = Timing::trace ? 1 : sync_quantum;
+  next_sync_cycle = cycle + num_cycles;
+
   // Invoke scheduler
   Schedule();
 
   // Run all cores
-  for (auto& core : cores) core->Run();
+  if (num_host_threads > 1 && cores.size() > 1 && !Timing::trace)
+    RunParallel(num_cycles);
+  else
+    for (auto& core : cores) core->Run(num_cycles);
 }
 
 void Cpu::MemoryAccess(mem::Module* module, mem::Module::AccessType access_type,
                        unsigned address, std::shared_ptr<Uop> uop) {
+  // The access starts in the cycle being simulated by the core, which may
+  // be ahead of the CPU cycle within a synchronization quantum
+  Core* core = uop->getCore();
+  int after = core->getCycle() - getCycle();
+
+  // Buffer the access while cores run on multiple host threads
+  if (parallel) {
+    buffered_accesses[core->getId()].push_back(
+        {module, access_type, address, uop, 0, after});
+    return;
+  }
+
+  // Start the access
+  ScheduleMemoryAccess(module, access_type, address, uop, after);
+}
+
+long long Cpu::FetchAccess(Core* core, mem::Module* module, unsigned address) {
+  // Start the access
+  if (!parallel) return module->Access(mem::Module::AccessLoad, address);
+
+  // Buffer the access while cores run on multiple host threads, reserving
+  // its identifier. Frame identifiers are shared among cores.
+  long long id;
+  {
+    SharedLock lock(this);
+    id = mem::Frame::getNewId();
+  }
+  buffered_accesses[core->getId()].push_back(
+      {module, mem::Module::AccessLoad, address, nullptr, id, 0});
+  return id;
+}
+
+void Cpu::ScheduleMemoryAccess(mem::Module* module,
+                               mem::Module::AccessType access_type,
+                               unsigned address, std::shared_ptr<Uop> uop,
+                               int after) {
   // New frame
   auto frame = misc::new_shared<MemoryAccessFrame>();
   frame->module = module;
@@ -169,7 +270,7 @@ void Cpu::MemoryAccess(mem::Module* module, mem::Module::AccessType access_type,
 
   // Schedule event
   esim::Engine* esim_engine = esim::Engine::getInstance();
-  esim_engine->Call(event_memory_access_start, frame);
+  esim_engine->Call(event_memory_access_start, frame, nullptr, after);
 }
 
 void Cpu::MemoryAccessHandler(esim::Event* event, esim::Frame* esim_frame) {
@@ -194,6 +295,77 @@ void Cpu::MemoryAccessHandler(esim::Event* event, esim::Frame* esim_frame) {
 
 long long Cpu::getCycle() const { return timing->getCycle(); }
 
+const long long* Cpu::getNumDispatchedUinstArray() {
+  for (int i = 0; i < Uinst::OpcodeCount; i++) {
+    num_dispatched_uinst_array[i] = 0;
+    for (auto& core : cores)
+      num_dispatched_uinst_array[i] += core->getNumDispatchedUinstArray()[i];
+  }
+  return num_dispatched_uinst_array;
+}
+
+long long Cpu::getNumDispatchedUinsts() const {
+  long long count = 0;
+  for (auto& core : cores) count += core->getNumDispatchedUinsts();
+  return count;
+}
+
+const long long* Cpu::getNumIssuedUinstArray() {
+  for (int i = 0; i < Uinst::OpcodeCount; i++) {
+    num_issued_uinst_array[i] = 0;
+    for (auto& core : cores)
+      num_issued_uinst_array[i] += core->getNumIssuedUinstArray()[i];
+  }
+  return num_issued_uinst_array;
+}
+
+long long Cpu::getNumIssuedUinsts() const {
+  long long count = 0;
+  for (auto& core : cores) count += core->getNumIssuedUinsts();
+  return count;
+}
+
+const long long* Cpu::getNumCommittedUinstArray() {
+  for (int i = 0; i < Uinst::OpcodeCount; i++) {
+    num_committed_uinst_array[i] = 0;
+    for (auto& core : cores)
+      num_committed_uinst_array[i] += core->getNumCommittedUinstArray()[i];
+  }
+  return num_committed_uinst_array;
+}
+
+long long Cpu::getNumCommittedUinsts() const {
+  long long count = 0;
+  for (auto& core : cores) count += core->getNumCommittedUinsts();
+  return count;
+}
+
+long long Cpu::getNumSquashedUinsts() const {
+  long long count = 0;
+  for (auto& core : cores) count += core->getNumSquashedUinsts();
+  return count;
+}
+
+long long Cpu::getNumCommittedInstructions() const {
+  long long count = 0;
+  for (auto& core : cores)
+    for (int i = 0; i < core->getNumThreads(); i++)
+      count += core->getThread(i)->getNumCommittedInstructions();
+  return count;
+}
+
+long long Cpu::getNumBranches() const {
+  long long count = 0;
+  for (auto& core : cores) count += core->getNumBranches();
+  return count;
+}
+
+long long Cpu::getNumMispredictedBranches() const {
+  long long count = 0;
+  for (auto& core : cores) count += core->getNumMispredictedBranches();
+  return count;
+}
+
 void Cpu::InsertInTraceList(std::shared_ptr<Uop> uop) {
   assert(Timing::trace == true);
   assert(!uop->in_trace_list);
@@ -22,10 +22,12 @@
 
 #include <deque>
 #include <list>
+#include <pthread.h>
 #include <vector>
 
 #include <arch/x86/emulator/Emulator.h>
 #include <arch/x86/emulator/Uinst.h>
+#include <lib/cpp/HostThreadPool.h>
 #include <memory/Mmu.h>
 #include <memory/Module.h>
 
@@ -117,6 +119,18 @@ class Cpu {
   /// Load/Store queue kind string map
   static misc::StringMap load_store_queue_kind_map;
 
+  /// Policy deciding when loads can issue ahead of older stores with
+  /// unknown addresses
+  enum MemoryDependenceKind {
+    MemoryDependenceKindInvalid = 0,
+    MemoryDependenceKindAggressive,
+    MemoryDependenceKindConservative,
+    MemoryDependenceKindStoreSets
+  };
+
+  /// Memory dependence kind string map
+  static misc::StringMap memory_dependence_kind_map;
+
   // Maximum number of cycles to simulate
   static long long max_cycles;
 
@@ -143,6 +157,13 @@ class Cpu {
   // Number of fast forward instructions
   static long long num_fast_forward_instructions;
 
+  // Number of host threads simulating cores in parallel
+  static int num_host_threads;
+
+  // Number of cycles simulated by each core between two synchronizations
+  // of the host threads
+  static int sync_quantum;
+
   //
   // Class members
   //
@@ -166,12 +187,11 @@ class Cpu {
   std::list<std::shared_ptr<Uop>> trace_list;
 
   //
-  // Statistics
+  // Statistics. Cores and threads keep their own counters, so that they
+  // can be simulated by different host threads. CPU statistics are
+  // obtained by adding them up.
   //
 
-  // Number of fectched micro-instructions
-  long long num_fetched_uinsts = 0;
-
   // Number of dispatched micro-instructions for every opcode
   long long num_dispatched_uinst_array[Uinst::OpcodeCount] = {};
 
@@ -181,27 +201,6 @@ class Cpu {
   // Number of committed micro-instructions for every opcode
   long long num_committed_uinst_array[Uinst::OpcodeCount] = {};
 
-  // Number of dispatched micro-instructions
-  long long num_dispatched_uinsts = 0;
-
-  // Number of issued micro-instructions
-  long long num_issued_uinsts = 0;
-
-  // Number of committed micro-instructions
-  long long num_committed_uinsts = 0;
-
-  // Committed macro-instructions
-  long long num_committed_instructions = 0;
-
-  // Number of squashed micro-instructions
-  long long num_squashed_uinsts = 0;
-
-  // Number of branch micro-instructions
-  long long num_branches = 0;
-
-  // Number of mis-predicted branch micro-instructions
-  long long num_mispredicted_branches = 0;
-
   //
   // For dumping
   //
@@ -240,6 +239,35 @@ class Cpu {
   // Event handler for memory accesses
   static void MemoryAccessHandler(esim::Event* event, esim::Frame* frame);
 
+  // Memory access buffered while cores are simulated on multiple host
+  // threads
+  struct BufferedAccess {
+    // Module to access
+    mem::Module* module;
+
+    // Access type
+    mem::Module::AccessType access_type;
+
+    // Physical address to access
+    unsigned address;
+
+    // Uop associated with a data access, or null for an instruction fetch
+    std::shared_ptr<Uop> uop;
+
+    // Identifier reserved for an instruction fetch
+    long long id;
+
+    // Cycles after the current CPU cycle when a data access starts
+    int after;
+  };
+
+  // Schedule the start of a data access, the given number of cycles after
+  // the current CPU cycle
+  void ScheduleMemoryAccess(mem::Module* module,
+                            mem::Module::AccessType access_type,
+                            unsigned address, std::shared_ptr<Uop> uop,
+                            int after);
+
   //
   // CPU parameters
   //
@@ -302,6 +330,21 @@ class Cpu {
   // Load/Store queue size
   static int load_store_queue_size;
 
+  // Whether loads obtain their data from older stores in the store queue
+  static bool store_forwarding;
+
+  // Latency of a load forwarded from a store
+  static int store_forward_latency;
+
+  // Memory dependence policy
+  static MemoryDependenceKind memory_dependence_kind;
+
+  // Number of entries of the store set predictor
+  static int store_sets_size;
+
+  // Cycles between clears of the store set predictor
+  static int store_sets_clear_interval;
+
   // Uop queue size
   static int uop_queue_size;
 
@@ -316,6 +359,46 @@ class Cpu {
   // UpdateContextAllocationCycle().
   long long min_context_allocate_cycle = 0;
 
+  // Flag set while hardware threads are being drained with a call to
+  // Drain(). The scheduler does not allocate contexts in the meantime.
+  bool draining = false;
+
+  //
+  // Parallel simulation
+  //
+
+  // Host threads simulating the cores, created the first time cores are
+  // simulated in parallel
+  std::unique_ptr<misc::HostThreadPool> host_thread_pool;
+
+  // Mutex protecting structures shared among cores while host threads are
+  // active. It is recursive, since system calls emulated under the lock
+  // take it again.
+  pthread_mutex_t shared_mutex;
+
+  // Flag set while cores are simulated by multiple host threads
+  bool parallel = false;
+
+  // Memory accesses issued by each core while cores are simulated by
+  // multiple host threads, in program order. They are submitted at the
+  // end of the quantum in the order of the sequential simulation, so the
+  // memory hierarchy sees the same sequence of accesses regardless of the
+  // number of host threads.
+  std::vector<std::vector<BufferedAccess>> buffered_accesses;
+
+  // Cycle when the next synchronization quantum starts
+  long long next_sync_cycle = 0;
+
+  // Simulate all cores for a synchronization quantum of the given number
+  // of cycles on multiple host threads
+  void RunParallel(int num_cycles);
+
+  // Create the host threads
+  void StartHostThreads();
+
+  // Make host threads finish and wait for them
+  void StopHostThreads();
+
  public:
   //
   // Static functions
@@ -363,6 +446,24 @@ class Cpu {
   /// Get load/store queue size
   static int getLoadStoreQueueSize() { return load_store_queue_size; }
 
+  /// Return whether store-to-load forwarding is enabled
+  static bool getStoreForwarding() { return store_forwarding; }
+
+  /// Return the latency of a load forwarded from a store
+  static int getStoreForwardLatency() { return store_forward_latency; }
+
+  /// Return the memory dependence policy
+  static MemoryDependenceKind getMemoryDependenceKind() {
+    return memory_dependence_kind;
+  }
+
+  /// Return the number of entries of the store set predictor
+  static int getStoreSetsSize() { return store_sets_size; }
+
+  /// Return the number of cycles between clears of the store set
+  /// predictor
+  static int getStoreSetsClearInterval() { return store_sets_clear_interval; }
+
   /// Return the size of the uop queue, as configured by the user
   static int getUopQueueSize() { return uop_queue_size; }
 
@@ -406,6 +507,14 @@ class Cpu {
   /// the user
   static long long getMaxCycles() { return max_cycles; }
 
+  /// Return the number of host threads simulating cores in parallel, as
+  /// configured by the user
+  static int getNumHostThreads() { return num_host_threads; }
+
+  /// Return the number of cycles between synchronizations of host threads,
+  /// as configured by the user
+  static int getSyncQuantum() { return sync_quantum; }
+
   /// Read branch predictor configuration from configuration file
   static void ParseConfiguration(misc::IniFile* ini_file);
 
@@ -416,6 +525,9 @@ class Cpu {
   /// Constructor
   Cpu(Timing* timing);
 
+  /// Destructor
+  ~Cpu();
+
   /// Return the core with the given index
   Core* getCore(int index) const {
     assert(index >= 0 && index < (int)cores.size());
@@ -445,9 +557,35 @@ class Cpu {
   /// its last 'end_inst' trace event.
   void EmptyTraceList();
 
-  /// Simulate one cycle of the CPU for all its cores and threads.
+  /// Simulate one cycle of the CPU for all its cores and threads. With a
+  /// synchronization quantum of more than one cycle, cores are simulated
+  /// for the whole quantum in its first cycle, and this function has no
+  /// effect in the rest of it.
   void Run();
 
+  /// Lock of the mutex protecting structures shared among cores, held
+  /// during the lifetime of the object. These are the MMU, the state of
+  /// the contexts, and the simulation control state. Emulated system
+  /// calls take the lock as well. Memory modules are not locked, since
+  /// accesses are buffered until all host threads finish. Locking has no
+  /// effect when cores are simulated by a single host thread, or when
+  /// \a lock is false.
+  class SharedLock {
+    Cpu* cpu;
+
+    bool locked;
+
+   public:
+    SharedLock(Cpu* cpu, bool lock = true)
+        : cpu(cpu), locked(lock && cpu->parallel) {
+      if (locked) pthread_mutex_lock(&cpu->shared_mutex);
+    }
+
+    ~SharedLock() {
+      if (locked) pthread_mutex_unlock(&cpu->shared_mutex);
+    }
+  };
+
   /// Update structure occupancy statistics
   void UpdateOccupancyStats();
 
@@ -460,6 +598,10 @@ class Cpu {
   void MemoryAccess(mem::Module* module, mem::Module::AccessType access_type,
                     unsigned address, std::shared_ptr<Uop> uop);
 
+  /// Start an instruction fetch of the given core from the given module,
+  /// and return the identifier of the access.
+  long long FetchAccess(Core* core, mem::Module* module, unsigned address);
+
   //
   // Scheduler (CpuScheduler.cc)
   //
@@ -485,85 +627,52 @@ class Cpu {
   /// exit with practically no cost.
   void Schedule();
 
+  /// Signal the eviction of all contexts allocated to hardware threads,
+  /// and stop allocating new contexts. Pipelines are flushed naturally as
+  /// the in-flight instructions commit.
+  void Drain();
+
+  /// Return true if no context is allocated to any hardware thread
+  bool isDrained() const;
+
+  /// Unmap all contexts from hardware threads once the CPU is drained,
+  /// leaving the contexts under the sole control of the emulator. The
+  /// scheduler maps them again after the next scheduling signal.
+  void UnmapContexts();
+
   //
   // Stats
   //
 
-  /// Increment the number of fetched micro-instructions
-  void incNumFetchedUinsts() { num_fetched_uinsts++; }
-
-  /// Increment the number of dispatched micro-instructions of a kind
-  void incNumDispatchedUinsts(Uinst::Opcode opcode) {
-    assert(opcode < Uinst::OpcodeCount);
-    num_dispatched_uinst_array[opcode]++;
-    num_dispatched_uinsts++;
-  }
-
-  /// Return the array of dispatched micro-instructions
-  const long long* getNumDispatchedUinstArray() const {
-    return num_dispatched_uinst_array;
-  }
+  /// Return the array of dispatched micro-instructions for every opcode
+  const long long* getNumDispatchedUinstArray();
 
   /// Return the number of dispatched micro-instructions
-  long long getNumDispatchedUinsts() const { return num_dispatched_uinsts; }
-
-  /// Increment the number of issued micro-instructions of a kind
-  void incNumIssuedUinsts(Uinst::Opcode opcode) {
-    assert(opcode < Uinst::OpcodeCount);
-    num_issued_uinst_array[opcode]++;
-    num_issued_uinsts++;
-  }
+  long long getNumDispatchedUinsts() const;
 
-  /// Return the array of issued micro-instructions
-  const long long* getNumIssuedUinstArray() const {
-    return num_issued_uinst_array;
-  }
+  /// Return the array of issued micro-instructions for every opcode
+  const long long* getNumIssuedUinstArray();
 
   /// Return the number of issued micro-instructions
-  long long getNumIssuedUinsts() const { return num_issued_uinsts; }
+  long long getNumIssuedUinsts() const;
 
-  /// Increment the number of committed micro-instructions of a type
-  void incNumCommittedUinsts(Uinst::Opcode opcode) {
-    assert(opcode < Uinst::OpcodeCount);
-    num_committed_uinst_array[opcode]++;
-    num_committed_uinsts++;
-  }
-
-  /// Return the array of committed micro-instructions
-  const long long* getNumCommittedUinstArray() const {
-    return num_committed_uinst_array;
-  }
+  /// Return the array of committed micro-instructions for every opcode
+  const long long* getNumCommittedUinstArray();
 
   /// Return the number of committed micro-instructions
-  long long getNumCommittedUinsts() const { return num_committed_uinsts; }
-
-  /// Increment the number of squashed micro-instructions
-  void incNumSquashedUinsts() { num_squashed_uinsts++; }
+  long long getNumCommittedUinsts() const;
 
   /// Return the number of squashed micro-instructions
-  long long getNumSquashedUinsts() const { return num_squashed_uinsts; }
-
-  /// Increment the number of committed instructions
-  void incNumCommittedInstructions() { num_committed_instructions++; }
+  long long getNumSquashedUinsts() const;
 
   /// Return the number of committed macro-instructions
-  long long getNumCommittedInstructions() const {
-    return num_committed_instructions;
-  }
-
-  /// Increment the number of branches
-  void incNumBranches() { num_branches++; }
+  long long getNumCommittedInstructions() const;
 
   /// Return the number of committed branches
-  long long getNumBranches() const { return num_branches; }
-
-  /// Increment the number of mispredicted branches
-  void incNumMispredictedBranches() { num_mispredicted_branches++; }
+  long long getNumBranches() const;
 
   /// Return the number of mispredicted branches
-  long long getNumMispredictedBranches() const {
-    return num_mispredicted_branches;
-  }
+  long long getNumMispredictedBranches() const;
 };
 }
 
@@ -0,0 +1,74 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cassert>
+
+#include "Cpu.h"
+#include "Timing.h"
+
+namespace x86 {
+
+void Cpu::RunParallel(int num_cycles) {
+  // Create host threads the first time
+  if (!host_thread_pool) StartHostThreads();
+
+  // Run the quantum, with each core simulated by one host thread.
+  // Structures shared among cores are locked in the meantime, as well as
+  // system calls emulated by the cores.
+  parallel = true;
+  emulator->setSharedMutex(&shared_mutex);
+  try {
+    host_thread_pool->Run(cores.size(),
+                          [&](int index) { cores[index]->Run(num_cycles); });
+  } catch (...) {
+    parallel = false;
+    emulator->setSharedMutex(nullptr);
+    throw;
+  }
+  parallel = false;
+  emulator->setSharedMutex(nullptr);
+
+  // Submit the memory accesses buffered by each core, in the same order in
+  // which cores run in the sequential simulation
+  for (auto& accesses : buffered_accesses) {
+    for (BufferedAccess& access : accesses) {
+      if (access.uop)
+        ScheduleMemoryAccess(access.module, access.access_type,
+                             access.address, access.uop, access.after);
+      else
+        access.module->Access(access.access_type, access.address, nullptr,
+                              nullptr, access.id);
+    }
+    accesses.clear();
+  }
+}
+
+void Cpu::StartHostThreads() {
+  // Create host threads
+  assert(!host_thread_pool);
+  host_thread_pool = misc::new_unique<misc::HostThreadPool>(num_host_threads);
+}
+
+void Cpu::StopHostThreads() {
+  // Make host threads finish
+  host_thread_pool = nullptr;
+}
+
+}  // namespace x86
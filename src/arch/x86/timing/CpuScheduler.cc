@@ -125,8 +125,10 @@ void Cpu::Schedule() {
 
   // Check for quick scheduler end. The only way to effectively execute
   // the scheduler is that either a quantum expired or a signal to
-  // reschedule has been flagged.
+  // reschedule has been flagged. Nothing is scheduled either while
+  // hardware threads are being drained.
   Emulator* emulator = Emulator::getInstance();
+  if (draining) return;
   if (!quantum_expired && !emulator->schedule_signal) return;
 
   // Debug
@@ -172,4 +174,48 @@ void Cpu::Schedule() {
   // when is the next time the scheduler should be invoked.
   UpdateContextAllocationCycle();
 }
+
+void Cpu::Drain() {
+  // Stop scheduling
+  draining = true;
+
+  // Signal eviction of all allocated contexts
+  for (int i = 0; i < getNumCores(); i++) {
+    Core* core = getCore(i);
+    for (int j = 0; j < core->getNumThreads(); j++) {
+      Thread* thread = core->getThread(j);
+      if (thread->context && !thread->context->evict_signal)
+        thread->EvictContextSignal();
+    }
+  }
+}
+
+bool Cpu::isDrained() const {
+  for (int i = 0; i < getNumCores(); i++) {
+    Core* core = getCore(i);
+    for (int j = 0; j < core->getNumThreads(); j++)
+      if (core->getThread(j)->context) return false;
+  }
+  return true;
+}
+
+void Cpu::UnmapContexts() {
+  // Sanity
+  assert(isDrained());
+
+  // Collect mapped contexts first, since unmapping a finished context
+  // frees it and removes it from the emulator context list.
+  std::vector<Context*> mapped_contexts;
+  for (auto it = emulator->getContextsBegin(), e = emulator->getContextsEnd();
+       it != e; ++it)
+    if ((*it)->getState(Context::StateMapped))
+      mapped_contexts.push_back(it->get());
+
+  // Unmap them
+  for (Context* context : mapped_contexts)
+    context->thread->UnmapContext(context);
+
+  // Resume scheduling
+  draining = false;
+}
 }
@@ -49,9 +49,8 @@ const misc::StringMap FunctionalUnit::type_map = {
     {"XmmFloatComplex", TypeXmmFloatComplex}};
 
 int FunctionalUnit::Reserve(Uop* uop) {
-  // Current cycle
-  Timing* timing = Timing::getInstance();
-  long long cycle = timing->getCycle();
+  // Current cycle in the core
+  long long cycle = uop->getCore()->getCycle();
 
   // Find a free functional unit
   assert(num_instances <= MaxInstances);
@@ -0,0 +1,197 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cassert>
+#include <cmath>
+
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
+
+#include "BranchPredictor.h"
+#include "Ittage.h"
+
+namespace x86 {
+
+int Ittage::num_tables;
+int Ittage::table_size;
+int Ittage::tag_bits;
+int Ittage::min_history;
+int Ittage::max_history;
+int Ittage::history_lengths[max_tables];
+
+// Number of updates between two resets of the useful counters
+static const long long useful_reset_period = 1 << 16;
+
+void Ittage::ParseConfiguration(misc::IniFile* ini_file,
+                                const std::string& section) {
+  // Read values
+  num_tables = ini_file->ReadInt(section, "ITTAGE.NumTables", 6);
+  table_size = ini_file->ReadInt(section, "ITTAGE.TableSize", 512);
+  tag_bits = ini_file->ReadInt(section, "ITTAGE.TagBits", 10);
+  min_history = ini_file->ReadInt(section, "ITTAGE.MinHistory", 4);
+  max_history = ini_file->ReadInt(section, "ITTAGE.MaxHistory", 64);
+
+  // Integrity
+  if (num_tables < 1 || num_tables > max_tables)
+    throw BranchPredictor::Error(misc::fmt(
+        "ITTAGE.NumTables must be between 1 and %d", max_tables));
+  if (table_size < 16 || (table_size & (table_size - 1)))
+    throw BranchPredictor::Error(
+        "ITTAGE.TableSize must be a power of 2 of at least 16");
+  if (tag_bits < 2 || tag_bits > 20)
+    throw BranchPredictor::Error("ITTAGE.TagBits must be between 2 and 20");
+  if (min_history < 1 || max_history < min_history || max_history > 1024)
+    throw BranchPredictor::Error(
+        "ITTAGE history lengths must satisfy 1 <= MinHistory <= "
+        "MaxHistory <= 1024");
+
+  // Geometric series of history lengths
+  for (int i = 0; i < num_tables; i++)
+    history_lengths[i] =
+        num_tables == 1
+            ? min_history
+            : (int)(min_history *
+                        pow((double)max_history / min_history,
+                            (double)i / (num_tables - 1)) +
+                    0.5);
+}
+
+void Ittage::DumpConfiguration(std::ostream& os) {
+  os << misc::fmt("ITTAGE.NumTables = %d\n", num_tables);
+  os << misc::fmt("ITTAGE.TableSize = %d\n", table_size);
+  os << misc::fmt("ITTAGE.TagBits = %d\n", tag_bits);
+  os << misc::fmt("ITTAGE.MinHistory = %d\n", min_history);
+  os << misc::fmt("ITTAGE.MaxHistory = %d\n", max_history);
+}
+
+long long Ittage::getStorageBits() {
+  // Entries with a tag, a 32-bit target, 2-bit confidence, and a useful
+  // bit, plus the global history
+  return (long long)num_tables * table_size * (tag_bits + 35) + max_history;
+}
+
+Ittage::Ittage() {
+  tables = misc::new_unique_array<Entry>(num_tables * table_size);
+  int log_table_size = misc::LogBase2(table_size);
+  for (int i = 0; i < num_tables; i++) {
+    folded_indexes[i] =
+        BranchHistory::Folded(history_lengths[i], log_table_size);
+    folded_tags[i][0] = BranchHistory::Folded(history_lengths[i], tag_bits);
+    folded_tags[i][1] =
+        BranchHistory::Folded(history_lengths[i], tag_bits - 1);
+  }
+}
+
+unsigned Ittage::Lookup(unsigned eip, unsigned base_target,
+                        Info& info) const {
+  // Compute indexes and tags
+  info.valid = true;
+  int log_table_size = misc::LogBase2(table_size);
+  for (int i = 0; i < num_tables; i++) {
+    info.indexes[i] = (eip ^ (eip >> (log_table_size - i % log_table_size)) ^
+                       folded_indexes[i].getValue()) &
+                      (table_size - 1);
+    info.tags[i] = (eip ^ folded_tags[i][0].getValue() ^
+                    (folded_tags[i][1].getValue() << 1)) &
+                   ((1u << tag_bits) - 1);
+  }
+
+  // Find provider and alternate tables
+  info.provider = -1;
+  info.alt_provider = -1;
+  for (int i = num_tables - 1; i >= 0; i--) {
+    if (tables[i * table_size + info.indexes[i]].tag != info.tags[i]) continue;
+    if (info.provider < 0)
+      info.provider = i;
+    else {
+      info.alt_provider = i;
+      break;
+    }
+  }
+
+  // Targets. A provider with no confidence yet defers to the alternate
+  // prediction.
+  info.alt_target =
+      info.alt_provider >= 0
+          ? tables[info.alt_provider * table_size +
+                   info.indexes[info.alt_provider]].target
+          : base_target;
+  info.provider_target = info.alt_target;
+  info.prediction = info.alt_target;
+  if (info.provider >= 0) {
+    const Entry& entry =
+        tables[info.provider * table_size + info.indexes[info.provider]];
+    info.provider_target = entry.target;
+    if (entry.confidence) info.prediction = entry.target;
+  }
+  return info.prediction;
+}
+
+void Ittage::Update(const Info& info, unsigned target) {
+  // Update provider, unless the entry was replaced since the lookup
+  assert(info.valid);
+  if (info.provider >= 0) {
+    Entry& entry =
+        tables[info.provider * table_size + info.indexes[info.provider]];
+    if (entry.tag == info.tags[info.provider]) {
+      if (entry.target == target) {
+        if (entry.confidence < 3) entry.confidence++;
+      } else if (entry.confidence) {
+        entry.confidence--;
+      } else {
+        entry.target = target;
+      }
+      if (info.provider_target != info.alt_target)
+        entry.useful = info.provider_target == target;
+    }
+  }
+
+  // On a misprediction, allocate an entry in a table with a longer
+  // history than the provider. If none is free, make them replaceable.
+  if (info.provider_target != target && info.provider < num_tables - 1) {
+    bool allocated = false;
+    for (int i = info.provider + 1; i < num_tables && !allocated; i++) {
+      Entry& entry = tables[i * table_size + info.indexes[i]];
+      if (entry.useful) continue;
+      entry.tag = info.tags[i];
+      entry.target = target;
+      entry.confidence = 0;
+      allocated = true;
+    }
+    if (!allocated)
+      for (int i = info.provider + 1; i < num_tables; i++)
+        tables[i * table_size + info.indexes[i]].useful = 0;
+  }
+
+  // Reset useful counters periodically
+  num_updates++;
+  if (num_updates % useful_reset_period == 0)
+    for (int i = 0; i < num_tables * table_size; i++) tables[i].useful = 0;
+}
+
+void Ittage::UpdateHistory(const BranchHistory& history) {
+  for (int i = 0; i < num_tables; i++) {
+    history.Update(folded_indexes[i]);
+    history.Update(folded_tags[i][0]);
+    history.Update(folded_tags[i][1]);
+  }
+}
+
+}  // namespace x86
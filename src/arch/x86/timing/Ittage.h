@@ -0,0 +1,149 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef ARCH_X86_TIMING_ITTAGE_H
+#define ARCH_X86_TIMING_ITTAGE_H
+
+#include <iostream>
+#include <memory>
+
+#include <lib/cpp/IniFile.h>
+
+#include "BranchHistory.h"
+
+namespace x86 {
+
+/// ITTAGE indirect branch target predictor. Partially tagged tables
+/// indexed with global histories of geometrically increasing lengths
+/// store full branch targets. The target stored in the BTB acts as the
+/// base prediction, and the table with the longest matching history
+/// overrides it.
+class Ittage {
+ public:
+  /// Maximum number of tagged tables
+  static const int max_tables = 16;
+
+  /// Information about a prediction, kept in the uop until the branch
+  /// commits and the predictor is updated.
+  struct Info {
+    // True if the fields have been initialized by a lookup
+    bool valid = false;
+
+    // Index and tag of each tagged table
+    int indexes[max_tables] = {};
+    unsigned tags[max_tables] = {};
+
+    // Table providing the prediction and alternate table, or -1 for the
+    // base prediction
+    int provider = -1;
+    int alt_provider = -1;
+
+    // Targets predicted by the provider and the alternate tables
+    unsigned provider_target = 0;
+    unsigned alt_target = 0;
+
+    // Final predicted target
+    unsigned prediction = 0;
+  };
+
+ private:
+  //
+  // Configuration
+  //
+
+  // Number of tagged tables
+  static int num_tables;
+
+  // Number of entries of each tagged table
+  static int table_size;
+
+  // Number of bits of the tags
+  static int tag_bits;
+
+  // Shortest and longest history lengths
+  static int min_history;
+  static int max_history;
+
+  // History length used by each tagged table
+  static int history_lengths[max_tables];
+
+  //
+  // Tables
+  //
+
+  // Entry of a tagged table
+  struct Entry {
+    // Partial tag
+    unsigned tag = 0;
+
+    // Predicted target
+    unsigned target = 0;
+
+    // 2-bit confidence counter
+    int confidence = 0;
+
+    // 1-bit useful counter
+    int useful = 0;
+  };
+
+  // Tagged tables, with 'num_tables' * 'table_size' entries
+  std::unique_ptr<Entry[]> tables;
+
+  // Folded histories used to compute indexes and tags
+  BranchHistory::Folded folded_indexes[max_tables];
+  BranchHistory::Folded folded_tags[max_tables][2];
+
+  // Number of updates, used to reset useful counters periodically
+  long long num_updates = 0;
+
+ public:
+  /// Read the configuration from section \a section of an INI file
+  static void ParseConfiguration(misc::IniFile* ini_file,
+                                 const std::string& section);
+
+  /// Dump configuration
+  static void DumpConfiguration(std::ostream& os);
+
+  /// Return the number of storage bits needed by the predictor
+  static long long getStorageBits();
+
+  /// Return the longest history length used
+  static int getMaxHistory() { return max_history; }
+
+  /// Constructor
+  Ittage();
+
+  /// Predict the target of the indirect branch at address \a eip, given
+  /// the target \a base_target found in the BTB, and record in \a info
+  /// the information needed to update the predictor later.
+  unsigned Lookup(unsigned eip, unsigned base_target, Info& info) const;
+
+  /// Update the predictor with the actual \a target of a branch
+  /// committed after a lookup that filled \a info.
+  void Update(const Info& info, unsigned target);
+
+  /// Update the folded histories after a new outcome was shifted into
+  /// the global history.
+  void UpdateHistory(const BranchHistory& history);
+};
+
+}  // namespace x86
+
+#endif
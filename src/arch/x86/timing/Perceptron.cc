@@ -0,0 +1,149 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
+
+#include "BranchPredictor.h"
+#include "Perceptron.h"
+
+namespace x86 {
+
+int Perceptron::num_tables;
+int Perceptron::table_size;
+int Perceptron::min_history;
+int Perceptron::max_history;
+int Perceptron::history_lengths[max_tables];
+int Perceptron::theta;
+
+void Perceptron::ParseConfiguration(misc::IniFile* ini_file,
+                                    const std::string& section) {
+  // Read values
+  num_tables = ini_file->ReadInt(section, "Perceptron.NumTables", 8);
+  table_size = ini_file->ReadInt(section, "Perceptron.TableSize", 1024);
+  min_history = ini_file->ReadInt(section, "Perceptron.MinHistory", 3);
+  max_history = ini_file->ReadInt(section, "Perceptron.MaxHistory", 64);
+
+  // Integrity
+  if (num_tables < 2 || num_tables > max_tables)
+    throw BranchPredictor::Error(misc::fmt(
+        "Perceptron.NumTables must be between 2 and %d", max_tables));
+  if (table_size < 16 || (table_size & (table_size - 1)))
+    throw BranchPredictor::Error(
+        "Perceptron.TableSize must be a power of 2 of at least 16");
+  if (min_history < 1 || max_history < min_history || max_history > 1024)
+    throw BranchPredictor::Error(
+        "Perceptron history lengths must satisfy 1 <= MinHistory <= "
+        "MaxHistory <= 1024");
+
+  // Table 0 is the bias, the rest use a geometric series of history
+  // lengths.
+  history_lengths[0] = 0;
+  for (int i = 1; i < num_tables; i++)
+    history_lengths[i] =
+        num_tables == 2
+            ? min_history
+            : (int)(min_history *
+                        pow((double)max_history / min_history,
+                            (double)(i - 1) / (num_tables - 2)) +
+                    0.5);
+
+  // Threshold proposed for perceptrons with the given number of weights
+  theta = (int)(1.93 * num_tables + 14);
+}
+
+void Perceptron::DumpConfiguration(std::ostream& os) {
+  os << misc::fmt("Perceptron.NumTables = %d\n", num_tables);
+  os << misc::fmt("Perceptron.TableSize = %d\n", table_size);
+  os << misc::fmt("Perceptron.MinHistory = %d\n", min_history);
+  os << misc::fmt("Perceptron.MaxHistory = %d\n", max_history);
+}
+
+long long Perceptron::getStorageBits() {
+  // 8-bit weights and global history
+  return (long long)num_tables * table_size * 8 + max_history;
+}
+
+Perceptron::Perceptron() {
+  weights = misc::new_unique_array<signed char>(num_tables * table_size);
+  int log_table_size = misc::LogBase2(table_size);
+  for (int i = 1; i < num_tables; i++)
+    folded_histories.indexes[i] =
+        BranchHistory::Folded(history_lengths[i], log_table_size);
+}
+
+void Perceptron::Predict(unsigned eip, const FoldedHistories& folded_histories,
+                         Info& info) const {
+  info.valid = true;
+  info.sum = 0;
+  int log_table_size = misc::LogBase2(table_size);
+  for (int i = 0; i < num_tables; i++) {
+    info.indexes[i] = (eip ^ (eip >> (log_table_size - i % log_table_size)) ^
+                       folded_histories.indexes[i].getValue()) &
+                      (table_size - 1);
+    info.sum += weights[i * table_size + info.indexes[i]];
+  }
+  info.prediction = info.sum >= 0;
+}
+
+bool Perceptron::Lookup(unsigned eip, Info& info) const {
+  Predict(eip, folded_histories, info);
+  return info.prediction;
+}
+
+int Perceptron::LookupMultiple(unsigned eip, int count,
+                               const BranchHistory& history) const {
+  FoldedHistories speculative_histories = folded_histories;
+  unsigned predictions = 0;
+  for (int i = 0; i < count; i++) {
+    Info info;
+    Predict(eip, speculative_histories, info);
+    predictions |= (unsigned)info.prediction << i;
+    for (int j = 1; j < num_tables; j++) {
+      BranchHistory::Folded& folded = speculative_histories.indexes[j];
+      folded.Update(info.prediction,
+                    history.getOutcome(folded.getLength(), predictions, i + 1));
+    }
+  }
+  return predictions;
+}
+
+void Perceptron::Update(const Info& info, bool taken) {
+  assert(info.valid);
+  if (info.prediction == taken && std::abs(info.sum) > theta) return;
+  for (int i = 0; i < num_tables; i++) {
+    signed char& weight = weights[i * table_size + info.indexes[i]];
+    if (taken && weight < 127)
+      weight++;
+    else if (!taken && weight > -128)
+      weight--;
+  }
+}
+
+void Perceptron::UpdateHistory(const BranchHistory& history) {
+  for (int i = 1; i < num_tables; i++)
+    history.Update(folded_histories.indexes[i]);
+}
+
+}  // namespace x86
@@ -0,0 +1,143 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef ARCH_X86_TIMING_PERCEPTRON_H
+#define ARCH_X86_TIMING_PERCEPTRON_H
+
+#include <iostream>
+#include <memory>
+
+#include <lib/cpp/IniFile.h>
+
+#include "BranchHistory.h"
+
+namespace x86 {
+
+/// Hashed perceptron conditional branch direction predictor. Each table
+/// holds signed weights, indexed by a hash of the branch address and a
+/// global history segment of geometrically increasing length. The first
+/// table is indexed by the address only and acts as the bias weight. The
+/// prediction is the sign of the sum of the selected weights.
+class Perceptron {
+ public:
+  /// Maximum number of tables
+  static const int max_tables = 16;
+
+  /// Information about a prediction, kept in the uop until the branch
+  /// commits and the predictor is updated.
+  struct Info {
+    // True if the fields have been initialized by a lookup
+    bool valid = false;
+
+    // Index of the weight selected in each table
+    int indexes[max_tables] = {};
+
+    // Sum of the selected weights
+    int sum = 0;
+
+    // Prediction
+    bool prediction = false;
+  };
+
+ private:
+  //
+  // Configuration
+  //
+
+  // Number of tables, including the bias table
+  static int num_tables;
+
+  // Number of weights of each table
+  static int table_size;
+
+  // Shortest and longest history lengths
+  static int min_history;
+  static int max_history;
+
+  // History length used by each table
+  static int history_lengths[max_tables];
+
+  // Training threshold
+  static int theta;
+
+  //
+  // Tables
+  //
+
+  // Signed 8-bit weights, 'num_tables' * 'table_size' entries
+  std::unique_ptr<signed char[]> weights;
+
+  // Folded histories used to compute indexes
+  struct FoldedHistories {
+    BranchHistory::Folded indexes[max_tables];
+  };
+
+  // Folded histories
+  FoldedHistories folded_histories;
+
+  // Compute a prediction using the given folded histories
+  void Predict(unsigned eip, const FoldedHistories& folded_histories,
+               Info& info) const;
+
+ public:
+  /// Read the configuration from section \a section of an INI file
+  static void ParseConfiguration(misc::IniFile* ini_file,
+                                 const std::string& section);
+
+  /// Dump configuration
+  static void DumpConfiguration(std::ostream& os);
+
+  /// Return the number of storage bits needed by the predictor
+  static long long getStorageBits();
+
+  /// Return the longest history length used
+  static int getMaxHistory() { return max_history; }
+
+  /// Return the training threshold
+  static int getTheta() { return theta; }
+
+  /// Constructor
+  Perceptron();
+
+  /// Predict the direction of the conditional branch at address \a eip,
+  /// and record in \a info the information needed to update the
+  /// predictor later.
+  bool Lookup(unsigned eip, Info& info) const;
+
+  /// Predict the direction of \a count consecutive branches at address
+  /// \a eip, shifting each prediction into the global history before
+  /// making the next one. The prediction of the first branch is returned
+  /// in bit 0.
+  int LookupMultiple(unsigned eip, int count,
+                     const BranchHistory& history) const;
+
+  /// Train the weights with the outcome of a branch committed after a
+  /// lookup that filled \a info. Weights are only trained on
+  /// mispredictions or when the sum is below the training threshold.
+  void Update(const Info& info, bool taken);
+
+  /// Update the folded histories after a new outcome was shifted into
+  /// the global history.
+  void UpdateHistory(const BranchHistory& history);
+};
+
+}  // namespace x86
+
+#endif
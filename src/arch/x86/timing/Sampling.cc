@@ -0,0 +1,338 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2012  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <lib/cpp/Misc.h>
+#include <lib/esim/Engine.h>
+
+#include "Cpu.h"
+#include "Sampling.h"
+
+namespace x86 {
+
+misc::StringMap Sampling::kind_map = {{"None", KindNone},
+                                            {"Periodic", KindPeriodic},
+                                            {"SimPoint", KindSimPoint}};
+
+Sampling::Kind Sampling::kind = KindNone;
+long long Sampling::period;
+long long Sampling::num_warmup_instructions;
+long long Sampling::num_measured_instructions;
+long long Sampling::interval_size;
+std::string Sampling::simpoints_file;
+std::string Sampling::weights_file;
+std::vector<Sampling::SimPoint> Sampling::simpoints;
+
+void Sampling::ParseConfiguration(misc::IniFile* ini_file) {
+  // Section
+  std::string section = "Sampling";
+
+  // Read variables
+  kind = (Kind)ini_file->ReadEnum(section, "Kind", kind_map, KindNone);
+  period = ini_file->ReadInt64(section, "Period", 10000000);
+  num_warmup_instructions = ini_file->ReadInt64(section, "WarmUp", 20000);
+  num_measured_instructions = ini_file->ReadInt64(section, "Measure", 10000);
+  interval_size = ini_file->ReadInt64(section, "IntervalSize", 100000000);
+  simpoints_file = ini_file->ReadString(section, "SimPoints");
+  weights_file = ini_file->ReadString(section, "Weights");
+
+  // Integrity checks
+  if (num_warmup_instructions < 0)
+    throw Error(misc::fmt("%s: %s: Invalid value for 'WarmUp'",
+                          ini_file->getPath().c_str(), section.c_str()));
+  if (kind == KindPeriodic) {
+    if (num_measured_instructions < 1)
+      throw Error(misc::fmt("%s: %s: Invalid value for 'Measure'",
+                            ini_file->getPath().c_str(), section.c_str()));
+    if (period < num_warmup_instructions + num_measured_instructions)
+      throw Error(misc::fmt(
+          "%s: %s: 'Period' must be at least 'WarmUp' + 'Measure'",
+          ini_file->getPath().c_str(), section.c_str()));
+  }
+  if (kind == KindSimPoint) {
+    if (interval_size < 1)
+      throw Error(misc::fmt("%s: %s: Invalid value for 'IntervalSize'",
+                            ini_file->getPath().c_str(), section.c_str()));
+    if (simpoints_file.empty() || weights_file.empty())
+      throw Error(misc::fmt(
+          "%s: %s: Variables 'SimPoints' and 'Weights' are required for "
+          "SimPoint sampling",
+          ini_file->getPath().c_str(), section.c_str()));
+    ReadSimPoints();
+  }
+}
+
+void Sampling::ReadSimPoints() {
+  // Read weights, indexed by cluster
+  std::ifstream weights_stream(weights_file);
+  if (!weights_stream.good())
+    throw Error(misc::fmt("%s: Cannot open weights file",
+                          weights_file.c_str()));
+  std::map<int, double> weights;
+  std::string line;
+  while (std::getline(weights_stream, line)) {
+    std::istringstream line_stream(line);
+    double weight;
+    int cluster;
+    if (!(line_stream >> weight >> cluster)) continue;
+    weights[cluster] = weight;
+  }
+
+  // Read simulation points
+  std::ifstream simpoints_stream(simpoints_file);
+  if (!simpoints_stream.good())
+    throw Error(misc::fmt("%s: Cannot open SimPoints file",
+                          simpoints_file.c_str()));
+  simpoints.clear();
+  while (std::getline(simpoints_stream, line)) {
+    std::istringstream line_stream(line);
+    SimPoint simpoint;
+    int cluster;
+    if (!(line_stream >> simpoint.interval >> cluster)) continue;
+    auto it = weights.find(cluster);
+    if (it == weights.end())
+      throw Error(misc::fmt("%s: No weight for cluster %d",
+                            weights_file.c_str(), cluster));
+    simpoint.weight = it->second;
+    simpoints.push_back(simpoint);
+  }
+
+  // Sort by position in the program
+  if (simpoints.empty())
+    throw Error(
+        misc::fmt("%s: No simulation points found", simpoints_file.c_str()));
+  std::sort(simpoints.begin(), simpoints.end(),
+            [](const SimPoint& a, const SimPoint& b) {
+              return a.interval < b.interval;
+            });
+}
+
+void Sampling::DumpConfiguration(std::ostream& os) {
+  os << misc::fmt("Sampling.Kind = %s\n", kind_map.MapValue(kind));
+  os << misc::fmt("Sampling.WarmUp = %lld\n", num_warmup_instructions);
+  if (kind == KindPeriodic) {
+    os << misc::fmt("Sampling.Period = %lld\n", period);
+    os << misc::fmt("Sampling.Measure = %lld\n", num_measured_instructions);
+  } else if (kind == KindSimPoint) {
+    os << misc::fmt("Sampling.IntervalSize = %lld\n", interval_size);
+    os << misc::fmt("Sampling.SimPoints = %s\n", simpoints_file.c_str());
+    os << misc::fmt("Sampling.Weights = %s\n", weights_file.c_str());
+  }
+}
+
+Sampling::Sampling(Cpu* cpu) : cpu(cpu) {}
+
+long long Sampling::getPosition() const {
+  return num_functional_instructions + cpu->getNumCommittedInstructions();
+}
+
+bool Sampling::NextSample() {
+  // Current position
+  long long position = getPosition();
+
+  // Periodic sampling. The measurement is placed at the end of the period,
+  // skipping periods already overlapped by the previous detailed window.
+  if (kind == KindPeriodic) {
+    long long measure_start;
+    do {
+      measure_start = period_start + period - num_measured_instructions;
+      period_start += period;
+    } while (measure_start - num_warmup_instructions < position);
+
+    // Do not start samples beyond the instruction limit
+    long long max_instructions = Emulator::getMaxInstructions();
+    if (max_instructions &&
+        measure_start + num_measured_instructions > max_instructions)
+      return false;
+
+    // Next sample
+    phase_end = measure_start - num_warmup_instructions;
+    warmup_end = measure_start;
+    measure_end = measure_start + num_measured_instructions;
+    weight = 1.0;
+    return true;
+  }
+
+  // SimPoint sampling. Simulation points overlapped by the previous
+  // detailed window are skipped.
+  assert(kind == KindSimPoint);
+  while (next_simpoint < simpoints.size()) {
+    SimPoint& simpoint = simpoints[next_simpoint++];
+    long long measure_start = simpoint.interval * interval_size;
+    if (measure_start < position) {
+      misc::Warning(
+          "x86 sampling: SimPoint interval %lld skipped, since it starts "
+          "before the current position (%lld)",
+          simpoint.interval, position);
+      continue;
+    }
+
+    // Next sample
+    phase_end = std::max(position, measure_start - num_warmup_instructions);
+    warmup_end = measure_start;
+    measure_end = measure_start + interval_size;
+    weight = simpoint.weight;
+    return true;
+  }
+
+  // No more simulation points
+  return false;
+}
+
+void Sampling::RunFunctional() {
+  Emulator* emulator = Emulator::getInstance();
+  esim::Engine* esim_engine = esim::Engine::getInstance();
+  while (getPosition() < phase_end && !esim_engine->hasFinished()) {
+    long long num_instructions = emulator->getNumInstructions();
+    if (!emulator->Run()) break;
+    num_functional_instructions +=
+        emulator->getNumInstructions() - num_instructions;
+  }
+}
+
+void Sampling::Run() {
+  // Record instructions executed before sampling started, such as those
+  // in the initial fast-forward.
+  Emulator* emulator = Emulator::getInstance();
+  esim::Engine* esim_engine = esim::Engine::getInstance();
+  if (!started) {
+    started = true;
+    num_functional_instructions = emulator->getNumInstructions();
+    if (!NextSample()) {
+      esim_engine->Finish("X86Sampling");
+      return;
+    }
+  }
+
+  // Functional execution up to the beginning of the warm-up window. The
+  // scheduler is signaled to map and allocate all running contexts.
+  if (phase == PhaseFunctional) {
+    RunFunctional();
+    if (esim_engine->hasFinished() || !emulator->getNumContexts()) return;
+    phase = PhaseWarmup;
+    emulator->schedule_signal = true;
+  }
+
+  // Warm-up finished, start measuring
+  if (phase == PhaseWarmup && getPosition() >= warmup_end) {
+    phase = PhaseMeasure;
+    measure_start_position = getPosition();
+    measure_start_cycle = cpu->getCycle();
+    measure_start_committed = cpu->getNumCommittedInstructions();
+  }
+
+  // Measurement finished. Record sample and drain pipelines.
+  if (phase == PhaseMeasure && getPosition() >= measure_end) {
+    Sample sample;
+    sample.position = measure_start_position;
+    sample.num_instructions =
+        cpu->getNumCommittedInstructions() - measure_start_committed;
+    sample.num_cycles = cpu->getCycle() - measure_start_cycle;
+    sample.weight = weight;
+    samples.push_back(sample);
+    phase = PhaseDrain;
+    cpu->Drain();
+  }
+
+  // Pipelines drained. Release hardware threads and continue with
+  // functional execution in the next cycle.
+  if (phase == PhaseDrain && cpu->isDrained()) {
+    cpu->UnmapContexts();
+    phase = PhaseFunctional;
+    if (!NextSample()) esim_engine->Finish("X86Sampling");
+  }
+}
+
+double Sampling::getCpi() const {
+  double cpi = 0.0;
+  double total_weight = 0.0;
+  for (const Sample& sample : samples) {
+    cpi += sample.weight * sample.getCpi();
+    total_weight += sample.weight;
+  }
+  return total_weight > 0.0 ? cpi / total_weight : 0.0;
+}
+
+double Sampling::getCpiError() const {
+  // Not enough samples
+  int n = samples.size();
+  if (n < 2) return 0.0;
+
+  // Sample standard deviation
+  double mean = getCpi();
+  double sum = 0.0;
+  for (const Sample& sample : samples)
+    sum += (sample.getCpi() - mean) * (sample.getCpi() - mean);
+  double deviation = std::sqrt(sum / (n - 1));
+
+  // Half-width of the 95% confidence interval
+  return 1.96 * deviation / std::sqrt((double)n);
+}
+
+void Sampling::DumpSummary(std::ostream& os) const {
+  // Totals
+  long long num_instructions = 0;
+  long long num_cycles = 0;
+  for (const Sample& sample : samples) {
+    num_instructions += sample.num_instructions;
+    num_cycles += sample.num_cycles;
+  }
+
+  // Dump
+  os << misc::fmt("SamplingKind = %s\n", kind_map.MapValue(kind));
+  os << misc::fmt("Samples = %d\n", getNumSamples());
+  os << misc::fmt("SampledInstructions = %lld\n", num_instructions);
+  os << misc::fmt("SampledCycles = %lld\n", num_cycles);
+  os << misc::fmt("SampledCPI = %.4g\n", getCpi());
+  if (kind == KindPeriodic)
+    os << misc::fmt("SampledCPIError = %.4g\n", getCpiError());
+}
+
+void Sampling::DumpReport(std::ostream& os) const {
+  // Header
+  os << "; Sampling\n";
+  os << ";    CPI - Estimated cycles per instruction\n";
+  os << ";    CPIError - Half-width of the 95% confidence interval of the "
+        "CPI\n";
+  os << ";    Sample.<n> - Position, instructions, cycles, CPI, and weight\n";
+  os << "[ Sampling ]\n";
+  DumpConfiguration(os);
+
+  // Estimates
+  os << misc::fmt("Samples = %d\n", getNumSamples());
+  os << misc::fmt("CPI = %.4g\n", getCpi());
+  if (kind == KindPeriodic)
+    os << misc::fmt("CPIError = %.4g\n", getCpiError());
+
+  // Samples
+  for (unsigned i = 0; i < samples.size(); i++) {
+    const Sample& sample = samples[i];
+    os << misc::fmt("Sample.%d = %lld %lld %lld %.4g %.4g\n", i,
+                    sample.position, sample.num_instructions,
+                    sample.num_cycles, sample.getCpi(), sample.weight);
+  }
+  os << '\n';
+}
+
+}  // namespace x86
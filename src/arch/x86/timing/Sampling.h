@@ -0,0 +1,242 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2012  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_X86_TIMING_SAMPLING_H
+#define ARCH_X86_TIMING_SAMPLING_H
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+
+namespace x86 {
+
+// Forward declarations
+class Cpu;
+
+/// Statistical sampling of the x86 detailed simulation. When active, the
+/// timing simulator alternates fast functional execution with short
+/// detailed windows. Every window starts with a warm-up period, whose
+/// statistics are discarded, followed by a measurement period. At the end
+/// of a measurement, all hardware threads are drained and functional
+/// execution resumes. Two kinds of sampling are supported:
+///
+///   - Periodic: one measurement is taken every fixed number of
+///     instructions (SMARTS-style systematic sampling). The CPI is
+///     reported together with its confidence interval.
+///
+///   - SimPoint: only the intervals selected by SimPoint are simulated in
+///     detail, and the CPI is computed as the average of their CPIs,
+///     weighted by the SimPoint weights. The input vectors are obtained
+///     with option '--x86-bbv' in a functional simulation.
+///
+/// All instruction counts refer to the position in the dynamic instruction
+/// stream of the program, i.e., the sum of functionally emulated and
+/// committed instructions.
+class Sampling {
+ public:
+  /// Sampling kind
+  enum Kind { KindInvalid = 0, KindNone, KindPeriodic, KindSimPoint };
+
+  /// String map for values of type Kind
+  static misc::StringMap kind_map;
+
+  /// Phase of the sampled simulation
+  enum Phase {
+    PhaseInvalid = 0,
+    PhaseFunctional,  // Functional execution, pipelines empty
+    PhaseWarmup,      // Detailed execution, statistics discarded
+    PhaseMeasure,     // Detailed execution, statistics recorded
+    PhaseDrain        // Pipelines being flushed before functional execution
+  };
+
+  /// Measurement taken in one detailed window
+  struct Sample {
+    // Position of the first measured instruction
+    long long position = 0;
+
+    // Number of measured instructions
+    long long num_instructions = 0;
+
+    // Number of cycles taken by the measured instructions
+    long long num_cycles = 0;
+
+    // Weight of the sample. All samples have weight 1 in periodic
+    // sampling, and their SimPoint weight otherwise.
+    double weight = 1.0;
+
+    /// Return the cycles per instruction of the sample
+    double getCpi() const {
+      return num_instructions ? (double)num_cycles / num_instructions : 0.0;
+    }
+  };
+
+  /// Exception for sampling errors
+  class Error : public misc::Error {
+   public:
+    Error(const std::string& message) : misc::Error(message) {
+      AppendPrefix("x86 sampling");
+    }
+  };
+
+ private:
+  //
+  // Static fields
+  //
+
+  // Sampling kind
+  static Kind kind;
+
+  // Number of instructions between the start of consecutive periods in
+  // periodic sampling
+  static long long period;
+
+  // Number of warm-up instructions before every measurement
+  static long long num_warmup_instructions;
+
+  // Number of measured instructions in periodic sampling
+  static long long num_measured_instructions;
+
+  // SimPoint interval size
+  static long long interval_size;
+
+  // SimPoint files
+  static std::string simpoints_file;
+  static std::string weights_file;
+
+  // Selected SimPoint intervals, sorted by their index
+  struct SimPoint {
+    long long interval;
+    double weight;
+  };
+  static std::vector<SimPoint> simpoints;
+
+  // Read the SimPoint and weights files
+  static void ReadSimPoints();
+
+  //
+  // Class members
+  //
+
+  // CPU that is being sampled
+  Cpu* cpu;
+
+  // Current phase
+  Phase phase = PhaseFunctional;
+
+  // Whether the initial position has been recorded
+  bool started = false;
+
+  // Number of instructions emulated in functional phases, including those
+  // executed before the sampled simulation started
+  long long num_functional_instructions = 0;
+
+  // Position where the current functional phase ends
+  long long phase_end = 0;
+
+  // Position where the warm-up window of the next sample ends
+  long long warmup_end = 0;
+
+  // Position where the measurement of the next sample ends
+  long long measure_end = 0;
+
+  // Weight of the next sample
+  double weight = 1.0;
+
+  // Position where the current sampling period starts
+  long long period_start = 0;
+
+  // Index of the next SimPoint to simulate
+  unsigned next_simpoint = 0;
+
+  // Position, cycle, and number of committed instructions at the start
+  // of the current measurement
+  long long measure_start_position = 0;
+  long long measure_start_cycle = 0;
+  long long measure_start_committed = 0;
+
+  // Measurements taken so far
+  std::vector<Sample> samples;
+
+  // Compute the end of the next functional phase and the warm-up window
+  // that follows it. Return false if no more samples are needed.
+  bool NextSample();
+
+  // Run functional emulation until the end of the current functional
+  // phase.
+  void RunFunctional();
+
+ public:
+  /// Read the sampling configuration from section [ Sampling ] of the x86
+  /// configuration file
+  static void ParseConfiguration(misc::IniFile* ini_file);
+
+  /// Dump the sampling configuration
+  static void DumpConfiguration(std::ostream& os = std::cout);
+
+  /// Return the sampling kind
+  static Kind getKind() { return kind; }
+
+  /// Return true if sampling is active
+  static bool isActive() { return kind != KindNone; }
+
+  /// Constructor
+  Sampling(Cpu* cpu);
+
+  /// Return the current phase
+  Phase getPhase() const { return phase; }
+
+  /// Return the current position in the dynamic instruction stream
+  long long getPosition() const;
+
+  /// Update the sampling state machine. This function must be invoked
+  /// once per cycle, before the CPU pipelines are simulated. Functional
+  /// phases are executed entirely within this call.
+  void Run();
+
+  /// Return the number of samples taken
+  int getNumSamples() const { return samples.size(); }
+
+  /// Return the sample with the given index
+  const Sample& getSample(int index) const {
+    assert(index >= 0 && index < (int)samples.size());
+    return samples[index];
+  }
+
+  /// Return the estimated cycles per instruction for the whole program
+  double getCpi() const;
+
+  /// Return the half-width of the 95% confidence interval for the CPI
+  /// estimate. Only meaningful for periodic sampling with more than one
+  /// sample.
+  double getCpiError() const;
+
+  /// Dump the sampling summary
+  void DumpSummary(std::ostream& os = std::cout) const;
+
+  /// Dump the sampling report, including every sample
+  void DumpReport(std::ostream& os = std::cout) const;
+};
+
+}  // namespace x86
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <algorithm>
+
+#include <lib/cpp/Misc.h>
+
+#include "StoreSets.h"
+
+namespace x86 {
+
+StoreSets::StoreSets(int size, long long clear_interval)
+    : size(size), clear_interval(clear_interval) {
+  // Sanity
+  assert(size > 0 && !(size & (size - 1)));
+
+  // Initialize table
+  table = misc::new_unique_array<int>(size);
+  Clear();
+}
+
+int StoreSets::getIndex(unsigned eip) const {
+  return (eip ^ (eip >> misc::LogBase2(size))) & (size - 1);
+}
+
+void StoreSets::Violation(unsigned load_eip, unsigned store_eip) {
+  int& load_set = table[getIndex(load_eip)];
+  int& store_set = table[getIndex(store_eip)];
+
+  // Neither instruction belongs to a set. A new set is created, using the
+  // load index as its identifier.
+  if (load_set < 0 && store_set < 0) {
+    load_set = getIndex(load_eip);
+    store_set = load_set;
+    return;
+  }
+
+  // Only one of them belongs to a set, which the other one joins
+  if (load_set < 0) {
+    load_set = store_set;
+    return;
+  }
+  if (store_set < 0) {
+    store_set = load_set;
+    return;
+  }
+
+  // Both belong to different sets. Both instructions move to the set with
+  // the smallest identifier, so that merges converge.
+  int set = std::min(load_set, store_set);
+  load_set = set;
+  store_set = set;
+}
+
+void StoreSets::Refresh(long long cycle) {
+  if (!clear_interval || cycle - last_clear_cycle < clear_interval) return;
+  last_clear_cycle = cycle;
+  Clear();
+}
+
+void StoreSets::Clear() {
+  for (int i = 0; i < size; i++) table[i] = -1;
+}
+
+}  // namespace x86
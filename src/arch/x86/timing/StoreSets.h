@@ -0,0 +1,74 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef ARCH_X86_TIMING_STORE_SETS_H
+#define ARCH_X86_TIMING_STORE_SETS_H
+
+#include <memory>
+
+namespace x86 {
+
+/// Store set memory dependence predictor. Loads and stores that caused a
+/// memory-ordering violation are assigned to the same store set, and a
+/// load is not allowed to issue while an older store of its set has an
+/// unknown address. All other loads issue speculatively. The table is
+/// cleared periodically, so that stale dependences do not keep loads
+/// waiting forever.
+class StoreSets {
+  // Number of entries of the store set identifier table
+  int size;
+
+  // Number of cycles between two consecutive clears of the table
+  long long clear_interval;
+
+  // Cycle when the table was last cleared
+  long long last_clear_cycle = 0;
+
+  // Store set identifier table, indexed by instruction address. Each
+  // entry contains a store set identifier, or -1 if the instruction is
+  // not part of any set.
+  std::unique_ptr<int[]> table;
+
+  // Return the table index for an instruction address
+  int getIndex(unsigned eip) const;
+
+ public:
+  /// Constructor
+  StoreSets(int size, long long clear_interval);
+
+  /// Return the store set of the load or store at address \a eip, or -1
+  /// if it does not belong to any set.
+  int getSet(unsigned eip) const { return table[getIndex(eip)]; }
+
+  /// Record a memory-ordering violation between the load at address
+  /// \a load_eip and an older store at address \a store_eip, which are
+  /// placed in the same store set.
+  void Violation(unsigned load_eip, unsigned store_eip);
+
+  /// Clear the table if the clear interval has elapsed at cycle \a cycle
+  void Refresh(long long cycle);
+
+  /// Remove all instructions from their store sets
+  void Clear();
+};
+
+}  // namespace x86
+
+#endif
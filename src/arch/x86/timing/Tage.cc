@@ -0,0 +1,493 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
+
+#include "BranchPredictor.h"
+#include "Tage.h"
+
+namespace x86 {
+
+int Tage::num_tables;
+int Tage::table_size;
+int Tage::tag_bits;
+int Tage::min_history;
+int Tage::max_history;
+int Tage::base_size;
+int Tage::loop_size;
+int Tage::sc_size;
+int Tage::history_lengths[max_tables];
+
+// History lengths of the statistical corrector tables
+static const int sc_history_lengths[Tage::num_sc_tables] = {0, 4, 8, 16};
+
+// Number of updates between two agings of the useful counters
+static const long long useful_reset_period = 1 << 18;
+
+// Weight of the TAGE confidence in the statistical corrector sum
+static const int sc_tage_weight = 8;
+
+// Statistical corrector training threshold
+static const int sc_threshold = 24;
+
+// Saturate a counter within the given range
+static void UpdateCounter(int& counter, bool increment, int min, int max) {
+  if (increment && counter < max)
+    counter++;
+  else if (!increment && counter > min)
+    counter--;
+}
+
+void Tage::ParseConfiguration(misc::IniFile* ini_file,
+                              const std::string& section) {
+  // Read values
+  num_tables = ini_file->ReadInt(section, "TAGE.NumTables", 7);
+  table_size = ini_file->ReadInt(section, "TAGE.TableSize", 1024);
+  tag_bits = ini_file->ReadInt(section, "TAGE.TagBits", 9);
+  min_history = ini_file->ReadInt(section, "TAGE.MinHistory", 5);
+  max_history = ini_file->ReadInt(section, "TAGE.MaxHistory", 130);
+  base_size = ini_file->ReadInt(section, "TAGE.BaseSize", 4096);
+  loop_size = ini_file->ReadInt(section, "TAGE.LoopSize", 64);
+  sc_size = ini_file->ReadInt(section, "TAGE.SCSize", 1024);
+
+  // Integrity
+  if (num_tables < 1 || num_tables > max_tables)
+    throw BranchPredictor::Error(misc::fmt(
+        "TAGE.NumTables must be between 1 and %d", max_tables));
+  if (table_size < 16 || (table_size & (table_size - 1)))
+    throw BranchPredictor::Error(
+        "TAGE.TableSize must be a power of 2 of at least 16");
+  if (tag_bits < 2 || tag_bits > 20)
+    throw BranchPredictor::Error("TAGE.TagBits must be between 2 and 20");
+  if (min_history < 1 || max_history < min_history || max_history > 1024)
+    throw BranchPredictor::Error(
+        "TAGE history lengths must satisfy 1 <= MinHistory <= "
+        "MaxHistory <= 1024");
+  if (base_size < 1 || (base_size & (base_size - 1)))
+    throw BranchPredictor::Error("TAGE.BaseSize must be a power of 2");
+  if (loop_size & (loop_size - 1))
+    throw BranchPredictor::Error("TAGE.LoopSize must be 0 or a power of 2");
+  if ((sc_size && sc_size < 16) || (sc_size & (sc_size - 1)))
+    throw BranchPredictor::Error(
+        "TAGE.SCSize must be 0 or a power of 2 of at least 16");
+
+  // Geometric series of history lengths
+  for (int i = 0; i < num_tables; i++)
+    history_lengths[i] =
+        num_tables == 1
+            ? min_history
+            : (int)(min_history *
+                        pow((double)max_history / min_history,
+                            (double)i / (num_tables - 1)) +
+                    0.5);
+}
+
+void Tage::DumpConfiguration(std::ostream& os) {
+  os << misc::fmt("TAGE.NumTables = %d\n", num_tables);
+  os << misc::fmt("TAGE.TableSize = %d\n", table_size);
+  os << misc::fmt("TAGE.TagBits = %d\n", tag_bits);
+  os << misc::fmt("TAGE.MinHistory = %d\n", min_history);
+  os << misc::fmt("TAGE.MaxHistory = %d\n", max_history);
+  os << misc::fmt("TAGE.BaseSize = %d\n", base_size);
+  os << misc::fmt("TAGE.LoopSize = %d\n", loop_size);
+  os << misc::fmt("TAGE.SCSize = %d\n", sc_size);
+}
+
+long long Tage::getStorageBits() {
+  // Tagged tables with 3-bit counters and 2-bit useful counters, and base
+  // predictor with 2-bit counters
+  long long bits = (long long)num_tables * table_size * (tag_bits + 5);
+  bits += base_size * 2;
+
+  // Loop predictor entries with a 14-bit tag, two 10-bit iteration
+  // counters, 2-bit confidence, 8-bit age, and direction
+  bits += loop_size * 45;
+
+  // Statistical corrector with 6-bit counters
+  bits += (long long)num_sc_tables * sc_size * 6;
+
+  // Global history and alternate prediction counter
+  return bits + max_history + 4;
+}
+
+Tage::Tage() {
+  // Tables
+  tables = misc::new_unique_array<Entry>(num_tables * table_size);
+  base = misc::new_unique_array<char>(base_size);
+  for (int i = 0; i < base_size; i++) base[i] = 2;
+  if (loop_size) loops = misc::new_unique_array<LoopEntry>(loop_size);
+  if (sc_size) sc = misc::new_unique_array<int>(num_sc_tables * sc_size);
+
+  // Folded histories. Two folded histories with different widths are
+  // used for tags, so that a history and its shifted version do not
+  // produce the same tag.
+  int log_table_size = misc::LogBase2(table_size);
+  for (int i = 0; i < num_tables; i++) {
+    folded_histories.indexes[i] =
+        BranchHistory::Folded(history_lengths[i], log_table_size);
+    folded_histories.tags[i][0] =
+        BranchHistory::Folded(history_lengths[i], tag_bits);
+    folded_histories.tags[i][1] =
+        BranchHistory::Folded(history_lengths[i], tag_bits - 1);
+  }
+  if (sc_size)
+    for (int i = 1; i < num_sc_tables; i++)
+      folded_histories.sc[i] = BranchHistory::Folded(
+          sc_history_lengths[i], misc::LogBase2(sc_size));
+}
+
+unsigned Tage::getRandom() {
+  // Linear congruential generator, deterministic across runs
+  random_seed = random_seed * 1103515245 + 12345;
+  return random_seed >> 16;
+}
+
+int Tage::getMaxHistory() {
+  return std::max(max_history, sc_history_lengths[num_sc_tables - 1]);
+}
+
+void Tage::Predict(unsigned eip, const FoldedHistories& folded_histories,
+                   Info& info) const {
+  // Base predictor
+  info.valid = true;
+  info.base_index = eip & (base_size - 1);
+  bool base_prediction = base[info.base_index] > 1;
+
+  // Compute indexes and tags. The path history is mixed into the index
+  // of tables with histories of up to 16 branches.
+  int log_table_size = misc::LogBase2(table_size);
+  for (int i = 0; i < num_tables; i++) {
+    unsigned path_hash =
+        folded_histories.path & ((1u << std::min(history_lengths[i], 16)) - 1);
+    path_hash ^= path_hash >> (log_table_size - i % log_table_size);
+    info.indexes[i] = (eip ^ (eip >> (log_table_size - i % log_table_size)) ^
+                       folded_histories.indexes[i].getValue() ^ path_hash) &
+                      (table_size - 1);
+    info.tags[i] = (eip ^ folded_histories.tags[i][0].getValue() ^
+                    (folded_histories.tags[i][1].getValue() << 1)) &
+                   ((1u << tag_bits) - 1);
+  }
+
+  // Find the provider, the table with the longest history that hits, and
+  // the alternate table with the next longest history.
+  info.provider = -1;
+  info.alt_provider = -1;
+  for (int i = num_tables - 1; i >= 0; i--) {
+    if (tables[i * table_size + info.indexes[i]].tag != info.tags[i]) continue;
+    if (info.provider < 0)
+      info.provider = i;
+    else {
+      info.alt_provider = i;
+      break;
+    }
+  }
+
+  // Alternate prediction
+  int alt_counter = 0;
+  if (info.alt_provider >= 0) {
+    alt_counter =
+        tables[info.alt_provider * table_size +
+               info.indexes[info.alt_provider]].counter;
+    info.alt_prediction = alt_counter >= 0;
+  } else {
+    info.alt_prediction = base_prediction;
+  }
+
+  // TAGE prediction. Newly allocated entries with weak counters are
+  // often wrong, so the alternate prediction is used instead if that has
+  // proven to be better.
+  if (info.provider >= 0) {
+    int counter =
+        tables[info.provider * table_size + info.indexes[info.provider]]
+            .counter;
+    info.provider_prediction = counter >= 0;
+    info.weak = counter == 0 || counter == -1;
+    info.tage_prediction = info.weak && use_alt_on_weak >= 0
+                               ? info.alt_prediction
+                               : info.provider_prediction;
+    info.confidence = 2 * counter + 1;
+  } else {
+    info.provider_prediction = base_prediction;
+    info.weak = false;
+    info.tage_prediction = base_prediction;
+    info.confidence = 2 * (base[info.base_index] - 2) + 1;
+  }
+  if (info.tage_prediction != (info.confidence >= 0))
+    info.confidence = -info.confidence;
+  info.prediction = info.tage_prediction;
+
+  // Statistical corrector. The sum of its counters is added to the TAGE
+  // confidence, so it only reverts predictions with low confidence.
+  info.sc_sum = 0;
+  if (sc_size) {
+    int log_sc_size = misc::LogBase2(sc_size);
+    for (int i = 0; i < num_sc_tables; i++) {
+      info.sc_indexes[i] =
+          i ? (eip ^ (eip >> (log_sc_size - i)) ^
+               folded_histories.sc[i].getValue()) &
+                  (sc_size - 1)
+            : ((eip << 1) | info.tage_prediction) & (sc_size - 1);
+      info.sc_sum += 2 * sc[i * sc_size + info.sc_indexes[i]] + 1;
+    }
+    info.sc_prediction = info.sc_sum + info.confidence * sc_tage_weight >= 0;
+    info.prediction = info.sc_prediction;
+  }
+
+  // Loop predictor, overriding everything else when it is confident
+  info.loop_hit = false;
+  info.loop_valid = false;
+  if (loop_size) {
+    int log_loop_size = misc::LogBase2(loop_size);
+    info.loop_index = (eip ^ (eip >> log_loop_size)) & (loop_size - 1);
+    LoopEntry& entry = loops[info.loop_index];
+    if (entry.age && entry.tag == ((eip >> log_loop_size) & 0x3fff)) {
+      info.loop_hit = true;
+      info.loop_valid = entry.confidence == 3;
+      info.loop_prediction =
+          entry.current_iteration + 1 == entry.past_iteration
+              ? !entry.direction
+              : entry.direction;
+      if (info.loop_valid) info.prediction = info.loop_prediction;
+    }
+  }
+}
+
+bool Tage::Lookup(unsigned eip, Info& info) const {
+  Predict(eip, folded_histories, info);
+  return info.prediction;
+}
+
+int Tage::LookupMultiple(unsigned eip, int count,
+                         const BranchHistory& history) const {
+  // Work on a copy of the folded histories, where predictions are shifted
+  // in as they are made.
+  FoldedHistories speculative_histories = folded_histories;
+  unsigned predictions = 0;
+  for (int i = 0; i < count; i++) {
+    // Predict
+    Info info;
+    Predict(eip, speculative_histories, info);
+    predictions |= (unsigned)info.prediction << i;
+
+    // Shift prediction into histories
+    auto update = [&](BranchHistory::Folded& folded) {
+      folded.Update(info.prediction,
+                    history.getOutcome(folded.getLength(), predictions, i + 1));
+    };
+    for (int j = 0; j < num_tables; j++) {
+      update(speculative_histories.indexes[j]);
+      update(speculative_histories.tags[j][0]);
+      update(speculative_histories.tags[j][1]);
+    }
+    for (int j = 0; j < num_sc_tables; j++)
+      update(speculative_histories.sc[j]);
+    speculative_histories.path =
+        ((speculative_histories.path << 1) | ((eip ^ (eip >> 2)) & 1)) &
+        0xffff;
+  }
+
+  // Return
+  return predictions;
+}
+
+void Tage::UpdateLoop(const Info& info, unsigned eip, bool taken) {
+  // Entry hit at lookup time. Ignore it if it was replaced since then.
+  unsigned tag = (eip >> misc::LogBase2(loop_size)) & 0x3fff;
+  LoopEntry& entry = loops[info.loop_index];
+  if (info.loop_hit) {
+    if (!entry.age || entry.tag != tag) return;
+
+    // A confident entry that mispredicts is freed
+    if (info.loop_valid && info.loop_prediction != taken) {
+      entry = LoopEntry();
+      return;
+    }
+
+    // Entries that fix TAGE mispredictions become harder to replace
+    if (info.loop_valid && info.loop_prediction != info.tage_prediction)
+      UpdateCounter(entry.age, true, 0, 255);
+
+    // Count iteration, giving up on too long loops
+    entry.current_iteration++;
+    if (entry.current_iteration > 1023) {
+      entry = LoopEntry();
+      return;
+    }
+
+    // Loop exit. Confidence grows while the loop keeps running for the
+    // same number of iterations.
+    if (taken != entry.direction) {
+      if (entry.current_iteration == entry.past_iteration) {
+        UpdateCounter(entry.confidence, true, 0, 3);
+      } else {
+        entry.past_iteration = entry.current_iteration;
+        entry.confidence = 0;
+      }
+      entry.current_iteration = 0;
+    }
+    return;
+  }
+
+  // Allocate an entry when TAGE mispredicts, assuming that the branch is
+  // exiting a loop. Entries in use age until they can be replaced.
+  if (info.tage_prediction == taken) return;
+  if (entry.age) {
+    entry.age--;
+    return;
+  }
+  if (getRandom() & 3) return;
+  entry = LoopEntry();
+  entry.tag = tag;
+  entry.direction = !taken;
+  entry.age = 7;
+}
+
+void Tage::Update(const Info& info, unsigned eip, bool taken) {
+  // Stats
+  assert(info.valid);
+  if (info.tage_prediction != taken) num_tage_mispredictions++;
+  if (info.loop_valid) {
+    num_loop_predictions++;
+    if (info.loop_prediction != taken) num_loop_mispredictions++;
+  }
+  if (sc_size && !info.loop_valid &&
+      info.sc_prediction != info.tage_prediction) {
+    num_sc_overrides++;
+    if (info.sc_prediction != taken) num_sc_override_mispredictions++;
+  }
+
+  // Loop predictor
+  if (loop_size) UpdateLoop(info, eip, taken);
+
+  // Statistical corrector, trained on mispredictions and on low
+  // confidence sums
+  if (sc_size) {
+    int sum = info.sc_sum + info.confidence * sc_tage_weight;
+    if (info.sc_prediction != taken || std::abs(sum) < sc_threshold)
+      for (int i = 0; i < num_sc_tables; i++)
+        UpdateCounter(sc[i * sc_size + info.sc_indexes[i]], taken, -32, 31);
+  }
+
+  // On a TAGE misprediction, allocate an entry in a table with a longer
+  // history than the provider. The first candidate table is randomized
+  // to spread allocations. If no entry is free, make the candidates
+  // more likely to be replaced next time.
+  if (info.tage_prediction != taken && info.provider < num_tables - 1) {
+    int first = info.provider + 1;
+    if (first < num_tables - 1 && (getRandom() & 1)) first++;
+    bool allocated = false;
+    for (int i = first; i < num_tables && !allocated; i++) {
+      Entry& entry = tables[i * table_size + info.indexes[i]];
+      if (entry.useful) continue;
+      entry.tag = info.tags[i];
+      entry.counter = taken ? 0 : -1;
+      allocated = true;
+    }
+    if (!allocated)
+      for (int i = info.provider + 1; i < num_tables; i++)
+        UpdateCounter(tables[i * table_size + info.indexes[i]].useful, false,
+                      0, 3);
+  }
+
+  // Update provider, unless the entry was replaced since the lookup
+  if (info.provider >= 0) {
+    Entry& entry =
+        tables[info.provider * table_size + info.indexes[info.provider]];
+    if (entry.tag == info.tags[info.provider]) {
+      // Learn whether new entries are worse than the alternate prediction
+      if (info.weak && info.provider_prediction != info.alt_prediction)
+        UpdateCounter(use_alt_on_weak, info.alt_prediction == taken, -8, 7);
+
+      // The alternate prediction is trained while the provider has not
+      // proven useful yet
+      if (!entry.useful) {
+        if (info.alt_provider >= 0) {
+          Entry& alt_entry = tables[info.alt_provider * table_size +
+                                    info.indexes[info.alt_provider]];
+          if (alt_entry.tag == info.tags[info.alt_provider])
+            UpdateCounter(alt_entry.counter, taken, -4, 3);
+        } else {
+          int counter = base[info.base_index];
+          UpdateCounter(counter, taken, 0, 3);
+          base[info.base_index] = counter;
+        }
+      }
+
+      // Prediction and useful counters
+      UpdateCounter(entry.counter, taken, -4, 3);
+      if (info.provider_prediction != info.alt_prediction)
+        UpdateCounter(entry.useful, info.provider_prediction == taken, 0, 3);
+    }
+  } else {
+    int counter = base[info.base_index];
+    UpdateCounter(counter, taken, 0, 3);
+    base[info.base_index] = counter;
+  }
+
+  // Age useful counters periodically, so that stale entries can be
+  // replaced
+  num_updates++;
+  if (num_updates % useful_reset_period == 0)
+    for (int i = 0; i < num_tables * table_size; i++) tables[i].useful >>= 1;
+}
+
+void Tage::UpdateHistory(const BranchHistory& history) {
+  for (int i = 0; i < num_tables; i++) {
+    history.Update(folded_histories.indexes[i]);
+    history.Update(folded_histories.tags[i][0]);
+    history.Update(folded_histories.tags[i][1]);
+  }
+  for (int i = 0; i < num_sc_tables; i++) history.Update(folded_histories.sc[i]);
+  folded_histories.path = history.getPath();
+}
+
+void Tage::DumpReport(std::ostream& os, long long num_instructions) const {
+  // Mispredictions of TAGE alone, before side predictors are applied
+  os << misc::fmt("BranchPredictor.TAGE.Mispred = %lld\n",
+                  num_tage_mispredictions);
+  os << misc::fmt("BranchPredictor.TAGE.MPKI = %.4g\n",
+                  num_instructions
+                      ? 1000.0 * num_tage_mispredictions / num_instructions
+                      : 0.0);
+
+  // Loop predictor
+  if (loop_size) {
+    os << misc::fmt("BranchPredictor.Loop.Predictions = %lld\n",
+                    num_loop_predictions);
+    os << misc::fmt("BranchPredictor.Loop.Mispred = %lld\n",
+                    num_loop_mispredictions);
+  }
+
+  // Statistical corrector
+  if (sc_size) {
+    os << misc::fmt("BranchPredictor.SC.Overrides = %lld\n",
+                    num_sc_overrides);
+    os << misc::fmt("BranchPredictor.SC.Mispred = %lld\n",
+                    num_sc_override_mispredictions);
+  }
+}
+
+}  // namespace x86
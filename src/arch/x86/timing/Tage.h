@@ -0,0 +1,270 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef ARCH_X86_TIMING_TAGE_H
+#define ARCH_X86_TIMING_TAGE_H
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <lib/cpp/IniFile.h>
+
+#include "BranchHistory.h"
+
+namespace x86 {
+
+/// TAGE-SC-L conditional branch direction predictor. A bimodal base
+/// predictor is backed by a set of partially tagged tables indexed with
+/// global histories of geometrically increasing lengths. The longest
+/// matching history provides the prediction. Two side predictors can
+/// override it:
+///
+///   - A loop predictor, which learns the trip count of regular loops
+///     and takes over once it is confident about it.
+///
+///   - A statistical corrector, a small sum of counters indexed by the
+///     address and short histories, which reverts TAGE predictions that
+///     are statistically biased the other way.
+///
+/// Both side predictors can be disabled by setting their size to 0.
+class Tage {
+ public:
+  /// Maximum number of tagged tables
+  static const int max_tables = 16;
+
+  /// Number of tables of the statistical corrector. The first one is
+  /// indexed by the address and the TAGE prediction, and the rest by the
+  /// address and a short global history.
+  static const int num_sc_tables = 4;
+
+  /// Information about a prediction, kept in the uop until the branch
+  /// commits and the predictor is updated.
+  struct Info {
+    // True if the fields have been initialized by a lookup
+    bool valid = false;
+
+    // Base predictor index
+    int base_index = 0;
+
+    // Index and tag of each tagged table
+    int indexes[max_tables] = {};
+    unsigned tags[max_tables] = {};
+
+    // Table providing the prediction and alternate table, or -1 for the
+    // base predictor
+    int provider = -1;
+    int alt_provider = -1;
+
+    // Predictions of the provider and alternate tables
+    bool provider_prediction = false;
+    bool alt_prediction = false;
+
+    // True if the provider entry had a weak counter
+    bool weak = false;
+
+    // Confidence of the TAGE prediction, as a signed centered value
+    int confidence = 0;
+
+    // Final TAGE prediction
+    bool tage_prediction = false;
+
+    // Loop predictor entry, and whether it hit and was confident
+    int loop_index = 0;
+    bool loop_hit = false;
+    bool loop_valid = false;
+    bool loop_prediction = false;
+
+    // Statistical corrector indexes, sum, and prediction
+    int sc_indexes[num_sc_tables] = {};
+    int sc_sum = 0;
+    bool sc_prediction = false;
+
+    // Final prediction
+    bool prediction = false;
+  };
+
+ private:
+  //
+  // Configuration
+  //
+
+  // Number of tagged tables
+  static int num_tables;
+
+  // Number of entries of each tagged table
+  static int table_size;
+
+  // Number of bits of the tags
+  static int tag_bits;
+
+  // Shortest and longest history lengths
+  static int min_history;
+  static int max_history;
+
+  // Number of entries of the base bimodal predictor
+  static int base_size;
+
+  // Number of entries of the loop predictor
+  static int loop_size;
+
+  // Number of entries of each statistical corrector table
+  static int sc_size;
+
+  // History length used by each tagged table
+  static int history_lengths[max_tables];
+
+  //
+  // Tables
+  //
+
+  // Entry of a tagged table
+  struct Entry {
+    // Partial tag
+    unsigned tag = 0;
+
+    // Signed 3-bit prediction counter
+    int counter = 0;
+
+    // 2-bit useful counter
+    int useful = 0;
+  };
+
+  // Entry of the loop predictor
+  struct LoopEntry {
+    // Partial tag
+    unsigned tag = 0;
+
+    // Iterations in the current and the last complete executions
+    int current_iteration = 0;
+    int past_iteration = 0;
+
+    // Confidence on the number of iterations
+    int confidence = 0;
+
+    // Replacement age
+    int age = 0;
+
+    // Direction taken while iterating
+    bool direction = false;
+  };
+
+  // Folded histories used to compute indexes and tags
+  struct FoldedHistories {
+    BranchHistory::Folded indexes[max_tables];
+    BranchHistory::Folded tags[max_tables][2];
+    BranchHistory::Folded sc[num_sc_tables];
+
+    // Path history
+    unsigned path = 0;
+  };
+
+  // Tagged tables, with 'num_tables' * 'table_size' entries
+  std::unique_ptr<Entry[]> tables;
+
+  // Base predictor, 2-bit counters
+  std::unique_ptr<char[]> base;
+
+  // Loop predictor
+  std::unique_ptr<LoopEntry[]> loops;
+
+  // Statistical corrector, signed 6-bit counters
+  std::unique_ptr<int[]> sc;
+
+  // Folded histories
+  FoldedHistories folded_histories;
+
+  // Signed 4-bit counter deciding whether to trust newly allocated
+  // entries or the alternate prediction
+  int use_alt_on_weak = 0;
+
+  // Number of updates, used to age useful counters periodically
+  long long num_updates = 0;
+
+  // Pseudo-random number generator state for allocation decisions
+  unsigned random_seed = 1;
+
+  // Return the next pseudo-random number
+  unsigned getRandom();
+
+  // Compute a prediction using the given folded histories
+  void Predict(unsigned eip, const FoldedHistories& folded_histories,
+               Info& info) const;
+
+  // Update the loop predictor
+  void UpdateLoop(const Info& info, unsigned eip, bool taken);
+
+  // Stats
+  long long num_tage_mispredictions = 0;
+  long long num_loop_predictions = 0;
+  long long num_loop_mispredictions = 0;
+  long long num_sc_overrides = 0;
+  long long num_sc_override_mispredictions = 0;
+
+ public:
+  /// Read the configuration from section \a section of an INI file
+  static void ParseConfiguration(misc::IniFile* ini_file,
+                                 const std::string& section);
+
+  /// Dump configuration
+  static void DumpConfiguration(std::ostream& os);
+
+  /// Return the number of storage bits needed by the predictor
+  static long long getStorageBits();
+
+  /// Return the longest history length used
+  static int getMaxHistory();
+
+  /// Return the number of tagged tables
+  static int getNumTables() { return num_tables; }
+
+  /// Return the history length used by tagged table \a table
+  static int getHistoryLength(int table) { return history_lengths[table]; }
+
+  /// Constructor
+  Tage();
+
+  /// Predict the direction of the conditional branch at address \a eip,
+  /// and record in \a info the information needed to update the
+  /// predictor later.
+  bool Lookup(unsigned eip, Info& info) const;
+
+  /// Predict the direction of \a count consecutive branches, assuming
+  /// that all of them are at address \a eip, and that each prediction is
+  /// shifted into the global history before making the next one. The
+  /// prediction of the first branch is returned in bit 0.
+  int LookupMultiple(unsigned eip, int count,
+                     const BranchHistory& history) const;
+
+  /// Update the predictor with the outcome of a branch committed after a
+  /// lookup that filled \a info.
+  void Update(const Info& info, unsigned eip, bool taken);
+
+  /// Update the folded histories after a new outcome was shifted into
+  /// the global history.
+  void UpdateHistory(const BranchHistory& history);
+
+  /// Dump statistics
+  void DumpReport(std::ostream& os, long long num_instructions) const;
+};
+
+}  // namespace x86
+
+#endif
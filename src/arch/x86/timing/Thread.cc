@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include "Thread.h"
 #include "Cpu.h"
 #include "Timing.h"
@@ -64,6 +66,11 @@ Thread::Thread(Core* core, int id_in_core)
 
   // Initialize register file
   register_file = misc::new_unique<RegisterFile>(this);
+
+  // Initialize store set predictor
+  if (Cpu::getMemoryDependenceKind() == Cpu::MemoryDependenceKindStoreSets)
+    store_sets = misc::new_unique<StoreSets>(
+        Cpu::getStoreSetsSize(), Cpu::getStoreSetsClearInterval());
 }
 
 void Thread::Dump(std::ostream& os) const {
@@ -267,7 +274,7 @@ void Thread::ExtractFromReorderBuffer(Uop* uop) {
 
 void Thread::DumpReorderBuffer(std::ostream& os) const {
   // Current cycle
-  long long cycle = cpu->getCycle();
+  long long cycle = core->getCycle();
 
   // Title
   std::string title = "Reorder buffer";
@@ -481,6 +488,59 @@ void Thread::ExtractFromStoreQueue(Uop* uop) {
   core->decLoadStoreQueueOccupancy();
 }
 
+bool Thread::SearchStoreQueue(Uop* load, Uop*& forwarding_store,
+                              Uop*& violating_store) {
+  // Bytes read by the load
+  unsigned load_begin = load->physical_address;
+  unsigned load_end = load_begin + std::max(load->getUinst()->getSize(), 1);
+
+  // Traverse stores from youngest to oldest
+  forwarding_store = nullptr;
+  violating_store = nullptr;
+  int load_set = store_sets ? store_sets->getSet(load->eip) : -1;
+  for (auto it = store_queue.rbegin(); it != store_queue.rend(); ++it) {
+    // Skip stores younger than the load
+    Uop* store = it->get();
+    if (store->getId() > load->getId()) continue;
+
+    // Bytes written by the store
+    unsigned store_begin = store->physical_address;
+    unsigned store_end =
+        store_begin + std::max(store->getUinst()->getSize(), 1);
+    bool overlap = load_begin < store_end && store_begin < load_end;
+
+    // The address of a store is known once its input operands are ready.
+    // Committed stores always have their operands ready.
+    if (store->in_reorder_buffer && !register_file->isUopReady(store)) {
+      // The load waits for all older stores in conservative mode, and
+      // for older stores of its store set with the store set predictor.
+      if (Cpu::getMemoryDependenceKind() ==
+          Cpu::MemoryDependenceKindConservative)
+        return false;
+      if (load_set >= 0 && store_sets->getSet(store->eip) == load_set)
+        return false;
+
+      // The load issues speculatively. If the store writes any of the
+      // data, a memory-ordering violation will be detected.
+      if (overlap && !violating_store) violating_store = store;
+      continue;
+    }
+
+    // Youngest older store writing any data read by the load. If the
+    // store provides all data, it can be forwarded. Otherwise, the load
+    // waits until the store writes the data cache.
+    if (!overlap) continue;
+    if (!Cpu::getStoreForwarding() || store_begin > load_begin ||
+        store_end < load_end)
+      return false;
+    forwarding_store = store;
+    break;
+  }
+
+  // The load can issue
+  return true;
+}
+
 void Thread::DumpLoadStoreQueue(std::ostream& os) const {
   // Load queue
   std::string title = "Load queue";
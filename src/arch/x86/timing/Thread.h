@@ -29,6 +29,7 @@
 
 #include "BranchPredictor.h"
 #include "RegisterFile.h"
+#include "StoreSets.h"
 #include "TraceCache.h"
 #include "Uop.h"
 
@@ -173,6 +174,17 @@ class Thread {
   // in said queue.
   void ExtractFromStoreQueue(Uop* uop);
 
+  // Search the store queue for stores older than the given load. The
+  // function returns false if the load cannot issue yet, either because
+  // an older store it depends on has an unknown address, or because it
+  // reads data partially written by an older store. Otherwise, argument
+  // 'forwarding_store' is set to the youngest older store providing all
+  // data read by the load, if any, and 'violating_store' to the youngest
+  // older store with an unknown address that writes the same data, if
+  // any.
+  bool SearchStoreQueue(Uop* load, Uop*& forwarding_store,
+                        Uop*& violating_store);
+
   // Dump content of load_store queue
   void DumpLoadStoreQueue(std::ostream& os = std::cout) const;
 
@@ -186,6 +198,9 @@ class Thread {
   // Trace cache
   std::unique_ptr<TraceCache> trace_cache;
 
+  // Store set memory dependence predictor
+  std::unique_ptr<StoreSets> store_sets;
+
   // Physical register file
   std::unique_ptr<RegisterFile> register_file;
 
@@ -247,6 +262,9 @@ class Thread {
   // Number of committed micro-instructions
   long long num_committed_uinsts = 0;
 
+  // Number of committed x86 instructions
+  long long num_committed_instructions = 0;
+
   // Number of dispatched micro-instructions for every opcode
   long long num_dispatched_uinst_array[Uinst::OpcodeCount] = {};
 
@@ -290,6 +308,12 @@ class Thread {
   long long num_btb_reads = 0;
   long long num_btb_writes = 0;
 
+  // Number of committed loads forwarded from the store queue
+  long long num_forwarded_loads = 0;
+
+  // Number of loads replayed due to memory-ordering violations
+  long long num_memory_violations = 0;
+
  public:
   /// Constructor
   Thread(Core* core, int id_in_core);
@@ -325,6 +349,11 @@ class Thread {
   // Register file
   //
 
+  /// Return the thread's branch predictor
+  BranchPredictor* getBranchPredictor() const {
+    return branch_predictor.get();
+  }
+
   /// Return the thread's trace cache
   TraceCache* getTraceCache() const { return trace_cache.get(); }
 
@@ -465,6 +494,12 @@ class Thread {
   /// The function returns the remaining quantum.
   int IssueInstructionQueue(int quantum);
 
+  /// Replay a load that completed after reading stale data, because it
+  /// issued before an older store to the same address. The load returns
+  /// to the load queue, and the store set predictor learns the
+  /// dependence.
+  void ReplayLoad(std::shared_ptr<Uop> uop);
+
   //
   // Commit stage (ThreadCommit.cc)
   //
@@ -582,6 +617,11 @@ class Thread {
   /// Return the number of committed micro-instructions
   long long getNumCommittedUinsts() const { return num_committed_uinsts; }
 
+  /// Return the number of committed x86 instructions
+  long long getNumCommittedInstructions() const {
+    return num_committed_instructions;
+  }
+
   /// Return the number of squashed micro-instructions
   long long getNumSquashedUinsts() const { return num_squashed_uinsts; }
 
@@ -655,6 +695,12 @@ class Thread {
   /// Return the number of writes to the BTB
   long long getNumBtbWrites() const { return num_btb_writes; }
 
+  /// Return the number of committed loads forwarded from the store queue
+  long long getNumForwardedLoads() const { return num_forwarded_loads; }
+
+  /// Return the number of loads replayed due to memory-ordering violations
+  long long getNumMemoryViolations() const { return num_memory_violations; }
+
   //
   // Public fields
   //
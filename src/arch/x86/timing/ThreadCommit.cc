@@ -31,14 +31,15 @@ const char* Thread::commit_stall_error =
 
 bool Thread::canCommit() {
   // Get current cycle
-  long long cycle = cpu->getCycle();
+  long long cycle = core->getCycle();
 
   // Sanity check - If the context is running, we assume that something is
   // going wrong if more than 1M cycles go by without committing a uop.
   if (!context || !context->getState(Context::StateRunning))
     last_commit_cycle = cycle;
   if (cycle - last_commit_cycle > 1000000) {
-    // Show warning
+    // Show warning. Simulation control is shared among cores.
+    Cpu::SharedLock lock(cpu);
     misc::Warning(
         "[x86] %s: simulation ended due to a commit "
         "stall.\n\t%s",
@@ -111,29 +112,29 @@ void Thread::Commit(int quantum) {
     if (TraceCache::isPresent()) trace_cache->RecordUop(uop.get());
 
     // Save last commit cycle
-    last_commit_cycle = cpu->getCycle();
+    last_commit_cycle = core->getCycle();
 
     // Record committed uops of each kind
     incNumCommittedUinsts(uop->getOpcode());
     core->incNumCommittedUinsts(uop->getOpcode());
-    cpu->incNumCommittedUinsts(uop->getOpcode());
-    if (!uop->mop_index) cpu->incNumCommittedInstructions();
+    if (!uop->mop_index) num_committed_instructions++;
 
     // Trace cache statistics
     if (uop->from_trace_cache) trace_cache->incNumCommittedUinsts();
 
+    // Loads that got their data from the store queue
+    if (uop->forwarded) num_forwarded_loads++;
+
     // Statistics for branch instructions
     if (uop->getFlags() & Uinst::FlagCtrl) {
       // Number of branches
       num_branches++;
       core->incNumBranches();
-      cpu->incNumBranches();
 
       // Mispredicted branches
       if (uop->neip != uop->predicted_neip) {
         num_mispredicted_branches++;
         core->incNumMispredictedBranches();
-        cpu->incNumMispredictedBranches();
       }
     }
 
@@ -77,7 +77,7 @@ int Thread::Dispatch(int quantum) {
 
     // Mark instruction as dispatched
     uop->dispatched = true;
-    uop->dispatch_when = cpu->getCycle();
+    uop->dispatch_when = core->getCycle();
 
     // Insert non-memory instruction into instruction queue
     if (!(uop->getFlags() & Uinst::FlagMem)) {
@@ -102,7 +102,6 @@ int Thread::Dispatch(int quantum) {
     // kind
     incNumDispatchedUinsts(uop->getOpcode());
     core->incNumDispatchedUinsts(uop->getOpcode());
-    cpu->incNumDispatchedUinsts(uop->getOpcode());
 
     // Increment number of dispatched micro-instructions coming from
     // the trace cache
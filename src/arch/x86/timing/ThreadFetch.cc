@@ -28,11 +28,13 @@ Thread::FetchStall Thread::canFetch() {
   // There must be a context mapped to this thread
   if (!context) return FetchStallContext;
 
-  // The context must be running
-  if (!context->getState(Context::StateRunning)) return FetchStallSuspended;
-
-  // The current context must not have been sent an eviction signal
-  if (context->evict_signal) return FetchStallContext;
+  // The context must be running, and it must not have been sent an
+  // eviction signal. Other cores change both under the shared lock.
+  {
+    Cpu::SharedLock lock(cpu);
+    if (!context->getState(Context::StateRunning)) return FetchStallSuspended;
+    if (context->evict_signal) return FetchStallContext;
+  }
 
   // Fetch queue must have not exceeded the limit of stored bytes to be
   // able to store new macro-instructions.
@@ -44,10 +46,14 @@ Thread::FetchStall Thread::canFetch() {
   unsigned block_address =
       fetch_neip & ~(instruction_module->getBlockSize() - 1);
   if (block_address != fetch_block_address) {
-    mem::Mmu* mmu = context->getMmu();
-    mem::Mmu::Space* mmu_space = context->getMmuSpace();
-    unsigned physical_address =
-        mmu->TranslateVirtualAddress(mmu_space, fetch_neip);
+    unsigned physical_address;
+    {
+      // The MMU is shared among cores
+      Cpu::SharedLock lock(cpu);
+      mem::Mmu* mmu = context->getMmu();
+      mem::Mmu::Space* mmu_space = context->getMmuSpace();
+      physical_address = mmu->TranslateVirtualAddress(mmu_space, fetch_neip);
+    }
     if (!instruction_module->canAccess(physical_address))
       return FetchStallInstructionMemory;
   }
@@ -63,17 +69,25 @@ Uop* Thread::FetchInstruction(bool fetch_from_trace_cache) {
   // Advance current fetch instruction pointer
   fetch_eip = fetch_neip;
 
-  // Record previous speculative mode
-  bool previous_speculative_mode = context->getState(Context::StateSpecMode);
+  // Emulate the instruction. Only contexts sharing state with others hold
+  // the shared lock, while the rest take it in system calls alone.
+  bool previous_speculative_mode;
+  bool speculative_mode;
+  {
+    Cpu::SharedLock lock(cpu, context->isSharingEmulatorState());
+
+    // Record previous speculative mode
+    previous_speculative_mode = context->getState(Context::StateSpecMode);
 
-  // Force it in the emulator, entering speculative mode if necessary
-  context->setEip(fetch_eip);
+    // Force it in the emulator, entering speculative mode if necessary
+    context->setEip(fetch_eip);
 
-  // Record new speculative mode
-  bool speculative_mode = context->getState(Context::StateSpecMode);
+    // Record new speculative mode
+    speculative_mode = context->getState(Context::StateSpecMode);
 
-  // Run emulation
-  context->Execute();
+    // Run emulation
+    context->Execute();
+  }
 
   // Set next fetch instruction pointer to the next instruction
   fetch_neip = fetch_eip + context->getInstruction()->getSize();
@@ -89,6 +103,7 @@ Uop* Thread::FetchInstruction(bool fetch_from_trace_cache) {
   // Traverse micro-instructions created by the x86 emulator
   int num_uinsts = context->getNumUinsts();
   int uinst_index = 0;
+  long long mop_id = 0;
   Uop* ret_uop = nullptr;
   while (context->getNumUinsts()) {
     // Get micro-instruction from head of list
@@ -97,10 +112,13 @@ Uop* Thread::FetchInstruction(bool fetch_from_trace_cache) {
     // Create uop
     auto uop = misc::new_shared<Uop>(this, context, uinst);
 
-    // Populate macro-instruction information
+    // Populate macro-instruction information. Other cores create uops
+    // concurrently, so the macro-instruction takes the identifier of its
+    // first uop.
+    if (!uinst_index) mop_id = uop->getId();
     uop->mop_count = num_uinsts;
     uop->mop_size = context->getInstruction()->getSize();
-    uop->mop_id = uop->getId() - uinst_index;
+    uop->mop_id = mop_id;
     uop->mop_index = uinst_index;
 
     // Other fields
@@ -117,8 +135,10 @@ Uop* Thread::FetchInstruction(bool fetch_from_trace_cache) {
     uop->first_speculative_mode =
         uinst_index == 0 && !previous_speculative_mode && speculative_mode;
 
-    // Calculate physical address of a memory access
+    // Calculate physical address of a memory access. The MMU is shared
+    // among cores.
     if (uop->getFlags() & Uinst::FlagMem) {
+      Cpu::SharedLock lock(cpu);
       mem::Mmu* mmu = context->getMmu();
       mem::Mmu::Space* mmu_space = context->getMmuSpace();
       uop->physical_address =
@@ -158,7 +178,6 @@ Uop* Thread::FetchInstruction(bool fetch_from_trace_cache) {
     InsertInFetchQueue(uop);
 
     // Stats
-    cpu->incNumFetchedUinsts();
     num_fetched_uinsts++;
     if (fetch_from_trace_cache) trace_cache->incNumFetchedUinsts();
 
@@ -190,7 +209,12 @@ bool Thread::FetchFromTraceCache() {
   // Fetch instruction in trace cache line.
   for (int i = 0; i < entry->getNumMacroInstructions(); i++) {
     // If instruction caused context to suspend or finish
-    if (!context->getState(Context::StateRunning)) break;
+    bool running;
+    {
+      Cpu::SharedLock lock(cpu);
+      running = context->getState(Context::StateRunning);
+    }
+    if (!running) break;
 
     // Insert decoded uops into the trace cache queue. In the
     // simulation, the uop is inserted into the fetch queue, but its
@@ -228,11 +252,14 @@ void Thread::Fetch() {
   unsigned block_address =
       fetch_neip & ~(instruction_module->getBlockSize() - 1);
   if (block_address != fetch_block_address) {
-    // Translate address
-    mem::Mmu* mmu = context->getMmu();
-    mem::Mmu::Space* mmu_space = context->getMmuSpace();
-    unsigned physical_address =
-        mmu->TranslateVirtualAddress(mmu_space, fetch_neip);
+    // Translate address. The MMU is shared among cores.
+    unsigned physical_address;
+    {
+      Cpu::SharedLock lock(cpu);
+      mem::Mmu* mmu = context->getMmu();
+      mem::Mmu::Space* mmu_space = context->getMmuSpace();
+      physical_address = mmu->TranslateVirtualAddress(mmu_space, fetch_neip);
+    }
 
     // Save last fetched block
     fetch_block_address = block_address;
@@ -240,8 +267,7 @@ void Thread::Fetch() {
 
     // Access instruction cache
     assert(instruction_module->canAccess(physical_address));
-    fetch_access =
-        instruction_module->Access(mem::Module::AccessLoad, physical_address);
+    fetch_access = cpu->FetchAccess(core, instruction_module, physical_address);
 
     // Stats
     num_btb_reads++;
@@ -252,7 +278,12 @@ void Thread::Fetch() {
   while ((fetch_neip & ~(instruction_module->getBlockSize() - 1)) ==
          block_address) {
     // If instruction caused context to suspend or finish
-    if (!context->getState(Context::StateRunning)) break;
+    bool running;
+    {
+      Cpu::SharedLock lock(cpu);
+      running = context->getState(Context::StateRunning);
+    }
+    if (!running) break;
 
     // If fetch queue is full, stop fetching
     if (fetch_queue_occupancy >= Cpu::getFetchQueueSize()) break;
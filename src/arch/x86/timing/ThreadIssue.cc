@@ -26,6 +26,9 @@
 namespace x86 {
 
 int Thread::IssueLoadQueue(int quantum) {
+  // Clear store sets periodically
+  if (store_sets) store_sets->Refresh(core->getCycle());
+
   // List iterators
   auto it = load_queue.begin();
   auto e = load_queue.end();
@@ -39,24 +42,40 @@ int Thread::IssueLoadQueue(int quantum) {
     // If the uop is not ready, skip it
     if (!register_file->isUopReady(uop.get())) continue;
 
+    // Check older stores. Loads that depend on them wait, and loads
+    // reading data written by a resolved store get it forwarded.
+    Uop* forwarding_store;
+    Uop* violating_store;
+    if (!SearchStoreQueue(uop.get(), forwarding_store, violating_store))
+      continue;
+    bool forward = forwarding_store && !violating_store;
+
     // Check that memory system is accessible
-    if (!data_module->canAccess(uop->physical_address)) continue;
+    if (!forward && !data_module->canAccess(uop->physical_address)) continue;
 
     // Remove uop from load queue
     ExtractFromLoadQueue(uop.get());
 
-    // Access memory system
-    cpu->MemoryAccess(data_module, mem::Module::AccessLoad,
-                      uop->physical_address, uop);
+    // Obtain data from the store queue or the memory system. A load that
+    // bypassed an older store to the same address is replayed when it
+    // completes.
+    if (forward) {
+      uop->forwarded = true;
+      core->InsertInEventQueue(uop, Cpu::getStoreForwardLatency());
+    } else {
+      uop->memory_violation = violating_store != nullptr;
+      if (violating_store) uop->violating_store_eip = violating_store->eip;
+      cpu->MemoryAccess(data_module, mem::Module::AccessLoad,
+                        uop->physical_address, uop);
+    }
 
     // Mark uop as issued
     uop->issued = true;
-    uop->issue_when = cpu->getCycle();
+    uop->issue_when = core->getCycle();
 
     // Increment the number of issued instructions of this kind
     incNumIssuedUinsts(uop->getOpcode());
     core->incNumIssuedUinsts(uop->getOpcode());
-    cpu->incNumIssuedUinsts(uop->getOpcode());
 
     // Increment number of reads from load-store-queue
     num_load_store_queue_reads++;
@@ -121,12 +140,11 @@ int Thread::IssueStoreQueue(int quantum) {
 
     // Mark uop as issued
     uop->issued = true;
-    uop->issue_when = cpu->getCycle();
+    uop->issue_when = core->getCycle();
 
     // Increment the number of issued instructions of this kind
     incNumIssuedUinsts(uop->getOpcode());
     core->incNumIssuedUinsts(uop->getOpcode());
-    cpu->incNumIssuedUinsts(uop->getOpcode());
 
     // Increment number of reads from load-store-queue
     num_load_store_queue_reads++;
@@ -154,6 +172,24 @@ int Thread::IssueStoreQueue(int quantum) {
   return quantum;
 }
 
+void Thread::ReplayLoad(std::shared_ptr<Uop> uop) {
+  // Sanity
+  assert(uop->getOpcode() == Uinst::OpcodeLoad);
+  assert(uop->memory_violation);
+  assert(!uop->completed);
+
+  // Train store set predictor
+  if (store_sets) store_sets->Violation(uop->eip, uop->violating_store_eip);
+
+  // Return load to the load queue
+  uop->memory_violation = false;
+  uop->issued = false;
+  InsertInLoadStoreQueue(uop);
+
+  // Stats
+  num_memory_violations++;
+}
+
 int Thread::IssueLoadStoreQueue(int quantum) {
   // Give priority to loads versus stores
   quantum = IssueLoadQueue(quantum);
@@ -194,7 +230,7 @@ int Thread::IssueInstructionQueue(int quantum) {
 
     // Instruction has been issued
     uop->issued = true;
-    uop->issue_when = cpu->getCycle();
+    uop->issue_when = core->getCycle();
 
     // Schedule instruction in event queue
     assert(latency > 0);
@@ -203,7 +239,6 @@ int Thread::IssueInstructionQueue(int quantum) {
     // Increment the number of issued instructions of this kind
     incNumIssuedUinsts(uop->getOpcode());
     core->incNumIssuedUinsts(uop->getOpcode());
-    cpu->incNumIssuedUinsts(uop->getOpcode());
 
     // Increment number of reads from instruction queue
     num_instruction_queue_reads++;
@@ -164,7 +164,6 @@ void Thread::Recover() {
     // Statistics
     num_squashed_uinsts++;
     core->incNumSquashedUinsts();
-    cpu->incNumSquashedUinsts();
     if (uop->from_trace_cache) trace_cache->incNumSquashedUinsts();
 
     // Finish register renaming if uop didn't complete yet
@@ -194,7 +193,10 @@ void Thread::Recover() {
   // Check state of fetch stage and mapped context, if still any
   if (context) {
     // If we actually fetched wrong instructions, recover emulator
-    if (context->getState(Context::StateSpecMode)) context->Recover();
+    if (context->getState(Context::StateSpecMode)) {
+      Cpu::SharedLock lock(cpu);
+      context->Recover();
+    }
 
     // Set next program counter to valid address
     fetch_neip = context->getRegs().getEip();
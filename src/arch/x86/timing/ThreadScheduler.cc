@@ -180,7 +180,8 @@ void Thread::EvictContext() {
   assert(reorder_buffer.empty());
   assert(context->evict_signal);
 
-  // Update context state
+  // Update context state. The emulator is shared among cores.
+  Cpu::SharedLock lock(cpu);
   context->clearState(Context::StateAlloc);
   context->evict_cycle = cpu->getCycle();
   context->evict_signal = 0;
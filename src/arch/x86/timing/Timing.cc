@@ -84,6 +84,23 @@ const std::string Timing::help_message =
     "  RecoverPenalty = <cycles> (Default = 0)\n"
     "      Number of cycles that the fetch stage gets stalled after a branch\n"
     "      misprediction.\n"
+    "  HostThreads = <num_threads> (Default = 1)\n"
+    "      Number of host threads simulating cores in parallel. With one "
+    "host\n"
+    "      thread, simulation is deterministic. With more, cores are "
+    "assigned to host\n"
+    "      threads in a round-robin fashion, and accesses to the emulator "
+    "and the\n"
+    "      memory hierarchy are serialized in an order that may change "
+    "between runs.\n"
+    "  SyncQuantum = <cycles> (Default = 1)\n"
+    "      Number of cycles that each core is simulated between two "
+    "synchronizations\n"
+    "      of the host threads. With values larger than 1, completions of "
+    "memory\n"
+    "      accesses are seen by a core at the beginning of the next quantum. "
+    "Both\n"
+    "      options are ignored when the pipeline trace is enabled.\n"
     "  PageSize = <size> (Default = 4kB)\n"
     "      Memory page size in bytes.\n"
     "  DataCachePerfect = {t|f} (Default = False)\n"
@@ -175,6 +192,29 @@ const std::string Timing::help_message =
     "  LsqSize = <num_uops> (Default = 20)\n"
     "      Load-store queue size in number of uops (if private, per-thread LSQ "
     "size).\n"
+    "  StoreForwarding = {t|f} (Default = True)\n"
+    "      Forward data from older stores in the load-store queue to loads "
+    "reading\n"
+    "      the same bytes, without accessing the data cache.\n"
+    "  StoreForwardLatency = <cycles> (Default = 1)\n"
+    "      Latency of a load obtaining its data from an older store.\n"
+    "  MemDepKind = {Aggressive|Conservative|StoreSets} (Default = "
+    "StoreSets)\n"
+    "      Memory dependence prediction. Loads wait for all older stores with "
+    "unknown\n"
+    "      addresses (Conservative), never wait for them (Aggressive), or wait "
+    "only\n"
+    "      for those in the same store set (StoreSets). A load that reads "
+    "memory\n"
+    "      before an older store to the same address is replayed.\n"
+    "  StoreSetsSize = <entries> (Default = 1024)\n"
+    "      Number of entries in the store set identifier table, indexed by "
+    "instruction\n"
+    "      address. Must be a power of 2.\n"
+    "  StoreSetsClearInterval = <cycles> (Default = 1000000)\n"
+    "      Number of cycles after which store sets are cleared. A value of 0 "
+    "never\n"
+    "      clears them.\n"
     "  RfKind = {Private|Shared} (Default = Private)\n"
     "      Register file sharing among threads.\n"
     "  RfIntSize = <entries> (Default = 80)\n"
@@ -251,9 +291,23 @@ const std::string Timing::help_message =
     "\n"
     "Section '[ BranchPredictor ]':\n"
     "\n"
-    "  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined} (Default = "
-    "TwoLevel)\n"
-    "      Branch predictor type.\n"
+    "  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined|TAGE|"
+    "Perceptron}\n"
+    "      (Default = TwoLevel)\n"
+    "      Branch predictor type. Option 'TAGE' selects a TAGE-SC-L "
+    "predictor, with\n"
+    "      a loop predictor and a statistical corrector. Option "
+    "'Perceptron' selects\n"
+    "      a hashed perceptron predictor.\n"
+    "  Indirect = {BTB|ITTAGE} (Default = BTB)\n"
+    "      Predictor of the target of indirect jumps and calls. Option "
+    "'ITTAGE'\n"
+    "      overrides the BTB target with an ITTAGE predictor.\n"
+    "  StorageBudget = <KB> (Default = 0)\n"
+    "      Maximum storage of the BTB, RAS, and direction and indirect "
+    "predictor\n"
+    "      tables. Configurations exceeding it are rejected. Value 0 means "
+    "no limit.\n"
     "  BTB.Sets = <num_sets> (Default = 256)\n"
     "      Number of sets in the BTB.\n"
     "  BTB.Assoc = <num_ways) (Default = 4)\n"
@@ -270,6 +324,73 @@ const std::string Timing::help_message =
     "      For the two-level adaptive predictor, level 2 size.\n"
     "  TwoLevel.HistorySize = <size> (Default = 8)\n"
     "      For the two-level adaptive predictor, level 2 history size.\n"
+    "  TAGE.NumTables = <num> (Default = 7)\n"
+    "      Number of tagged tables of the TAGE predictor.\n"
+    "  TAGE.TableSize = <entries> (Default = 1024)\n"
+    "      Number of entries of each tagged table.\n"
+    "  TAGE.TagBits = <bits> (Default = 9)\n"
+    "      Number of bits of the partial tags.\n"
+    "  TAGE.MinHistory = <length> (Default = 5)\n"
+    "  TAGE.MaxHistory = <length> (Default = 130)\n"
+    "      Shortest and longest global history lengths, used by the first "
+    "and last\n"
+    "      tagged tables. Tables in between use a geometric series.\n"
+    "  TAGE.BaseSize = <entries> (Default = 4096)\n"
+    "      Number of entries of the bimodal base predictor.\n"
+    "  TAGE.LoopSize = <entries> (Default = 64)\n"
+    "      Number of entries of the loop predictor, or 0 to disable it.\n"
+    "  TAGE.SCSize = <entries> (Default = 1024)\n"
+    "      Number of entries of each table of the statistical corrector, or "
+    "0 to\n"
+    "      disable it.\n"
+    "  Perceptron.NumTables = <num> (Default = 8)\n"
+    "      Number of weight tables of the hashed perceptron, including the "
+    "bias table.\n"
+    "  Perceptron.TableSize = <entries> (Default = 1024)\n"
+    "      Number of weights of each table.\n"
+    "  Perceptron.MinHistory = <length> (Default = 3)\n"
+    "  Perceptron.MaxHistory = <length> (Default = 64)\n"
+    "      Shortest and longest global history lengths of the weight "
+    "tables.\n"
+    "  ITTAGE.NumTables = <num> (Default = 6)\n"
+    "  ITTAGE.TableSize = <entries> (Default = 512)\n"
+    "  ITTAGE.TagBits = <bits> (Default = 10)\n"
+    "  ITTAGE.MinHistory = <length> (Default = 4)\n"
+    "  ITTAGE.MaxHistory = <length> (Default = 64)\n"
+    "      Geometry of the ITTAGE indirect target predictor, as for "
+    "TAGE.\n"
+    "\n"
+    "Section '[ Sampling ]':\n"
+    "\n"
+    "  Kind = {None|Periodic|SimPoint} (Default = None)\n"
+    "      Statistical sampling of the detailed simulation. Periodic "
+    "sampling\n"
+    "      measures a short detailed window in every period of the "
+    "program and\n"
+    "      reports the CPI with its 95% confidence interval. SimPoint "
+    "sampling\n"
+    "      only simulates the intervals chosen by SimPoint, weighting "
+    "their CPIs.\n"
+    "      Between detailed windows, the program runs functionally.\n"
+    "  WarmUp = <num_inst> (Default = 20000)\n"
+    "      Number of instructions simulated in detail before each "
+    "measurement,\n"
+    "      whose statistics are not accounted for in the sample.\n"
+    "  Period = <num_inst> (Default = 10M)\n"
+    "      For periodic sampling, number of instructions between samples.\n"
+    "  Measure = <num_inst> (Default = 10000)\n"
+    "      For periodic sampling, number of measured instructions per "
+    "sample.\n"
+    "  IntervalSize = <num_inst> (Default = 100M)\n"
+    "      For SimPoint sampling, number of instructions per interval, as "
+    "used\n"
+    "      in option '--x86-bbv-interval' to generate basic block "
+    "vectors.\n"
+    "  SimPoints = <file>\n"
+    "  Weights = <file>\n"
+    "      For SimPoint sampling, files generated by SimPoint with the "
+    "selected\n"
+    "      intervals and their weights.\n"
     "\n";
 
 const char* Timing::error_fast_forward =
@@ -289,6 +410,9 @@ Timing::Timing() : comm::Timing("x86") {
   // Create CPU
   cpu = misc::new_unique<Cpu>(this);
 
+  // Sampling
+  if (Sampling::isActive()) sampling = misc::new_unique<Sampling>(cpu.get());
+
   // Create the trace header related to CPU
   trace.Header(
       misc::fmt("x86.init version=\"%d.%d\" "
@@ -317,11 +441,19 @@ bool Timing::Run() {
       emulator->getNumInstructions() < Cpu::getNumFastForwardInstructions())
     FastForward();
 
-  // Stop if maximum number of CPU instructions exceeded
+  // Sampled simulation. Functional phases between detailed windows are
+  // emulated within this call.
   esim::Engine* esim_engine = esim::Engine::getInstance();
+  if (sampling && !esim_engine->hasFinished()) sampling->Run();
+
+  // Stop if maximum number of CPU instructions exceeded. With sampling,
+  // the limit applies to the position in the dynamic instruction stream.
+  long long num_instructions =
+      sampling ? sampling->getPosition()
+               : cpu->getNumCommittedInstructions() +
+                     Cpu::getNumFastForwardInstructions();
   if (Emulator::getMaxInstructions() &&
-      cpu->getNumCommittedInstructions() >=
-          Emulator::getMaxInstructions() - Cpu::getNumFastForwardInstructions())
+      num_instructions >= Emulator::getMaxInstructions())
     esim_engine->Finish("X86MaxInstructions");
 
   // Stop if maximum number of cycles exceeded
@@ -686,6 +818,9 @@ void Timing::ParseConfiguration(misc::IniFile* ini_file) {
   // Parse ALU configuration by their sections
   Alu::ParseConfiguration(ini_file);
 
+  // Parse sampling configuration
+  Sampling::ParseConfiguration(ini_file);
+
   // Check the configuration for forbidden variables
   ini_file->Check();
 }
@@ -743,6 +878,9 @@ void Timing::DumpSummary(std::ostream& os) const {
                                      cpu->getNumBranches()
                                : 0.0;
   os << misc::fmt("BranchPredictionAccuracy = %.4g\n", branch_accuracy);
+
+  // Sampling estimates
+  if (sampling) sampling->DumpSummary(os);
 }
 
 void Timing::DumpUopReport(std::ostream& os, const long long* uop_stats,
@@ -822,6 +960,9 @@ void Timing::DumpReport() const {
                   now ? (double)getCycle() / now * 1e6 : 0.0);
   os << '\n';
 
+  // Sampling
+  if (sampling) sampling->DumpReport(os);
+
   // Dispatch stage
   os << "; Dispatch stage\n";
   DumpUopReport(os, cpu->getNumDispatchedUinstArray(), "Dispatch",
@@ -1053,6 +1194,10 @@ void Timing::DumpReport() const {
         os << misc::fmt("LSQ.Writes = %lld\n",
                         thread->getNumLoadStoreQueueWrites());
       }
+      os << misc::fmt("LSQ.Forwarded = %lld\n",
+                      thread->getNumForwardedLoads());
+      os << misc::fmt("LSQ.Violations = %lld\n",
+                      thread->getNumMemoryViolations());
 
       // Shared register file statistics
       if (RegisterFile::getKind() == RegisterFile::KindPrivate) {
@@ -1098,6 +1243,10 @@ void Timing::DumpReport() const {
       os << misc::fmt("BTB.Reads = %lld\n", thread->getNumBtbReads());
       os << misc::fmt("BTB.Writes = %lld\n", thread->getNumBtbWrites());
 
+      // Branch predictor statistics
+      thread->getBranchPredictor()->DumpReport(
+          os, thread->getNumCommittedInstructions());
+
       // Done
       os << '\n';
 
@@ -1121,6 +1270,8 @@ void Timing::DumpConfiguration(std::ofstream& os) const {
   os << misc::fmt("RecoverKind = %s\n",
                   cpu->recover_kind_map[cpu->getRecoverKind()]);
   os << misc::fmt("RecoverPenalty = %d\n", cpu->getRecoverPenalty());
+  os << misc::fmt("HostThreads = %d\n", cpu->getNumHostThreads());
+  os << misc::fmt("SyncQuantum = %d\n", cpu->getSyncQuantum());
   os << std::endl;
 
   // Pipeline
@@ -1153,6 +1304,16 @@ void Timing::DumpConfiguration(std::ofstream& os) const {
   os << misc::fmt("LsqKind = %s\n",
                   cpu->load_store_queue_kind_map[cpu->getLoadStoreQueueKind()]);
   os << misc::fmt("LsqSize = %d\n", cpu->getLoadStoreQueueSize());
+  os << misc::fmt("StoreForwarding = %s\n",
+                  cpu->getStoreForwarding() ? "True" : "False");
+  os << misc::fmt("StoreForwardLatency = %d\n",
+                  cpu->getStoreForwardLatency());
+  os << misc::fmt(
+      "MemDepKind = %s\n",
+      cpu->memory_dependence_kind_map[cpu->getMemoryDependenceKind()]);
+  os << misc::fmt("StoreSetsSize = %d\n", cpu->getStoreSetsSize());
+  os << misc::fmt("StoreSetsClearInterval = %d\n",
+                  cpu->getStoreSetsClearInterval());
   os << misc::fmt("RfKind = %s\n",
                   RegisterFile::KindMap[RegisterFile::getKind()]);
   os << misc::fmt("RfIntSize = %d\n", RegisterFile::getIntegerSize());
@@ -1190,6 +1351,18 @@ void Timing::DumpConfiguration(std::ofstream& os) const {
                   BranchPredictor::getTwoLevelL2Height());
   os << misc::fmt("TwoLevel.HistorySize = %d\n",
                   BranchPredictor::getTwoLevelHistorySize());
+  if (BranchPredictor::getKind() == BranchPredictor::KindTage)
+    Tage::DumpConfiguration(os);
+  if (BranchPredictor::getKind() == BranchPredictor::KindPerceptron)
+    Perceptron::DumpConfiguration(os);
+  os << misc::fmt(
+      "Indirect = %s\n",
+      BranchPredictor::IndirectKindMap[BranchPredictor::getIndirectKind()]);
+  if (BranchPredictor::getIndirectKind() == BranchPredictor::IndirectKindIttage)
+    Ittage::DumpConfiguration(os);
+  os << misc::fmt("StorageBudget = %d\n", BranchPredictor::getStorageBudget());
+  os << misc::fmt("StorageBytes = %lld\n",
+                  (BranchPredictor::getStorageBits() + 7) / 8);
   os << misc::fmt("\n");
 
   // End of configuration
@@ -30,6 +30,7 @@
 
 #include "BranchPredictor.h"
 #include "Cpu.h"
+#include "Sampling.h"
 #include "TraceCache.h"
 
 namespace x86 {
@@ -75,6 +76,9 @@ class Timing : public comm::Timing {
   // CPU object
   std::unique_ptr<Cpu> cpu;
 
+  // Statistical sampling state, or null if sampling is not active
+  std::unique_ptr<Sampling> sampling;
+
   // List of entry modules to the memory hierarchy
   std::vector<mem::Module*> entry_modules;
 
@@ -125,6 +129,9 @@ class Timing : public comm::Timing {
     return cpu.get();
   }
 
+  /// Return the sampling state, or null if sampling is not active
+  Sampling* getSampling() const { return sampling.get(); }
+
   /// Fast forward instructions set up by the user
   void FastForward();
 
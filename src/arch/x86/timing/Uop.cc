@@ -23,7 +23,7 @@
 
 namespace x86 {
 
-long long Uop::id_counter = 0;
+std::atomic<long long> Uop::id_counter(0);
 
 Uop::Uop(Thread* thread, Context* context, std::shared_ptr<Uinst> uinst)
     : thread(thread), context(context), uinst(uinst) {
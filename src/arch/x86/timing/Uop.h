@@ -20,7 +20,9 @@
 #ifndef ARCH_X86_TIMING_UOP_H
 #define ARCH_X86_TIMING_UOP_H
 
+#include <atomic>
 #include <deque>
+#include <memory>
 
 #include <arch/x86/emulator/Context.h>
 #include <arch/x86/emulator/Uinst.h>
@@ -40,8 +42,9 @@ class Uop {
   // Static fields
   //
 
-  // Counter used to assign unique global uop identifiers
-  static long long id_counter;
+  // Counter used to assign unique global uop identifiers. Host threads
+  // simulating different cores create uops concurrently.
+  static std::atomic<long long> id_counter;
 
   //
   // Class members
@@ -336,6 +339,19 @@ class Uop {
   // For memory uops, unique identifier of memory access
   long long memory_access = 0;
 
+  /// For loads, true if the data was forwarded from an older store in the
+  /// store queue, without accessing the data cache
+  bool forwarded = false;
+
+  /// For loads, true if the load issued before an older store to the same
+  /// address whose address was still unknown. The load is replayed when
+  /// it completes.
+  bool memory_violation = false;
+
+  /// For loads with a memory violation, address of the store instruction
+  /// that caused it
+  unsigned violating_store_eip = 0;
+
   /// Access identifier for instruction fetch
   long long fetch_access = 0;
 
@@ -380,6 +396,17 @@ class Uop {
   BranchPredictor::Prediction choice_prediction =
       BranchPredictor::PredictionNotTaken;
 
+  /// TAGE-SC-L prediction information, allocated by the branch predictor
+  /// on the first lookup of a control uop
+  std::unique_ptr<Tage::Info> tage_info;
+
+  /// Hashed perceptron prediction information, allocated on lookup
+  std::unique_ptr<Perceptron::Info> perceptron_info;
+
+  /// ITTAGE prediction information for indirect jumps and calls,
+  /// allocated on lookup
+  std::unique_ptr<Ittage::Info> ittage_info;
+
   //
   // State
   //
@@ -0,0 +1,108 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include "Checkpoint.h"
+#include "String.h"
+
+namespace misc {
+
+// Magic string found at the beginning of every checkpoint file
+static const char* checkpoint_magic = "m2s-checkpoint";
+
+const int Checkpoint::version = 1;
+
+Checkpoint::Checkpoint(const std::string& path, Mode mode)
+    : path(path), mode(mode) {
+  // Open file. Saving uses a fast compression level, since checkpoints
+  // are dominated by memory pages and are written while the simulation
+  // is stopped.
+  assert(mode == ModeSave || mode == ModeLoad);
+  gz_file = gzopen(path.c_str(), mode == ModeSave ? "wb1" : "rb");
+  if (!gz_file) throw Error(path, "Cannot open file");
+
+  // Header
+  if (mode == ModeSave) {
+    WriteString(checkpoint_magic);
+    WriteValue(version);
+  } else {
+    if (ReadString() != checkpoint_magic)
+      throw Error(path, "Not a Multi2Sim checkpoint");
+    int file_version = ReadValue<int>();
+    if (file_version != version)
+      throw Error(path, fmt("Checkpoint version %d not supported (expected %d)",
+                            file_version, version));
+  }
+}
+
+Checkpoint::~Checkpoint() {
+  if (gz_file) gzclose(gz_file);
+}
+
+void Checkpoint::Write(const void* buffer, unsigned size) {
+  assert(mode == ModeSave);
+  if (!size) return;
+  if (gzwrite(gz_file, buffer, size) != (int)size)
+    throw Error(path, "Cannot write to file");
+}
+
+void Checkpoint::Read(void* buffer, unsigned size) {
+  assert(mode == ModeLoad);
+  if (!size) return;
+  if (gzread(gz_file, buffer, size) != (int)size)
+    throw Error(path, "Unexpected end of file");
+}
+
+void Checkpoint::WriteString(const std::string& s) {
+  WriteValue((unsigned)s.size());
+  Write(s.data(), s.size());
+}
+
+std::string Checkpoint::ReadString() {
+  // Read length. Strings in checkpoints are paths, arguments, and tags,
+  // so a very large value is a sign of a corrupted file.
+  unsigned size = ReadValue<unsigned>();
+  if (size > (1u << 24)) throw Error(path, "Corrupted string length");
+
+  // Read content
+  std::string s(size, '\0');
+  Read(&s[0], size);
+  return s;
+}
+
+void Checkpoint::WriteStrings(const std::vector<std::string>& strings) {
+  WriteValue((unsigned)strings.size());
+  for (auto& s : strings) WriteString(s);
+}
+
+void Checkpoint::ReadStrings(std::vector<std::string>& strings) {
+  unsigned size = ReadValue<unsigned>();
+  strings.clear();
+  for (unsigned i = 0; i < size; i++) strings.push_back(ReadString());
+}
+
+void Checkpoint::ReadTag(const std::string& tag) {
+  std::string file_tag = ReadString();
+  if (file_tag != tag)
+    throw Error(path, fmt("Expected section '%s', found '%s'", tag.c_str(),
+                          file_tag.c_str()));
+}
+
+}  // namespace misc
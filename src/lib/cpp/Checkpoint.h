@@ -0,0 +1,141 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_CHECKPOINT_H
+#define LIB_CPP_CHECKPOINT_H
+
+#include <zlib.h>
+#include <string>
+#include <vector>
+
+#include "Error.h"
+
+namespace misc {
+
+/// Compressed binary file used to save and restore the state of a
+/// simulation. Data is streamed through zlib as it is written or read, so
+/// large memory images never need to be fully buffered. Values are stored
+/// in the host byte order, so a checkpoint can only be restored on a host
+/// with the same architecture as the one that saved it.
+class Checkpoint {
+ public:
+  /// Class representing an error in a checkpoint file
+  class Error : public misc::Error {
+   public:
+    /// Constructor
+    Error(const std::string& path, const std::string& message)
+        : misc::Error(message) {
+      AppendPrefix("Checkpoint");
+      AppendPrefix(path);
+    }
+  };
+
+  /// Direction in which the checkpoint file is accessed
+  enum Mode { ModeInvalid = 0, ModeSave, ModeLoad };
+
+ private:
+  // Version of the checkpoint format. Checkpoints with a different version
+  // are rejected when loaded.
+  static const int version;
+
+  // Path of the checkpoint file
+  std::string path;
+
+  // Access mode
+  Mode mode;
+
+  // Compressed file
+  gzFile gz_file = nullptr;
+
+ public:
+  /// Open a checkpoint file in the given mode. When saving, the file is
+  /// created and a header is written. When loading, the header is
+  /// validated.
+  ///
+  /// \throw
+  ///	An Error is thrown if the file cannot be opened or its header is
+  ///	not valid.
+  Checkpoint(const std::string& path, Mode mode);
+
+  /// Destructor, closing the file
+  ~Checkpoint();
+
+  /// Return the path of the checkpoint file
+  const std::string& getPath() const { return path; }
+
+  /// Return the access mode
+  Mode getMode() const { return mode; }
+
+  /// Write \a size bytes from \a buffer. The checkpoint must have been
+  /// opened with ModeSave.
+  void Write(const void* buffer, unsigned size);
+
+  /// Read \a size bytes into \a buffer. The checkpoint must have been
+  /// opened with ModeLoad.
+  ///
+  /// \throw
+  ///	An Error is thrown if the file is truncated.
+  void Read(void* buffer, unsigned size);
+
+  /// Write a value of a plain data type
+  template <typename T>
+  void WriteValue(const T& value) {
+    Write(&value, sizeof(T));
+  }
+
+  /// Read a value of a plain data type
+  template <typename T>
+  void ReadValue(T& value) {
+    Read(&value, sizeof(T));
+  }
+
+  /// Read and return a value of a plain data type
+  template <typename T>
+  T ReadValue() {
+    T value;
+    Read(&value, sizeof(T));
+    return value;
+  }
+
+  /// Write a string, preceded by its length
+  void WriteString(const std::string& s);
+
+  /// Read a string written with WriteString()
+  std::string ReadString();
+
+  /// Write a vector of strings
+  void WriteStrings(const std::vector<std::string>& strings);
+
+  /// Read a vector of strings written with WriteStrings()
+  void ReadStrings(std::vector<std::string>& strings);
+
+  /// Write a section tag. Tags are used to detect corrupted or mismatching
+  /// checkpoints as early as possible while loading.
+  void WriteTag(const std::string& tag) { WriteString(tag); }
+
+  /// Read a section tag and check that it matches \a tag.
+  ///
+  /// \throw
+  ///	An Error is thrown if the tag does not match.
+  void ReadTag(const std::string& tag);
+};
+
+}  // namespace misc
+
+#endif
@@ -91,7 +91,7 @@ class Debug {
   /// to setPath(), this call is ignored. The argument can be of any
   /// type accepted by an \c std::ostream object.
   template <typename T>
-  Debug& operator<<(T val) {
+  Debug& operator<<(const T& val) {
     if (os && active) *os << prefix << val;
     Flush();
     return *this;
@@ -0,0 +1,107 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include "Error.h"
+#include "HostThreadPool.h"
+#include "Misc.h"
+
+namespace misc {
+
+HostThreadPool::HostThreadPool(int num_threads) : num_threads(num_threads) {
+  // Initialize barriers
+  assert(num_threads > 0);
+  pthread_barrier_init(&start_barrier, nullptr, num_threads);
+  pthread_barrier_init(&end_barrier, nullptr, num_threads);
+
+  // Create host threads
+  for (int i = 1; i < num_threads; i++) {
+    host_threads.emplace_back(misc::new_unique<HostThread>());
+    HostThread* host_thread = host_threads.back().get();
+    host_thread->pool = this;
+    if (pthread_create(&host_thread->thread, nullptr, HostThreadMain,
+                       host_thread))
+      throw misc::Panic("Cannot create host thread");
+  }
+}
+
+HostThreadPool::~HostThreadPool() {
+  // Release host threads from the start barrier
+  exit = true;
+  pthread_barrier_wait(&start_barrier);
+  for (auto& host_thread : host_threads)
+    pthread_join(host_thread->thread, nullptr);
+
+  // Destroy barriers
+  pthread_barrier_destroy(&start_barrier);
+  pthread_barrier_destroy(&end_barrier);
+}
+
+void* HostThreadPool::HostThreadMain(void* arg) {
+  HostThread* host_thread = (HostThread*)arg;
+  HostThreadPool* pool = host_thread->pool;
+  for (;;) {
+    // Wait for the next batch
+    pthread_barrier_wait(&pool->start_barrier);
+    if (pool->exit) break;
+
+    // Run items and wait for the rest of host threads
+    pool->RunBatch();
+    pthread_barrier_wait(&pool->end_barrier);
+  }
+  return nullptr;
+}
+
+void HostThreadPool::RunBatch() {
+  // An exception is saved to be rethrown by Run(), since host threads must
+  // still reach the end barrier
+  try {
+    for (;;) {
+      int index = batch_next_index++;
+      if (index >= batch_size) break;
+      (*batch_function)(index);
+    }
+  } catch (...) {
+    pthread_mutex_lock(&exception_mutex);
+    if (!exception) exception = std::current_exception();
+    pthread_mutex_unlock(&exception_mutex);
+  }
+}
+
+void HostThreadPool::Run(int num_items,
+                         const std::function<void(int)>& function) {
+  // Run the batch
+  batch_function = &function;
+  batch_size = num_items;
+  batch_next_index = 0;
+  pthread_barrier_wait(&start_barrier);
+  RunBatch();
+  pthread_barrier_wait(&end_barrier);
+  batch_function = nullptr;
+
+  // Propagate errors found by any host thread
+  if (exception) {
+    std::exception_ptr saved_exception = exception;
+    exception = nullptr;
+    std::rethrow_exception(saved_exception);
+  }
+}
+
+}  // namespace misc
@@ -0,0 +1,111 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_HOST_THREAD_POOL_H
+#define LIB_CPP_HOST_THREAD_POOL_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <pthread.h>
+#include <vector>
+
+namespace misc {
+
+/// Pool of host threads running batches of items in parallel. The thread
+/// calling Run() takes part as one of the host threads, so a pool of N
+/// threads creates N - 1 POSIX threads, which wait on a barrier between
+/// batches.
+class HostThreadPool {
+  // POSIX thread other than the one calling Run()
+  struct HostThread {
+    // Pool that the host thread belongs to
+    HostThreadPool* pool;
+
+    // POSIX thread
+    pthread_t thread;
+  };
+
+  // Number of host threads, including the one calling Run()
+  int num_threads;
+
+  // Host threads other than the one calling Run()
+  std::vector<std::unique_ptr<HostThread>> host_threads;
+
+  // Barriers where all host threads meet at the beginning and at the end
+  // of a batch
+  pthread_barrier_t start_barrier;
+  pthread_barrier_t end_barrier;
+
+  // Flag telling host threads to finish at the next start barrier
+  bool exit = false;
+
+  // Function run for each item of the current batch
+  const std::function<void(int)>* batch_function = nullptr;
+
+  // Number of items in the current batch
+  int batch_size = 0;
+
+  // Index of the next item of the current batch to be picked up
+  std::atomic<int> batch_next_index;
+
+  // First exception thrown by an item of the current batch, rethrown by
+  // Run() once all host threads finish
+  std::exception_ptr exception;
+
+  // Mutex protecting the saved exception
+  pthread_mutex_t exception_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+  // Entry point of a host thread
+  static void* HostThreadMain(void* arg);
+
+  // Run items of the current batch until none is left
+  void RunBatch();
+
+ public:
+  /// Number of items per host thread in a batch, as returned by
+  /// getBatchSize()
+  static const int items_per_thread = 4;
+
+  /// Create a pool of the given number of host threads, including the
+  /// one that will call Run().
+  explicit HostThreadPool(int num_threads);
+
+  /// Make host threads finish and wait for them
+  ~HostThreadPool();
+
+  /// Return the number of host threads, including the one calling Run()
+  int getNumThreads() const { return num_threads; }
+
+  /// Return a batch size that keeps all host threads busy when the
+  /// execution times of items differ
+  int getBatchSize() const { return num_threads * items_per_thread; }
+
+  /// Call \a function with every index in the range [0, \a num_items),
+  /// and return once all calls complete. Items are picked up dynamically
+  /// by the host threads, since their execution times may differ widely.
+  /// The first exception thrown by \a function is rethrown after all host
+  /// threads finish the batch.
+  void Run(int num_items, const std::function<void(int)>& function);
+};
+
+}  // namespace misc
+
+#endif
@@ -44,6 +44,7 @@
 #include <arch/x86/emulator/Signal.h>
 #include <arch/x86/timing/Timing.h>
 #include <dram/System.h>
+#include <lib/cpp/Checkpoint.h>
 #include <lib/cpp/CommandLine.h>
 #include <lib/cpp/Environment.h>
 #include <lib/cpp/IniFile.h>
@@ -66,6 +67,15 @@ extern "C" {
 // Context configuration file
 std::string m2s_context_config;
 
+// File where a checkpoint is saved
+std::string m2s_checkpoint_file = "m2s.ckpt";
+
+// Checkpoint file to restore the simulation from
+std::string m2s_load_checkpoint;
+
+// Number of CPU instructions after which a checkpoint is saved
+long long m2s_save_checkpoint = 0;
+
 // Debug information in CUDA runtime
 std::string m2s_cuda_debug;
 
@@ -103,6 +113,9 @@ std::string m2s_visual_file;
 // Number of iterations in the main simulation loop
 long long m2s_loop_iterations = 0;
 
+// Names of the architectures whose guest contexts are saved in checkpoints
+const char* m2s_checkpoint_archs[] = {"x86", "ARM", "MIPS"};
+
 //
 // Functions
 //
@@ -211,6 +224,54 @@ void LoadPrograms() {
   }
 }
 
+// Return the emulators of the checkpoint architectures that have been
+// instantiated so far
+std::vector<comm::Emulator*> getCheckpointEmulators() {
+  std::vector<comm::Emulator*> emulators;
+  comm::ArchPool* arch_pool = comm::ArchPool::getInstance();
+  for (const char* name : m2s_checkpoint_archs) {
+    comm::Arch* arch = arch_pool->getByName(name);
+    if (arch && arch->getEmulator()) emulators.push_back(arch->getEmulator());
+  }
+  return emulators;
+}
+
+// Save all guest contexts into the checkpoint file
+void SaveCheckpoint() {
+  misc::Checkpoint checkpoint(m2s_checkpoint_file, misc::Checkpoint::ModeSave);
+  for (comm::Emulator* emulator : getCheckpointEmulators()) {
+    checkpoint.WriteString(emulator->getName());
+    emulator->SaveCheckpoint(checkpoint);
+  }
+  checkpoint.WriteString("");
+}
+
+// Create the guest contexts saved in a checkpoint file
+void LoadCheckpoint() {
+  misc::Checkpoint checkpoint(m2s_load_checkpoint, misc::Checkpoint::ModeLoad);
+  for (;;) {
+    // Architecture name, or empty string for the end of the checkpoint
+    std::string name = checkpoint.ReadString();
+    if (name.empty()) break;
+
+    // Choose emulator
+    comm::Emulator* emulator;
+    if (name == "x86")
+      emulator = x86::Emulator::getInstance();
+    else if (name == "ARM")
+      emulator = ARM::Emulator::getInstance();
+    else if (name == "MIPS")
+      emulator = MIPS::Emulator::getInstance();
+    else
+      throw misc::Checkpoint::Error(
+          m2s_load_checkpoint,
+          misc::fmt("Unsupported architecture '%s'", name.c_str()));
+
+    // Load contexts
+    emulator->LoadCheckpoint(checkpoint);
+  }
+}
+
 void RegisterOptions() {
   // Set error message
   misc::CommandLine* command_line = misc::CommandLine::getInstance();
@@ -245,6 +306,12 @@ void RegisterOptions() {
       "call stacks, including function invocations and "
       "returns.");
 
+  // Checkpoint file
+  command_line->RegisterString(
+      "--checkpoint-file <file> (default = m2s.ckpt)", m2s_checkpoint_file,
+      "File where the checkpoint requested with option "
+      "--save-checkpoint is written.");
+
   // Context configuration
   command_line->RegisterString(
       "--ctx-config <file>", m2s_context_config,
@@ -266,6 +333,16 @@ void RegisterOptions() {
       "Dump debug information about all processed INI files "
       "into the specified path.");
 
+  // Load checkpoint
+  command_line->RegisterString(
+      "--load-checkpoint <file>", m2s_load_checkpoint,
+      "Restore the x86, ARM, and MIPS guest contexts saved in <file> "
+      "with option --save-checkpoint, instead of loading programs "
+      "from the command line or the context configuration file. The "
+      "restored contexts can continue in functional or detailed "
+      "simulation, so one checkpoint can be shared by many runs with "
+      "different configurations.");
+
   // Maximum simulation time
   command_line->RegisterInt64(
       "--max-time <time> (default = 0)", m2s_max_time,
@@ -273,6 +350,17 @@ void RegisterOptions() {
       "will stop once this time is exceeded. A value of 0 "
       "(default) means no time limit.");
 
+  // Save checkpoint
+  command_line->RegisterInt64(
+      "--save-checkpoint <inst>", m2s_save_checkpoint,
+      "Run functional simulation until <inst> instructions have been "
+      "emulated by the x86, ARM, and MIPS emulators altogether, save "
+      "the state of all guest contexts into the file given with "
+      "option --checkpoint-file, and end the simulation. The "
+      "checkpoint includes registers, memory, file descriptors, "
+      "signal state, and the emulator context lists. Guest programs "
+      "using pipes, sockets, or GPU devices cannot be saved.");
+
   // Trace file
   command_line->RegisterString(
       "--trace <file>", m2s_trace_file,
@@ -343,8 +431,9 @@ void RegisterOptions() {
 }
 
 void ProcessOptions() {
-  // Get environment
+  // Get environment and command line
   misc::Environment* environment = misc::Environment::getInstance();
+  misc::CommandLine* command_line = misc::CommandLine::getInstance();
 
   // CUDA runtime debug
   if (!m2s_cuda_debug.empty())
@@ -373,6 +462,20 @@ void ProcessOptions() {
   if (!m2s_opencl_binary.empty())
     environment->addVariable("M2S_OPENCL_BINARY", m2s_opencl_binary);
 
+  // Checkpoints
+  if (m2s_save_checkpoint < 0)
+    throw misc::Error("Value for --save-checkpoint must be positive");
+  if (m2s_save_checkpoint &&
+      x86::Timing::getSimKind() == comm::Arch::SimDetailed)
+    throw misc::Error(
+        "Option --save-checkpoint can only be used in functional "
+        "simulation");
+  if (!m2s_load_checkpoint.empty() &&
+      (command_line->getNumArguments() || !m2s_context_config.empty()))
+    throw misc::Error(
+        "Option --load-checkpoint cannot be used together with a "
+        "program or a context configuration file");
+
   // Trace file
   if (!m2s_trace_file.empty()) {
     esim::TraceSystem* trace_system = esim::TraceSystem::getInstance();
@@ -422,6 +525,10 @@ void MainLoop() {
   // Get singletons
   comm::ArchPool* arch_pool = comm::ArchPool::getInstance();
 
+  // Emulators counting instructions toward the checkpoint
+  std::vector<comm::Emulator*> checkpoint_emulators;
+  if (m2s_save_checkpoint) checkpoint_emulators = getCheckpointEmulators();
+
   // Simulation loop
   while (!esim->hasFinished()) {
     // Run iteration for all architectures. This function returns
@@ -443,6 +550,17 @@ void MainLoop() {
     if (!num_active_emulators && !num_active_timing_simulators)
       esim->Finish("ContextsFinished");
 
+    // Save checkpoint once enough instructions have been emulated
+    if (m2s_save_checkpoint && !esim->hasFinished()) {
+      long long num_instructions = 0;
+      for (comm::Emulator* emulator : checkpoint_emulators)
+        num_instructions += emulator->getNumInstructions();
+      if (num_instructions >= m2s_save_checkpoint) {
+        SaveCheckpoint();
+        esim->Finish("Checkpoint");
+      }
+    }
+
     // Count loop iterations, and check for limit in simulation time
     // only every 128k iterations. This avoids a constant overhead
     // of system calls.
@@ -642,8 +760,11 @@ int MainProgram(int argc, char** argv) {
   RegisterDrivers();
   RegisterRuntimes();
 
-  // Load programs
-  LoadPrograms();
+  // Load programs, or restore them from a checkpoint
+  if (m2s_load_checkpoint.empty())
+    LoadPrograms();
+  else
+    LoadCheckpoint();
 
   // Main simulation loop
   MainLoop();
@@ -21,7 +21,9 @@
 #include <cassert>
 #include <cstring>
 #include <fstream>
+#include <vector>
 
+#include <lib/cpp/Checkpoint.h>
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/String.h>
 
@@ -101,6 +103,7 @@ void Memory::Copy(unsigned dest, unsigned src, unsigned size) {
 
     // Different actions depending on whether source and
     // destination page data are allocated.
+    if (page_dest->getPerm() & AccessExec) code_version++;
     if (page_src->getData()) {
       page_dest->AllocateData();
       memcpy(page_dest->getData(), page_src->getData(), PageSize);
@@ -115,6 +118,81 @@ void Memory::Copy(unsigned dest, unsigned src, unsigned size) {
   }
 }
 
+void Memory::Copy(unsigned dest, Memory* src_memory, unsigned src,
+                  unsigned size) {
+  // When the destination overlaps the end of the source region in the same
+  // memory, chunks are copied from the end, so that the source is read
+  // before being overwritten
+  bool backward = src_memory == this && src < dest && src + size > dest;
+
+  // Copy chunks that cross neither a source nor a destination page boundary
+  src_memory->last_address = src;
+  last_address = dest;
+  while (size) {
+    unsigned chunk_src = src;
+    unsigned chunk_dest = dest;
+    unsigned chunk_size;
+    if (backward) {
+      unsigned src_end_offset = ((src + size - 1) & (PageSize - 1)) + 1;
+      unsigned dest_end_offset = ((dest + size - 1) & (PageSize - 1)) + 1;
+      chunk_size = std::min(size, std::min(src_end_offset, dest_end_offset));
+      chunk_src = src + size - chunk_size;
+      chunk_dest = dest + size - chunk_size;
+    } else {
+      unsigned src_offset = src & (PageSize - 1);
+      unsigned dest_offset = dest & (PageSize - 1);
+      chunk_size = std::min(size, PageSize - std::max(src_offset, dest_offset));
+    }
+    unsigned src_offset = chunk_src & (PageSize - 1);
+    unsigned dest_offset = chunk_dest & (PageSize - 1);
+
+    // Source page. A missing page reads as zeros in unsafe mode.
+    Page* src_page = src_memory->getPage(chunk_src);
+    if (!src_page && src_memory->safe)
+      throw Error(
+          misc::fmt("[0x%x] Segmentation fault in guest program", chunk_src));
+    if (src_page && src_memory->safe &&
+        !(src_page->getPerm() & AccessRead))
+      throw Error(misc::fmt("[0x%x] Permission denied", chunk_src));
+    char* src_data = src_page ? src_page->getData() : nullptr;
+
+    // Destination page. A missing page is created in unsafe mode, as a
+    // write would do, unless it would only receive zeros.
+    Page* dest_page = getPage(chunk_dest);
+    if (!dest_page) {
+      if (safe)
+        throw Error(misc::fmt("[0x%x] Segmentation fault in guest program",
+                              chunk_dest));
+      if (src_data)
+        dest_page = newPage(
+            chunk_dest, AccessRead | AccessWrite | AccessExec | AccessInit);
+    }
+    if (dest_page) {
+      if (safe && !(dest_page->getPerm() & AccessWrite))
+        throw Error(misc::fmt("[0x%x] Permission denied", chunk_dest));
+      dest_page->addPerm(AccessModified);
+      if (dest_page->getPerm() & AccessExec) code_version++;
+
+      // Copy data, or clear it if the source has no data. Both chunks may
+      // overlap within the same page.
+      if (src_data) {
+        dest_page->AllocateData();
+        memmove(dest_page->getData() + dest_offset, src_data + src_offset,
+                chunk_size);
+      } else if (dest_page->getData()) {
+        memset(dest_page->getData() + dest_offset, 0, chunk_size);
+      }
+    }
+
+    // Next chunk
+    size -= chunk_size;
+    if (!backward) {
+      src += chunk_size;
+      dest += chunk_size;
+    }
+  }
+}
+
 char* Memory::getBuffer(unsigned address, unsigned size, AccessType access) {
   // Get page offset and check page bounds
   unsigned offset = address & (PageSize - 1);
@@ -176,6 +254,7 @@ void Memory::AccessAtPageBoundary(unsigned address, unsigned size, char* buffer,
 
   // Write/initialize access
   if (access == AccessWrite || access == AccessInit) {
+    if (page->getPerm() & AccessExec) code_version++;
     page->AllocateData();
     memcpy(page->getData() + offset, buffer, size);
     return;
@@ -290,6 +369,7 @@ void Memory::Map(unsigned address, unsigned size, unsigned perm) {
     Page* page = getPage(tag);
     if (!page) page = newPage(tag, perm);
     page->addPerm(perm);
+    if (page->getPerm() & AccessExec) code_version++;
   }
 }
 
@@ -301,7 +381,11 @@ void Memory::Unmap(unsigned address, unsigned size) {
   unsigned tag2 = (address + size - 1) & ~(PageSize - 1);
 
   // Deallocate pages
-  for (unsigned tag = tag1; tag <= tag2; tag += PageSize) pages.erase(tag);
+  for (unsigned tag = tag1; tag <= tag2; tag += PageSize) {
+    Page* page = getPage(tag);
+    if (page && (page->getPerm() & AccessExec)) code_version++;
+    pages.erase(tag);
+  }
 }
 
 void Memory::Protect(unsigned address, unsigned size, unsigned perm) {
@@ -317,6 +401,7 @@ void Memory::Protect(unsigned address, unsigned size, unsigned perm) {
     if (!page) continue;
 
     // Set page new protection flags
+    if ((page->getPerm() | perm) & AccessExec) code_version++;
     page->setPerm(perm);
   }
 }
@@ -412,4 +497,54 @@ void Memory::Clone(const Memory& memory) {
   heap_break = memory.heap_break;
 }
 
+void Memory::SaveCheckpoint(misc::Checkpoint& checkpoint) const {
+  // Sort pages by tag, so that the same memory image always produces the
+  // same checkpoint.
+  std::vector<Page*> sorted_pages;
+  for (auto& it : pages) sorted_pages.push_back(it.second.get());
+  std::sort(sorted_pages.begin(), sorted_pages.end(),
+            [](Page* a, Page* b) { return a->getTag() < b->getTag(); });
+
+  // Attributes
+  checkpoint.WriteTag("Memory");
+  checkpoint.WriteValue(safe);
+  checkpoint.WriteValue(heap_break);
+  checkpoint.WriteValue((unsigned)sorted_pages.size());
+
+  // Pages. Pages that were mapped but never accessed have no data and are
+  // saved without it.
+  for (Page* page : sorted_pages) {
+    checkpoint.WriteValue(page->getTag());
+    checkpoint.WriteValue(page->getPerm());
+    bool has_data = page->getData() != nullptr;
+    checkpoint.WriteValue(has_data);
+    if (has_data) checkpoint.Write(page->getData(), PageSize);
+  }
+}
+
+void Memory::LoadCheckpoint(misc::Checkpoint& checkpoint) {
+  // Discard current content
+  Clear();
+
+  // Attributes
+  checkpoint.ReadTag("Memory");
+  checkpoint.ReadValue(safe);
+  checkpoint.ReadValue(heap_break);
+  unsigned num_pages = checkpoint.ReadValue<unsigned>();
+
+  // Pages, read directly into their data buffers
+  for (unsigned i = 0; i < num_pages; i++) {
+    unsigned tag = checkpoint.ReadValue<unsigned>();
+    unsigned perm = checkpoint.ReadValue<unsigned>();
+    if (tag & (PageSize - 1) || getPage(tag))
+      throw misc::Checkpoint::Error(checkpoint.getPath(),
+                                    misc::fmt("Invalid memory page 0x%x", tag));
+    Page* page = newPage(tag, perm);
+    if (checkpoint.ReadValue<bool>()) {
+      page->AllocateData();
+      checkpoint.Read(page->getData(), PageSize);
+    }
+  }
+}
+
 }  // namespace mem
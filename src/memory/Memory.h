@@ -28,6 +28,10 @@
 #include <lib/cpp/Error.h>
 #include <lib/cpp/Misc.h>
 
+namespace misc {
+class Checkpoint;
+}
+
 namespace mem {
 
 /// A 32-bit virtual memory space
@@ -124,6 +128,12 @@ class Memory {
   /// Last accessed address
   unsigned last_address = 0;
 
+  /// Number of changes to executable code, incremented on every write to
+  /// a page with execute permission, and on every change of the memory
+  /// map or page permissions affecting a page that has or gains execute
+  /// permission.
+  long long code_version = 0;
+
   /// Create a new page and add it to the page table. The value given in
   /// \a perm is an *or*'ed bitmap of AccessType flags.
   Page* newPage(unsigned address, unsigned perm);
@@ -152,7 +162,16 @@ class Memory {
   bool getSafe() const { return safe; }
 
   /// Clear content of memory
-  void Clear() { pages.clear(); }
+  void Clear() {
+    pages.clear();
+    code_version++;
+  }
+
+  /// Return a counter that changes whenever executable code in memory may
+  /// have changed. Emulators keeping decoded instructions compare it with
+  /// the value seen when decoding to discard stale instructions. Writes
+  /// through pointers returned by getBuffer() are not tracked.
+  long long getCodeVersion() const { return code_version; }
 
   /// Return the memory page corresponding to an address, or `nullptr` if
   /// there is currently no page allocated for that address.
@@ -258,6 +277,33 @@ class Memory {
   ///	region does not have write permissions.
   void Copy(unsigned dest, unsigned src, unsigned size);
 
+  /// Copy a region of memory from another memory space, or from another
+  /// region of this one, with no alignment or size restrictions. Data
+  /// moves directly from the source pages into the destination pages,
+  /// without an intermediate buffer. Pages with no data allocated in the
+  /// source are copied without allocating data in the destination
+  /// whenever possible. This is equivalent to reading the source region
+  /// into a buffer and writing it into the destination, also when both
+  /// regions overlap in the same memory, as memmove() does.
+  ///
+  /// \param dest
+  ///	Destination address in this memory
+  ///
+  /// \param src_memory
+  ///	Source memory space, which can be this same memory
+  ///
+  /// \param src
+  ///	Source address in \a src_memory
+  ///
+  /// \param size
+  ///	Number of bytes to copy
+  ///
+  /// \throw
+  ///	A Memory::Error is thrown in safe mode if the pages involved are
+  ///	not allocated or do not have read (source) or write (destination)
+  ///	permissions.
+  void Copy(unsigned dest, Memory* src_memory, unsigned src, unsigned size);
+
   /// Access memory at any address and size, without page boundary
   /// restrictions.
   ///
@@ -412,6 +458,17 @@ class Memory {
   ///	A Memory::Error is thrown if file \a path cannot be accessed.
   void Load(const std::string& path, unsigned start);
 
+  /// Save the complete memory image, including page permissions, the heap
+  /// break, and the safe mode, into a checkpoint.
+  void SaveCheckpoint(misc::Checkpoint& checkpoint) const;
+
+  /// Replace the content of the memory object with an image previously
+  /// saved with SaveCheckpoint().
+  ///
+  /// \throw
+  ///	A misc::Checkpoint::Error is thrown if the checkpoint is corrupted.
+  void LoadCheckpoint(misc::Checkpoint& checkpoint);
+
   /// Set a new value for the heap break.
   void setHeapBreak(unsigned heap_break) { this->heap_break = heap_break; }
 
@@ -131,9 +131,10 @@ bool Module::canAccess(int address) const {
 }
 
 long long Module::Access(AccessType access_type, unsigned address, int* witness,
-                         esim::Event* return_event) {
+                         esim::Event* return_event, long long id) {
   // Create a new event frame
-  auto frame = misc::new_shared<Frame>(Frame::getNewId(), this, address);
+  if (!id) id = Frame::getNewId();
+  auto frame = misc::new_shared<Frame>(id, this, address);
   frame->witness = witness;
 
   // Select initial event type
@@ -561,12 +561,17 @@ class Module {
   ///	current frame will be available within the event handler of
   ///	\a return_event. Use \c nullptr (default) for no return event.
   ///
+  /// \param id
+  ///	Identifier for the access, obtained earlier with
+  ///	Frame::getNewId(), or 0 (default) to assign a new one.
+  ///
   /// \return frame_id
   ///	The function returns a unique identifier of the new memory
   ///	access.
   ///
   long long Access(AccessType access_type, unsigned address,
-                   int* witness = nullptr, esim::Event* return_event = nullptr);
+                   int* witness = nullptr, esim::Event* return_event = nullptr,
+                   long long id = 0);
 
   /// Add the given frame to the list of in-flight accesses, and record
   /// its access type. This function is invoked internally by the event
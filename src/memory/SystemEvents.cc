@@ -975,8 +975,16 @@ void System::EventFindAndLockHandler(esim::Event* event,
     // that the it will complete and can allow processing to
     // continue by incrementing the witness pointer.  Misses
     // cannot do this without violating consistency, so their
-    // witness pointer is updated in the write request logic.
-    if (frame->write && frame->hit && frame->witness) (*frame->witness)++;
+    // witness pointer is updated in the write request logic. The
+    // witness is cleared in the store as well, so that it is not
+    // incremented again when the lookup is repeated after waiting for
+    // the directory entry, or by the write request of a hit in a
+    // shared state.
+    if (frame->write && frame->hit && frame->witness) {
+      (*frame->witness)++;
+      frame->witness = nullptr;
+      parent_frame->witness = nullptr;
+    }
 
     // Check if miss
     if (!frame->hit) {
@@ -2098,8 +2106,11 @@ void System::EventWriteRequestHandler(esim::Event* event,
     // increment the witness pointer to allow processing to
     // continue while assuring consistency.
     if (frame->request_direction == Frame::RequestDirectionUpDown &&
-        frame->witness)
+        frame->witness) {
       (*frame->witness)++;
+      frame->witness = nullptr;
+      parent_frame->witness = nullptr;
+    }
 
     // Return
     esim_engine->Return();
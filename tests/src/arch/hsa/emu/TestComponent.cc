@@ -0,0 +1,184 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Yifan Sun (yifansun@coe.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/hsa/driver/Driver.h>
+#include <arch/hsa/driver/SignalManager.h>
+#include <arch/hsa/emulator/AQLPacket.h>
+#include <arch/hsa/emulator/AQLQueue.h>
+#include <arch/hsa/emulator/Component.h>
+#include <arch/hsa/emulator/Emulator.h>
+#include <lib/cpp/Error.h>
+#include <memory/Memory.h>
+
+namespace HSA {
+
+// Packet header bits, as written by the HSA runtime
+static const unsigned short header_barrier_bit = 1 << 8;
+
+// Test fixture owning the guest memory and a component with one queue
+class TestComponent : public testing::Test {
+ protected:
+  mem::Memory memory;
+
+  std::unique_ptr<Component> component;
+
+  AQLQueue* queue = nullptr;
+
+  unsigned saved_max_active_grids;
+
+  void SetUp() override {
+    saved_max_active_grids = Emulator::max_active_grids;
+    Emulator::getInstance()->setMemory(&memory);
+    component = misc::new_unique<Component>(100);
+    auto new_queue = misc::new_unique<AQLQueue>(8, 0);
+    queue = new_queue.get();
+    component->addQueue(std::move(new_queue));
+  }
+
+  void TearDown() override {
+    Emulator::max_active_grids = saved_max_active_grids;
+  }
+
+  // Return the guest address of the packet slot with the given index
+  unsigned getPacketAddress(uint64_t index) {
+    return queue->getBaseAddress() + index * sizeof(AQLPacket);
+  }
+
+  // Write the packet header into a slot
+  void WriteHeader(uint64_t index, unsigned short header) {
+    memory.Write(getPacketAddress(index), sizeof header, (char*)&header);
+  }
+
+  // Write a 64-bit field of the packet in a slot
+  void WriteField(uint64_t index, unsigned offset, uint64_t value) {
+    memory.Write(getPacketAddress(index) + offset, sizeof value,
+                 (char*)&value);
+  }
+
+  // Publish packets up to the given index, as the runtime does with
+  // hsa_queue_store_write_index_relaxed()
+  void StoreWriteIndex(uint64_t value) {
+    memory.Write(queue->getFieldsAddress() + 40, sizeof value,
+                 (char*)&value);
+  }
+
+  // Write a barrier packet waiting on one signal, or none if 0
+  void WriteBarrier(uint64_t index, unsigned short format,
+                    uint64_t dependent_signal, uint64_t completion_signal) {
+    WriteField(index, 8, dependent_signal);
+    WriteField(index, 56, completion_signal);
+    WriteHeader(index, format);
+  }
+
+  SignalManager* getSignalManager() {
+    return Driver::getInstance()->getSignalManager();
+  }
+};
+
+TEST_F(TestComponent, dispatch_then_barrier) {
+  // A kernel dispatch packet is never taken for a barrier. With no grid
+  // slot available it stays at the head of the queue, and the barrier
+  // behind it waits.
+  Emulator::max_active_grids = 0;
+  uint64_t completion = getSignalManager()->CreateSignal(1);
+  WriteHeader(0, AQLFormatKernelDispatch);
+  WriteBarrier(1, AQLFormatBarrierAnd, 0, completion);
+  StoreWriteIndex(2);
+
+  EXPECT_TRUE(component->Execute());
+  EXPECT_EQ(0u, queue->getReadIndex());
+  EXPECT_EQ(AQLFormatKernelDispatch, queue->getHeadPacket()->getFormat());
+  EXPECT_EQ(1, getSignalManager()->GetValue(completion));
+}
+
+TEST_F(TestComponent, barrier_and) {
+  uint64_t dependent = getSignalManager()->CreateSignal(1);
+  uint64_t completion = getSignalManager()->CreateSignal(1);
+  WriteBarrier(0, AQLFormatBarrierAnd, dependent, completion);
+  StoreWriteIndex(1);
+
+  // The barrier waits for its dependent signal
+  EXPECT_TRUE(component->Execute());
+  EXPECT_EQ(0u, queue->getReadIndex());
+  EXPECT_EQ(1, getSignalManager()->GetValue(completion));
+
+  // Once it is satisfied, the packet is consumed, its slot is marked
+  // invalid and the completion signal is decremented
+  getSignalManager()->ChangeValue(dependent, 0);
+  EXPECT_FALSE(component->Execute());
+  EXPECT_EQ(1u, queue->getReadIndex());
+  EXPECT_EQ(0, getSignalManager()->GetValue(completion));
+  AQLPacket* packet = (AQLPacket*)memory.getBuffer(
+      getPacketAddress(0), sizeof(AQLPacket), mem::Memory::AccessRead);
+  EXPECT_EQ(AQLFormatInvalid, packet->getFormat());
+}
+
+TEST_F(TestComponent, barrier_bit) {
+  // The barrier bit is decoded from the header, not from the format
+  uint64_t completion = getSignalManager()->CreateSignal(1);
+  WriteBarrier(0, AQLFormatBarrierOr, 0, completion);
+  WriteHeader(0, AQLFormatBarrierOr | header_barrier_bit);
+  StoreWriteIndex(1);
+
+  AQLPacket* packet = queue->getHeadPacket();
+  EXPECT_EQ(AQLFormatBarrierOr, packet->getFormat());
+  EXPECT_TRUE(packet->getBarrierBit());
+  EXPECT_FALSE(component->Execute());
+  EXPECT_EQ(1u, queue->getReadIndex());
+  EXPECT_EQ(0, getSignalManager()->GetValue(completion));
+}
+
+TEST_F(TestComponent, invalid_packet) {
+  // A slot whose header has not been written yet is left in the queue,
+  // as well as the barrier behind it
+  uint64_t completion = getSignalManager()->CreateSignal(1);
+  WriteHeader(0, AQLFormatInvalid);
+  WriteBarrier(1, AQLFormatBarrierAnd, 0, completion);
+  StoreWriteIndex(2);
+
+  EXPECT_TRUE(component->Execute());
+  EXPECT_EQ(0u, queue->getReadIndex());
+  EXPECT_EQ(1, getSignalManager()->GetValue(completion));
+
+  // Once the runtime writes the header, both packets are processed
+  WriteBarrier(0, AQLFormatBarrierAnd, 0, 0);
+  EXPECT_FALSE(component->Execute());
+  EXPECT_EQ(2u, queue->getReadIndex());
+  EXPECT_EQ(0, getSignalManager()->GetValue(completion));
+}
+
+TEST_F(TestComponent, agent_dispatch_packet) {
+  // Agent dispatch packets are not supported and are not launched
+  WriteHeader(0, AQLFormatAgentDispatch);
+  StoreWriteIndex(1);
+
+  EXPECT_TRUE(component->Execute());
+  EXPECT_EQ(0u, queue->getReadIndex());
+}
+
+TEST_F(TestComponent, barrier_invalid_signal) {
+  WriteBarrier(0, AQLFormatBarrierAnd, 0xdead0000, 0);
+  StoreWriteIndex(1);
+
+  EXPECT_THROW(component->Execute(), Error);
+}
+
+}  // namespace HSA
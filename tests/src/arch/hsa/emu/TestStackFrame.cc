@@ -0,0 +1,57 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Yifan Sun (yifansun@coe.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <arch/hsa/emulator/Function.h>
+#include <arch/hsa/emulator/StackFrame.h>
+#include <arch/hsa/emulator/Variable.h>
+#include <lib/cpp/Misc.h>
+
+namespace HSA {
+
+// Add a private variable to a stack frame
+static void AddVariable(StackFrame& frame, const std::string& name,
+                        unsigned address) {
+  frame.addVariable(misc::new_unique<Variable>(
+      name, BRIG_TYPE_U32, 0, address, BRIG_SEGMENT_PRIVATE, false));
+}
+
+TEST(TestStackFrame, resolve_symbol) {
+  Function function("&test");
+  StackFrame frame(&function, nullptr, nullptr);
+  AddVariable(frame, "%a", 0x100);
+
+  // Each operand resolves to the variable named by its symbol
+  Function::AddressOperand operand_a;
+  operand_a.symbol = "%a";
+  Variable* variable = frame.ResolveSymbol(operand_a);
+  ASSERT_TRUE(variable);
+  EXPECT_EQ(0x100u, variable->getAddress());
+  EXPECT_EQ(variable, frame.ResolveSymbol(operand_a));
+
+  // Declaring more variables keeps earlier resolutions valid
+  AddVariable(frame, "%b", 0x200);
+  Function::AddressOperand operand_b;
+  operand_b.symbol = "%b";
+  EXPECT_EQ(0x200u, frame.ResolveSymbol(operand_b)->getAddress());
+  EXPECT_EQ(variable, frame.ResolveSymbol(operand_a));
+}
+
+}  // namespace HSA
@@ -30,7 +30,7 @@ ObjectPool::ObjectPool() {
   emulator = Emulator::getInstance();
 
   // Allocate NDRange
-  ndrange = misc::new_unique<NDRange>();
+  ndrange = misc::new_unique<NDRange>(0);
 
   // Set local size, global size, and work dimension
   int work_dim = 1;
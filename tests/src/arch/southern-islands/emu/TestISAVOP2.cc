@@ -17,6 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cmath>
+#include <cstring>
+#include <random>
+
 #include <gtest/gtest.h>
 
 #include "ObjectPool.h"
@@ -108,4 +112,320 @@ TEST(TestISAVOP2, V_ADD_I32) {
   EXPECT_EQ(12, work_item->ReadVReg(vdst));
   EXPECT_EQ(0, work_item->ReadReg(vcc));
 }
+
+// Encode a VOP1, VOP2, or VOPC instruction with source operand 'src0',
+// vector source 'vsrc1', and destination vector register 'vdst'.
+static void EncodeVectorAlu(Instruction* inst, Instruction::Format format,
+                            int op, int src0, int vsrc1, int vdst,
+                            unsigned lit_cnst) {
+  Instruction::Bytes bytes = {};
+  if (format == Instruction::FormatVOP1) {
+    bytes.vop1.src0 = src0;
+    bytes.vop1.op = op;
+    bytes.vop1.vdst = vdst;
+    bytes.vop1.enc = 0x3f;
+    bytes.vop1.lit_cnst = lit_cnst;
+  } else if (format == Instruction::FormatVOP2) {
+    bytes.vop2.src0 = src0;
+    bytes.vop2.vsrc1 = vsrc1;
+    bytes.vop2.vdst = vdst;
+    bytes.vop2.op = op;
+    bytes.vop2.enc = 0;
+    bytes.vop2.lit_cnst = lit_cnst;
+  } else {
+    bytes.vopc.src0 = src0;
+    bytes.vopc.vsrc1 = vsrc1;
+    bytes.vopc.op = op;
+    bytes.vopc.enc = 0x3e;
+    bytes.vopc.lit_cnst = lit_cnst;
+  }
+  inst->Decode((char*)&bytes, 0);
+}
+
+// This test checks that vector ALU instructions executed on a whole
+// wavefront produce the same registers, bit by bit, as the same
+// instructions executed on each active work-item. Both wavefronts start
+// with the same random register values and execution mask.
+TEST(TestISAVOP2, wavefront_execution) {
+  // Two work-groups with one full wavefront each
+  Disassembler::getInstance();
+  Emulator::getInstance();
+  NDRange ndrange(0);
+  unsigned global_size[1] = {128};
+  unsigned local_size[1] = {64};
+  ndrange.SetupSize(global_size, local_size, 1);
+  WorkGroup reference_work_group(&ndrange, 0);
+  WorkGroup work_group(&ndrange, 1);
+  Wavefront* reference = reference_work_group.getWavefront(0);
+  Wavefront* wavefront = work_group.getWavefront(0);
+  ASSERT_EQ(64u, reference->getWorkItemCount());
+  ASSERT_EQ(64u, wavefront->getWorkItemCount());
+
+  // Instructions: format, opcode
+  const std::pair<Instruction::Format, int> instructions[] = {
+      {Instruction::FormatVOP1, 1},   {Instruction::FormatVOP2, 0},
+      {Instruction::FormatVOP2, 3},   {Instruction::FormatVOP2, 4},
+      {Instruction::FormatVOP2, 5},   {Instruction::FormatVOP2, 8},
+      {Instruction::FormatVOP2, 9},   {Instruction::FormatVOP2, 15},
+      {Instruction::FormatVOP2, 16},  {Instruction::FormatVOP2, 17},
+      {Instruction::FormatVOP2, 18},  {Instruction::FormatVOP2, 19},
+      {Instruction::FormatVOP2, 20},  {Instruction::FormatVOP2, 22},
+      {Instruction::FormatVOP2, 24},  {Instruction::FormatVOP2, 25},
+      {Instruction::FormatVOP2, 26},  {Instruction::FormatVOP2, 27},
+      {Instruction::FormatVOP2, 28},  {Instruction::FormatVOP2, 29},
+      {Instruction::FormatVOP2, 31},  {Instruction::FormatVOP2, 32},
+      {Instruction::FormatVOP2, 33},  {Instruction::FormatVOP2, 37},
+      {Instruction::FormatVOP2, 38},  {Instruction::FormatVOP2, 39},
+      {Instruction::FormatVOPC, 1},   {Instruction::FormatVOPC, 4},
+      {Instruction::FormatVOPC, 6},   {Instruction::FormatVOPC, 11},
+      {Instruction::FormatVOPC, 13},  {Instruction::FormatVOPC, 129},
+      {Instruction::FormatVOPC, 130}, {Instruction::FormatVOPC, 131},
+      {Instruction::FormatVOPC, 132}, {Instruction::FormatVOPC, 133},
+      {Instruction::FormatVOPC, 134}, {Instruction::FormatVOPC, 193},
+      {Instruction::FormatVOPC, 195}, {Instruction::FormatVOPC, 196},
+      {Instruction::FormatVOPC, 197}, {Instruction::FormatVOPC, 198}};
+
+  // Register values, mixing integers and special floating-point values
+  std::mt19937 random(1234);
+  const unsigned special_values[] = {0,          1,          31,
+                                     0x80000000, 0xffffffff, 0x3f800000,
+                                     0xbf800000, 0x7f800000, 0x7fc00000,
+                                     0x00000001, 0x007fffff, 0x00800000};
+  auto random_value = [&]() {
+    unsigned value = random();
+    if (value % 4) return value;
+    return special_values[(value >> 2) %
+                          (sizeof special_values / sizeof special_values[0])];
+  };
+
+  // Operand S0: vector register, scalar register, inline constant, and
+  // literal constant
+  const int sources[] = {257, 4, 129, 240, 0xff};
+
+  Instruction inst;
+  for (auto& instruction : instructions) {
+    for (int src0 : sources) {
+      for (int trial = 0; trial < 8; trial++) {
+        // Instructions with a constant K take S0 from a register
+        EncodeVectorAlu(&inst, instruction.first, instruction.second, src0,
+                        2, trial % 2 ? 2 : 3, random_value() % 32);
+        if (src0 == 0xff &&
+            (inst.getOpcode() == Instruction::Opcode_V_MADMK_F32 ||
+             inst.getOpcode() == Instruction::Opcode_V_MADAK_F32))
+          continue;
+        SCOPED_TRACE(misc::fmt("%s, src0 = %d, trial %d", inst.getName(),
+                               src0, trial));
+
+        // Initial state
+        unsigned exec_lo = trial ? random() : 0xffffffff;
+        unsigned exec_hi = trial ? random() : 0xffffffff;
+        unsigned vcc_lo = random();
+        unsigned vcc_hi = random();
+        unsigned sreg_value = random_value();
+        for (Wavefront* w : {reference, wavefront}) {
+          w->setSregUint(Instruction::RegisterExec, exec_lo);
+          w->setSregUint(Instruction::RegisterExec + 1, exec_hi);
+          w->setSregUint(Instruction::RegisterVcc, vcc_lo);
+          w->setSregUint(Instruction::RegisterVcc + 1, vcc_hi);
+          w->setSregUint(4, sreg_value);
+        }
+        for (int vreg = 0; vreg < 4; vreg++) {
+          for (int lane = 0; lane < Wavefront::NumLanes; lane++) {
+            unsigned value = random_value();
+            reference->setVregUint(vreg, lane, value);
+            wavefront->setVregUint(vreg, lane, value);
+          }
+        }
+
+        // Execute on each work-item and on the whole wavefront
+        for (int lane = 0; lane < Wavefront::NumLanes; lane++)
+          if (reference->isWorkItemActive(lane))
+            reference->getWorkItem(lane)->Execute(inst.getOpcode(), &inst);
+        ASSERT_TRUE(wavefront->ExecuteVectorAlu(&inst));
+
+        // Compare registers. When more than one operand of a floating-point
+        // operation is a NaN, the host returns one of them depending on the
+        // order of operands chosen by the compiler, so NaN payloads are not
+        // compared.
+        bool float_op = strstr(inst.getName(), "_F32");
+        for (int vreg = 0; vreg < 4; vreg++) {
+          for (int lane = 0; lane < Wavefront::NumLanes; lane++) {
+            Instruction::Register expected, actual;
+            expected.as_uint = reference->getVregUint(vreg, lane);
+            actual.as_uint = wavefront->getVregUint(vreg, lane);
+            if (float_op && std::isnan(expected.as_float) &&
+                std::isnan(actual.as_float))
+              continue;
+            ASSERT_EQ(expected.as_uint, actual.as_uint)
+                << "v" << vreg << ", lane " << lane;
+          }
+        }
+        EXPECT_EQ(reference->getSregUint(Instruction::RegisterVcc),
+                  wavefront->getSregUint(Instruction::RegisterVcc));
+        EXPECT_EQ(reference->getSregUint(Instruction::RegisterVcc + 1),
+                  wavefront->getSregUint(Instruction::RegisterVcc + 1));
+        EXPECT_EQ(reference->getSregUint(Instruction::RegisterVccz),
+                  wavefront->getSregUint(Instruction::RegisterVccz));
+      }
+    }
+  }
+
+  // Register access statistics match as well
+  EXPECT_EQ(reference_work_group.getSregReadCount(),
+            work_group.getSregReadCount());
+  EXPECT_EQ(reference_work_group.getSregWriteCount(),
+            work_group.getSregWriteCount());
+  EXPECT_EQ(reference_work_group.getVregReadCount(),
+            work_group.getVregReadCount());
+  EXPECT_EQ(reference_work_group.getVregWriteCount(),
+            work_group.getVregWriteCount());
+}
+
+// Encode a VOP3a instruction
+static void EncodeVOP3a(Instruction* inst, int op, int src0, int src1,
+                        int src2, int vdst, int abs, int neg) {
+  Instruction::Bytes bytes = {};
+  bytes.vop3a.vdst = vdst;
+  bytes.vop3a.abs = abs;
+  bytes.vop3a.op = op;
+  bytes.vop3a.enc = 0x34;
+  bytes.vop3a.src0 = src0;
+  bytes.vop3a.src1 = src1;
+  bytes.vop3a.src2 = src2;
+  bytes.vop3a.neg = neg;
+  inst->Decode((char*)&bytes, 0);
+}
+
+// This test checks the whole-wavefront execution of VOP3a forms of vector
+// ALU instructions against per-work-item execution, including source
+// modifiers and scalar destinations of compares other than VCC.
+TEST(TestISAVOP2, wavefront_execution_vop3a) {
+  // Two work-groups with one full wavefront each
+  Disassembler::getInstance();
+  Emulator::getInstance();
+  NDRange ndrange(0);
+  unsigned global_size[1] = {128};
+  unsigned local_size[1] = {64};
+  ndrange.SetupSize(global_size, local_size, 1);
+  WorkGroup reference_work_group(&ndrange, 0);
+  WorkGroup work_group(&ndrange, 1);
+  Wavefront* reference = reference_work_group.getWavefront(0);
+  Wavefront* wavefront = work_group.getWavefront(0);
+
+  // Opcodes, and whether they take source modifiers
+  const std::pair<int, bool> instructions[] = {
+      {256, true},  {259, true},  {261, true},  {264, true},  {265, false},
+      {272, true},  {1, true},    {4, true},    {6, true},    {13, true},
+      {129, true},  {130, true},  {131, true},  {132, true},  {133, true},
+      {134, true},  {193, false}, {195, false}, {196, false}, {198, false}};
+
+  // Register values, mixing integers and special floating-point values
+  std::mt19937 random(4321);
+  const unsigned special_values[] = {0,          1,          31,
+                                     0x80000000, 0xffffffff, 0x3f800000,
+                                     0xbf800000, 0x7f800000, 0x7fc00000,
+                                     0x00000001, 0x007fffff, 0x00800000};
+  auto random_value = [&]() {
+    unsigned value = random();
+    if (value % 4) return value;
+    return special_values[(value >> 2) %
+                          (sizeof special_values / sizeof special_values[0])];
+  };
+
+  // Source operands: vector registers, scalar registers, and inline
+  // constants. Masks of V_CNDMASK_B32 and destinations of compares are
+  // VCC, EXEC, or a pair of scalar registers.
+  const int sources[] = {257, 258, 4, 129, 240};
+  const int masks[] = {Instruction::RegisterVcc, 6};
+  const int sdsts[] = {Instruction::RegisterVcc, Instruction::RegisterExec, 8};
+
+  Instruction inst;
+  for (auto& instruction : instructions) {
+    for (int src0 : sources) {
+      for (int src1 : sources) {
+        for (int trial = 0; trial < 4; trial++) {
+          // Modifiers. V_CNDMASK_B32 takes negation only.
+          int abs = instruction.second ? random() % 4 : 0;
+          int neg = instruction.second ? random() % 4 : 0;
+          if (instruction.first == 256) abs = 0;
+          int vdst = instruction.first < 256 ? sdsts[trial % 3] : trial % 4;
+          EncodeVOP3a(&inst, instruction.first, src0, src1, masks[trial % 2],
+                      vdst, abs, neg);
+          SCOPED_TRACE(misc::fmt("%s, src0 = %d, src1 = %d, trial %d",
+                                 inst.getName(), src0, src1, trial));
+
+          // Initial state
+          unsigned exec_lo = trial ? random() : 0xffffffff;
+          unsigned exec_hi = trial ? random() : 0xffffffff;
+          unsigned vcc_lo = random();
+          unsigned vcc_hi = random();
+          unsigned sreg_values[6];
+          for (unsigned& value : sreg_values) value = random_value();
+          for (Wavefront* w : {reference, wavefront}) {
+            w->setSregUint(Instruction::RegisterExec, exec_lo);
+            w->setSregUint(Instruction::RegisterExec + 1, exec_hi);
+            w->setSregUint(Instruction::RegisterVcc, vcc_lo);
+            w->setSregUint(Instruction::RegisterVcc + 1, vcc_hi);
+            for (int sreg = 4; sreg < 10; sreg++)
+              w->setSregUint(sreg, sreg_values[sreg - 4]);
+          }
+          for (int vreg = 0; vreg < 4; vreg++) {
+            for (int lane = 0; lane < Wavefront::NumLanes; lane++) {
+              unsigned value = random_value();
+              reference->setVregUint(vreg, lane, value);
+              wavefront->setVregUint(vreg, lane, value);
+            }
+          }
+
+          // Execute on each work-item and on the whole wavefront
+          for (int lane = 0; lane < Wavefront::NumLanes; lane++)
+            if (reference->isWorkItemActive(lane))
+              reference->getWorkItem(lane)->Execute(inst.getOpcode(), &inst);
+          ASSERT_TRUE(wavefront->ExecuteVectorAlu(&inst));
+
+          // Compare registers, except for NaN payloads
+          bool float_op = strstr(inst.getName(), "_F32");
+          for (int vreg = 0; vreg < 4; vreg++) {
+            for (int lane = 0; lane < Wavefront::NumLanes; lane++) {
+              Instruction::Register expected, actual;
+              expected.as_uint = reference->getVregUint(vreg, lane);
+              actual.as_uint = wavefront->getVregUint(vreg, lane);
+              if (float_op && std::isnan(expected.as_float) &&
+                  std::isnan(actual.as_float))
+                continue;
+              ASSERT_EQ(expected.as_uint, actual.as_uint)
+                  << "v" << vreg << ", lane " << lane;
+            }
+          }
+          for (int sreg : {4, 5, 6, 7, 8, 9}) {
+            EXPECT_EQ(reference->getSregUint(sreg),
+                      wavefront->getSregUint(sreg))
+                << "s" << sreg;
+          }
+          for (int sreg : {Instruction::RegisterVcc,
+                           Instruction::RegisterVcc + 1,
+                           Instruction::RegisterVccz,
+                           Instruction::RegisterExec,
+                           Instruction::RegisterExec + 1,
+                           Instruction::RegisterExecz}) {
+            EXPECT_EQ(reference->getSregUint(sreg),
+                      wavefront->getSregUint(sreg))
+                << "s" << sreg;
+          }
+        }
+      }
+    }
+  }
+
+  // Register access statistics match as well
+  EXPECT_EQ(reference_work_group.getSregReadCount(),
+            work_group.getSregReadCount());
+  EXPECT_EQ(reference_work_group.getSregWriteCount(),
+            work_group.getSregWriteCount());
+  EXPECT_EQ(reference_work_group.getVregReadCount(),
+            work_group.getVregReadCount());
+  EXPECT_EQ(reference_work_group.getVregWriteCount(),
+            work_group.getVregWriteCount());
+}
+
 }
@@ -0,0 +1,132 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <lib/cpp/Error.h>
+#include <memory/Memory.h>
+
+namespace SI {
+
+// Kernel adding 1 with buffer atomics to a counter per work-item index in
+// the wavefront at 'memory_base', and to a single counter shared by all
+// work-items at 'memory_base + 0x100'.
+//   s_mov_b32 s4, 0x10000
+//   s_mov_b32 s5, 0x40000        (stride 4)
+//   s_mov_b32 s6, 0x100
+//   s_mov_b32 s7, 0
+//   v_mov_b32 v1, 1
+//   buffer_atomic_add v1, v0, s[4:7], 0
+//   s_mov_b32 s4, 0x10100
+//   s_mov_b32 s5, 0              (stride 0)
+//   buffer_atomic_add v1, v0, s[4:7], 0
+//   s_waitcnt vmcnt(0) expcnt(0) lgkmcnt(0)
+//   s_endpgm
+static const unsigned kernel_code[] = {
+    0xbe8403ff, 0x00010000, 0xbe8503ff, 0x00040000, 0xbe8603ff,
+    0x00000100, 0xbe870380, 0x7e020281, 0xe0c80000, 0x80010100,
+    0xbe8403ff, 0x00010100, 0xbe850380, 0xe0c80000, 0x80010100,
+    0xbf8c0000, 0xbf810000};
+
+// Number of instructions run by each wavefront of the kernel
+static const long long kernel_num_instructions = 11;
+
+// Global memory address of the counters written by the kernel
+static const unsigned memory_base = 0x10000;
+
+// Number of 32-bit counters written by the kernel
+static const unsigned memory_num_counters = 65;
+
+// Number of work-items in a work-group, one wavefront
+static const unsigned local_size = 64;
+
+// Number of work-groups, more than fit in one batch of the host threads
+static const unsigned num_work_groups = 40;
+
+// Run the kernel functionally on the given number of host threads, and
+// return the number of emulated instructions and the counters written by
+// the kernel
+static long long RunKernel(int num_host_threads,
+                           std::vector<unsigned>& memory) {
+  // Create emulator
+  Emulator::Destroy();
+  Emulator::setNumHostThreads(num_host_threads);
+  Emulator* emulator = Emulator::getInstance();
+
+  // Global memory with the counters set to zero
+  mem::Memory* global_memory = emulator->getGlobalMemory();
+  global_memory->Map(memory_base, mem::Memory::PageSize,
+                     mem::Memory::AccessRead | mem::Memory::AccessWrite);
+
+  // NDRange with all work-groups waiting
+  NDRange* ndrange = emulator->addNDRange(0);
+  unsigned global_size[1] = {num_work_groups * local_size};
+  unsigned local_size[1] = {SI::local_size};
+  ndrange->SetupSize(global_size, local_size, 1);
+  ndrange->SetupInstructionMemory((const char*)kernel_code,
+                                  sizeof(kernel_code), 0);
+  ndrange->setNumVgprUsed(4);
+  ndrange->setNumSgprUsed(16);
+  for (unsigned id = 0; id < num_work_groups; id++)
+    ndrange->AddWorkgroupIdToWaitingList(id);
+
+  // Emulate until all work-groups finish
+  while (!ndrange->isWaitingWorkGroupsEmpty()) emulator->Run();
+  EXPECT_TRUE(ndrange->isRunningWorkGroupsEmpty());
+
+  // Results
+  memory.resize(memory_num_counters);
+  global_memory->Read(memory_base, memory_num_counters * 4,
+                      (char*)memory.data());
+  return emulator->getNumInstructions();
+}
+
+// This test checks that executing work-groups on multiple host threads
+// gives the same global memory and instruction counts as the sequential
+// emulation, with all work-items adding atomically to a shared counter
+TEST(TestParallel, host_threads) {
+  int saved_num_host_threads = Emulator::getNumHostThreads();
+  try {
+    std::vector<unsigned> memory;
+    long long num_instructions = RunKernel(1, memory);
+
+    // Every work-item added to its own counter and to the shared one
+    for (unsigned i = 0; i < local_size; i++)
+      EXPECT_EQ(num_work_groups, memory[i]);
+    EXPECT_EQ(num_work_groups * local_size, memory[local_size]);
+    EXPECT_EQ(num_work_groups * kernel_num_instructions, num_instructions);
+
+    // Same results with host threads
+    std::vector<unsigned> parallel_memory;
+    long long parallel_num_instructions = RunKernel(3, parallel_memory);
+    EXPECT_EQ(memory, parallel_memory);
+    EXPECT_EQ(num_instructions, parallel_num_instructions);
+  } catch (misc::Exception& e) {
+    std::cerr << "Exception in SI emulation: " << e.getMessage() << "\n";
+    ADD_FAILURE();
+  }
+  Emulator::setNumHostThreads(saved_num_host_threads);
+  Emulator::Destroy();
+}
+
+}  // namespace SI
@@ -0,0 +1,77 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <algorithm>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <arch/southern-islands/timing/ComputeUnitStatistics.h>
+
+namespace SI {
+
+// This test checks that counters are added and subtracted one by one, as
+// done to obtain the counters of an interval or an NDRange
+TEST(TestComputeUnitStatistics, add_subtract) {
+  ComputeUnitStats stats;
+  stats.Increment(CounterInstructions, 10);
+  stats.Increment(CounterStallDecode);
+
+  // Add
+  ComputeUnitStats total;
+  total.Add(stats);
+  total.Add(stats);
+  EXPECT_EQ(20, total[CounterInstructions]);
+  EXPECT_EQ(2, total[CounterStallDecode]);
+  EXPECT_EQ(0, total[CounterWorkGroups]);
+
+  // Subtract
+  total.Subtract(stats);
+  EXPECT_EQ(10, total[CounterInstructions]);
+  EXPECT_EQ(1, total[CounterStallDecode]);
+}
+
+// This test checks that every counter is dumped by name, in the report
+// and in the time series
+TEST(TestComputeUnitStatistics, dump) {
+  ComputeUnitStats stats;
+  stats.Increment(CounterWorkGroups, 3);
+  stats.Increment(CounterVectorMemoryDivergence, 5);
+
+  // Report
+  std::ostringstream report;
+  report << stats;
+  std::string text = report.str();
+  EXPECT_EQ(0u, text.find("WorkGroupCount = 3\n"));
+  EXPECT_NE(std::string::npos, text.find("\nVectorMemDivergence = 5\n"));
+  EXPECT_EQ(CounterMax, std::count(text.begin(), text.end(), '\n'));
+
+  // Time series
+  std::ostringstream fields;
+  std::ostringstream values;
+  ComputeUnitStats::DumpFields(fields);
+  stats.DumpValues(values);
+  std::string line = values.str();
+  EXPECT_EQ(0u, fields.str().find("WorkGroupCount,Instructions,"));
+  EXPECT_EQ(0u, line.find("3,0,"));
+  EXPECT_EQ(CounterMax - 1, std::count(line.begin(), line.end(), ','));
+}
+
+}  // namespace SI
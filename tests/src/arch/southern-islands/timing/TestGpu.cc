@@ -0,0 +1,681 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
+#include <arch/southern-islands/emulator/WorkGroup.h>
+#include <arch/southern-islands/timing/ComputeUnit.h>
+#include <arch/southern-islands/timing/Dispatcher.h>
+#include <arch/southern-islands/timing/Gpu.h>
+#include <arch/southern-islands/timing/Sampler.h>
+#include <arch/southern-islands/timing/Timing.h>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+#include <lib/esim/Engine.h>
+#include <memory/System.h>
+#include <network/System.h>
+
+namespace SI {
+
+static void Cleanup() {
+  esim::Engine::Destroy();
+  Timing::Destroy();
+  Emulator::Destroy();
+  mem::System::Destroy();
+  net::System::Destroy();
+  comm::ArchPool::Destroy();
+}
+
+// Kernel executed by every wavefront. All instructions run on the scalar
+// unit, so that the last one completes the wavefront.
+//   s_mov_b32 s0, 1
+//   s_add_u32 s0, 1, s0   (x 8)
+//   s_endpgm
+static const unsigned kernel_code[] = {
+    0xbe800381, 0x80000081, 0x80000081, 0x80000081, 0x80000081,
+    0x80000081, 0x80000081, 0x80000081, 0x80000081, 0xbf810000};
+
+// Kernel adding 1 with a buffer atomic to a counter per work-item index in
+// the wavefront, so that work-groups running on different compute units
+// update the same counters.
+//   s_mov_b32 s4, 0x10000
+//   s_mov_b32 s5, 0x40000        (stride 4)
+//   s_mov_b32 s6, 0x100
+//   s_mov_b32 s7, 0
+//   v_mov_b32 v1, 1
+//   buffer_atomic_add v1, v0, s[4:7], 0
+//   s_waitcnt vmcnt(0) expcnt(0) lgkmcnt(0)
+//   s_endpgm
+static const unsigned memory_kernel_code[] = {
+    0xbe8403ff, 0x00010000, 0xbe8503ff, 0x00040000, 0xbe8603ff, 0x00000100,
+    0xbe870380, 0x7e020281, 0xe0c80000, 0x80010100, 0xbf8c0000, 0xbf810000};
+
+// Global memory address of the counters written by the memory kernel
+static const unsigned memory_base = 0x10000;
+
+// Number of work-items in a work-group, one wavefront
+static const unsigned local_size = 64;
+
+// Rethrow an error of the simulator as a standard exception, whose message
+// is reported by the test framework when it aborts the test
+[[noreturn]] static void Rethrow(const misc::Exception& e) {
+  throw std::runtime_error("Exception in SI timing simulation: " +
+                           e.getMessage());
+}
+
+// Saves the static configuration of the GPU when created, and restores it
+// when destroyed, so that tests do not affect each other.
+class ConfigurationGuard {
+  int num_compute_units = Gpu::num_compute_units;
+  int compute_units_per_cluster = Gpu::compute_units_per_cluster;
+  int max_work_groups_per_compute_unit =
+      Gpu::max_work_groups_per_compute_unit;
+  int num_host_threads = Gpu::num_host_threads;
+  unsigned max_wavefront_count = Gpu::max_wavefront_count;
+  unsigned count_completed_wavefronts = Gpu::count_completed_wavefronts;
+  Dispatcher::Kind dispatcher_kind = Dispatcher::kind;
+  Sampler::Kind sampler_kind = Sampler::kind;
+  int num_detailed_work_groups = Sampler::num_detailed_work_groups;
+  unsigned seed = Sampler::seed;
+  bool skip_idle_cycles = ComputeUnit::skip_idle_cycles;
+
+ public:
+  ~ConfigurationGuard() {
+    Gpu::num_compute_units = num_compute_units;
+    Gpu::compute_units_per_cluster = compute_units_per_cluster;
+    Gpu::max_work_groups_per_compute_unit = max_work_groups_per_compute_unit;
+    Gpu::num_host_threads = num_host_threads;
+    Gpu::max_wavefront_count = max_wavefront_count;
+    Gpu::count_completed_wavefronts = count_completed_wavefronts;
+    Dispatcher::kind = dispatcher_kind;
+    Sampler::kind = sampler_kind;
+    Sampler::num_detailed_work_groups = num_detailed_work_groups;
+    Sampler::seed = seed;
+    ComputeUnit::skip_idle_cycles = skip_idle_cycles;
+    Cleanup();
+  }
+};
+
+// Create the emulator and the timing simulator with the given variables in
+// section [ Device ] of the configuration file, optionally followed by
+// other sections
+static Timing* Configure(const std::string& config) {
+  // Cleanup singleton instances
+  Cleanup();
+
+  // Options are read with their current value as default, so start from
+  // a known configuration
+  Gpu::num_host_threads = 1;
+  Gpu::compute_units_per_cluster = 1;
+  Gpu::max_work_groups_per_compute_unit = 0;
+  Gpu::count_completed_wavefronts = 0;
+  Dispatcher::kind = Dispatcher::KindRoundRobin;
+  Sampler::kind = Sampler::KindNone;
+  Sampler::num_detailed_work_groups = 0;
+  Sampler::seed = 1;
+  ComputeUnit::skip_idle_cycles = true;
+
+  // Parse configuration. The frequency is given, since the configuration
+  // tests leave an invalid one.
+  try {
+    misc::IniFile ini_file;
+    ini_file.LoadFromString("[ Device ]\nFrequency = 1000\n" + config);
+    Timing::ParseConfiguration(&ini_file);
+
+    // Create emulator and timing simulator
+    Emulator::getInstance();
+    return Timing::getInstance();
+  } catch (misc::Exception& e) {
+    Rethrow(e);
+  }
+}
+
+// Add work-groups to the waiting list of an NDRange, as the driver call
+// 'NDRangeSendWorkGroups' does
+static void SendWorkGroups(NDRange* ndrange, unsigned first, unsigned count) {
+  for (unsigned id = first; id < first + count; id++)
+    ndrange->AddWorkgroupIdToWaitingList(id);
+}
+
+// Create an NDRange running a kernel in the given number of work-groups,
+// and optionally send all of them to the waiting list
+static NDRange* NewNDRange(unsigned num_work_groups,
+                           bool send_work_groups = true,
+                           const unsigned* code = kernel_code,
+                           unsigned code_size = sizeof(kernel_code)) {
+  Emulator* emulator = Emulator::getInstance();
+  NDRange* ndrange = emulator->addNDRange(0);
+  unsigned global_size[1] = {num_work_groups * local_size};
+  unsigned local_size[1] = {SI::local_size};
+  ndrange->SetupSize(global_size, local_size, 1);
+  ndrange->SetupInstructionMemory((const char*)code, code_size, 0);
+  ndrange->setNumVgprUsed(4);
+  ndrange->setNumSgprUsed(16);
+  if (send_work_groups) SendWorkGroups(ndrange, 0, num_work_groups);
+  return ndrange;
+}
+
+// Map an NDRange to the GPU before the first simulated cycle, as the
+// timing simulator does when it first finds the NDRange
+static void MapNDRange(NDRange* ndrange) {
+  Gpu* gpu = Timing::getInstance()->getGpu();
+  ndrange->address_space = gpu->getMmu()->newSpace("Southern Islands");
+  ndrange->instruction_space =
+      gpu->getMmu()->newSpace("Southern Islands Instructions");
+  gpu->MapNDRange(ndrange);
+
+  // The limit in completed wavefronts is computed for the last mapped
+  // NDRange alone, so it would stop simulation before the others finish
+  Gpu::max_wavefront_count = 0;
+}
+
+// Simulate one GPU cycle
+static void RunCycle() {
+  try {
+    Timing::getInstance()->Run();
+    esim::Engine::getInstance()->ProcessEvents();
+  } catch (misc::Exception& e) {
+    Rethrow(e);
+  }
+}
+
+// Simulate until all NDRanges finish and are removed from the emulator, as
+// the driver does once the timing simulator unmaps them. Return the number
+// of simulated cycles.
+static long long RunNDRanges() {
+  Emulator* emulator = Emulator::getInstance();
+  Timing* timing = Timing::getInstance();
+  Gpu* gpu = timing->getGpu();
+  while (emulator->getNumNDRanges()) {
+    RunCycle();
+    for (auto it = emulator->getNDRangesBegin();
+         it != emulator->getNDRangesEnd();) {
+      NDRange* ndrange = (it++)->get();
+      if (ndrange->LastWorkGroupSent() && ndrange->isRunningWorkGroupsEmpty() &&
+          gpu->getMappedNDRangeIndex(ndrange) < 0)
+        emulator->RemoveNDRange(ndrange);
+    }
+    if (timing->getCycle() > 100000)
+      throw std::runtime_error("NDRanges did not finish");
+  }
+  return timing->getCycle();
+}
+
+// Map an NDRange with the given number of work-groups and simulate one
+// cycle, in which all of them are dispatched. Return the identifiers of the
+// work-groups simulated in detail, the only ones still running after
+// dispatch.
+static std::set<int> getDetailedWorkGroups(unsigned num_work_groups) {
+  NDRange* ndrange = NewNDRange(num_work_groups);
+  MapNDRange(ndrange);
+  RunCycle();
+  EXPECT_TRUE(ndrange->isWaitingWorkGroupsEmpty());
+  std::set<int> ids;
+  for (auto it = ndrange->getWorkGroupsBegin(), e = ndrange->getWorkGroupsEnd();
+       it != e; ++it)
+    ids.insert((*it)->getId());
+  return ids;
+}
+
+// This test checks that the round-robin dispatcher alternates compute units
+// as they become available
+TEST(TestGpu, dispatch_round_robin) {
+  ConfigurationGuard guard;
+  Timing* timing = Configure(
+      "NumComputeUnits = 2\n"
+      "DispatchKind = RoundRobin");
+  Gpu* gpu = timing->getGpu();
+
+  // Map two NDRanges, with 3 and 1 work-groups
+  NDRange* ndrange_0 = NewNDRange(3);
+  NDRange* ndrange_1 = NewNDRange(1);
+  MapNDRange(ndrange_0);
+  MapNDRange(ndrange_1);
+
+  // All work-groups fit in the GPU, and they are spread evenly
+  RunCycle();
+  EXPECT_EQ(2, gpu->getComputeUnit(0)->getNumWorkGroups());
+  EXPECT_EQ(2, gpu->getComputeUnit(1)->getNumWorkGroups());
+
+  // Run to completion
+  RunNDRanges();
+  EXPECT_EQ(2, gpu->getComputeUnit(0)->stats[CounterWorkGroups]);
+  EXPECT_EQ(2, gpu->getComputeUnit(1)->stats[CounterWorkGroups]);
+
+  // Counters of NDRanges that ran concurrently are not recorded
+  EXPECT_TRUE(gpu->getNDRangeCounters().empty());
+}
+
+// This test checks that the spatial dispatcher gives each of two NDRanges
+// its own half of the compute units
+TEST(TestGpu, dispatch_spatial) {
+  ConfigurationGuard guard;
+  Timing* timing = Configure(
+      "NumComputeUnits = 2\n"
+      "DispatchKind = Spatial");
+  Gpu* gpu = timing->getGpu();
+
+  // Map two NDRanges, with 3 and 1 work-groups
+  NDRange* ndrange_0 = NewNDRange(3);
+  NDRange* ndrange_1 = NewNDRange(1);
+  MapNDRange(ndrange_0);
+  MapNDRange(ndrange_1);
+
+  // Each NDRange only uses its partition
+  RunCycle();
+  EXPECT_EQ(3, gpu->getComputeUnit(0)->getNumWorkGroups());
+  EXPECT_EQ(1, gpu->getComputeUnit(1)->getNumWorkGroups());
+
+  // Run to completion
+  RunNDRanges();
+  EXPECT_EQ(3, gpu->getComputeUnit(0)->stats[CounterWorkGroups]);
+  EXPECT_EQ(1, gpu->getComputeUnit(1)->stats[CounterWorkGroups]);
+}
+
+// This test checks that the tail-aware dispatcher does not give a compute
+// unit more than its share of the work-groups of an NDRange, even when it
+// is the only one with free resources
+TEST(TestGpu, dispatch_tail_aware) {
+  ConfigurationGuard guard;
+  Timing* timing = Configure(
+      "NumComputeUnits = 2\n"
+      "MaxWorkGroupsPerComputeUnit = 4\n"
+      "DispatchKind = TailAware");
+  Gpu* gpu = timing->getGpu();
+  Dispatcher* dispatcher = gpu->getDispatcher();
+  ComputeUnit* compute_unit_0 = gpu->getComputeUnit(0);
+  ComputeUnit* compute_unit_1 = gpu->getComputeUnit(1);
+
+  // NDRange with 4 work-groups, whose share is 4 / 2 + 1 = 3 work-groups
+  // per compute unit
+  NDRange* ndrange = NewNDRange(4);
+  MapNDRange(ndrange);
+
+  // Dispatch with compute unit 1 unavailable. Compute unit 0 could fit
+  // all work-groups, but it only takes its share.
+  gpu->RemoveFromAvailableComputeUnits(compute_unit_1);
+  int num_dispatched = 0;
+  while (ComputeUnit* compute_unit = dispatcher->getComputeUnit(ndrange)) {
+    EXPECT_EQ(compute_unit_0, compute_unit);
+    WorkGroup* work_group =
+        ndrange->ScheduleWorkGroup(ndrange->GetWaitingWorkGroup());
+    gpu->RemoveFromAvailableComputeUnits(compute_unit);
+    compute_unit->MapWorkGroup(work_group);
+    dispatcher->MapWorkGroup(ndrange, compute_unit);
+    num_dispatched++;
+  }
+  EXPECT_EQ(3, num_dispatched);
+  EXPECT_TRUE(compute_unit_0->canMapWorkGroup(ndrange));
+
+  // The last work-group goes to compute unit 1 once available
+  gpu->InsertInAvailableComputeUnits(compute_unit_1);
+  RunNDRanges();
+  EXPECT_EQ(3, compute_unit_0->stats[CounterWorkGroups]);
+  EXPECT_EQ(1, compute_unit_1->stats[CounterWorkGroups]);
+}
+
+// This test checks that sampling with the 'First' policy simulates the
+// first work-groups in detail
+TEST(TestGpu, sampling_first) {
+  ConfigurationGuard guard;
+  Configure(
+      "NumComputeUnits = 1\n"
+      "[ Sampling ]\n"
+      "Kind = First\n"
+      "WorkGroups = 3");
+  EXPECT_EQ(std::set<int>({0, 1, 2}), getDetailedWorkGroups(10));
+  RunNDRanges();
+}
+
+// This test checks that sampling with the 'Random' policy simulates exactly
+// the given number of work-groups in detail, and picks the same ones for
+// the same seed
+TEST(TestGpu, sampling_random) {
+  ConfigurationGuard guard;
+  std::string config =
+      "NumComputeUnits = 1\n"
+      "[ Sampling ]\n"
+      "Kind = Random\n"
+      "WorkGroups = 3\n"
+      "Seed = 7";
+  Configure(config);
+  std::set<int> ids = getDetailedWorkGroups(10);
+  RunNDRanges();
+  EXPECT_EQ(3u, ids.size());
+  for (int id : ids) {
+    EXPECT_GE(id, 0);
+    EXPECT_LT(id, 10);
+  }
+
+  // Same sample with the same seed
+  Configure(config);
+  EXPECT_EQ(ids, getDetailedWorkGroups(10));
+  RunNDRanges();
+}
+
+// This test checks that sampling with the 'Stratified' policy simulates one
+// work-group in detail from each group of consecutive work-groups
+TEST(TestGpu, sampling_stratified) {
+  ConfigurationGuard guard;
+  Configure(
+      "NumComputeUnits = 1\n"
+      "[ Sampling ]\n"
+      "Kind = Stratified\n"
+      "WorkGroups = 3");
+  std::set<int> ids = getDetailedWorkGroups(10);
+  RunNDRanges();
+
+  // Strata are work-groups 0-2, 3-5, and 6-9
+  ASSERT_EQ(3u, ids.size());
+  auto it = ids.begin();
+  EXPECT_LE(*it, 2);
+  ++it;
+  EXPECT_GE(*it, 3);
+  EXPECT_LE(*it, 5);
+  ++it;
+  EXPECT_GE(*it, 6);
+  EXPECT_LE(*it, 9);
+}
+
+// This test checks the statistics extrapolated from a sample. With one
+// work-group running at a time, 2 out of 8 work-groups take 2 out of 8
+// waves of work-groups, so cycles are scaled by 4.
+TEST(TestGpu, sampling_extrapolation) {
+  ConfigurationGuard guard;
+  Timing* timing = Configure(
+      "NumComputeUnits = 1\n"
+      "MaxWorkGroupsPerComputeUnit = 1\n"
+      "[ Sampling ]\n"
+      "Kind = First\n"
+      "WorkGroups = 2");
+  NDRange* ndrange = NewNDRange(8);
+  int id = ndrange->getId();
+  MapNDRange(ndrange);
+  RunNDRanges();
+
+  // Read report
+  std::ostringstream report;
+  timing->getGpu()->getSampler()->DumpReport(report);
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(report.str());
+  std::string section = misc::fmt("Sample.NDRange %d", id);
+
+  // Work-groups
+  EXPECT_EQ(8, ini_file.ReadInt(section, "WorkGroups"));
+  EXPECT_EQ(2, ini_file.ReadInt(section, "DetailedWorkGroups"));
+  EXPECT_EQ(6, ini_file.ReadInt(section, "FunctionalWorkGroups"));
+
+  // Cycles
+  long long detailed_cycles = ini_file.ReadInt64(section, "DetailedCycles");
+  EXPECT_GT(detailed_cycles, 0);
+  EXPECT_EQ(detailed_cycles * 4,
+            ini_file.ReadInt64(section, "EstimatedCycles"));
+
+  // Every work-group runs one wavefront of 10 instructions
+  EXPECT_EQ(20, ini_file.ReadInt(section, "DetailedInstructions"));
+  EXPECT_EQ(80, ini_file.ReadInt(section, "Instructions"));
+}
+
+// Configure the memory hierarchy with one main memory module used as the
+// instruction cache of all compute units. The main memory is also the data
+// cache, unless each compute unit is given its own L1 cache.
+static void ConfigureMemory(int num_compute_units, bool data_caches = false) {
+  std::string mem_config_string =
+      "[ General ]\n"
+      "[ Module mod-mm ]\n"
+      "Type = MainMemory\n"
+      "Latency = 20\n"
+      "BlockSize = 64\n";
+  if (data_caches)
+    mem_config_string +=
+        "HighNetwork = net-l1-mm\n"
+        "[ CacheGeometry geo-l1 ]\n"
+        "Sets = 16\n"
+        "Assoc = 2\n"
+        "BlockSize = 64\n"
+        "Latency = 2\n"
+        "[ Network net-l1-mm ]\n"
+        "DefaultInputBufferSize = 1024\n"
+        "DefaultOutputBufferSize = 1024\n"
+        "DefaultBandwidth = 64\n";
+  for (int i = 0; i < num_compute_units; i++) {
+    if (data_caches)
+      mem_config_string += misc::fmt(
+          "[ Module mod-l1-%d ]\n"
+          "Type = Cache\n"
+          "Geometry = geo-l1\n"
+          "LowNetwork = net-l1-mm\n"
+          "LowModules = mod-mm\n",
+          i);
+    mem_config_string += misc::fmt(
+        "[ Entry cu-%d ]\n"
+        "Arch = SouthernIslands\n"
+        "ComputeUnit = %d\n"
+        "Module = %s\n"
+        "InstructionModule = mod-mm\n",
+        i, i, data_caches ? misc::fmt("mod-l1-%d", i).c_str() : "mod-mm");
+  }
+  try {
+    misc::IniFile mem_config_ini;
+    mem_config_ini.LoadFromString(mem_config_string);
+    mem::System::getInstance()->ReadConfiguration(&mem_config_ini);
+  } catch (misc::Exception& e) {
+    Rethrow(e);
+  }
+}
+
+// Run 6 work-groups of the scalar test kernel with an instruction memory,
+// and return the number of cycles, the counters of all compute units, and
+// the number of sleeping cycles of each
+static long long RunWithInstructionMemory(
+    bool skip_idle_cycles, std::vector<long long>& counters,
+    std::vector<long long>& sleeping_cycles) {
+  // Configure GPU
+  const int num_compute_units = 2;
+  Timing* timing = Configure(misc::fmt(
+      "NumComputeUnits = %d\n"
+      "[ ComputeUnit ]\n"
+      "SkipIdleCycles = %s",
+      num_compute_units, skip_idle_cycles ? "True" : "False"));
+  ConfigureMemory(num_compute_units);
+
+  // Simulate
+  MapNDRange(NewNDRange(6));
+  long long cycles = RunNDRanges();
+
+  // Statistics
+  counters.clear();
+  sleeping_cycles.clear();
+  Gpu* gpu = timing->getGpu();
+  for (int i = 0; i < num_compute_units; i++) {
+    ComputeUnit* compute_unit = gpu->getComputeUnit(i);
+    for (int counter = 0; counter < CounterMax; counter++)
+      counters.push_back(compute_unit->stats[(Counter)counter]);
+    sleeping_cycles.push_back(compute_unit->getNumSleepingCycles());
+  }
+  return cycles;
+}
+
+// This test checks that skipping the cycles in which compute units are idle
+// does not change simulation results
+TEST(TestGpu, skip_idle_cycles) {
+  ConfigurationGuard guard;
+  std::vector<long long> counters;
+  std::vector<long long> sleeping_cycles;
+  long long cycles = RunWithInstructionMemory(false, counters, sleeping_cycles);
+  for (long long value : sleeping_cycles) EXPECT_EQ(0, value);
+
+  std::vector<long long> skip_counters;
+  std::vector<long long> skip_sleeping_cycles;
+  long long skip_cycles =
+      RunWithInstructionMemory(true, skip_counters, skip_sleeping_cycles);
+  for (long long value : skip_sleeping_cycles) EXPECT_GT(value, 0);
+
+  // Same results
+  EXPECT_EQ(cycles, skip_cycles);
+  EXPECT_EQ(counters, skip_counters);
+}
+
+// This test checks that the port of a shared instruction cache is granted
+// in round-robin order among the compute units requesting it, so that the
+// cycles of idle sharers are not wasted
+TEST(TestGpu, instruction_cache_port) {
+  InstructionCachePort port(4);
+  for (int sharer = 0; sharer < 4; sharer++) EXPECT_FALSE(port.isOwner(sharer));
+
+  // A lone requester owns the port in every cycle
+  for (int i = 0; i < 3; i++) {
+    port.Request(2);
+    port.Arbitrate();
+    EXPECT_TRUE(port.isOwner(2));
+  }
+
+  // Requesters take turns, starting after the last owner
+  for (int expected : {3, 0, 2, 3}) {
+    port.Request(0);
+    port.Request(2);
+    port.Request(3);
+    port.Arbitrate();
+    EXPECT_TRUE(port.isOwner(expected));
+  }
+
+  // Requests are cleared after each arbitration
+  port.Arbitrate();
+  for (int sharer = 0; sharer < 4; sharer++) EXPECT_FALSE(port.isOwner(sharer));
+}
+
+// This test checks that an NDRange whose work-groups arrive in two driver
+// batches is mapped again for the second one, after being unmapped when
+// the first one drained
+TEST(TestGpu, send_work_groups_in_batches) {
+  ConfigurationGuard guard;
+  Timing* timing = Configure("NumComputeUnits = 2");
+  Gpu* gpu = timing->getGpu();
+
+  // The timing simulator maps the NDRange when it first finds it
+  NDRange* ndrange = NewNDRange(4, false);
+  int ndrange_id = ndrange->getId();
+  SendWorkGroups(ndrange, 0, 2);
+  RunCycle();
+  EXPECT_EQ(1, gpu->getNumMappedNDRanges());
+
+  // Run the first batch until the NDRange is unmapped
+  while (gpu->getNumMappedNDRanges()) {
+    RunCycle();
+    ASSERT_LE(timing->getCycle(), 100000) << "First batch did not finish";
+  }
+  EXPECT_TRUE(ndrange->isRunningWorkGroupsEmpty());
+
+  // Send the second batch, which maps the NDRange again
+  SendWorkGroups(ndrange, 2, 2);
+  RunCycle();
+  EXPECT_EQ(1, gpu->getNumMappedNDRanges());
+  EXPECT_FALSE(ndrange->isRunningWorkGroupsEmpty());
+
+  // Run to completion
+  RunNDRanges();
+  EXPECT_EQ(0, gpu->getNumMappedNDRanges());
+  EXPECT_EQ(2, gpu->getComputeUnit(0)->stats[CounterWorkGroups]);
+  EXPECT_EQ(2, gpu->getComputeUnit(1)->stats[CounterWorkGroups]);
+
+  // The counters of the NDRange, already removed, include both batches
+  auto& ndrange_counters = gpu->getNDRangeCounters();
+  ASSERT_EQ(1u, ndrange_counters.size());
+  EXPECT_EQ(ndrange_id, ndrange_counters.begin()->first);
+  EXPECT_EQ(4, ndrange_counters.begin()->second[CounterWorkGroups]);
+}
+
+// Run 8 work-groups of the memory kernel on the given number of host
+// threads, and return the number of cycles, the counters of all compute
+// units, the number of emulated instructions, and the counters written by
+// the kernel
+static long long RunMemoryKernel(int num_host_threads,
+                                 std::vector<long long>& counters,
+                                 long long& num_instructions,
+                                 std::vector<unsigned>& memory) {
+  // Configure GPU
+  const int num_compute_units = 4;
+  Timing* timing = Configure(misc::fmt(
+      "NumComputeUnits = %d\n"
+      "HostThreads = %d",
+      num_compute_units, num_host_threads));
+  ConfigureMemory(num_compute_units, true);
+
+  // Retry latencies of the memory hierarchy are random, so every run starts
+  // from the same sequence
+  srandom(1);
+
+  // Global memory with the counters set to zero
+  mem::Memory* global_memory = Emulator::getInstance()->getGlobalMemory();
+  global_memory->Map(memory_base, mem::Memory::PageSize,
+                     mem::Memory::AccessRead | mem::Memory::AccessWrite);
+
+  // Simulate
+  MapNDRange(NewNDRange(8, true, memory_kernel_code,
+                        sizeof(memory_kernel_code)));
+  long long cycles = RunNDRanges();
+
+  // Results
+  counters.clear();
+  Gpu* gpu = timing->getGpu();
+  for (int i = 0; i < num_compute_units; i++)
+    for (int counter = 0; counter < CounterMax; counter++)
+      counters.push_back(gpu->getComputeUnit(i)->stats[(Counter)counter]);
+  num_instructions = Emulator::getInstance()->getNumInstructions();
+  memory.resize(local_size);
+  global_memory->Read(memory_base, local_size * 4, (char*)memory.data());
+  return cycles;
+}
+
+// This test checks that simulating compute units on multiple host threads
+// gives the same results as the sequential simulation
+TEST(TestGpu, host_threads) {
+  ConfigurationGuard guard;
+  std::vector<long long> counters;
+  std::vector<unsigned> memory;
+  long long num_instructions;
+  long long cycles = RunMemoryKernel(1, counters, num_instructions, memory);
+
+  // Each counter was incremented once by each of the 8 work-groups
+  for (unsigned i = 0; i < local_size; i++) EXPECT_EQ(8u, memory[i]);
+  EXPECT_EQ(8 * 8, num_instructions);
+
+  std::vector<long long> parallel_counters;
+  std::vector<unsigned> parallel_memory;
+  long long parallel_num_instructions;
+  long long parallel_cycles = RunMemoryKernel(
+      3, parallel_counters, parallel_num_instructions, parallel_memory);
+
+  // Same results
+  EXPECT_EQ(cycles, parallel_cycles);
+  EXPECT_EQ(counters, parallel_counters);
+  EXPECT_EQ(num_instructions, parallel_num_instructions);
+  EXPECT_EQ(memory, parallel_memory);
+}
+
+}  // namespace SI
@@ -19,6 +19,9 @@
 
 #include <gtest/gtest.h>
 
+#include <arch/southern-islands/timing/Dispatcher.h>
+#include <arch/southern-islands/timing/Gpu.h>
+#include <arch/southern-islands/timing/Sampler.h>
 #include <arch/southern-islands/timing/Timing.h>
 #include <lib/cpp/IniFile.h>
 #include <lib/esim/Engine.h>
@@ -93,4 +96,163 @@ TEST(TestTiming, config_section_device_frequency_1) {
                      message.c_str());
 }
 
+// This test checks to see if the correct error message is returned when
+// the number of host threads simulating compute units is not positive
+TEST(TestTiming, config_section_device_host_threads) {
+  // Cleanup singleton instances
+  Cleanup();
+
+  // Create config file. The frequency is given, since the previous tests
+  // left an invalid one.
+  std::string config =
+      "[ Device ]\n"
+      "Frequency = 1000\n"
+      "HostThreads = 0";
+
+  // Load config file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+
+  // Try ParseConfiguration for invalid number of host threads
+  std::string message;
+  try {
+    Timing::ParseConfiguration(&ini_file);
+  } catch (misc::Error& error) {
+    message = error.getMessage();
+  }
+
+  // Check error message
+  EXPECT_REGEX_MATCH(misc::fmt(".*%s: The value for 'HostThreads' "
+                               "must be at least 1.\n.*",
+                               ini_file.getPath().c_str())
+                         .c_str(),
+                     message.c_str());
+}
+
+// This test checks to see if the correct error message is returned when
+// the maximum number of work-groups per compute unit is negative
+TEST(TestTiming, config_section_device_max_work_groups_per_compute_unit) {
+  // Cleanup singleton instances
+  Cleanup();
+
+  // Save the static configuration changed by this test
+  Dispatcher::Kind dispatcher_kind = Dispatcher::kind;
+  int max_work_groups_per_compute_unit =
+      Gpu::max_work_groups_per_compute_unit;
+
+  // Create config file. The frequency and the number of host threads are
+  // given, since the previous tests left invalid ones.
+  std::string config =
+      "[ Device ]\n"
+      "Frequency = 1000\n"
+      "HostThreads = 1\n"
+      "DispatchKind = TailAware\n"
+      "MaxWorkGroupsPerComputeUnit = -1";
+
+  // Load config file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+
+  // Try ParseConfiguration for invalid work-group limit
+  std::string message;
+  try {
+    Timing::ParseConfiguration(&ini_file);
+  } catch (misc::Error& error) {
+    message = error.getMessage();
+  }
+
+  // Check error message and dispatch policy read before the error
+  EXPECT_REGEX_MATCH(misc::fmt(".*%s: The value for "
+                               "'MaxWorkGroupsPerComputeUnit' cannot be "
+                               "negative.\n.*",
+                               ini_file.getPath().c_str())
+                         .c_str(),
+                     message.c_str());
+  EXPECT_EQ(Dispatcher::KindTailAware, Dispatcher::kind);
+
+  // Restore the static configuration for the tests running afterwards
+  Dispatcher::kind = dispatcher_kind;
+  Gpu::max_work_groups_per_compute_unit = max_work_groups_per_compute_unit;
+}
+
+// This test checks to see if the correct error message is returned when
+// sampling is enabled with no work-groups simulated in detail
+TEST(TestTiming, config_section_sampling_work_groups) {
+  // Cleanup singleton instances
+  Cleanup();
+
+  // Save the static configuration changed by this test
+  Sampler::Kind sampler_kind = Sampler::kind;
+  int num_detailed_work_groups = Sampler::num_detailed_work_groups;
+
+  // Create config file. Device variables are given, since the previous
+  // tests left invalid ones.
+  std::string config =
+      "[ Device ]\n"
+      "Frequency = 1000\n"
+      "HostThreads = 1\n"
+      "MaxWorkGroupsPerComputeUnit = 0\n"
+      "[ Sampling ]\n"
+      "Kind = Stratified\n"
+      "WorkGroups = 0";
+
+  // Load config file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+
+  // Try ParseConfiguration for invalid sample size
+  std::string message;
+  try {
+    Timing::ParseConfiguration(&ini_file);
+  } catch (misc::Error& error) {
+    message = error.getMessage();
+  }
+
+  // Check error message
+  EXPECT_REGEX_MATCH(misc::fmt(".*%s: Sampling->WorkGroups must be at "
+                               "least 1 when sampling is enabled.\n.*",
+                               ini_file.getPath().c_str())
+                         .c_str(),
+                     message.c_str());
+
+  // Restore the static configuration for the tests running afterwards
+  Sampler::kind = sampler_kind;
+  Sampler::num_detailed_work_groups = num_detailed_work_groups;
+}
+
+// This test checks to see if the correct error message is returned when
+// the number of compute units per cluster is not positive
+TEST(TestTiming, config_section_device_compute_units_per_cluster) {
+  // Cleanup singleton instances
+  Cleanup();
+
+  // Create config file. Device variables are given, since the previous
+  // tests left invalid ones.
+  std::string config =
+      "[ Device ]\n"
+      "Frequency = 1000\n"
+      "HostThreads = 1\n"
+      "MaxWorkGroupsPerComputeUnit = 0\n"
+      "ComputeUnitsPerCluster = 0";
+
+  // Load config file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+
+  // Try ParseConfiguration for invalid cluster size
+  std::string message;
+  try {
+    Timing::ParseConfiguration(&ini_file);
+  } catch (misc::Error& error) {
+    message = error.getMessage();
+  }
+
+  // Check error message
+  EXPECT_REGEX_MATCH(misc::fmt(".*%s: The value for 'ComputeUnitsPerCluster' "
+                               "must be at least 1.\n.*",
+                               ini_file.getPath().c_str())
+                         .c_str(),
+                     message.c_str());
+}
+
 }  // namespace SI
@@ -447,4 +447,125 @@ TEST(TestBranchPredictor, test_combined_branch_predictor_1) {
     EXPECT_EQ(choice_status_trace[i], choice_status);
   }
 }
+
+// Look up and update the branch predictor with a conditional branch at
+// address 'eip', in the same way as fetch and commit do. Return true if the
+// branch was predicted correctly.
+static bool PredictBranch(BranchPredictor& branch_predictor, unsigned eip,
+                          bool taken) {
+  ObjectPool* object_pool = ObjectPool::getInstance();
+  auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeBranch);
+  Uop uop(object_pool->getThread(), object_pool->getContext(), uinst);
+  uop.eip = eip;
+  uop.mop_size = 4;
+  uop.neip = taken ? eip + 64 : eip + 4;
+  BranchPredictor::Prediction prediction = branch_predictor.Lookup(&uop);
+  uop.predicted_neip =
+      prediction == BranchPredictor::PredictionTaken ? eip + 64 : eip + 4;
+  branch_predictor.Update(&uop);
+  return prediction == (taken ? BranchPredictor::PredictionTaken
+                              : BranchPredictor::PredictionNotTaken);
+}
+
+TEST(TestBranchPredictor, read_ini_configuration_file_tage) {
+  // Setup configuration file
+  std::string config =
+      "[ BranchPredictor ]\n"
+      "Kind = TAGE\n"
+      "Indirect = ITTAGE\n"
+      "TAGE.NumTables = 4\n"
+      "TAGE.MinHistory = 4\n"
+      "TAGE.MaxHistory = 32\n"
+      "StorageBudget = 64";
+
+  // Set up INI file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+  BranchPredictor::ParseConfiguration(&ini_file);
+
+  // Assertions
+  EXPECT_EQ(BranchPredictor::KindTage, BranchPredictor::getKind());
+  EXPECT_EQ(BranchPredictor::IndirectKindIttage,
+            BranchPredictor::getIndirectKind());
+  EXPECT_EQ(64, BranchPredictor::getStorageBudget());
+  EXPECT_EQ(4, Tage::getNumTables());
+  EXPECT_EQ(4, Tage::getHistoryLength(0));
+  EXPECT_EQ(8, Tage::getHistoryLength(1));
+  EXPECT_EQ(16, Tage::getHistoryLength(2));
+  EXPECT_EQ(32, Tage::getHistoryLength(3));
+  EXPECT_LE(BranchPredictor::getStorageBits(), 64 * 8192);
+}
+
+TEST(TestBranchPredictor, storage_budget_exceeded) {
+  // Default TAGE tables do not fit in 4KB
+  std::string config =
+      "[ BranchPredictor ]\n"
+      "Kind = TAGE\n"
+      "StorageBudget = 4";
+
+  // Set up INI file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+  EXPECT_THROW(BranchPredictor::ParseConfiguration(&ini_file),
+               BranchPredictor::Error);
+}
+
+TEST(TestBranchPredictor, test_tage_branch_predictor_1) {
+  // Setup configuration file for branch predictor
+  std::string config =
+      "[ BranchPredictor ]\n"
+      "Kind = TAGE";
+
+  // Set up INI file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+  BranchPredictor::ParseConfiguration(&ini_file);
+
+  // Create a branch predictor instance
+  BranchPredictor branch_predictor;
+
+  // A loop branch taken 9 times and then not taken, followed by a branch
+  // alternating its direction. Once trained, all branches are predicted
+  // correctly, including the loop exits.
+  int num_mispredictions = 0;
+  for (int i = 0; i < 200; i++) {
+    for (int j = 0; j < 10; j++)
+      if (!PredictBranch(branch_predictor, 0x1000, j < 9) && i >= 100)
+        num_mispredictions++;
+    if (!PredictBranch(branch_predictor, 0x2000, i % 2) && i >= 100)
+      num_mispredictions++;
+  }
+  EXPECT_EQ(0, num_mispredictions);
+
+  // Predictions for a trace with the first three iterations of the loop
+  EXPECT_EQ(0b111, branch_predictor.LookupMultiple(0x1000, 3));
+}
+
+TEST(TestBranchPredictor, test_perceptron_branch_predictor_1) {
+  // Setup configuration file for branch predictor
+  std::string config =
+      "[ BranchPredictor ]\n"
+      "Kind = Perceptron";
+
+  // Set up INI file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+  BranchPredictor::ParseConfiguration(&ini_file);
+
+  // Create a branch predictor instance
+  BranchPredictor branch_predictor;
+
+  // Two branches, the second one repeating the direction of the first one,
+  // which follows the pattern taken, taken, not taken. The second branch
+  // correlates with the most recent outcome in the global history, so it
+  // is learned.
+  int num_mispredictions = 0;
+  for (int i = 0; i < 300; i++) {
+    bool taken = i % 3 != 2;
+    PredictBranch(branch_predictor, 0x1000, taken);
+    if (!PredictBranch(branch_predictor, 0x2000, taken) && i >= 200)
+      num_mispredictions++;
+  }
+  EXPECT_EQ(0, num_mispredictions);
+}
 }
@@ -0,0 +1,268 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Cpu.h>
+#include <arch/x86/timing/Thread.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+#include <memory/Manager.h>
+#include <memory/System.h>
+#include <network/System.h>
+
+namespace x86 {
+
+static void Cleanup() {
+  Timing::Destroy();
+  Emulator::Destroy();
+  mem::System::Destroy();
+  net::System::Destroy();
+  esim::Engine::Destroy();
+  comm::ArchPool::Destroy();
+}
+
+// Number of cores, each running its own context
+static const int num_cores = 4;
+
+// Return a memory configuration giving each core a private main memory
+static std::string getPrivateMemoryConfig() {
+  std::string config = "[ General ]\n";
+  for (int i = 0; i < num_cores; i++)
+    config += misc::fmt(
+        "[ Module mod-mm-%d ]\n"
+        "Type = MainMemory\n"
+        "Latency = 10\n"
+        "BlockSize = 64\n"
+        "[ Entry core-%d ]\n"
+        "Arch = x86\n"
+        "Core = %d\n"
+        "Thread = 0\n"
+        "Module = mod-mm-%d\n",
+        i, i, i, i);
+  return config;
+}
+
+// Return a memory configuration with a private L1 cache per core, and an
+// L2 cache and a main memory shared by all cores
+static std::string getSharedMemoryConfig() {
+  std::string config =
+      "[ General ]\n"
+      "[ CacheGeometry geo-l1 ]\n"
+      "Sets = 16\n"
+      "Assoc = 2\n"
+      "BlockSize = 64\n"
+      "Latency = 2\n"
+      "[ CacheGeometry geo-l2 ]\n"
+      "Sets = 64\n"
+      "Assoc = 4\n"
+      "BlockSize = 64\n"
+      "Latency = 10\n"
+      "Ports = 4\n"
+      "[ Module mod-l2 ]\n"
+      "Type = Cache\n"
+      "Geometry = geo-l2\n"
+      "HighNetwork = net-l1-l2\n"
+      "LowNetwork = net-l2-mm\n"
+      "LowModules = mod-mm\n"
+      "[ Module mod-mm ]\n"
+      "Type = MainMemory\n"
+      "Latency = 50\n"
+      "BlockSize = 64\n"
+      "HighNetwork = net-l2-mm\n"
+      "[ Network net-l1-l2 ]\n"
+      "DefaultInputBufferSize = 1024\n"
+      "DefaultOutputBufferSize = 1024\n"
+      "DefaultBandwidth = 256\n"
+      "[ Network net-l2-mm ]\n"
+      "DefaultInputBufferSize = 1024\n"
+      "DefaultOutputBufferSize = 1024\n"
+      "DefaultBandwidth = 256\n";
+  for (int i = 0; i < num_cores; i++)
+    config += misc::fmt(
+        "[ Module mod-l1-%d ]\n"
+        "Type = Cache\n"
+        "Geometry = geo-l1\n"
+        "LowNetwork = net-l1-l2\n"
+        "LowModules = mod-l2\n"
+        "[ Entry core-%d ]\n"
+        "Arch = x86\n"
+        "Core = %d\n"
+        "Thread = 0\n"
+        "Module = mod-l1-%d\n",
+        i, i, i, i);
+  return config;
+}
+
+// Run a loop incrementing a memory location on every core for the given
+// number of cycles, and return the number of instructions committed by
+// each core.
+static std::vector<long long> RunCores(int num_host_threads,
+                                       int sync_quantum, int num_cycles,
+                                       const std::string& mem_config_string) {
+  // Cleanup the environment
+  Cleanup();
+
+  // CPU configuration file
+  std::string config_string = misc::fmt(
+      "[ General ]\n"
+      "Cores = %d\n"
+      "Threads = 1\n"
+      "HostThreads = %d\n"
+      "SyncQuantum = %d\n"
+      "[ TraceCache ]\n"
+      "Present = f",
+      num_cores, num_host_threads, sync_quantum);
+  misc::IniFile config_ini;
+  config_ini.LoadFromString(config_string);
+  Timing::ParseConfiguration(&config_ini);
+
+  // Get instance of Timing, register emulator and timing simulator in
+  // the arch_pool
+  Emulator* emulator = Emulator::getInstance();
+  Timing* timing = Timing::getInstance();
+
+  // Memory configuration file
+  misc::IniFile mem_config_ini;
+  mem_config_ini.LoadFromString(mem_config_string);
+  mem::System::getInstance()->ReadConfiguration(&mem_config_ini);
+
+  // Code to execute
+  // loop:
+  //   mov eax, [ebx]
+  //   add eax, 1
+  //   mov [ebx], eax
+  //   jmp loop
+  unsigned char code[] = {0x8B, 0x03, 0x83, 0xC0, 0x01,
+                          0x89, 0x03, 0xEB, 0xF7};
+
+  // Create one context per core
+  Cpu* cpu = timing->getCpu();
+  for (int i = 0; i < num_cores; i++) {
+    Context* context = emulator->newContext();
+    context->Initialize();
+    mem::Memory* memory = context->getMemory();
+    memory->setHeapBreak(
+        misc::RoundUp(memory->getHeapBreak(), mem::Memory::PageSize));
+
+    // Allocate memory for the code and the counter
+    mem::Manager manager(memory);
+    unsigned eip = manager.Allocate(sizeof(code), 128);
+    unsigned counter = manager.Allocate(4, 4);
+    memory->Write(eip, sizeof(code), (const char*)code);
+
+    // Update context status
+    context->setUinstActive(true);
+    context->setState(Context::StateRunning);
+    context->getRegs().setEip(eip);
+    context->getRegs().setEbx(counter);
+
+    // Map the context onto the core
+    Thread* thread = cpu->getThread(i, 0);
+    thread->MapContext(context);
+    thread->Schedule();
+    thread->setFetchNeip(eip);
+  }
+
+  // Simulate
+  esim::Engine* engine = esim::Engine::getInstance();
+  for (int i = 0; i < num_cycles; i++) {
+    timing->Run();
+    engine->ProcessEvents();
+  }
+
+  // Committed instructions per core
+  std::vector<long long> num_committed_instructions;
+  for (int i = 0; i < num_cores; i++)
+    num_committed_instructions.push_back(
+        cpu->getThread(i, 0)->getNumCommittedInstructions());
+  return num_committed_instructions;
+}
+
+// Restore the default CPU configuration for tests running afterwards
+static void ResetConfiguration() {
+  Cleanup();
+  misc::IniFile config_ini;
+  config_ini.LoadFromString(
+      "[ General ]\n"
+      "Cores = 1\n"
+      "Threads = 1\n");
+  Timing::ParseConfiguration(&config_ini);
+  Cleanup();
+}
+
+TEST(TestX86TimingParallel, same_commits_per_cycle_quantum) {
+  try {
+    std::vector<long long> sequential =
+        RunCores(1, 1, 2000, getPrivateMemoryConfig());
+    std::vector<long long> parallel =
+        RunCores(3, 1, 2000, getPrivateMemoryConfig());
+    EXPECT_EQ(sequential, parallel);
+    for (long long num_committed_instructions : sequential)
+      EXPECT_GT(num_committed_instructions, 0);
+  } catch (misc::Exception& e) {
+    std::cerr << "Exception in x86 timing simulation: " << e.getMessage()
+              << "\n";
+    ASSERT_TRUE(false);
+  }
+  ResetConfiguration();
+}
+
+TEST(TestX86TimingParallel, same_commits_relaxed_quantum) {
+  try {
+    std::vector<long long> sequential =
+        RunCores(1, 8, 2000, getPrivateMemoryConfig());
+    std::vector<long long> parallel =
+        RunCores(num_cores, 8, 2000, getPrivateMemoryConfig());
+    EXPECT_EQ(sequential, parallel);
+    for (long long num_committed_instructions : sequential)
+      EXPECT_GT(num_committed_instructions, 0);
+  } catch (misc::Exception& e) {
+    std::cerr << "Exception in x86 timing simulation: " << e.getMessage()
+              << "\n";
+    ASSERT_TRUE(false);
+  }
+  ResetConfiguration();
+}
+
+TEST(TestX86TimingParallel, same_commits_shared_l2) {
+  // Accesses of all cores meet in the shared L2 cache and main memory, so
+  // the order in which they reach the memory hierarchy affects latencies
+  try {
+    std::vector<long long> sequential =
+        RunCores(1, 4, 3000, getSharedMemoryConfig());
+    std::vector<long long> parallel =
+        RunCores(num_cores, 4, 3000, getSharedMemoryConfig());
+    EXPECT_EQ(sequential, parallel);
+    for (long long num_committed_instructions : sequential)
+      EXPECT_GT(num_committed_instructions, 0);
+  } catch (misc::Exception& e) {
+    std::cerr << "Exception in x86 timing simulation: " << e.getMessage()
+              << "\n";
+    ASSERT_TRUE(false);
+  }
+  ResetConfiguration();
+}
+
+}  // namespace x86
@@ -0,0 +1,267 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <arch/x86/emulator/BasicBlockProfiler.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Sampling.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+#include <memory/Manager.h>
+#include <memory/System.h>
+
+namespace x86 {
+
+static void Cleanup() {
+  Timing::Destroy();
+  Emulator::Destroy();
+  mem::System::Destroy();
+  esim::Engine::Destroy();
+  comm::ArchPool::Destroy();
+}
+
+// Return the path of a new temporary file
+static std::string getTemporaryPath() {
+  char path[] = "/tmp/m2s-test-sampling.XXXXXX";
+  int fd = mkstemp(path);
+  EXPECT_GE(fd, 0);
+  close(fd);
+  return path;
+}
+
+// Write a temporary file with the given content and return its path
+static std::string WriteTemporaryFile(const std::string& content) {
+  std::string path = getTemporaryPath();
+  std::ofstream os(path);
+  os << content;
+  return path;
+}
+
+// Return the lines of a file
+static std::vector<std::string> ReadLines(const std::string& path) {
+  std::vector<std::string> lines;
+  std::ifstream is(path);
+  std::string line;
+  while (std::getline(is, line)) lines.push_back(line);
+  return lines;
+}
+
+// Run a loop of three instructions with the given sampling configuration,
+// until the simulation finishes or the given number of samples is taken.
+// Return the sampling state, which is valid until the next call to
+// Cleanup().
+static Sampling* RunSampledLoop(const std::string& sampling_config,
+                                int max_samples) {
+  // Cleanup the environment
+  Cleanup();
+
+  // CPU configuration file
+  std::string config_string =
+      "[ General ]\n"
+      "Cores = 1\n"
+      "Threads = 1\n"
+      "[ TraceCache ]\n"
+      "Present = f\n"
+      "[ Sampling ]\n" +
+      sampling_config;
+  misc::IniFile config_ini;
+  config_ini.LoadFromString(config_string);
+  Timing::ParseConfiguration(&config_ini);
+
+  // Get instance of Timing, register emulator and timing simulator in
+  // the arch_pool
+  Emulator* emulator = Emulator::getInstance();
+  Timing* timing = Timing::getInstance();
+
+  // Memory configuration file
+  misc::IniFile mem_config_ini;
+  mem_config_ini.LoadFromString(
+      "[ General ]\n"
+      "[ Module mod-mm ]\n"
+      "Type = MainMemory\n"
+      "Latency = 10\n"
+      "BlockSize = 64\n"
+      "[ Entry core-0 ]\n"
+      "Arch = x86\n"
+      "Core = 0\n"
+      "Thread = 0\n"
+      "Module = mod-mm\n");
+  mem::System::getInstance()->ReadConfiguration(&mem_config_ini);
+
+  // Code to execute
+  // loop:
+  //   add eax, 1
+  //   add ebx, 2
+  //   jmp loop
+  unsigned char code[] = {0x83, 0xC0, 0x01, 0x83, 0xC3, 0x02, 0xEB, 0xF8};
+
+  // Create context. The sampled simulation starts with a functional phase,
+  // after which the scheduler maps the context onto the core.
+  Context* context = emulator->newContext();
+  context->Initialize();
+  mem::Memory* memory = context->getMemory();
+  memory->setHeapBreak(
+      misc::RoundUp(memory->getHeapBreak(), mem::Memory::PageSize));
+  mem::Manager manager(memory);
+  unsigned eip = manager.Allocate(sizeof(code), 128);
+  memory->Write(eip, sizeof(code), (const char*)code);
+  context->setUinstActive(true);
+  context->setState(Context::StateRunning);
+  context->getRegs().setEip(eip);
+
+  // Simulate
+  esim::Engine* engine = esim::Engine::getInstance();
+  Sampling* sampling = timing->getSampling();
+  EXPECT_TRUE(sampling != nullptr);
+  while (!engine->hasFinished() && sampling->getNumSamples() < max_samples) {
+    if (timing->getCycle() > 100000)
+      throw misc::Panic("Sampled simulation did not finish");
+    timing->Run();
+    engine->ProcessEvents();
+  }
+  return sampling;
+}
+
+// Restore the default CPU configuration for tests running afterwards
+static void ResetConfiguration() {
+  Cleanup();
+  misc::IniFile config_ini;
+  config_ini.LoadFromString(
+      "[ General ]\n"
+      "Cores = 1\n"
+      "Threads = 1\n");
+  Timing::ParseConfiguration(&config_ini);
+  Cleanup();
+}
+
+TEST(TestSampling, basic_block_vector) {
+  std::string path = getTemporaryPath();
+  {
+    BasicBlockProfiler profiler(path, 10);
+
+    // The third block completes the first interval. The excess instruction
+    // is carried over to the next interval.
+    profiler.RecordBlock(0x1000, 4);
+    profiler.RecordBlock(0x2000, 3);
+    profiler.RecordBlock(0x1000, 4);
+    EXPECT_EQ(1, profiler.getNumIntervals());
+    EXPECT_EQ(9, profiler.getNumIntervalInstructionsLeft());
+
+    // A block longer than the rest of the interval, such as the iterations
+    // of a repeated string instruction run in a chunk, is counted in the
+    // interval where it is recorded
+    profiler.RecordBlock(0x3000, 12);
+    EXPECT_EQ(2, profiler.getNumIntervals());
+    EXPECT_EQ(7, profiler.getNumIntervalInstructionsLeft());
+
+    // The last, incomplete interval is dumped on destruction
+    profiler.RecordBlock(0x2000, 2);
+    EXPECT_EQ(3, profiler.getNumBlocks());
+  }
+
+  // One line per interval, with block identifiers in order of first
+  // execution
+  std::vector<std::string> lines = ReadLines(path);
+  unlink(path.c_str());
+  ASSERT_EQ(3u, lines.size());
+  EXPECT_EQ("T:1:8 :2:3 ", lines[0]);
+  EXPECT_EQ("T:3:12 ", lines[1]);
+  EXPECT_EQ("T:2:2 ", lines[2]);
+}
+
+TEST(TestSampling, simpoint_weights) {
+  // Simulation points are given out of order, and are sorted by interval
+  std::string simpoints_path = WriteTemporaryFile("4 0\n1 1\n");
+  std::string weights_path = WriteTemporaryFile("0.25 0\n0.75 1\n");
+  try {
+    Sampling* sampling = RunSampledLoop(
+        "Kind = SimPoint\n"
+        "IntervalSize = 1000\n"
+        "WarmUp = 200\n"
+        "SimPoints = " + simpoints_path + "\n"
+        "Weights = " + weights_path + "\n",
+        100);
+
+    // One sample per simulation point, measuring the instructions of its
+    // interval with its weight
+    ASSERT_EQ(2, sampling->getNumSamples());
+    const Sampling::Sample& first = sampling->getSample(0);
+    const Sampling::Sample& second = sampling->getSample(1);
+    EXPECT_GE(first.position, 1000);
+    EXPECT_LT(first.position, 1100);
+    EXPECT_GE(second.position, 4000);
+    EXPECT_LT(second.position, 4100);
+    EXPECT_GE(first.num_instructions, 900);
+    EXPECT_GE(second.num_instructions, 900);
+    EXPECT_GT(first.num_cycles, 0);
+    EXPECT_GT(second.num_cycles, 0);
+    EXPECT_DOUBLE_EQ(0.75, first.weight);
+    EXPECT_DOUBLE_EQ(0.25, second.weight);
+
+    // CPI is the weighted average of the samples
+    EXPECT_DOUBLE_EQ(0.75 * first.getCpi() + 0.25 * second.getCpi(),
+                     sampling->getCpi());
+  } catch (misc::Exception& e) {
+    e.Dump();
+    FAIL();
+  }
+  unlink(simpoints_path.c_str());
+  unlink(weights_path.c_str());
+  ResetConfiguration();
+}
+
+TEST(TestSampling, periodic) {
+  try {
+    Sampling* sampling = RunSampledLoop(
+        "Kind = Periodic\n"
+        "Period = 1000\n"
+        "WarmUp = 100\n"
+        "Measure = 300\n",
+        3);
+
+    // Measurements are placed at the end of every period, with weight 1
+    ASSERT_EQ(3, sampling->getNumSamples());
+    double cpi = 0.0;
+    for (int i = 0; i < 3; i++) {
+      const Sampling::Sample& sample = sampling->getSample(i);
+      EXPECT_GE(sample.position, i * 1000 + 700);
+      EXPECT_LT(sample.position, i * 1000 + 800);
+      EXPECT_GE(sample.num_instructions, 200);
+      EXPECT_DOUBLE_EQ(1.0, sample.weight);
+      cpi += sample.getCpi() / 3;
+    }
+    EXPECT_DOUBLE_EQ(cpi, sampling->getCpi());
+    EXPECT_GE(sampling->getCpiError(), 0.0);
+  } catch (misc::Exception& e) {
+    e.Dump();
+    FAIL();
+  }
+  ResetConfiguration();
+}
+
+}  // namespace x86
@@ -0,0 +1,312 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Cpu.h>
+#include <arch/x86/timing/StoreSets.h>
+#include <arch/x86/timing/Thread.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+#include <memory/Manager.h>
+#include <memory/System.h>
+
+namespace x86 {
+
+static void Cleanup() {
+  Timing::Destroy();
+  Emulator::Destroy();
+  mem::System::Destroy();
+  esim::Engine::Destroy();
+  comm::ArchPool::Destroy();
+}
+
+// Number of iterations of the store-load loop
+static const int num_iterations = 200;
+
+// Activity of the load-store queue while running the store-load loop
+struct LoopStats {
+  long long num_committed_loads;
+  long long num_committed_stores;
+  long long num_forwarded_loads;
+  long long num_memory_violations;
+};
+
+// Run a loop where each iteration stores to a location whose address is
+// computed by a chain of multiplications, and then loads from the same
+// location through a register that is ready much earlier. The given
+// options are added to the [ Queues ] section of the CPU configuration.
+static LoopStats RunStoreLoadLoop(const std::string& queues_config) {
+  // Cleanup the environment
+  Cleanup();
+
+  // CPU configuration file
+  std::string config_string =
+      "[ General ]\n"
+      "Cores = 1\n"
+      "Threads = 1\n"
+      "[ TraceCache ]\n"
+      "Present = f\n"
+      "[ Queues ]\n" +
+      queues_config;
+  misc::IniFile config_ini;
+  config_ini.LoadFromString(config_string);
+  Timing::ParseConfiguration(&config_ini);
+
+  // Get instance of Timing, register emulator and timing simulator in
+  // the arch_pool
+  Emulator* emulator = Emulator::getInstance();
+  Timing* timing = Timing::getInstance();
+
+  // Memory configuration file
+  misc::IniFile mem_config_ini;
+  mem_config_ini.LoadFromString(
+      "[ General ]\n"
+      "[ Module mod-mm ]\n"
+      "Type = MainMemory\n"
+      "Latency = 10\n"
+      "BlockSize = 64\n"
+      "[ Entry core-0 ]\n"
+      "Arch = x86\n"
+      "Core = 0\n"
+      "Thread = 0\n"
+      "Module = mod-mm\n");
+  mem::System::getInstance()->ReadConfiguration(&mem_config_ini);
+
+  // Code to execute
+  // loop:
+  //   imul ecx, ebx, 1
+  //   imul ecx, ecx, 1
+  //   imul ecx, ecx, 1
+  //   mov [ecx], eax
+  //   mov edx, [ebx]
+  //   lea eax, [edx + 1]
+  //   dec esi
+  //   jnz loop
+  // end:
+  //   jmp end
+  unsigned char code[] = {0x6B, 0xCB, 0x01, 0x6B, 0xC9, 0x01, 0x6B,
+                          0xC9, 0x01, 0x89, 0x01, 0x8B, 0x13, 0x8D,
+                          0x42, 0x01, 0x4E, 0x75, 0xED, 0xEB, 0xFE};
+
+  // Create context
+  Context* context = emulator->newContext();
+  context->Initialize();
+  mem::Memory* memory = context->getMemory();
+  memory->setHeapBreak(
+      misc::RoundUp(memory->getHeapBreak(), mem::Memory::PageSize));
+
+  // Allocate memory for the code and the counter
+  mem::Manager manager(memory);
+  unsigned eip = manager.Allocate(sizeof(code), 128);
+  unsigned counter = manager.Allocate(4, 4);
+  memory->Write(eip, sizeof(code), (const char*)code);
+
+  // Update context status
+  context->setUinstActive(true);
+  context->setState(Context::StateRunning);
+  context->getRegs().setEip(eip);
+  context->getRegs().setEbx(counter);
+  context->getRegs().setEsi(num_iterations);
+
+  // Map the context onto the core
+  Cpu* cpu = timing->getCpu();
+  Thread* thread = cpu->getThread(0, 0);
+  thread->MapContext(context);
+  thread->Schedule();
+  thread->setFetchNeip(eip);
+
+  // Simulate until the loads of all iterations commit. The final jump
+  // does not access memory.
+  esim::Engine* engine = esim::Engine::getInstance();
+  const long long* num_committed_uinsts = thread->getNumCommittedUinstArray();
+  while (num_committed_uinsts[Uinst::OpcodeLoad] < num_iterations) {
+    if (timing->getCycle() > 100000)
+      throw misc::Panic("Store-load loop did not finish");
+    timing->Run();
+    engine->ProcessEvents();
+  }
+
+  // Statistics
+  LoopStats stats;
+  stats.num_committed_loads = num_committed_uinsts[Uinst::OpcodeLoad];
+  stats.num_committed_stores = num_committed_uinsts[Uinst::OpcodeStore];
+  stats.num_forwarded_loads = thread->getNumForwardedLoads();
+  stats.num_memory_violations = thread->getNumMemoryViolations();
+  return stats;
+}
+
+// Restore the default CPU configuration for tests running afterwards
+static void ResetConfiguration() {
+  Cleanup();
+  misc::IniFile config_ini;
+  config_ini.LoadFromString(
+      "[ General ]\n"
+      "Cores = 1\n"
+      "Threads = 1\n");
+  Timing::ParseConfiguration(&config_ini);
+  Cleanup();
+}
+
+TEST(TestStoreSets, read_ini_configuration_file) {
+  // Setup configuration file
+  std::string config =
+      "[ Queues ]\n"
+      "StoreForwarding = f\n"
+      "StoreForwardLatency = 3\n"
+      "MemDepKind = Conservative\n"
+      "StoreSetsSize = 256\n"
+      "StoreSetsClearInterval = 5000";
+
+  // Set up INI file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+  Cpu::ParseConfiguration(&ini_file);
+
+  // Assertions
+  EXPECT_FALSE(Cpu::getStoreForwarding());
+  EXPECT_EQ(3, Cpu::getStoreForwardLatency());
+  EXPECT_EQ(Cpu::MemoryDependenceKindConservative,
+            Cpu::getMemoryDependenceKind());
+  EXPECT_EQ(256, Cpu::getStoreSetsSize());
+  EXPECT_EQ(5000, Cpu::getStoreSetsClearInterval());
+}
+
+TEST(TestStoreSets, store_sets_size_not_power_of_two) {
+  // Setup configuration file
+  std::string config =
+      "[ Queues ]\n"
+      "StoreSetsSize = 1000";
+
+  // Set up INI file
+  misc::IniFile ini_file;
+  ini_file.LoadFromString(config);
+  EXPECT_THROW(Cpu::ParseConfiguration(&ini_file), Timing::Error);
+}
+
+TEST(TestStoreSets, violation) {
+  StoreSets store_sets(1024, 0);
+
+  // Initially, no instruction belongs to a store set
+  EXPECT_EQ(-1, store_sets.getSet(0x1000));
+  EXPECT_EQ(-1, store_sets.getSet(0x2000));
+
+  // A violation places the load and the store in a new set
+  store_sets.Violation(0x1000, 0x2000);
+  int set = store_sets.getSet(0x1000);
+  EXPECT_NE(-1, set);
+  EXPECT_EQ(set, store_sets.getSet(0x2000));
+
+  // A second store joins the set of the load
+  store_sets.Violation(0x1000, 0x3000);
+  EXPECT_EQ(set, store_sets.getSet(0x3000));
+
+  // A violation between two instructions in different sets moves both
+  // to the same set
+  store_sets.Violation(0x4000, 0x5000);
+  EXPECT_NE(set, store_sets.getSet(0x4000));
+  store_sets.Violation(0x4000, 0x2000);
+  EXPECT_EQ(store_sets.getSet(0x4000), store_sets.getSet(0x2000));
+}
+
+TEST(TestStoreSets, refresh) {
+  StoreSets store_sets(1024, 100);
+  store_sets.Violation(0x1000, 0x2000);
+
+  // The table is kept until the clear interval elapses
+  store_sets.Refresh(50);
+  EXPECT_NE(-1, store_sets.getSet(0x1000));
+  store_sets.Refresh(100);
+  EXPECT_EQ(-1, store_sets.getSet(0x1000));
+  EXPECT_EQ(-1, store_sets.getSet(0x2000));
+}
+
+TEST(TestStoreSets, replay_aggressive) {
+  try {
+    // Loads issuing before the store of their iteration resolves its
+    // address read stale data and are replayed. Replayed loads get their
+    // data from the store.
+    LoopStats stats = RunStoreLoadLoop("MemDepKind = Aggressive\n");
+    EXPECT_GT(stats.num_memory_violations, num_iterations / 4);
+    EXPECT_EQ(num_iterations, stats.num_forwarded_loads);
+
+    // Replayed loads commit only once
+    EXPECT_EQ(num_iterations, stats.num_committed_loads);
+    EXPECT_EQ(num_iterations, stats.num_committed_stores);
+  } catch (misc::Exception& e) {
+    e.Dump();
+    FAIL();
+  }
+  ResetConfiguration();
+}
+
+TEST(TestStoreSets, replay_store_sets) {
+  try {
+    // The first violation places the load and the store in the same
+    // store set, and later loads wait for the store
+    LoopStats stats = RunStoreLoadLoop("MemDepKind = StoreSets\n");
+    EXPECT_EQ(1, stats.num_memory_violations);
+    EXPECT_EQ(num_iterations, stats.num_forwarded_loads);
+    EXPECT_EQ(num_iterations, stats.num_committed_loads);
+    EXPECT_EQ(num_iterations, stats.num_committed_stores);
+  } catch (misc::Exception& e) {
+    e.Dump();
+    FAIL();
+  }
+  ResetConfiguration();
+}
+
+TEST(TestStoreSets, replay_conservative) {
+  try {
+    // Loads never issue before older stores resolve their addresses
+    LoopStats stats = RunStoreLoadLoop("MemDepKind = Conservative\n");
+    EXPECT_EQ(0, stats.num_memory_violations);
+    EXPECT_EQ(num_iterations, stats.num_forwarded_loads);
+    EXPECT_EQ(num_iterations, stats.num_committed_loads);
+    EXPECT_EQ(num_iterations, stats.num_committed_stores);
+  } catch (misc::Exception& e) {
+    e.Dump();
+    FAIL();
+  }
+  ResetConfiguration();
+}
+
+TEST(TestStoreSets, replay_no_forwarding) {
+  try {
+    // Without forwarding, replayed loads access the data cache
+    LoopStats stats = RunStoreLoadLoop(
+        "StoreForwarding = f\n"
+        "MemDepKind = Aggressive\n");
+    EXPECT_GT(stats.num_memory_violations, 0);
+    EXPECT_EQ(0, stats.num_forwarded_loads);
+    EXPECT_EQ(num_iterations, stats.num_committed_loads);
+    EXPECT_EQ(num_iterations, stats.num_committed_stores);
+  } catch (misc::Exception& e) {
+    e.Dump();
+    FAIL();
+  }
+  ResetConfiguration();
+}
+
+}  // namespace x86
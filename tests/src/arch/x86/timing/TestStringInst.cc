@@ -0,0 +1,206 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <arch/x86/emulator/Emulator.h>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/Misc.h>
+#include <memory/Manager.h>
+
+namespace x86 {
+
+static void Cleanup() {
+  Emulator::Destroy();
+  esim::Engine::Destroy();
+  comm::ArchPool::Destroy();
+}
+
+// Guest memory accessed by string instructions, spanning several pages
+static const unsigned data_address = 0x20000000;
+static const unsigned data_size = 4 * mem::Memory::PageSize;
+
+// Architected state after running a string instruction
+struct StringState {
+  std::vector<char> data;
+  unsigned esi;
+  unsigned edi;
+  unsigned ecx;
+  unsigned eflags;
+  long long num_instructions;
+};
+
+// Run one string instruction until it finishes, with or without
+// micro-instructions, and return the resulting state. The data pages are
+// filled with the given bytes, or with a pattern if empty.
+static StringState RunStringInst(bool uinst_active,
+                                 const std::vector<unsigned char>& inst,
+                                 unsigned esi, unsigned edi, unsigned ecx,
+                                 bool backward,
+                                 const std::vector<char>& data = {}) {
+  // Cleanup the environment
+  Cleanup();
+  Emulator* emulator = Emulator::getInstance();
+
+  // Code, followed by a jump to itself marking the end
+  std::vector<unsigned char> code = inst;
+  code.push_back(0xeb);
+  code.push_back(0xfe);
+
+  // Create context
+  Context* context = emulator->newContext();
+  context->Initialize();
+  mem::Memory* memory = context->getMemory();
+  memory->setHeapBreak(
+      misc::RoundUp(memory->getHeapBreak(), mem::Memory::PageSize));
+  mem::Manager manager(memory);
+  unsigned eip = manager.Allocate(code.size(), 128);
+  memory->Write(eip, code.size(), (const char*)code.data());
+
+  // Data pages
+  memory->Map(data_address, data_size,
+              mem::Memory::AccessRead | mem::Memory::AccessWrite);
+  std::vector<char> initial_data = data;
+  if (initial_data.empty())
+    for (unsigned i = 0; i < data_size; i++)
+      initial_data.push_back((char)(i * 7 + i / 251));
+  memory->Write(data_address, data_size, initial_data.data());
+
+  // Registers
+  Regs& regs = context->getRegs();
+  context->setUinstActive(uinst_active);
+  context->setState(Context::StateRunning);
+  regs.setEip(eip);
+  regs.setEsi(esi);
+  regs.setEdi(edi);
+  regs.setEcx(ecx);
+  regs.setEax(0x5a6b7c8d);
+  if (backward) regs.setFlag(Instruction::FlagDF);
+
+  // Run until the end of the instruction
+  unsigned end_eip = eip + inst.size();
+  while (regs.getEip() != end_eip) {
+    context->Execute();
+    if (emulator->getNumInstructions() > 100000)
+      throw misc::Panic("String instruction did not finish");
+  }
+
+  // Resulting state
+  StringState state;
+  state.data.resize(data_size);
+  memory->Read(data_address, data_size, state.data.data());
+  state.esi = regs.getEsi();
+  state.edi = regs.getEdi();
+  state.ecx = regs.getEcx();
+  state.eflags = regs.getEflags();
+  state.num_instructions = emulator->getNumInstructions();
+  return state;
+}
+
+// Check that a string instruction gives the same results when iterations
+// run in chunks in functional simulation as when they run one by one with
+// micro-instructions
+static void CheckStringInst(const std::vector<unsigned char>& inst,
+                            unsigned esi, unsigned edi, unsigned ecx,
+                            bool backward,
+                            const std::vector<char>& data = {}) {
+  try {
+    StringState chunked =
+        RunStringInst(false, inst, esi, edi, ecx, backward, data);
+    StringState reference =
+        RunStringInst(true, inst, esi, edi, ecx, backward, data);
+    EXPECT_TRUE(chunked.data == reference.data);
+    EXPECT_EQ(reference.esi, chunked.esi);
+    EXPECT_EQ(reference.edi, chunked.edi);
+    EXPECT_EQ(reference.ecx, chunked.ecx);
+    EXPECT_EQ(reference.eflags, chunked.eflags);
+    EXPECT_EQ(reference.num_instructions, chunked.num_instructions);
+  } catch (misc::Exception& e) {
+    e.Dump();
+    FAIL();
+  }
+  Cleanup();
+}
+
+// Instruction encodings
+static const std::vector<unsigned char> rep_movsb = {0xf3, 0xa4};
+static const std::vector<unsigned char> rep_movsd = {0xf3, 0xa5};
+static const std::vector<unsigned char> rep_stosb = {0xf3, 0xaa};
+static const std::vector<unsigned char> rep_stosd = {0xf3, 0xab};
+static const std::vector<unsigned char> repz_cmpsb = {0xf3, 0xa6};
+static const std::vector<unsigned char> repnz_scasb = {0xf2, 0xae};
+
+TEST(TestStringInst, rep_movs_overlap_forward) {
+  // Destination 3 bytes after the source, so each iteration reads bytes
+  // written by previous ones
+  CheckStringInst(rep_movsb, data_address + 100, data_address + 103, 6000,
+                  false);
+  CheckStringInst(rep_movsd, data_address + 100, data_address + 106, 2000,
+                  false);
+}
+
+TEST(TestStringInst, rep_movs_overlap_backward) {
+  // Backward copy with the destination after the source, as memmove() does
+  unsigned last = data_address + 3 * mem::Memory::PageSize + 50;
+  CheckStringInst(rep_movsb, last, last + 5, 7000, true);
+  CheckStringInst(rep_movsd, last, last + 6, 2500, true);
+}
+
+TEST(TestStringInst, rep_movs_page_straddle) {
+  // Elements crossing a page boundary in the source and the destination
+  unsigned page = data_address + mem::Memory::PageSize;
+  CheckStringInst(rep_movsd, page - 2, page + mem::Memory::PageSize - 1, 1500,
+                  false);
+  CheckStringInst(rep_movsd, page + 2 * mem::Memory::PageSize - 2,
+                  page + mem::Memory::PageSize - 1, 1500, true);
+}
+
+TEST(TestStringInst, rep_stos) {
+  unsigned page = data_address + mem::Memory::PageSize;
+  CheckStringInst(rep_stosb, 0, page - 10, 5000, false);
+  CheckStringInst(rep_stosd, 0, page - 2, 2000, false);
+  CheckStringInst(rep_stosd, 0, page + 2 * mem::Memory::PageSize - 1, 1800,
+                  true);
+}
+
+TEST(TestStringInst, repz_cmps) {
+  // Equal strings for 6000 bytes across pages, then a mismatch
+  std::vector<char> data(data_size, 'a');
+  data[2 * mem::Memory::PageSize + 6000] = 'b';
+  CheckStringInst(repz_cmpsb, data_address + 100,
+                  data_address + 2 * mem::Memory::PageSize, 7000, false,
+                  data);
+
+  // Equal strings until ECX runs out
+  CheckStringInst(repz_cmpsb, data_address + 100,
+                  data_address + 2 * mem::Memory::PageSize, 5000, false,
+                  data);
+}
+
+TEST(TestStringInst, repnz_scas) {
+  // Search for AL going backward
+  std::vector<char> data(data_size, 'a');
+  data[500] = (char)0x8d;
+  CheckStringInst(repnz_scasb, 0, data_address + 3 * mem::Memory::PageSize,
+                  14000, true, data);
+}
+
+}  // namespace x86
@@ -0,0 +1,134 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include <memory/Memory.h>
+
+namespace mem {
+
+TEST(TestMemory, copy_between_memories) {
+  // Source region spanning three pages, the last one without data
+  Memory host;
+  host.Map(0x10000, 0x3000, Memory::AccessRead | Memory::AccessWrite);
+  char data[0x1800];
+  for (unsigned i = 0; i < sizeof data; i++) data[i] = i * 7 + 1;
+  host.Write(0x10800, sizeof data, data);
+
+  // Destination with a different page alignment and stale content
+  Memory device;
+  device.Map(0x40000, 0x4000, Memory::AccessRead | Memory::AccessWrite);
+  char stale[0x2800];
+  memset(stale, 0xff, sizeof stale);
+  device.Write(0x40100, sizeof stale, stale);
+
+  // Copy, and check the result matches a read followed by a write
+  device.Copy(0x40100, &host, 0x10800, 0x2800);
+  char buffer[0x2800];
+  device.Read(0x40100, sizeof buffer, buffer);
+  EXPECT_EQ(0, memcmp(buffer, data, sizeof data));
+  for (unsigned i = sizeof data; i < sizeof buffer; i++)
+    ASSERT_EQ(0, buffer[i]);
+  EXPECT_TRUE(device.getPage(0x40000)->getPerm() & Memory::AccessModified);
+}
+
+TEST(TestMemory, copy_overlapping) {
+  Memory memory;
+  memory.Map(0x10000, 0x5000, Memory::AccessRead | Memory::AccessWrite);
+  char data[0x1800];
+  for (unsigned i = 0; i < sizeof data; i++) data[i] = i * 7 + 1;
+  char buffer[sizeof data];
+
+  // Destination after the source, both crossing page boundaries
+  memory.Write(0x10800, sizeof data, data);
+  memory.Copy(0x10a00, &memory, 0x10800, sizeof data);
+  memory.Read(0x10a00, sizeof buffer, buffer);
+  EXPECT_EQ(0, memcmp(buffer, data, sizeof data));
+
+  // Destination before the source
+  memory.Write(0x12a00, sizeof data, data);
+  memory.Copy(0x12900, &memory, 0x12a00, sizeof data);
+  memory.Read(0x12900, sizeof buffer, buffer);
+  EXPECT_EQ(0, memcmp(buffer, data, sizeof data));
+}
+
+TEST(TestMemory, copy_errors) {
+  Memory memory;
+  memory.Map(0x10000, 0x2000, Memory::AccessRead | Memory::AccessWrite);
+  memory.Map(0x20000, 0x1000, Memory::AccessRead);
+
+  // Destination without write permission
+  std::string message;
+  try {
+    memory.Copy(0x20000, &memory, 0x10000, 0x100);
+  } catch (misc::Error& e) {
+    message = e.getMessage();
+  }
+  EXPECT_NE(std::string::npos, message.find("Permission denied"));
+
+  // Source not allocated
+  message.clear();
+  try {
+    memory.Copy(0x10000, &memory, 0x30000, 0x100);
+  } catch (misc::Error& e) {
+    message = e.getMessage();
+  }
+  EXPECT_NE(std::string::npos, message.find("Segmentation fault"));
+}
+
+TEST(TestMemory, code_version) {
+  Memory memory;
+  memory.Map(0x10000, 0x1000,
+             Memory::AccessRead | Memory::AccessExec | Memory::AccessInit);
+  memory.Map(0x20000, 0x1000, Memory::AccessRead | Memory::AccessWrite);
+  char data[4] = {1, 2, 3, 4};
+
+  // Writes to pages without execute permission keep the version
+  long long version = memory.getCodeVersion();
+  memory.Write(0x20000, 4, data);
+  memory.Copy(0x20100, &memory, 0x20000, 4);
+  EXPECT_EQ(version, memory.getCodeVersion());
+
+  // So do changes of the memory map and of permissions of such pages
+  memory.Map(0x30000, 0x1000, Memory::AccessRead | Memory::AccessWrite);
+  memory.Protect(0x30000, 0x1000, Memory::AccessRead);
+  memory.Unmap(0x30000, 0x1000);
+  EXPECT_EQ(version, memory.getCodeVersion());
+
+  // Initializing an executable page changes it
+  memory.Init(0x10000, 4, data);
+  EXPECT_NE(version, memory.getCodeVersion());
+
+  // So do changes of permissions and of the memory map affecting
+  // executable pages
+  version = memory.getCodeVersion();
+  memory.Protect(0x20000, 0x1000, Memory::AccessRead | Memory::AccessExec);
+  EXPECT_NE(version, memory.getCodeVersion());
+  version = memory.getCodeVersion();
+  memory.Unmap(0x10000, 0x1000);
+  EXPECT_NE(version, memory.getCodeVersion());
+  version = memory.getCodeVersion();
+  memory.Map(0x10000, 0x1000, Memory::AccessRead | Memory::AccessExec);
+  EXPECT_NE(version, memory.getCodeVersion());
+}
+
+}  // namespace mem
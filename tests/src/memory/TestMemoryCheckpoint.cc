@@ -0,0 +1,100 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <unistd.h>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include <lib/cpp/Checkpoint.h>
+#include <memory/Memory.h>
+
+namespace mem {
+
+// Return the path of a new temporary file for a checkpoint
+static std::string getCheckpointPath() {
+  char path[] = "/tmp/m2s-test-checkpoint.XXXXXX";
+  int fd = mkstemp(path);
+  EXPECT_GE(fd, 0);
+  close(fd);
+  return path;
+}
+
+TEST(TestMemoryCheckpoint, save_and_load) {
+  // Memory image with two separate regions, one of them without data
+  Memory memory;
+  memory.Map(0x10000, 0x3000, Memory::AccessRead | Memory::AccessWrite);
+  memory.Map(0x80000, 0x1000, Memory::AccessRead | Memory::AccessExec);
+  memory.setHeapBreak(0x13000);
+  const char text[] = "checkpoint";
+  memory.Write(0x10ffc, sizeof text, text);
+
+  // Save
+  std::string path = getCheckpointPath();
+  {
+    misc::Checkpoint checkpoint(path, misc::Checkpoint::ModeSave);
+    memory.SaveCheckpoint(checkpoint);
+  }
+
+  // Load into a memory that already has other content
+  Memory restored;
+  restored.Map(0x40000, 0x1000, Memory::AccessRead);
+  {
+    misc::Checkpoint checkpoint(path, misc::Checkpoint::ModeLoad);
+    restored.LoadCheckpoint(checkpoint);
+  }
+  unlink(path.c_str());
+
+  // Check content, spanning a page boundary
+  char buffer[sizeof text];
+  restored.Read(0x10ffc, sizeof buffer, buffer);
+  EXPECT_EQ(0, memcmp(buffer, text, sizeof text));
+  EXPECT_EQ(0x13000u, restored.getHeapBreak());
+
+  // Check page permissions
+  ASSERT_TRUE(restored.getPage(0x12000) != nullptr);
+  ASSERT_TRUE(restored.getPage(0x80000) != nullptr);
+  EXPECT_EQ(Memory::AccessRead | Memory::AccessExec,
+            restored.getPage(0x80000)->getPerm());
+  EXPECT_EQ(nullptr, restored.getPage(0x40000));
+}
+
+TEST(TestMemoryCheckpoint, wrong_section) {
+  // Save a file that does not contain a memory image
+  std::string path = getCheckpointPath();
+  {
+    misc::Checkpoint checkpoint(path, misc::Checkpoint::ModeSave);
+    checkpoint.WriteTag("FileTable");
+  }
+
+  // Loading it as a memory image must fail
+  Memory memory;
+  std::string message;
+  try {
+    misc::Checkpoint checkpoint(path, misc::Checkpoint::ModeLoad);
+    memory.LoadCheckpoint(checkpoint);
+  } catch (misc::Error& e) {
+    message = e.getMessage();
+  }
+  unlink(path.c_str());
+  EXPECT_NE(std::string::npos, message.find("Expected section 'Memory'"));
+}
+
+}  // namespace mem